@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2023 ARM Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *      Name:    RTE_Components.h
+ *      Purpose: Component selection of the host build
+ *
+ *---------------------------------------------------------------------------*/
+
+#ifndef RTE_COMPONENTS_H
+#define RTE_COMPONENTS_H
+
+/* Device (host_device.c) */
+#define CMSIS_device_header "host_device.h"
+
+/* CMSIS-Driver USART (usart_host.c), with transmit capture */
+#define USART_HOST_CAPTURE
+
+/* Deferred log decoding of captured output (log_host.c) */
+#define LOG_HOST_DECODE
+
+/* Library glue (retarget_host.c), with a counter of rt_fs calls */
+#define RETARGET_HOST_FS_CALLS
+
+/* CMSIS-RTOS2 (os_host.c) */
+#define RTE_CMSIS_RTOS2
+
+/* Compiler I/O: stdio and file interface retargeted by the user */
+#define RTE_Compiler_IO_STDERR
+#define RTE_Compiler_IO_STDERR_User
+#define RTE_Compiler_IO_STDIN
+#define RTE_Compiler_IO_STDIN_User
+#define RTE_Compiler_IO_STDOUT
+#define RTE_Compiler_IO_STDOUT_User
+#define RTE_Compiler_IO_File
+#define RTE_Compiler_IO_File_Interface
+
+#endif /* RTE_COMPONENTS_H */
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2023 ARM Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CMSIS_COMPILER_H__
+#define CMSIS_COMPILER_H__
+
+/*
+  Host replacement for CMSIS-Core cmsis_compiler.h
+
+  Provides the compiler abstraction macros and the core register access
+  functions used by the retarget code. Interrupt masking is modelled with a
+  global lock (see irq_host.c): driver stand-ins call event callbacks while
+  holding it, so code disabling interrupts is serialized against them the
+  same way as on the target.
+*/
+
+#include <stdint.h>
+
+#ifndef   __WEAK
+  #define __WEAK                    __attribute__((weak))
+#endif
+#ifndef   __STATIC_INLINE
+  #define __STATIC_INLINE           static inline
+#endif
+#ifndef   __STATIC_FORCEINLINE
+  #define __STATIC_FORCEINLINE      __attribute__((always_inline)) static inline
+#endif
+#ifndef   __NO_RETURN
+  #define __NO_RETURN               __attribute__((__noreturn__))
+#endif
+#ifndef   __USED
+  #define __USED                    __attribute__((used))
+#endif
+#ifndef   __ALIGNED
+  #define __ALIGNED(x)              __attribute__((aligned(x)))
+#endif
+#ifndef   __PACKED
+  #define __PACKED                  __attribute__((packed, aligned(1)))
+#endif
+
+/* Interrupt model */
+extern void     __disable_irq (void);
+extern void     __enable_irq  (void);
+extern uint32_t __get_PRIMASK (void);
+extern void     __set_PRIMASK (uint32_t priMask);
+extern uint32_t __get_IPSR    (void);
+
+/* Run an "interrupt handler" in the context of the calling host thread */
+extern void     host_irq_enter (void);
+extern void     host_irq_exit  (void);
+
+/* Barriers */
+#define __DSB()                     __sync_synchronize()
+#define __ISB()                     __sync_synchronize()
+#define __DMB()                     __sync_synchronize()
+
+/* Instructions */
+#define __NOP()                     __asm volatile ("")
+
+#endif /* CMSIS_COMPILER_H__ */
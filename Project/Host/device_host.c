@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2023 ARM Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *      Name:    device_host.c
+ *      Purpose: Device interrupt model of the host build
+ *
+ *---------------------------------------------------------------------------*/
+
+#include <stddef.h>
+
+#include "host_device.h"
+
+uint32_t SystemCoreClock = 100000000U;
+
+/* Default interrupt handler */
+void Default_Handler (void) {
+}
+
+void Interrupt0_Handler (void) __attribute__((weak, alias("Default_Handler")));
+void Interrupt1_Handler (void) __attribute__((weak, alias("Default_Handler")));
+void Interrupt2_Handler (void) __attribute__((weak, alias("Default_Handler")));
+void Interrupt3_Handler (void) __attribute__((weak, alias("Default_Handler")));
+void Interrupt4_Handler (void) __attribute__((weak, alias("Default_Handler")));
+void Interrupt5_Handler (void) __attribute__((weak, alias("Default_Handler")));
+void Interrupt6_Handler (void) __attribute__((weak, alias("Default_Handler")));
+void Interrupt7_Handler (void) __attribute__((weak, alias("Default_Handler")));
+
+static void (* const irq_vector[HOST_IRQ_NUM])(void) = {
+  Interrupt0_Handler,
+  Interrupt1_Handler,
+  Interrupt2_Handler,
+  Interrupt3_Handler,
+  Interrupt4_Handler,
+  Interrupt5_Handler,
+  Interrupt6_Handler,
+  Interrupt7_Handler
+};
+
+static volatile uint32_t irq_enabled;
+
+void NVIC_EnableIRQ (IRQn_Type IRQn) {
+  if ((uint32_t)IRQn < HOST_IRQ_NUM) {
+    __atomic_fetch_or(&irq_enabled, 1U << IRQn, __ATOMIC_SEQ_CST);
+  }
+}
+
+void NVIC_DisableIRQ (IRQn_Type IRQn) {
+  if ((uint32_t)IRQn < HOST_IRQ_NUM) {
+    __atomic_fetch_and(&irq_enabled, ~(1U << IRQn), __ATOMIC_SEQ_CST);
+  }
+}
+
+void NVIC_SetPriority (IRQn_Type IRQn, uint32_t priority) {
+  /* Interrupts do not preempt each other in the model */
+  (void)IRQn;
+  (void)priority;
+}
+
+void NVIC_SetPendingIRQ (IRQn_Type IRQn) {
+
+  if (((uint32_t)IRQn < HOST_IRQ_NUM) && ((irq_enabled & (1U << IRQn)) != 0U)) {
+    host_irq_enter();
+    irq_vector[IRQn]();
+    host_irq_exit();
+  }
+}
+
+uint32_t NVIC_GetPendingIRQ (IRQn_Type IRQn) {
+  /* Pending interrupts are executed at once */
+  (void)IRQn;
+  return (0U);
+}
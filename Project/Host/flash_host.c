@@ -0,0 +1,279 @@
+/*
+ * Copyright (C) 2023 ARM Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *      Name:    flash_host.c
+ *      Purpose: CMSIS-Driver Flash stand-in for POSIX hosts (NOR in RAM)
+ *
+ *---------------------------------------------------------------------------*/
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "Driver_Flash.h"
+
+/*
+  A NOR flash device of FLASH_HOST_SECTOR_NUM sectors of
+  FLASH_HOST_SECTOR_SIZE bytes, kept in RAM. Erased bytes read as 0xFF,
+  programming clears bits only (the new content is old AND data), a
+  sector erase sets all its bytes to 0xFF. The content is kept over
+  Uninitialize, like on a real device.
+
+  When FLASH_HOST_TIMING is non-zero, operations take as long as on a
+  serial NOR device: a sector erase FLASH_HOST_ERASE_TIME us, programming
+  FLASH_HOST_PROGRAM_TIME us per page plus FLASH_HOST_BYTE_TIME ns per
+  byte. Reads are not delayed. The driver is synchronous: operations are
+  completed on return and GetStatus never reports busy.
+*/
+#ifndef FLASH_HOST_SECTOR_SIZE
+#define FLASH_HOST_SECTOR_SIZE  4096
+#endif
+#ifndef FLASH_HOST_SECTOR_NUM
+#define FLASH_HOST_SECTOR_NUM   64
+#endif
+#ifndef FLASH_HOST_PAGE_SIZE
+#define FLASH_HOST_PAGE_SIZE    256
+#endif
+#ifndef FLASH_HOST_TIMING
+#define FLASH_HOST_TIMING       1
+#endif
+#ifndef FLASH_HOST_ERASE_TIME
+#define FLASH_HOST_ERASE_TIME   20000
+#endif
+#ifndef FLASH_HOST_PROGRAM_TIME
+#define FLASH_HOST_PROGRAM_TIME 10
+#endif
+#ifndef FLASH_HOST_BYTE_TIME
+#define FLASH_HOST_BYTE_TIME    1500
+#endif
+
+#define FLASH_HOST_SIZE         (FLASH_HOST_SECTOR_SIZE * FLASH_HOST_SECTOR_NUM)
+
+#define ARM_FLASH_DRV_VERSION   ARM_DRIVER_VERSION_MAJOR_MINOR(1, 0)
+
+static const ARM_DRIVER_VERSION DriverVersion = {
+  ARM_FLASH_API_VERSION,
+  ARM_FLASH_DRV_VERSION
+};
+
+static const ARM_FLASH_CAPABILITIES DriverCapabilities = {
+  0, /* event_ready */
+  0, /* data_width = 0:8-bit, 1:16-bit, 2:32-bit */
+  1, /* erase_chip */
+  0  /* reserved (must be zero) */
+};
+
+static ARM_FLASH_INFO FlashInfo = {
+  NULL,                         /* Uniform sector layout */
+  FLASH_HOST_SECTOR_NUM,
+  FLASH_HOST_SECTOR_SIZE,
+  FLASH_HOST_PAGE_SIZE,
+  1U,                           /* Program unit in bytes */
+  0xFFU,                        /* Erased value */
+  { 0U, 0U, 0U }
+};
+
+/* Driver state */
+static struct {
+  uint8_t powered;
+  uint8_t erased;               /* Memory set to the erased value */
+} flash;
+
+static uint8_t flash_mem[FLASH_HOST_SIZE];
+
+static pthread_mutex_t flash_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Wait for the time of a device operation */
+static void flash_delay (uint64_t ns) {
+#if (FLASH_HOST_TIMING != 0)
+  struct timespec now, end, ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  end.tv_sec  += (time_t)(ns / 1000000000U);
+  end.tv_nsec += (long)  (ns % 1000000000U);
+  if (end.tv_nsec >= 1000000000L) {
+    end.tv_sec  += 1;
+    end.tv_nsec -= 1000000000L;
+  }
+
+  if (ns > 200000U) {
+    /* Sleep for the most part, nanosleep takes longer than requested */
+    ns -= 100000U;
+    ts.tv_sec  = (time_t)(ns / 1000000000U);
+    ts.tv_nsec = (long)  (ns % 1000000000U);
+    nanosleep(&ts, NULL);
+  }
+
+  /* Busy wait for the rest */
+  do {
+    clock_gettime(CLOCK_MONOTONIC, &now);
+  } while ((now.tv_sec < end.tv_sec) || ((now.tv_sec == end.tv_sec) && (now.tv_nsec < end.tv_nsec)));
+#else
+  (void)ns;
+#endif
+}
+
+static ARM_DRIVER_VERSION Flash_GetVersion (void) {
+  return (DriverVersion);
+}
+
+static ARM_FLASH_CAPABILITIES Flash_GetCapabilities (void) {
+  return (DriverCapabilities);
+}
+
+static int32_t Flash_Initialize (ARM_Flash_SignalEvent_t cb_event) {
+
+  /* Synchronous driver: no events */
+  (void)cb_event;
+
+  pthread_mutex_lock(&flash_mutex);
+  if (flash.erased == 0U) {
+    /* A new device is erased */
+    memset(flash_mem, 0xFF, sizeof(flash_mem));
+    flash.erased = 1U;
+  }
+  pthread_mutex_unlock(&flash_mutex);
+
+  return (ARM_DRIVER_OK);
+}
+
+static int32_t Flash_Uninitialize (void) {
+  flash.powered = 0U;
+  return (ARM_DRIVER_OK);
+}
+
+static int32_t Flash_PowerControl (ARM_POWER_STATE state) {
+  switch (state) {
+    case ARM_POWER_OFF:
+      flash.powered = 0U;
+      break;
+    case ARM_POWER_FULL:
+      flash.powered = 1U;
+      break;
+    case ARM_POWER_LOW:
+    default:
+      return (ARM_DRIVER_ERROR_UNSUPPORTED);
+  }
+  return (ARM_DRIVER_OK);
+}
+
+static int32_t Flash_ReadData (uint32_t addr, void *data, uint32_t cnt) {
+
+  if ((data == NULL) || (addr > FLASH_HOST_SIZE) || (cnt > (FLASH_HOST_SIZE - addr))) {
+    return (ARM_DRIVER_ERROR_PARAMETER);
+  }
+  if (flash.powered == 0U) {
+    return (ARM_DRIVER_ERROR);
+  }
+
+  pthread_mutex_lock(&flash_mutex);
+  memcpy(data, &flash_mem[addr], cnt);
+  pthread_mutex_unlock(&flash_mutex);
+
+  return ((int32_t)cnt);
+}
+
+static int32_t Flash_ProgramData (uint32_t addr, const void *data, uint32_t cnt) {
+  const uint8_t *p = data;
+  uint32_t i, k, n;
+
+  if ((data == NULL) || (addr > FLASH_HOST_SIZE) || (cnt > (FLASH_HOST_SIZE - addr))) {
+    return (ARM_DRIVER_ERROR_PARAMETER);
+  }
+  if (flash.powered == 0U) {
+    return (ARM_DRIVER_ERROR);
+  }
+
+  pthread_mutex_lock(&flash_mutex);
+  for (i = 0U; i < cnt; i += n) {
+    /* One page program operation up to the end of the page */
+    n = FLASH_HOST_PAGE_SIZE - ((addr + i) % FLASH_HOST_PAGE_SIZE);
+    if (n > (cnt - i)) {
+      n = cnt - i;
+    }
+    for (k = 0U; k < n; k++) {
+      flash_mem[addr + i + k] &= p[i + k];
+    }
+    flash_delay(((uint64_t)FLASH_HOST_PROGRAM_TIME * 1000U) + ((uint64_t)n * FLASH_HOST_BYTE_TIME));
+  }
+  pthread_mutex_unlock(&flash_mutex);
+
+  return ((int32_t)cnt);
+}
+
+static int32_t Flash_EraseSector (uint32_t addr) {
+
+  if (addr >= FLASH_HOST_SIZE) {
+    return (ARM_DRIVER_ERROR_PARAMETER);
+  }
+  if (flash.powered == 0U) {
+    return (ARM_DRIVER_ERROR);
+  }
+
+  pthread_mutex_lock(&flash_mutex);
+  addr -= addr % FLASH_HOST_SECTOR_SIZE;
+  memset(&flash_mem[addr], 0xFF, FLASH_HOST_SECTOR_SIZE);
+  flash_delay((uint64_t)FLASH_HOST_ERASE_TIME * 1000U);
+  pthread_mutex_unlock(&flash_mutex);
+
+  return (ARM_DRIVER_OK);
+}
+
+static int32_t Flash_EraseChip (void) {
+
+  if (flash.powered == 0U) {
+    return (ARM_DRIVER_ERROR);
+  }
+
+  pthread_mutex_lock(&flash_mutex);
+  memset(flash_mem, 0xFF, sizeof(flash_mem));
+  flash_delay((uint64_t)FLASH_HOST_ERASE_TIME * 1000U * FLASH_HOST_SECTOR_NUM);
+  pthread_mutex_unlock(&flash_mutex);
+
+  return (ARM_DRIVER_OK);
+}
+
+static ARM_FLASH_STATUS Flash_GetStatus (void) {
+  ARM_FLASH_STATUS status;
+
+  /* Operations are completed on return */
+  status.busy     = 0U;
+  status.error    = 0U;
+  status.reserved = 0U;
+
+  return (status);
+}
+
+static ARM_FLASH_INFO *Flash_GetInfo (void) {
+  return (&FlashInfo);
+}
+
+extern ARM_DRIVER_FLASH Driver_Flash0;
+       ARM_DRIVER_FLASH Driver_Flash0 = {
+  Flash_GetVersion,
+  Flash_GetCapabilities,
+  Flash_Initialize,
+  Flash_Uninitialize,
+  Flash_PowerControl,
+  Flash_ReadData,
+  Flash_ProgramData,
+  Flash_EraseSector,
+  Flash_EraseChip,
+  Flash_GetStatus,
+  Flash_GetInfo
+};
@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2023 ARM Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *      Name:    host_device.h
+ *      Purpose: Device header of the host build
+ *
+ *---------------------------------------------------------------------------*/
+
+#ifndef HOST_DEVICE_H__
+#define HOST_DEVICE_H__
+
+#include <stdint.h>
+#include "cmsis_compiler.h"
+
+/* Number of modelled device interrupts */
+#define HOST_IRQ_NUM            8
+
+typedef enum {
+  Interrupt0_IRQn = 0,
+  Interrupt1_IRQn = 1,
+  Interrupt2_IRQn = 2,
+  Interrupt3_IRQn = 3,
+  Interrupt4_IRQn = 4,
+  Interrupt5_IRQn = 5,
+  Interrupt6_IRQn = 6,
+  Interrupt7_IRQn = 7
+} IRQn_Type;
+
+extern uint32_t SystemCoreClock;
+
+/* NVIC model: a pending enabled interrupt runs at once in the calling thread */
+extern void     NVIC_EnableIRQ     (IRQn_Type IRQn);
+extern void     NVIC_DisableIRQ    (IRQn_Type IRQn);
+extern void     NVIC_SetPriority   (IRQn_Type IRQn, uint32_t priority);
+extern void     NVIC_SetPendingIRQ (IRQn_Type IRQn);
+extern uint32_t NVIC_GetPendingIRQ (IRQn_Type IRQn);
+
+#endif /* HOST_DEVICE_H__ */
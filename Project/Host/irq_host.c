@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2023 ARM Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <pthread.h>
+#include "cmsis_compiler.h"
+
+/* Global interrupt lock: held while "interrupts" are disabled or an
+   interrupt handler is running */
+static pthread_mutex_t irq_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static __thread uint32_t irq_masked;  /* Calling thread holds irq_lock */
+static __thread uint32_t irq_active;  /* Calling thread runs a handler */
+
+void __disable_irq (void) {
+  if (irq_masked == 0U) {
+    pthread_mutex_lock(&irq_lock);
+    irq_masked = 1U;
+  }
+}
+
+void __enable_irq (void) {
+  if ((irq_masked != 0U) && (irq_active == 0U)) {
+    irq_masked = 0U;
+    pthread_mutex_unlock(&irq_lock);
+  }
+}
+
+uint32_t __get_PRIMASK (void) {
+  return (irq_masked);
+}
+
+void __set_PRIMASK (uint32_t priMask) {
+  if (priMask != 0U) {
+    __disable_irq();
+  } else {
+    __enable_irq();
+  }
+}
+
+uint32_t __get_IPSR (void) {
+  /* Report a non-zero exception number while a handler is running */
+  return ((irq_active != 0U) ? 16U : 0U);
+}
+
+void host_irq_enter (void) {
+  __disable_irq();
+  irq_active = 1U;
+}
+
+void host_irq_exit (void) {
+  irq_active = 0U;
+  __enable_irq();
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2023 ARM Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *      Name:    itm_host.c
+ *      Purpose: Software model of the ITM stimulus port FIFO
+ *
+ *---------------------------------------------------------------------------*/
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "itm_host.h"
+
+/*
+  Every stimulus port write creates a packet of one header byte followed by
+  1, 2 or 4 payload bytes. Packets are queued in a FIFO of ITM_HOST_FIFO_SIZE
+  bytes which drains to the SWO pin at ITM_HOST_SWO_BAUD (UART/NRZ encoding,
+  10 bits per byte). A port is ready while the FIFO has room for a packet.
+
+  Payload of port 0 is written to file descriptor 1, payload of port 1 to
+  file descriptor 2, payload of other ports is only counted.
+*/
+
+#ifndef ITM_HOST_SWO_BAUD
+#define ITM_HOST_SWO_BAUD       2000000U
+#endif
+
+#ifndef ITM_HOST_FIFO_SIZE
+#define ITM_HOST_FIFO_SIZE      10U
+#endif
+
+/* Enabled stimulus ports (ITM TER) */
+#ifndef ITM_HOST_TER
+#define ITM_HOST_TER            0xFFFFFFFFU
+#endif
+
+static pthread_mutex_t itm_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static uint64_t         itm_drain_ns;   /* Time the FIFO becomes empty      */
+static itm_host_stats_t itm_stats;
+
+/* Current time in nanoseconds */
+static uint64_t itm_now (void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec);
+}
+
+/* Time to transmit cnt bytes on SWO in nanoseconds */
+static uint64_t itm_wire_ns (uint32_t cnt) {
+  return (((uint64_t)cnt * 10U * 1000000000U) / ITM_HOST_SWO_BAUD);
+}
+
+uint32_t itm_host_enabled (uint32_t port) {
+  return (((ITM_HOST_TER >> port) & 1U) != 0U);
+}
+
+uint32_t itm_host_ready (uint32_t port) {
+  uint64_t now, level;
+  uint32_t ready;
+
+  (void)port;
+
+  pthread_mutex_lock(&itm_lock);
+
+  now   = itm_now();
+  level = 0U;
+  if (itm_drain_ns > now) {
+    /* Bytes still queued in the FIFO */
+    level = ((itm_drain_ns - now) * ITM_HOST_SWO_BAUD + (10U * 1000000000U - 1U)) / (10U * 1000000000U);
+  }
+
+  ready = ((level + 5U) <= ITM_HOST_FIFO_SIZE) ? 1U : 0U;
+  if (ready == 0U) {
+    itm_stats.stalls++;
+  }
+
+  pthread_mutex_unlock(&itm_lock);
+
+  return (ready);
+}
+
+void itm_host_write (uint32_t port, uint32_t val, uint32_t size) {
+  uint8_t  buf[4];
+  uint64_t now;
+  int      fd;
+
+  pthread_mutex_lock(&itm_lock);
+
+  now = itm_now();
+  if (itm_drain_ns < now) {
+    itm_drain_ns = now;
+  }
+  itm_drain_ns += itm_wire_ns(1U + size);
+
+  itm_stats.payload    += size;
+  itm_stats.packets    += 1U;
+  itm_stats.wire_bytes += 1U + size;
+
+  pthread_mutex_unlock(&itm_lock);
+
+  buf[0] = (uint8_t)(val);
+  buf[1] = (uint8_t)(val >>  8);
+  buf[2] = (uint8_t)(val >> 16);
+  buf[3] = (uint8_t)(val >> 24);
+
+  fd = (port == 0U) ? 1 : ((port == 1U) ? 2 : -1);
+  if (fd >= 0) {
+    (void)write(fd, buf, size);
+  }
+}
+
+uint32_t ITM_SendChar (uint32_t ch) {
+
+  if (itm_host_enabled(0U) != 0U) {
+    while (itm_host_ready(0U) == 0U);
+    itm_host_write(0U, ch, 1U);
+  }
+  return (ch);
+}
+
+int32_t ITM_ReceiveChar (void) {
+  struct pollfd pfd;
+  uint8_t ch;
+
+  pfd.fd     = 0;
+  pfd.events = POLLIN;
+
+  if ((poll(&pfd, 1, 0) > 0) && (read(0, &ch, 1) == 1)) {
+    return ((int32_t)ch);
+  }
+  return (-1);
+}
+
+void itm_host_get_stats (itm_host_stats_t *stats) {
+
+  pthread_mutex_lock(&itm_lock);
+  *stats = itm_stats;
+  pthread_mutex_unlock(&itm_lock);
+}
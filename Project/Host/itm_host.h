@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2023 ARM Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *      Name:    itm_host.h
+ *      Purpose: Software model of the ITM stimulus port FIFO
+ *
+ *---------------------------------------------------------------------------*/
+
+#ifndef ITM_HOST_H__
+#define ITM_HOST_H__
+
+#include <stdint.h>
+
+/* Model statistics */
+typedef struct {
+  uint32_t payload;             /* Number of payload bytes                  */
+  uint32_t packets;             /* Number of stimulus packets               */
+  uint32_t wire_bytes;          /* Number of bytes on SWO incl. headers     */
+  uint32_t stalls;              /* Number of ready polls with FIFO full     */
+} itm_host_stats_t;
+
+/* Stimulus port access */
+extern uint32_t itm_host_enabled (uint32_t port);
+extern uint32_t itm_host_ready   (uint32_t port);
+extern void     itm_host_write   (uint32_t port, uint32_t val, uint32_t size);
+
+/* Byte oriented CMSIS-Core functions, for comparison */
+extern uint32_t ITM_SendChar     (uint32_t ch);
+extern int32_t  ITM_ReceiveChar  (void);
+
+/* Statistics */
+extern void     itm_host_get_stats (itm_host_stats_t *stats);
+
+#endif /* ITM_HOST_H__ */
@@ -0,0 +1,213 @@
+#!/usr/bin/env python3
+# -----------------------------------------------------------------------------
+# Copyright (c) 2023 Arm Limited (or its affiliates). All rights reserved.
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the License); you may
+# not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an AS IS BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+#      Name:    log_decode.py
+#      Purpose: Decode deferred log frames (see Project/retarget_log.h)
+#
+# -----------------------------------------------------------------------------
+"""
+Render stdout output containing log frames written by LOG_PRINTF.
+
+Format strings are read from the .log_fmt section of the application ELF
+file, frames give their offset from the symbol log_fmt_base. Text outside
+of frames is passed through unchanged.
+
+Usage: log_decode.py <application.elf> [<capture file>]
+       (reads standard input when no capture file is given)
+"""
+
+import re
+import struct
+import sys
+
+FRAME_START = 0xFF
+HDR_SIZE    = 4
+FMT_SECTION = ".log_fmt"
+FMT_BASE    = "log_fmt_base"
+
+CONV = re.compile(rb"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d+))?(hh|h|ll|l|L|z|j|t)?([diouxXcfFeEgGaAsp%])")
+
+
+def read_section(elf_path, name, symbol):
+    """Return (data, base, is64) of an ELF section: base is the offset of the
+    symbol in the section, is64 is set for 64-bit images."""
+    with open(elf_path, "rb") as f:
+        elf = f.read()
+
+    if elf[:4] != b"\x7fELF":
+        raise ValueError("not an ELF file")
+    is64 = elf[4] == 2
+    end  = "<" if elf[5] == 1 else ">"
+
+    if is64:
+        shoff, = struct.unpack_from(end + "Q", elf, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from(end + "HHH", elf, 0x3A)
+        shdr = end + "IIQQQQIIQQ"
+    else:
+        shoff, = struct.unpack_from(end + "I", elf, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from(end + "HHH", elf, 0x2E)
+        shdr = end + "IIIIIIIIII"
+
+    def cstr(off):
+        return elf[off:elf.index(b"\0", off)].decode()
+
+    sections = [struct.unpack_from(shdr, elf, shoff + i * shentsize) for i in range(shnum)]
+    strtab   = sections[shstrndx]
+    for idx, (sh_name, sh_type, _, sh_addr, sh_offset, sh_size, *_) in enumerate(sections):
+        if cstr(strtab[4] + sh_name) == name:
+            break
+    else:
+        raise ValueError("section %s not found" % name)
+    data = b"" if sh_type == 8 else elf[sh_offset:sh_offset + sh_size]
+
+    # Symbol table (SHT_SYMTAB), its sh_link is the string table
+    for _, st_type, _, _, st_offset, st_size, st_link, _, _, st_entsize in sections:
+        if st_type != 2:
+            continue
+        names = sections[st_link][4]
+        for off in range(st_offset, st_offset + st_size, st_entsize):
+            if is64:
+                st_name, _, _, st_shndx, st_value = struct.unpack_from(end + "IBBHQ", elf, off)
+            else:
+                st_name, st_value, _, _, _, st_shndx = struct.unpack_from(end + "IIIBBH", elf, off)
+            if st_shndx == idx and cstr(names + st_name) == symbol:
+                return data, st_value - sh_addr, is64
+
+    raise ValueError("symbol %s not found" % symbol)
+
+
+class Args:
+    """Sequential reader of frame argument bytes."""
+
+    def __init__(self, data):
+        self.data = data
+        self.pos  = 0
+
+    def take(self, fmt):
+        size = struct.calcsize(fmt)
+        if self.pos + size > len(self.data):
+            return None
+        val, = struct.unpack_from(fmt, self.data, self.pos)
+        self.pos += size
+        return val
+
+    def string(self):
+        n = self.take("<B")
+        if n is None or self.pos + n > len(self.data):
+            return None
+        s = self.data[self.pos:self.pos + n]
+        self.pos += n
+        return s.decode("latin-1")
+
+
+def arg_sizes(is64):
+    """Argument sizes of integer length modifiers and pointers on the target."""
+    word = 8 if is64 else 4
+    return {"": 4, "hh": 4, "h": 4, "l": word, "ll": 8, "L": 8, "j": 8,
+            "z": word, "t": word, "p": word}
+
+
+def render(fmt, data, sizes):
+    """Format a log message from the format string and argument bytes."""
+    args = Args(data)
+
+    def conv(m):
+        flags, width, prec, lng, c = (g.decode() if g else "" for g in m.groups())
+        if c == "%":
+            return "%"
+        if width == "*":
+            width = args.take("<i")
+            if width is None:
+                return "<?>"
+            width = str(width)
+        if prec == "*":
+            prec = args.take("<i")
+            if prec is None:
+                return "<?>"
+            prec = str(prec)
+        spec = "%" + flags + width + ("." + prec if prec != "" else "")
+
+        wide = sizes[lng] == 8
+        if c in "di":
+            val = args.take("<q" if wide else "<i")
+            c = "d"
+        elif c in "uoxX":
+            val = args.take("<Q" if wide else "<I")
+            c = "d" if c == "u" else c
+        elif c == "c":
+            val = args.take("<I")
+            val = None if val is None else chr(val & 0xFF)
+        elif c in "fFeEgGaA":
+            val = args.take("<d")
+            if val is not None and c in "aA":
+                val = val.hex() if c == "a" else val.hex().upper()
+                c = "s"
+        elif c == "s":
+            val = args.string()
+        else:  # 'p'
+            wide = sizes["p"] == 8
+            val = args.take("<Q" if wide else "<I")
+            val = None if val is None else ("0x%016x" if wide else "0x%08x") % val
+            c = "s"
+
+        if val is None:
+            return "<?>"
+        return (spec + c) % val
+
+    return CONV.sub(lambda m: conv(m).encode("latin-1"), fmt).decode("latin-1")
+
+
+def decode(stream, strings, base, sizes, out):
+    """Decode a byte stream, pass text through and render frames."""
+    buf = stream.read()
+    pos = 0
+    while pos < len(buf):
+        idx = buf.find(bytes([FRAME_START]), pos)
+        if idx < 0:
+            out.write(buf[pos:].decode("latin-1"))
+            break
+        out.write(buf[pos:idx].decode("latin-1"))
+        if idx + HDR_SIZE > len(buf):
+            break
+        n, rel = struct.unpack_from("<Bh", buf, idx + 1)
+        data   = buf[idx + HDR_SIZE:idx + HDR_SIZE + n]
+        off    = base + rel
+        if 0 <= off < len(strings):
+            fmt = strings[off:strings.index(b"\0", off)]
+            out.write(render(fmt, data, sizes))
+        else:
+            out.write("<unknown log format %+d>\n" % rel)
+        pos = idx + HDR_SIZE + n
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit(__doc__)
+
+    strings, base, is64 = read_section(sys.argv[1], FMT_SECTION, FMT_BASE)
+    sizes = arg_sizes(is64)
+
+    if len(sys.argv) > 2:
+        with open(sys.argv[2], "rb") as f:
+            decode(f, strings, base, sizes, sys.stdout)
+    else:
+        decode(sys.stdin.buffer, strings, base, sizes, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2023 ARM Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *      Name:    log_host.c
+ *      Purpose: Deferred log decoding of captured output on the host
+ *
+ *---------------------------------------------------------------------------*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "log_host.h"
+
+/*
+  The captured data is written to a temporary file and decoded by running
+  log_decode.py with the running executable, which holds the format strings.
+  The decoder is taken from the directory of this source file unless its
+  path is given with LOG_HOST_DECODER.
+*/
+
+#ifndef LOG_HOST_PYTHON
+#define LOG_HOST_PYTHON         "python3"
+#endif
+
+int32_t log_host_decode (const uint8_t *data, uint32_t len, char *text, uint32_t size) {
+  char tmp[] = "/tmp/log_host_XXXXXX";
+  char exe[256];
+  char cmd[1024];
+  const char *dir;
+  int32_t rval;
+  ssize_t n;
+  size_t cnt;
+  FILE *p;
+  int fd;
+
+  if ((text == NULL) || (size == 0U)) {
+    return (-1);
+  }
+  text[0] = '\0';
+
+  n = readlink("/proc/self/exe", exe, sizeof(exe) - 1U);
+  if (n <= 0) {
+    return (-1);
+  }
+  exe[n] = '\0';
+
+  fd = mkstemp(tmp);
+  if (fd < 0) {
+    return (-1);
+  }
+  n = write(fd, data, len);
+  close(fd);
+
+#ifdef LOG_HOST_DECODER
+  (void)dir;
+  snprintf(cmd, sizeof(cmd), "%s '%s' '%s' '%s'", LOG_HOST_PYTHON, LOG_HOST_DECODER, exe, tmp);
+#else
+  dir = strrchr(__FILE__, '/');
+  snprintf(cmd, sizeof(cmd), "%s '%.*slog_decode.py' '%s' '%s'", LOG_HOST_PYTHON,
+           (dir != NULL) ? (int)(dir - __FILE__) + 1 : 0, __FILE__, exe, tmp);
+#endif
+
+  rval = -1;
+  if (n == (ssize_t)len) {
+    p = popen(cmd, "r");
+    if (p != NULL) {
+      cnt = fread(text, 1U, size - 1U, p);
+      text[cnt] = '\0';
+      if (pclose(p) == 0) {
+        rval = (int32_t)cnt;
+      }
+    }
+  }
+  unlink(tmp);
+
+  return (rval);
+}
@@ -0,0 +1,32 @@
+/*
+ * Copyright (C) 2023 ARM Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *      Name:    log_host.h
+ *      Purpose: Deferred log decoding of captured output on the host
+ *
+ *---------------------------------------------------------------------------*/
+
+#ifndef LOG_HOST_H__
+#define LOG_HOST_H__
+
+#include <stdint.h>
+
+/* Decode output containing log frames with log_decode.py and the running
+   executable, return the length of the text (null terminated) or -1 */
+extern int32_t log_host_decode (const uint8_t *data, uint32_t len, char *text, uint32_t size);
+
+#endif /* LOG_HOST_H__ */
@@ -0,0 +1,421 @@
+/*
+ * Copyright (C) 2023 ARM Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *      Name:    mdkfs_host.c
+ *      Purpose: MDK-FS stand-in for POSIX hosts (files on the host file system)
+ *
+ *---------------------------------------------------------------------------*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include <rt_sys.h>
+#include "rl_fs_lib.h"
+#include "rl_fs.h"
+
+/*
+  The MDK-FS functions called by Project/retarget_mdk-fs.c: the low level
+  file functions __sys_open, __sys_close, __sys_write, __sys_read,
+  __sys_ensure, __sys_seek and __sys_flen, and fdelete, frename, ffind,
+  fmkdir, frmdir and fmedia. Files are kept in MDKFS_HOST_ROOT on the host,
+  a drive prefix ("M0:") is removed.
+
+  A commit to the medium (__sys_ensure, and __sys_close, which writes the
+  directory entry of a file changed) takes MDKFS_HOST_COMMIT_TIME us, one
+  commit at a time as on a single card; host data is not synced. So
+  closing and reopening a file and rt_fs_sync both pay one commit per
+  durable record, and commits saved by group commit show as time saved.
+
+  Each __sys_write takes MDKFS_HOST_WRITE_TIME us in addition, outside of
+  the commit lock: writes of different threads overlap, as on a drive
+  queueing requests, so a retarget that waits for the drive without
+  blocking calls on other files shows higher throughput with more writers.
+
+  ffind lists a directory for a pattern ending with "*", fileID counts the
+  entries found; "." and ".." are listed, as in FAT subdirectories. Host
+  calls not redirected with --wrap are used (renameat, unlink), so the
+  stand-in can be linked with the test suite.
+*/
+#ifndef MDKFS_HOST_ROOT
+#define MDKFS_HOST_ROOT         "."
+#endif
+#ifndef MDKFS_HOST_COMMIT_TIME
+#define MDKFS_HOST_COMMIT_TIME  2000
+#endif
+#ifndef MDKFS_HOST_WRITE_TIME
+#define MDKFS_HOST_WRITE_TIME   1000
+#endif
+
+/* Maximum length of a host path */
+#define MDKFS_HOST_PATH_MAX     256
+
+/* Commits are serialized */
+static pthread_mutex_t mdkfs_host_commit_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Convert errno value to file system status */
+static fsStatus errno_to_fs (int err) {
+  fsStatus stat;
+
+  if      (err == ENOENT)    { stat = fsFileNotFound;     }
+  else if (err == ENOTDIR)   { stat = fsFileNotFound;     }
+  else if (err == EEXIST)    { stat = fsAlreadyExists;    }
+  else if (err == ENOTEMPTY) { stat = fsDirNotEmpty;      }
+  else if (err == EACCES)    { stat = fsAccessDenied;     }
+  else if (err == EBUSY)     { stat = fsAccessDenied;     }
+  else if (err == EISDIR)    { stat = fsAccessDenied;     }
+  else if (err == ENOSPC)    { stat = fsNoFreeSpace;      }
+  else if (err == EMFILE)    { stat = fsTooManyOpenFiles; }
+  else if (err == EINVAL)    { stat = fsInvalidParameter; }
+  else                       { stat = fsError;            }
+
+  return (stat);
+}
+
+/* Convert a path to a host path, a drive prefix ("M0:") is removed */
+static fsStatus host_path (char *buf, const char *path) {
+  const char *p;
+  char *q;
+  int n;
+
+  if (path == NULL) {
+    return (fsInvalidParameter);
+  }
+
+  p = strchr(path, ':');
+  if ((p != NULL) && ((p - path) <= 2)) {
+    path = p + 1;
+  }
+  while ((*path == '/') || (*path == '\\')) {
+    path++;
+  }
+
+  n = snprintf(buf, MDKFS_HOST_PATH_MAX, "%s/%s", MDKFS_HOST_ROOT, path);
+  if ((n < 0) || (n >= MDKFS_HOST_PATH_MAX)) {
+    return (fsInvalidPath);
+  }
+  for (q = buf; *q != '\0'; q++) {
+    if (*q == '\\') {
+      *q = '/';
+    }
+  }
+  return (fsOK);
+}
+
+#if (MDKFS_HOST_COMMIT_TIME > 0) || (MDKFS_HOST_WRITE_TIME > 0)
+/* Wait for the medium */
+static void host_delay (uint32_t us) {
+  struct timespec ts;
+
+  ts.tv_sec  = (time_t)(us / 1000000U);
+  ts.tv_nsec = (long)(us % 1000000U) * 1000L;
+
+  while (nanosleep(&ts, &ts) != 0) {
+    /* Interrupted by a signal */
+  }
+}
+#endif
+
+/* Commit to the medium */
+static void host_commit (void) {
+#if (MDKFS_HOST_COMMIT_TIME > 0)
+  pthread_mutex_lock(&mdkfs_host_commit_lock);
+  host_delay(MDKFS_HOST_COMMIT_TIME);
+  pthread_mutex_unlock(&mdkfs_host_commit_lock);
+#endif
+}
+
+/* Fill in file information of a host path */
+static fsStatus host_info (const char *buf, fsFileInfo *info) {
+  struct stat st;
+  struct tm tm;
+
+  if (stat(buf, &st) != 0) {
+    return (errno_to_fs(errno));
+  }
+  localtime_r(&st.st_mtime, &tm);
+
+  info->size      = (uint32_t)st.st_size;
+  info->attrib    = S_ISDIR(st.st_mode) ? FS_FAT_ATTR_DIRECTORY : FS_FAT_ATTR_ARCHIVE;
+  info->time.year = (uint16_t)(tm.tm_year + 1900);
+  info->time.mon  = (uint8_t)(tm.tm_mon + 1);
+  info->time.day  = (uint8_t)tm.tm_mday;
+  info->time.hr   = (uint8_t)tm.tm_hour;
+  info->time.min  = (uint8_t)tm.tm_min;
+  info->time.sec  = (uint8_t)tm.tm_sec;
+
+  return (fsOK);
+}
+
+/* Open a file, return handle or negative status */
+int __sys_open (const char *fname, int openmode) {
+  char buf[MDKFS_HOST_PATH_MAX];
+  fsStatus stat;
+  int flags;
+  int fd;
+
+  stat = host_path(buf, fname);
+  if (stat != fsOK) {
+    return (-(int)stat);
+  }
+
+  if ((openmode & OPEN_A) != 0) {
+    flags = ((openmode & OPEN_PLUS) ? O_RDWR : O_WRONLY) | O_CREAT | O_APPEND;
+  } else
+  if ((openmode & OPEN_W) != 0) {
+    flags = ((openmode & OPEN_PLUS) ? O_RDWR : O_WRONLY) | O_CREAT | O_TRUNC;
+  } else {
+    flags = (openmode & OPEN_PLUS) ? O_RDWR : O_RDONLY;
+  }
+
+  fd = open(buf, flags, 0644);
+  if (fd < 0) {
+    return (-(int)errno_to_fs(errno));
+  }
+  return (fd);
+}
+
+/* Close a file, the directory entry is written */
+int __sys_close (int handle) {
+  int acc;
+
+  acc = fcntl(handle, F_GETFL);
+  if (close(handle) != 0) {
+    return (-(int)fsError);
+  }
+  if ((acc >= 0) && ((acc & O_ACCMODE) != O_RDONLY)) {
+    host_commit();
+  }
+  return (0);
+}
+
+/* Write to a file, return number of bytes not written or negative status */
+int __sys_write (int handle, const uint8_t *buf, uint32_t len) {
+  ssize_t n;
+
+#if (MDKFS_HOST_WRITE_TIME > 0)
+  host_delay(MDKFS_HOST_WRITE_TIME);
+#endif
+  n = write(handle, buf, len);
+  if (n < 0) {
+    return (-(int)errno_to_fs(errno));
+  }
+  return ((int)(len - (uint32_t)n));
+}
+
+/* Read from a file, return number of bytes not read, bit 31 set at end of file */
+int __sys_read (int handle, uint8_t *buf, uint32_t len) {
+  ssize_t n;
+
+  n = read(handle, buf, len);
+  if (n < 0) {
+    return (-(int)errno_to_fs(errno));
+  }
+  if ((uint32_t)n < len) {
+    return ((int)((len - (uint32_t)n) | 0x80000000U));
+  }
+  return (0);
+}
+
+/* Commit data and size of a file to the medium */
+int __sys_ensure (int handle) {
+
+  if (fcntl(handle, F_GETFD) < 0) {
+    return (-(int)fsInvalidParameter);
+  }
+  host_commit();
+  return (0);
+}
+
+/* Set the file position, not beyond the end of file */
+int __sys_seek (int handle, uint32_t pos) {
+  struct stat st;
+
+  if (fstat(handle, &st) != 0) {
+    return (-(int)fsInvalidParameter);
+  }
+  if ((off_t)pos > st.st_size) {
+    return (-(int)fsInvalidParameter);
+  }
+  if (lseek(handle, (off_t)pos, SEEK_SET) < 0) {
+    return (-(int)fsError);
+  }
+  return (0);
+}
+
+/* Get the file length */
+int __sys_flen (int handle) {
+  struct stat st;
+
+  if (fstat(handle, &st) != 0) {
+    return (-(int)fsInvalidParameter);
+  }
+  return ((int)st.st_size);
+}
+
+/* Delete a file or an empty directory */
+fsStatus fdelete (const char *path, const char *options) {
+  char buf[MDKFS_HOST_PATH_MAX];
+  fsStatus stat;
+
+  (void)options;
+
+  stat = host_path(buf, path);
+  if (stat != fsOK) {
+    return (stat);
+  }
+  if ((unlink(buf) != 0) && (((errno != EISDIR) && (errno != EPERM)) || (rmdir(buf) != 0))) {
+    return (errno_to_fs(errno));
+  }
+  return (fsOK);
+}
+
+/* Rename a file or directory, newname without directory stays in the same directory */
+fsStatus frename (const char *path, const char *newname) {
+  char buf[MDKFS_HOST_PATH_MAX];
+  char nbuf[MDKFS_HOST_PATH_MAX];
+  const char *dir;
+  fsStatus stat;
+  int n;
+
+  stat = host_path(buf, path);
+  if (stat != fsOK) {
+    return (stat);
+  }
+  if ((newname == NULL) || (*newname == '\0')) {
+    return (fsInvalidParameter);
+  }
+
+  if (strpbrk(newname, "/\\:") == NULL) {
+    dir = strrchr(buf, '/');
+    n   = snprintf(nbuf, sizeof(nbuf), "%.*s/%s", (int)(dir - buf), buf, newname);
+    if ((n < 0) || (n >= (int)sizeof(nbuf))) {
+      return (fsInvalidPath);
+    }
+  } else {
+    stat = host_path(nbuf, newname);
+    if (stat != fsOK) {
+      return (stat);
+    }
+  }
+
+  if (access(nbuf, F_OK) == 0) {
+    return (fsAlreadyExists);
+  }
+  if (renameat(AT_FDCWD, buf, AT_FDCWD, nbuf) != 0) {
+    return (errno_to_fs(errno));
+  }
+  return (fsOK);
+}
+
+/* Find a file or directory, list a directory with a pattern ending with "*" */
+fsStatus ffind (const char *pattern, fsFileInfo *info) {
+  char buf[MDKFS_HOST_PATH_MAX];
+  char ebuf[MDKFS_HOST_PATH_MAX + 256];
+  const struct dirent *e;
+  const char *name;
+  fsStatus stat;
+  DIR *d;
+  size_t len;
+  uint32_t i;
+
+  if (info == NULL) {
+    return (fsInvalidParameter);
+  }
+  stat = host_path(buf, pattern);
+  if (stat != fsOK) {
+    return (stat);
+  }
+
+  len = strlen(buf);
+  if (buf[len - 1U] != '*') {
+    /* Single entry */
+    stat = host_info(buf, info);
+    if (stat == fsOK) {
+      name = strrchr(buf, '/');
+      strncpy(info->name, name + 1, sizeof(info->name) - 1U);
+      info->name[sizeof(info->name) - 1U] = '\0';
+    }
+    return (stat);
+  }
+
+  /* Entry number fileID of the directory */
+  buf[len - 1U] = '\0';
+  d = opendir(buf);
+  if (d == NULL) {
+    return (fsFileNotFound);
+  }
+  stat = fsFileNotFound;
+  for (i = 0U; (e = readdir(d)) != NULL; i++) {
+    if (i == info->fileID) {
+      snprintf(ebuf, sizeof(ebuf), "%s%s", buf, e->d_name);
+      stat = host_info(ebuf, info);
+      strncpy(info->name, e->d_name, sizeof(info->name) - 1U);
+      info->name[sizeof(info->name) - 1U] = '\0';
+      info->fileID = (uint16_t)(i + 1U);
+      break;
+    }
+  }
+  closedir(d);
+
+  return (stat);
+}
+
+/* Create a directory */
+fsStatus fmkdir (const char *path) {
+  char buf[MDKFS_HOST_PATH_MAX];
+  fsStatus stat;
+
+  stat = host_path(buf, path);
+  if (stat != fsOK) {
+    return (stat);
+  }
+  if (mkdir(buf, 0755) != 0) {
+    return (errno_to_fs(errno));
+  }
+  return (fsOK);
+}
+
+/* Remove an empty directory */
+fsStatus frmdir (const char *path, const char *options) {
+  char buf[MDKFS_HOST_PATH_MAX];
+  fsStatus stat;
+
+  (void)options;
+
+  stat = host_path(buf, path);
+  if (stat != fsOK) {
+    return (stat);
+  }
+  if (rmdir(buf) != 0) {
+    return (errno_to_fs(errno));
+  }
+  return (fsOK);
+}
+
+/* Check the media of a drive, the host file system is always present */
+fsStatus fmedia (const char *drive) {
+  (void)drive;
+
+  return (fsOK);
+}
@@ -0,0 +1,711 @@
+/*
+ * Copyright (C) 2023 ARM Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *      Name:    os_host.c
+ *      Purpose: CMSIS-RTOS2 subset on POSIX threads
+ *
+ *---------------------------------------------------------------------------*/
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "cmsis_os2.h"
+#include "cmsis_compiler.h"
+
+/*
+  Threads are POSIX threads scheduled by the host, priorities are ignored.
+  osKernelStart returns when all threads created with osThreadNew before
+  the kernel was started have terminated, so a host application ends when
+  its test run is complete. Threads created later (i.e. service threads of
+  the retarget layer that wait for requests forever) end with the process.
+
+  Kernel tick frequency is OS_HOST_TICK_FREQ, the system timer counts at
+  OS_HOST_SYSTIMER_FREQ derived from CLOCK_MONOTONIC.
+*/
+
+#ifndef OS_HOST_TICK_FREQ
+#define OS_HOST_TICK_FREQ       1000U
+#endif
+
+#ifndef OS_HOST_SYSTIMER_FREQ
+#define OS_HOST_SYSTIMER_FREQ   100000000U
+#endif
+
+#if ((1000000000U % OS_HOST_TICK_FREQ) != 0U) || ((1000000000U % OS_HOST_SYSTIMER_FREQ) != 0U)
+#error "OS_HOST_TICK_FREQ and OS_HOST_SYSTIMER_FREQ must divide 1 GHz."
+#endif
+
+/* Thread control block */
+typedef struct {
+  pthread_t       tid;
+  osThreadFunc_t  func;
+  void           *argument;
+  const char     *name;
+  uint32_t        attr_bits;
+  uint32_t        counted;      /* Counted in os_run_cnt                    */
+  uint32_t        terminated;   /* Thread function has returned or exited   */
+  pthread_mutex_t lock;
+  pthread_cond_t  cond;
+  uint32_t        flags;
+} os_thread_t;
+
+/* Event flags control block */
+typedef struct {
+  pthread_mutex_t lock;
+  pthread_cond_t  cond;
+  uint32_t        flags;
+} os_event_flags_t;
+
+/* Mutex control block */
+typedef struct {
+  pthread_mutex_t mutex;
+} os_mutex_t;
+
+/* Semaphore control block */
+typedef struct {
+  pthread_mutex_t lock;
+  pthread_cond_t  cond;
+  uint32_t        count;
+  uint32_t        max_count;
+} os_semaphore_t;
+
+static osKernelState_t os_state = osKernelInactive;
+
+/* Scheduler lock, held by at most one thread */
+static pthread_mutex_t os_kernel_lock = PTHREAD_MUTEX_INITIALIZER;
+static __thread int32_t os_lock_cnt;
+
+/* Number of running threads created with osThreadNew before osKernelStart */
+static pthread_mutex_t os_run_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  os_run_cond = PTHREAD_COND_INITIALIZER;
+static uint32_t        os_run_cnt;
+
+/* Control block of the calling thread */
+static __thread os_thread_t *os_self;
+
+/* Current time in nanoseconds */
+static uint64_t os_now_ns (void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec);
+}
+
+/* Initialize a condition variable using the monotonic clock */
+static void os_cond_init (pthread_cond_t *cond) {
+  pthread_condattr_t attr;
+
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(cond, &attr);
+  pthread_condattr_destroy(&attr);
+}
+
+/* Absolute monotonic time after the timeout in ticks */
+static void os_deadline (struct timespec *ts, uint32_t timeout) {
+  uint64_t ns;
+
+  ns = os_now_ns() + (((uint64_t)timeout * 1000000000U) / OS_HOST_TICK_FREQ);
+
+  ts->tv_sec  = (time_t)(ns / 1000000000U);
+  ts->tv_nsec = (long)(ns % 1000000000U);
+}
+
+/* Wait on a condition variable, return 0 on timeout */
+static uint32_t os_cond_wait (pthread_cond_t *cond, pthread_mutex_t *lock, const struct timespec *ts, uint32_t timeout) {
+
+  if (timeout == osWaitForever) {
+    pthread_cond_wait(cond, lock);
+    return (1U);
+  }
+  return ((pthread_cond_timedwait(cond, lock, ts) == ETIMEDOUT) ? 0U : 1U);
+}
+
+/* Get control block of the calling thread, allocate it for foreign threads */
+static os_thread_t *os_thread_self (void) {
+  os_thread_t *thread;
+
+  if (os_self == NULL) {
+    thread = calloc(1U, sizeof(os_thread_t));
+    if (thread != NULL) {
+      thread->tid = pthread_self();
+      pthread_mutex_init(&thread->lock, NULL);
+      os_cond_init(&thread->cond);
+    }
+    os_self = thread;
+  }
+  return (os_self);
+}
+
+/* Account termination of the calling thread */
+static void os_thread_done (void) {
+
+  if (os_self != NULL) {
+    os_self->terminated = 1U;
+  }
+  if ((os_self == NULL) || (os_self->counted == 0U)) {
+    return;
+  }
+  pthread_mutex_lock(&os_run_lock);
+  os_self->counted = 0U;
+  os_run_cnt--;
+  pthread_cond_broadcast(&os_run_cond);
+  pthread_mutex_unlock(&os_run_lock);
+}
+
+/* Thread entry */
+static void *os_thread_entry (void *arg) {
+  os_thread_t *thread = arg;
+
+  os_self = thread;
+
+  /* Threads created before osKernelStart wait for the kernel to start */
+  pthread_mutex_lock(&os_run_lock);
+  while (os_state != osKernelRunning) {
+    pthread_cond_wait(&os_run_cond, &os_run_lock);
+  }
+  pthread_mutex_unlock(&os_run_lock);
+
+  thread->func(thread->argument);
+
+  os_thread_done();
+  return (NULL);
+}
+
+/*---------------------------------------------------------------------------
+ *      Kernel
+ *---------------------------------------------------------------------------*/
+
+osStatus_t osKernelInitialize (void) {
+
+  if (os_state != osKernelInactive) {
+    return (osError);
+  }
+  os_state = osKernelReady;
+  return (osOK);
+}
+
+osKernelState_t osKernelGetState (void) {
+
+  if ((os_state == osKernelRunning) && (os_lock_cnt != 0)) {
+    return (osKernelLocked);
+  }
+  return (os_state);
+}
+
+osStatus_t osKernelStart (void) {
+
+  if (os_state != osKernelReady) {
+    return (osError);
+  }
+
+  pthread_mutex_lock(&os_run_lock);
+  os_state = osKernelRunning;
+  pthread_cond_broadcast(&os_run_cond);
+
+  /* Return when all threads have terminated */
+  while (os_run_cnt != 0U) {
+    pthread_cond_wait(&os_run_cond, &os_run_lock);
+  }
+  pthread_mutex_unlock(&os_run_lock);
+
+  return (osOK);
+}
+
+/* Scheduler lock: a thread calling osKernelLock waits while another thread
+   holds the lock, as it could not run on a single core. Threads that do not
+   lock the scheduler keep running in parallel. */
+int32_t osKernelLock (void) {
+  int32_t lock = os_lock_cnt;
+
+  if (lock == 0) {
+    pthread_mutex_lock(&os_kernel_lock);
+    os_lock_cnt = 1;
+  }
+  return (lock);
+}
+
+int32_t osKernelUnlock (void) {
+  int32_t lock = os_lock_cnt;
+
+  if (lock != 0) {
+    os_lock_cnt = 0;
+    pthread_mutex_unlock(&os_kernel_lock);
+  }
+  return (lock);
+}
+
+int32_t osKernelRestoreLock (int32_t lock) {
+
+  if (lock != 0) {
+    (void)osKernelLock();
+  } else {
+    (void)osKernelUnlock();
+  }
+  return (lock);
+}
+
+uint32_t osKernelGetTickCount (void) {
+  return ((uint32_t)(os_now_ns() / (1000000000U / OS_HOST_TICK_FREQ)));
+}
+
+uint32_t osKernelGetTickFreq (void) {
+  return (OS_HOST_TICK_FREQ);
+}
+
+uint32_t osKernelGetSysTimerCount (void) {
+  return ((uint32_t)(os_now_ns() / (1000000000U / OS_HOST_SYSTIMER_FREQ)));
+}
+
+uint32_t osKernelGetSysTimerFreq (void) {
+  return (OS_HOST_SYSTIMER_FREQ);
+}
+
+/*---------------------------------------------------------------------------
+ *      Threads
+ *---------------------------------------------------------------------------*/
+
+osThreadId_t osThreadNew (osThreadFunc_t func, void *argument, const osThreadAttr_t *attr) {
+  os_thread_t *thread;
+  pthread_attr_t pattr;
+
+  if (func == NULL) {
+    return (NULL);
+  }
+
+  thread = calloc(1U, sizeof(os_thread_t));
+  if (thread == NULL) {
+    return (NULL);
+  }
+  thread->func     = func;
+  thread->argument = argument;
+  if (attr != NULL) {
+    thread->name      = attr->name;
+    thread->attr_bits = attr->attr_bits;
+  }
+  pthread_mutex_init(&thread->lock, NULL);
+  os_cond_init(&thread->cond);
+
+  pthread_mutex_lock(&os_run_lock);
+  if (os_state != osKernelRunning) {
+    thread->counted = 1U;
+    os_run_cnt++;
+  }
+  pthread_mutex_unlock(&os_run_lock);
+
+  pthread_attr_init(&pattr);
+  if ((thread->attr_bits & osThreadJoinable) == 0U) {
+    pthread_attr_setdetachstate(&pattr, PTHREAD_CREATE_DETACHED);
+  }
+
+  if (pthread_create(&thread->tid, &pattr, os_thread_entry, thread) != 0) {
+    pthread_attr_destroy(&pattr);
+    pthread_mutex_lock(&os_run_lock);
+    if (thread->counted != 0U) {
+      os_run_cnt--;
+    }
+    pthread_mutex_unlock(&os_run_lock);
+    free(thread);
+    return (NULL);
+  }
+  pthread_attr_destroy(&pattr);
+
+  return ((osThreadId_t)thread);
+}
+
+osThreadId_t osThreadGetId (void) {
+  return ((osThreadId_t)os_thread_self());
+}
+
+osThreadState_t osThreadGetState (osThreadId_t thread_id) {
+  os_thread_t *thread = thread_id;
+
+  if (thread == NULL) {
+    return (osThreadError);
+  }
+  if (thread->terminated != 0U) {
+    return (osThreadTerminated);
+  }
+  return ((thread == os_self) ? osThreadRunning : osThreadReady);
+}
+
+osStatus_t osThreadYield (void) {
+  sched_yield();
+  return (osOK);
+}
+
+osStatus_t osThreadJoin (osThreadId_t thread_id) {
+  os_thread_t *thread = thread_id;
+
+  if ((thread == NULL) || ((thread->attr_bits & osThreadJoinable) == 0U)) {
+    return (osErrorParameter);
+  }
+  pthread_join(thread->tid, NULL);
+  return (osOK);
+}
+
+__NO_RETURN void osThreadExit (void) {
+  os_thread_done();
+  pthread_exit(NULL);
+}
+
+osStatus_t osThreadTerminate (osThreadId_t thread_id) {
+
+  if (thread_id == (osThreadId_t)os_self) {
+    osThreadExit();
+  }
+  /* Asynchronous termination of host threads is not supported */
+  return (osErrorResource);
+}
+
+uint32_t osThreadFlagsSet (osThreadId_t thread_id, uint32_t flags) {
+  os_thread_t *thread = thread_id;
+  uint32_t rflags;
+
+  if ((thread == NULL) || ((flags & osFlagsError) != 0U)) {
+    return (osFlagsErrorParameter);
+  }
+
+  pthread_mutex_lock(&thread->lock);
+  thread->flags |= flags;
+  rflags = thread->flags;
+  pthread_cond_broadcast(&thread->cond);
+  pthread_mutex_unlock(&thread->lock);
+
+  return (rflags);
+}
+
+/* Wait for flags, common to thread and event flags */
+static uint32_t os_flags_wait (pthread_mutex_t *lock, pthread_cond_t *cond, uint32_t *cur,
+                               uint32_t flags, uint32_t options, uint32_t timeout) {
+  struct timespec ts;
+  uint32_t rflags, match;
+
+  os_deadline(&ts, timeout);
+
+  pthread_mutex_lock(lock);
+
+  for (;;) {
+    match = *cur & flags;
+    if (((options & osFlagsWaitAll) != 0U) ? (match == flags) : (match != 0U)) {
+      rflags = *cur;
+      if ((options & osFlagsNoClear) == 0U) {
+        *cur &= ~flags;
+      }
+      break;
+    }
+    if (timeout == 0U) {
+      rflags = osFlagsErrorResource;
+      break;
+    }
+    if (os_cond_wait(cond, lock, &ts, timeout) == 0U) {
+      rflags = osFlagsErrorTimeout;
+      break;
+    }
+  }
+
+  pthread_mutex_unlock(lock);
+
+  return (rflags);
+}
+
+uint32_t osThreadFlagsWait (uint32_t flags, uint32_t options, uint32_t timeout) {
+  os_thread_t *thread = os_thread_self();
+
+  if (__get_IPSR() != 0U) {
+    return (osFlagsErrorISR);
+  }
+  if (thread == NULL) {
+    return (osFlagsErrorUnknown);
+  }
+  return (os_flags_wait(&thread->lock, &thread->cond, &thread->flags, flags, options, timeout));
+}
+
+osStatus_t osDelay (uint32_t ticks) {
+  struct timespec ts;
+
+  if (__get_IPSR() != 0U) {
+    return (osErrorISR);
+  }
+  os_deadline(&ts, ticks);
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR);
+
+  return (osOK);
+}
+
+/*---------------------------------------------------------------------------
+ *      Event flags
+ *---------------------------------------------------------------------------*/
+
+osEventFlagsId_t osEventFlagsNew (const osEventFlagsAttr_t *attr) {
+  os_event_flags_t *ef;
+
+  (void)attr;
+
+  ef = calloc(1U, sizeof(os_event_flags_t));
+  if (ef != NULL) {
+    pthread_mutex_init(&ef->lock, NULL);
+    os_cond_init(&ef->cond);
+  }
+  return ((osEventFlagsId_t)ef);
+}
+
+uint32_t osEventFlagsSet (osEventFlagsId_t ef_id, uint32_t flags) {
+  os_event_flags_t *ef = ef_id;
+  uint32_t rflags;
+
+  if ((ef == NULL) || ((flags & osFlagsError) != 0U)) {
+    return (osFlagsErrorParameter);
+  }
+
+  pthread_mutex_lock(&ef->lock);
+  ef->flags |= flags;
+  rflags = ef->flags;
+  pthread_cond_broadcast(&ef->cond);
+  pthread_mutex_unlock(&ef->lock);
+
+  return (rflags);
+}
+
+uint32_t osEventFlagsClear (osEventFlagsId_t ef_id, uint32_t flags) {
+  os_event_flags_t *ef = ef_id;
+  uint32_t rflags;
+
+  if (ef == NULL) {
+    return (osFlagsErrorParameter);
+  }
+
+  pthread_mutex_lock(&ef->lock);
+  rflags = ef->flags;
+  ef->flags &= ~flags;
+  pthread_mutex_unlock(&ef->lock);
+
+  return (rflags);
+}
+
+uint32_t osEventFlagsGet (osEventFlagsId_t ef_id) {
+  os_event_flags_t *ef = ef_id;
+
+  return ((ef != NULL) ? ef->flags : 0U);
+}
+
+uint32_t osEventFlagsWait (osEventFlagsId_t ef_id, uint32_t flags, uint32_t options, uint32_t timeout) {
+  os_event_flags_t *ef = ef_id;
+
+  if (ef == NULL) {
+    return (osFlagsErrorParameter);
+  }
+  if ((__get_IPSR() != 0U) && (timeout != 0U)) {
+    return (osFlagsErrorParameter);
+  }
+  return (os_flags_wait(&ef->lock, &ef->cond, &ef->flags, flags, options, timeout));
+}
+
+osStatus_t osEventFlagsDelete (osEventFlagsId_t ef_id) {
+  os_event_flags_t *ef = ef_id;
+
+  if (ef == NULL) {
+    return (osErrorParameter);
+  }
+  pthread_cond_destroy(&ef->cond);
+  pthread_mutex_destroy(&ef->lock);
+  free(ef);
+
+  return (osOK);
+}
+
+/*---------------------------------------------------------------------------
+ *      Mutexes
+ *---------------------------------------------------------------------------*/
+
+osMutexId_t osMutexNew (const osMutexAttr_t *attr) {
+  os_mutex_t *mtx;
+  pthread_mutexattr_t mattr;
+
+  mtx = calloc(1U, sizeof(os_mutex_t));
+  if (mtx != NULL) {
+    pthread_mutexattr_init(&mattr);
+    if ((attr != NULL) && ((attr->attr_bits & osMutexRecursive) != 0U)) {
+      pthread_mutexattr_settype(&mattr, PTHREAD_MUTEX_RECURSIVE);
+    } else {
+      pthread_mutexattr_settype(&mattr, PTHREAD_MUTEX_ERRORCHECK);
+    }
+    pthread_mutex_init(&mtx->mutex, &mattr);
+    pthread_mutexattr_destroy(&mattr);
+  }
+  return ((osMutexId_t)mtx);
+}
+
+osStatus_t osMutexAcquire (osMutexId_t mutex_id, uint32_t timeout) {
+  os_mutex_t *mtx = mutex_id;
+  struct timespec ts;
+  int err;
+
+  if (mtx == NULL) {
+    return (osErrorParameter);
+  }
+  if (__get_IPSR() != 0U) {
+    return (osErrorISR);
+  }
+
+  if (timeout == osWaitForever) {
+    err = pthread_mutex_lock(&mtx->mutex);
+  } else if (timeout == 0U) {
+    err = pthread_mutex_trylock(&mtx->mutex);
+  } else {
+    /* pthread_mutex_timedlock uses the realtime clock */
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec  += (time_t)(timeout / OS_HOST_TICK_FREQ);
+    ts.tv_nsec += (long)(((uint64_t)(timeout % OS_HOST_TICK_FREQ) * 1000000000U) / OS_HOST_TICK_FREQ);
+    if (ts.tv_nsec >= 1000000000L) {
+      ts.tv_sec  += 1;
+      ts.tv_nsec -= 1000000000L;
+    }
+    err = pthread_mutex_timedlock(&mtx->mutex, &ts);
+  }
+
+  if (err == 0) {
+    return (osOK);
+  }
+  return ((err == ETIMEDOUT) ? osErrorTimeout : osErrorResource);
+}
+
+osStatus_t osMutexRelease (osMutexId_t mutex_id) {
+  os_mutex_t *mtx = mutex_id;
+
+  if (mtx == NULL) {
+    return (osErrorParameter);
+  }
+  return ((pthread_mutex_unlock(&mtx->mutex) == 0) ? osOK : osErrorResource);
+}
+
+osStatus_t osMutexDelete (osMutexId_t mutex_id) {
+  os_mutex_t *mtx = mutex_id;
+
+  if (mtx == NULL) {
+    return (osErrorParameter);
+  }
+  pthread_mutex_destroy(&mtx->mutex);
+  free(mtx);
+
+  return (osOK);
+}
+
+/*---------------------------------------------------------------------------
+ *      Semaphores
+ *---------------------------------------------------------------------------*/
+
+osSemaphoreId_t osSemaphoreNew (uint32_t max_count, uint32_t initial_count, const osSemaphoreAttr_t *attr) {
+  os_semaphore_t *sem;
+
+  (void)attr;
+
+  if ((max_count == 0U) || (initial_count > max_count)) {
+    return (NULL);
+  }
+
+  sem = calloc(1U, sizeof(os_semaphore_t));
+  if (sem != NULL) {
+    pthread_mutex_init(&sem->lock, NULL);
+    os_cond_init(&sem->cond);
+    sem->count     = initial_count;
+    sem->max_count = max_count;
+  }
+  return ((osSemaphoreId_t)sem);
+}
+
+osStatus_t osSemaphoreAcquire (osSemaphoreId_t semaphore_id, uint32_t timeout) {
+  os_semaphore_t *sem = semaphore_id;
+  struct timespec ts;
+  osStatus_t status;
+
+  if (sem == NULL) {
+    return (osErrorParameter);
+  }
+  if ((__get_IPSR() != 0U) && (timeout != 0U)) {
+    return (osErrorParameter);
+  }
+
+  os_deadline(&ts, timeout);
+
+  pthread_mutex_lock(&sem->lock);
+
+  for (;;) {
+    if (sem->count != 0U) {
+      sem->count--;
+      status = osOK;
+      break;
+    }
+    if (timeout == 0U) {
+      status = osErrorResource;
+      break;
+    }
+    if (os_cond_wait(&sem->cond, &sem->lock, &ts, timeout) == 0U) {
+      status = osErrorTimeout;
+      break;
+    }
+  }
+
+  pthread_mutex_unlock(&sem->lock);
+
+  return (status);
+}
+
+osStatus_t osSemaphoreRelease (osSemaphoreId_t semaphore_id) {
+  os_semaphore_t *sem = semaphore_id;
+  osStatus_t status;
+
+  if (sem == NULL) {
+    return (osErrorParameter);
+  }
+
+  pthread_mutex_lock(&sem->lock);
+  if (sem->count < sem->max_count) {
+    sem->count++;
+    pthread_cond_signal(&sem->cond);
+    status = osOK;
+  } else {
+    status = osErrorResource;
+  }
+  pthread_mutex_unlock(&sem->lock);
+
+  return (status);
+}
+
+uint32_t osSemaphoreGetCount (osSemaphoreId_t semaphore_id) {
+  os_semaphore_t *sem = semaphore_id;
+
+  return ((sem != NULL) ? sem->count : 0U);
+}
+
+osStatus_t osSemaphoreDelete (osSemaphoreId_t semaphore_id) {
+  os_semaphore_t *sem = semaphore_id;
+
+  if (sem == NULL) {
+    return (osErrorParameter);
+  }
+  pthread_cond_destroy(&sem->cond);
+  pthread_mutex_destroy(&sem->lock);
+  free(sem);
+
+  return (osOK);
+}
@@ -0,0 +1,240 @@
+/*
+ * Copyright (C) 2023 ARM Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *      Name:    retarget_host.c
+ *      Purpose: C library glue of the host build (glibc)
+ *
+ *---------------------------------------------------------------------------*/
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "retarget_stdio.h"
+#include "retarget_fs.h"
+#include "retarget_errno.h"
+#include "retarget_host.h"
+
+#if defined(RT_FS_VFS)
+#include "retarget_vfs.h"
+#endif
+
+/*
+  On the target, the CMSIS-Compiler component connects the C library to the
+  stdio functions (stdout_putchar, ...) and to the rt_fs file interface. This
+  file does the same for glibc:
+
+    - stdin, stdout and stderr are replaced with streams calling the
+      retarget stdio functions before main is called.
+    - buffered output is transmitted before the process exits.
+    - fopen, remove and rename are redirected to rt_fs with the linker
+      option -Wl,--wrap=fopen,--wrap=remove,--wrap=rename. The rt_fs calls
+      done for the library are counted (retarget_host_fs_calls).
+    - with RT_FS_VFS, the host file system is mounted for all paths, the
+      RAM file system at "/ram" and the log-structured file system on the
+      simulated NOR flash (flash_host.c) at "/nor".
+*/
+
+/* stdout stream write */
+static ssize_t host_stdout_write (void *cookie, const char *buf, size_t size) {
+  int32_t n;
+
+  (void)cookie;
+
+  n = stdout_write((const uint8_t *)buf, (uint32_t)size);
+  return ((n < 0) ? -1 : (ssize_t)n);
+}
+
+/* stderr stream write */
+static ssize_t host_stderr_write (void *cookie, const char *buf, size_t size) {
+  size_t n;
+
+  (void)cookie;
+
+  for (n = 0U; n < size; n++) {
+    if (stderr_putchar((uint8_t)buf[n]) < 0) {
+      return (-1);
+    }
+  }
+  return ((ssize_t)size);
+}
+
+/* stdin stream read */
+static ssize_t host_stdin_read (void *cookie, char *buf, size_t size) {
+  int32_t n;
+
+  (void)cookie;
+
+  n = stdin_read((uint8_t *)buf, (uint32_t)size);
+  return ((n < 0) ? 0 : (ssize_t)n);
+}
+
+/* Replace standard streams */
+__attribute__((constructor))
+static void host_stdio_init (void) {
+  cookie_io_functions_t out = { NULL, host_stdout_write, NULL, NULL };
+  cookie_io_functions_t err = { NULL, host_stderr_write, NULL, NULL };
+  cookie_io_functions_t in  = { host_stdin_read, NULL, NULL, NULL };
+  FILE *f;
+
+  f = fopencookie(NULL, "w", out);
+  if (f != NULL) {
+    /* Retarget buffers the output, the library passes each call through */
+    setvbuf(f, NULL, _IONBF, 0U);
+    stdout = f;
+  }
+  f = fopencookie(NULL, "w", err);
+  if (f != NULL) {
+    setvbuf(f, NULL, _IONBF, 0U);
+    stderr = f;
+  }
+  f = fopencookie(NULL, "r", in);
+  if (f != NULL) {
+    stdin = f;
+  }
+}
+
+#if defined(RT_FS_VFS)
+/* Mount the file system backends: the host file system also read-only at
+   /rom, RAM with write-back, flash with write-through */
+__attribute__((constructor))
+static void host_vfs_init (void) {
+  rt_vfs_mount("",     &rt_fs_ops_posix, 0U);
+  rt_vfs_mount("/rom", &rt_fs_ops_posix, RT_VFS_RDONLY);
+  rt_vfs_mount("/ram", &rt_fs_ops_ramfs, 0U);
+  rt_vfs_mount("/nor", &rt_fs_ops_logfs, RT_VFS_WRITE_THROUGH);
+}
+#endif
+
+/* Transmit buffered output at exit */
+__attribute__((destructor))
+static void host_stdio_exit (void) {
+  stdout_flush();
+}
+
+/* Number of rt_fs calls done for the library */
+static uint32_t host_fs_calls;
+
+/* Count an rt_fs call */
+#define HOST_FS_CALL()  (void)__atomic_fetch_add(&host_fs_calls, 1U, __ATOMIC_RELAXED)
+
+uint32_t retarget_host_fs_calls (void) {
+  return (__atomic_load_n(&host_fs_calls, __ATOMIC_RELAXED));
+}
+
+/* File stream read */
+static ssize_t host_file_read (void *cookie, char *buf, size_t size) {
+  int32_t n;
+
+  HOST_FS_CALL();
+  n = rt_fs_read((int32_t)(intptr_t)cookie, buf, (uint32_t)size);
+  if (n < 0) {
+    errno = EIO;
+    return (-1);
+  }
+  return ((ssize_t)n);
+}
+
+/* File stream write */
+static ssize_t host_file_write (void *cookie, const char *buf, size_t size) {
+  int32_t n;
+
+  HOST_FS_CALL();
+  n = rt_fs_write((int32_t)(intptr_t)cookie, buf, (uint32_t)size);
+  if (n < 0) {
+    errno = EIO;
+    return (0);
+  }
+  return ((ssize_t)n);
+}
+
+/* File stream seek */
+static int host_file_seek (void *cookie, off64_t *offset, int whence) {
+  int64_t pos;
+  int32_t w;
+
+  if      (whence == SEEK_SET) { w = RT_SEEK_SET; }
+  else if (whence == SEEK_CUR) { w = RT_SEEK_CUR; }
+  else                         { w = RT_SEEK_END; }
+
+  HOST_FS_CALL();
+  pos = rt_fs_seek((int32_t)(intptr_t)cookie, *offset, w);
+  if (pos < 0) {
+    errno = EINVAL;
+    return (-1);
+  }
+  *offset = pos;
+  return (0);
+}
+
+/* File stream close */
+static int host_file_close (void *cookie) {
+  HOST_FS_CALL();
+  return ((rt_fs_close((int32_t)(intptr_t)cookie) < 0) ? -1 : 0);
+}
+
+extern FILE *__wrap_fopen (const char *path, const char *mode);
+extern int   __wrap_remove (const char *path);
+extern int   __wrap_rename (const char *oldpath, const char *newpath);
+
+/* Open a file with rt_fs */
+FILE *__wrap_fopen (const char *path, const char *mode) {
+  cookie_io_functions_t io = { host_file_read, host_file_write, host_file_seek, host_file_close };
+  FILE *f;
+  int32_t rt_mode, fd;
+
+  if      (mode[0] == 'r') { rt_mode = RT_OPEN_RDONLY; }
+  else if (mode[0] == 'w') { rt_mode = RT_OPEN_WRONLY | RT_OPEN_CREATE | RT_OPEN_TRUNCATE; }
+  else if (mode[0] == 'a') { rt_mode = RT_OPEN_WRONLY | RT_OPEN_CREATE | RT_OPEN_APPEND; }
+  else {
+    errno = EINVAL;
+    return (NULL);
+  }
+  if (strchr(mode, '+') != NULL) {
+    rt_mode = (rt_mode & ~(RT_OPEN_RDONLY | RT_OPEN_WRONLY)) | RT_OPEN_RDWR;
+  }
+
+  HOST_FS_CALL();
+  fd = rt_fs_open(path, rt_mode);
+  if (fd < 0) {
+    errno = rt_rval_to_errno(fd);
+    return (NULL);
+  }
+
+  f = fopencookie((void *)(intptr_t)fd, mode, io);
+  if (f == NULL) {
+    HOST_FS_CALL();
+    rt_fs_close(fd);
+  }
+  return (f);
+}
+
+/* Remove a file with rt_fs */
+int __wrap_remove (const char *path) {
+  HOST_FS_CALL();
+  return ((rt_fs_remove(path) < 0) ? -1 : 0);
+}
+
+/* Rename a file with rt_fs */
+int __wrap_rename (const char *oldpath, const char *newpath) {
+  HOST_FS_CALL();
+  return ((rt_fs_rename(oldpath, newpath) < 0) ? -1 : 0);
+}
@@ -0,0 +1,31 @@
+/*
+ * Copyright (C) 2023 ARM Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *      Name:    retarget_host.h
+ *      Purpose: CMSIS-Compiler library glue for glibc
+ *
+ *---------------------------------------------------------------------------*/
+
+#ifndef RETARGET_HOST_H__
+#define RETARGET_HOST_H__
+
+#include <stdint.h>
+
+/* Number of rt_fs calls done for the library (fopen, remove, rename and streams) */
+extern uint32_t retarget_host_fs_calls (void);
+
+#endif /* RETARGET_HOST_H__ */
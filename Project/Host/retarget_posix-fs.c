@@ -0,0 +1,604 @@
+/*-----------------------------------------------------------------------------
+ * Name:    retarget_posix-fs.c
+ * Purpose: File Interface Retarget to POSIX file system (host build)
+ * Rev.:    1.0.0
+ *-----------------------------------------------------------------------------*/
+
+/*
+ * Copyright (C) 2023 ARM Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#if defined(RT_FS_VFS)
+/* Backend of the mount table: functions are named posix_rt_fs_... */
+#define RT_FS_VFS_BACKEND       posix
+#include "retarget_vfs.h"
+#endif
+#include "retarget_fs.h"
+#include "retarget_fs_ext.h"
+
+/* Host directory that holds the files (target paths are relative to it) */
+#ifndef RT_FS_HOST_ROOT
+#define RT_FS_HOST_ROOT     "."
+#endif
+
+/* Maximum length of a host path */
+#define RT_FS_PATH_MAX      256
+
+/* Number of segments passed to the host per readv/writev call */
+#define RT_FS_IOV_NUM       16
+
+/* Maximum number of mappings */
+#define RT_FS_MAP_NUM       8
+
+/* Number of open directories */
+#define RT_FS_DIR_NUM       8
+
+/* Mapping, data is mapped with mmap or copied when mmap fails */
+typedef struct {
+  const uint8_t *ptr;           /* Mapped data, NULL when the entry is free */
+  void          *base;          /* Start of the mapping (page aligned)      */
+  size_t         len;           /* Length of the mapping                    */
+  int            copy;          /* Data copied to allocated memory          */
+} host_map_t;
+
+static host_map_t host_map[RT_FS_MAP_NUM];
+
+static DIR *host_dir[RT_FS_DIR_NUM];
+
+/* Convert errno value to retarget return code */
+static int32_t errno_to_rt_rval (int err) {
+  int32_t rt_rval;
+
+  if      (err == ENOENT)    { rt_rval = RT_ERR_NOTFOUND; }
+  else if (err == EEXIST)    { rt_rval = RT_ERR_EXIST;    }
+  else if (err == EISDIR)    { rt_rval = RT_ERR_ISDIR;    }
+  else if (err == ENOTDIR)   { rt_rval = RT_ERR_NOTDIR;   }
+  else if (err == ENOTEMPTY) { rt_rval = RT_ERR_NOTEMPTY; }
+  else if (err == EBUSY)     { rt_rval = RT_ERR_BUSY;     }
+  else if (err == EACCES)    { rt_rval = RT_ERR_BUSY;     }
+  else if (err == ENOSPC)    { rt_rval = RT_ERR_NOSPACE;  }
+  else if (err == EMFILE)    { rt_rval = RT_ERR_MAXFILES; }
+  else if (err == ENFILE)    { rt_rval = RT_ERR_MAXFILES; }
+  else if (err == EINVAL)    { rt_rval = RT_ERR_INVAL;    }
+  else if (err == EBADF)     { rt_rval = RT_ERR_INVAL;    }
+  else if (err == EIO)       { rt_rval = RT_ERR_IO;       }
+  else                       { rt_rval = RT_ERR;          }
+
+  return (rt_rval);
+}
+
+/* Convert target path to host path, a drive prefix ("R0:") is removed */
+static int32_t host_path (char *buf, const char *path) {
+  const char *p;
+  int n;
+
+  if (path == NULL) {
+    return (RT_ERR_INVAL);
+  }
+
+  p = strchr(path, ':');
+  if ((p != NULL) && ((p - path) <= 2)) {
+    path = p + 1;
+  }
+  while (*path == '/') {
+    path++;
+  }
+
+  n = snprintf(buf, RT_FS_PATH_MAX, "%s/%s", RT_FS_HOST_ROOT, path);
+  if ((n < 0) || (n >= RT_FS_PATH_MAX)) {
+    return (RT_ERR_INVAL);
+  }
+  return (0);
+}
+
+/* Convert host time to retarget time */
+static void host_time (rt_fs_time_t *t, time_t sec) {
+  struct tm tm;
+
+  localtime_r(&sec, &tm);
+
+  t->year = (uint16_t)(tm.tm_year + 1900);
+  t->mon  = (uint8_t)(tm.tm_mon + 1);
+  t->day  = (uint8_t)tm.tm_mday;
+  t->hour = (uint8_t)tm.tm_hour;
+  t->min  = (uint8_t)tm.tm_min;
+  t->sec  = (uint8_t)tm.tm_sec;
+}
+
+/* Fill in a directory entry from host file status */
+static void host_dirent (rt_fs_dirent_t *ent, const char *name, const struct stat *st) {
+
+  snprintf(ent->name, sizeof(ent->name), "%s", name);
+
+  ent->attr = S_ISDIR(st->st_mode) ? RT_ATTR_DIR : RT_ATTR_FILE;
+  if ((st->st_mode & S_IWUSR) == 0) {
+    ent->attr |= RT_ATTR_RD;
+  }
+  ent->size = S_ISDIR(st->st_mode) ? 0 : (int64_t)st->st_size;
+  host_time(&ent->modify, st->st_mtime);
+}
+
+/* Open a file */
+int32_t rt_fs_open (const char *path, int32_t mode) {
+  char buf[RT_FS_PATH_MAX];
+  int32_t rval;
+  int flags;
+
+  rval = host_path(buf, path);
+  if (rval != 0) {
+    return (rval);
+  }
+
+  if ((mode & (RT_OPEN_RDONLY | RT_OPEN_WRONLY | RT_OPEN_RDWR)) == RT_OPEN_WRONLY) {
+    flags = O_WRONLY;
+  } else
+  if ((mode & (RT_OPEN_RDONLY | RT_OPEN_WRONLY | RT_OPEN_RDWR)) == RT_OPEN_RDWR) {
+    flags = O_RDWR;
+  } else {
+    flags = O_RDONLY;
+  }
+
+  if (mode & RT_OPEN_APPEND)   { flags |= O_APPEND; }
+  if (mode & RT_OPEN_CREATE)   { flags |= O_CREAT;  }
+  if (mode & RT_OPEN_TRUNCATE) { flags |= O_TRUNC;  }
+  if (mode & RT_OPEN_EXCL)     { flags |= O_EXCL;   }
+
+  rval = open(buf, flags, 0666);
+
+  if (rval < 0) {
+    rval = errno_to_rt_rval(errno);
+  }
+  return (rval);
+}
+
+/* Close a file */
+int32_t rt_fs_close (int32_t fd) {
+
+  if (close(fd) != 0) {
+    return (errno_to_rt_rval(errno));
+  }
+  return (0);
+}
+
+/* Write to a file */
+int32_t rt_fs_write (int32_t fd, const void *buf, uint32_t cnt) {
+  ssize_t n;
+
+  n = write(fd, buf, cnt);
+  if (n < 0) {
+    return (errno_to_rt_rval(errno));
+  }
+  return ((int32_t)n);
+}
+
+/* Read from a file */
+int32_t rt_fs_read (int32_t fd, void *buf, uint32_t cnt) {
+  ssize_t n;
+
+  n = read(fd, buf, cnt);
+  if (n < 0) {
+    return (errno_to_rt_rval(errno));
+  }
+  return ((int32_t)n);
+}
+
+/* Move the file position pointer */
+int64_t rt_fs_seek (int32_t fd, int64_t offset, int32_t whence) {
+  off_t pos;
+  int w;
+
+  if      (whence == RT_SEEK_SET) { w = SEEK_SET; }
+  else if (whence == RT_SEEK_CUR) { w = SEEK_CUR; }
+  else if (whence == RT_SEEK_END) { w = SEEK_END; }
+  else                            { return (RT_ERR_INVAL); }
+
+  pos = lseek(fd, (off_t)offset, w);
+  if (pos < 0) {
+    return (errno_to_rt_rval(errno));
+  }
+  return ((int64_t)pos);
+}
+
+/* Get file size */
+int64_t rt_fs_size (int32_t fd) {
+  struct stat st;
+
+  if (fstat(fd, &st) != 0) {
+    return (errno_to_rt_rval(errno));
+  }
+  return ((int64_t)st.st_size);
+}
+
+/* Get file status information */
+int32_t rt_fs_stat (int32_t fd, rt_fs_stat_t *stat) {
+  struct stat st;
+
+  if (stat == NULL) {
+    return (RT_ERR_INVAL);
+  }
+  if (fstat(fd, &st) != 0) {
+    return (errno_to_rt_rval(errno));
+  }
+
+  stat->attr = S_ISDIR(st.st_mode) ? RT_ATTR_DIR : RT_ATTR_FILE;
+  if ((st.st_mode & S_IWUSR) == 0) {
+    stat->attr |= RT_ATTR_RD;
+  }
+  host_time(&stat->access, st.st_atime);
+  host_time(&stat->modify, st.st_mtime);
+  host_time(&stat->change, st.st_ctime);
+
+  stat->blksize  = (uint32_t)st.st_blksize;
+  stat->blkcount = (uint32_t)st.st_blocks;
+
+  return (0);
+}
+
+/* Remove a file or directory */
+int32_t rt_fs_remove (const char *path) {
+  char buf[RT_FS_PATH_MAX];
+  int32_t rval;
+
+  rval = host_path(buf, path);
+  if (rval != 0) {
+    return (rval);
+  }
+
+  /* Library functions remove and rename are redirected to rt_fs by the host glue */
+  if (unlink(buf) != 0) {
+    if ((errno != EISDIR) && (errno != EPERM)) {
+      return (errno_to_rt_rval(errno));
+    }
+    if (rmdir(buf) != 0) {
+      return (errno_to_rt_rval(errno));
+    }
+  }
+  return (0);
+}
+
+/* Rename or move a file or directory */
+int32_t rt_fs_rename (const char *oldpath, const char *newpath) {
+  char buf_old[RT_FS_PATH_MAX];
+  char buf_new[RT_FS_PATH_MAX];
+  int32_t rval;
+
+  rval = host_path(buf_old, oldpath);
+  if (rval == 0) {
+    rval = host_path(buf_new, newpath);
+  }
+  if (rval != 0) {
+    return (rval);
+  }
+
+  if (renameat(AT_FDCWD, buf_old, AT_FDCWD, buf_new) != 0) {
+    return (errno_to_rt_rval(errno));
+  }
+  return (0);
+}
+
+/* Write cached data of a file to the file system */
+int32_t rt_fs_flush (int32_t fd) {
+  (void)fd;
+
+  /* Data is passed to the host with every write */
+  return (0);
+}
+
+/* Write cached data of a file and commit it to the storage medium */
+int32_t rt_fs_sync (int32_t fd) {
+
+  /* The host commits data and size of the file */
+  if (fdatasync(fd) != 0) {
+    return (errno_to_rt_rval(errno));
+  }
+  return (0);
+}
+
+/* Get cache statistics */
+int32_t rt_fs_cache_get_stats (rt_fs_cache_stats_t *stats) {
+  (void)stats;
+
+  /* No cache, the host caches file data */
+  return (RT_ERR_NOTSUP);
+}
+
+/* Map file data for reading */
+int32_t rt_fs_map (int32_t fd, int64_t offset, uint32_t len, const void **ptr) {
+  host_map_t *m;
+  struct stat st;
+  long page;
+  off_t ofs;
+  ssize_t n;
+  uint32_t i;
+
+  if ((ptr == NULL) || (offset < 0)) {
+    return (RT_ERR_INVAL);
+  }
+  if (fstat(fd, &st) != 0) {
+    return (errno_to_rt_rval(errno));
+  }
+  if (offset >= st.st_size) {
+    /* End of file */
+    return (0);
+  }
+  if ((uint64_t)len > (uint64_t)(st.st_size - offset)) {
+    len = (uint32_t)(st.st_size - offset);
+  }
+  if (len > INT32_MAX) {
+    len = INT32_MAX;
+  }
+
+  m = NULL;
+  for (i = 0U; i < RT_FS_MAP_NUM; i++) {
+    if (host_map[i].ptr == NULL) {
+      m = &host_map[i];
+      break;
+    }
+  }
+  if (m == NULL) {
+    return (RT_ERR_BUSY);
+  }
+
+  /* mmap needs a page aligned offset */
+  page = sysconf(_SC_PAGESIZE);
+  ofs  = (off_t)offset - ((off_t)offset % page);
+
+  m->len  = (size_t)(offset - ofs) + len;
+  m->base = mmap(NULL, m->len, PROT_READ, MAP_SHARED, fd, ofs);
+  if (m->base != MAP_FAILED) {
+    m->copy = 0;
+    m->ptr  = (const uint8_t *)m->base + (offset - ofs);
+  } else {
+    /* File not readable through a mapping (i.e. opened for writing only) */
+    m->base = malloc(len);
+    if (m->base == NULL) {
+      return (RT_ERR);
+    }
+    n = pread(fd, m->base, len, (off_t)offset);
+    if (n <= 0) {
+      free(m->base);
+      return ((n < 0) ? errno_to_rt_rval(errno) : 0);
+    }
+    len     = (uint32_t)n;
+    m->copy = 1;
+    m->ptr  = m->base;
+  }
+
+  *ptr = m->ptr;
+  return ((int32_t)len);
+}
+
+/* Release mapped file data */
+int32_t rt_fs_unmap (int32_t fd, const void *ptr) {
+  uint32_t i;
+
+  (void)fd;
+
+  for (i = 0U; i < RT_FS_MAP_NUM; i++) {
+    if ((ptr != NULL) && (host_map[i].ptr == ptr)) {
+      if (host_map[i].copy != 0) {
+        free(host_map[i].base);
+      } else {
+        munmap(host_map[i].base, host_map[i].len);
+      }
+      host_map[i].ptr = NULL;
+      return (0);
+    }
+  }
+  return (RT_ERR_INVAL);
+}
+
+/* Write or read segments with the host, in parts of up to RT_FS_IOV_NUM segments */
+static int32_t host_rw_v (int32_t fd, const rt_fs_iovec_t *iov, uint32_t iovcnt, int wr) {
+  struct iovec v[RT_FS_IOV_NUM];
+  uint32_t i, k, n, len;
+  ssize_t r;
+
+  if ((iov == NULL) && (iovcnt != 0U)) {
+    return (RT_ERR_INVAL);
+  }
+  for (i = 0U, n = 0U; i < iovcnt; i++) {
+    if (iov[i].len > ((uint32_t)INT32_MAX - n)) {
+      return (RT_ERR_INVAL);
+    }
+    n += iov[i].len;
+  }
+
+  n = 0U;
+  for (i = 0U; i < iovcnt; i += k) {
+    len = 0U;
+    for (k = 0U; (k < RT_FS_IOV_NUM) && ((i + k) < iovcnt); k++) {
+      v[k].iov_base = iov[i + k].base;
+      v[k].iov_len  = iov[i + k].len;
+      len += iov[i + k].len;
+    }
+
+    r = (wr != 0) ? writev(fd, v, (int)k) : readv(fd, v, (int)k);
+    if (r < 0) {
+      if (n == 0U) {
+        return (errno_to_rt_rval(errno));
+      }
+      break;
+    }
+    n += (uint32_t)r;
+    if ((uint32_t)r != len) {
+      break;
+    }
+  }
+  return ((int32_t)n);
+}
+
+/* Write segments to a file */
+int32_t rt_fs_writev (int32_t fd, const rt_fs_iovec_t *iov, uint32_t iovcnt) {
+  return (host_rw_v(fd, iov, iovcnt, 1));
+}
+
+/* Read from a file into segments */
+int32_t rt_fs_readv (int32_t fd, const rt_fs_iovec_t *iov, uint32_t iovcnt) {
+  return (host_rw_v(fd, iov, iovcnt, 0));
+}
+
+/* Create a directory */
+int32_t rt_fs_mkdir (const char *path) {
+  char buf[RT_FS_PATH_MAX];
+  int32_t rval;
+
+  rval = host_path(buf, path);
+  if (rval != 0) {
+    return (rval);
+  }
+
+  if (mkdir(buf, 0777) != 0) {
+    return (errno_to_rt_rval(errno));
+  }
+  return (0);
+}
+
+/* Remove an empty directory */
+int32_t rt_fs_rmdir (const char *path) {
+  char buf[RT_FS_PATH_MAX];
+  int32_t rval;
+
+  rval = host_path(buf, path);
+  if (rval != 0) {
+    return (rval);
+  }
+
+  if (rmdir(buf) != 0) {
+    return (errno_to_rt_rval(errno));
+  }
+  return (0);
+}
+
+/* Open a directory */
+int32_t rt_fs_opendir (const char *path) {
+  char buf[RT_FS_PATH_MAX];
+  int32_t rval;
+  int32_t dd;
+
+  rval = host_path(buf, path);
+  if (rval != 0) {
+    return (rval);
+  }
+
+  for (dd = 0; dd < RT_FS_DIR_NUM; dd++) {
+    if (host_dir[dd] == NULL) {
+      break;
+    }
+  }
+  if (dd == RT_FS_DIR_NUM) {
+    return (RT_ERR_MAXFILES);
+  }
+
+  host_dir[dd] = opendir(buf);
+  if (host_dir[dd] == NULL) {
+    return (errno_to_rt_rval(errno));
+  }
+  return (dd);
+}
+
+/* Read the next directory entry */
+int32_t rt_fs_readdir (int32_t dd, rt_fs_dirent_t *ent) {
+  struct dirent *d;
+  struct stat st;
+
+  if ((dd < 0) || (dd >= RT_FS_DIR_NUM) || (host_dir[dd] == NULL) || (ent == NULL)) {
+    return (RT_ERR_INVAL);
+  }
+
+  for (;;) {
+    errno = 0;
+    d = readdir(host_dir[dd]);
+    if (d == NULL) {
+      /* No more entries, or error */
+      return ((errno == 0) ? 0 : errno_to_rt_rval(errno));
+    }
+    if ((strcmp(d->d_name, ".") == 0) || (strcmp(d->d_name, "..") == 0)) {
+      continue;
+    }
+    if (fstatat(dirfd(host_dir[dd]), d->d_name, &st, 0) == 0) {
+      break;
+    }
+    /* Entry removed meanwhile */
+  }
+
+  host_dirent(ent, d->d_name, &st);
+  return (1);
+}
+
+/* Close a directory */
+int32_t rt_fs_closedir (int32_t dd) {
+
+  if ((dd < 0) || (dd >= RT_FS_DIR_NUM) || (host_dir[dd] == NULL)) {
+    return (RT_ERR_INVAL);
+  }
+
+  closedir(host_dir[dd]);
+  host_dir[dd] = NULL;
+
+  return (0);
+}
+
+/* Get the directory entry of a path */
+int32_t rt_fs_lookup (const char *path, rt_fs_dirent_t *ent) {
+  char buf[RT_FS_PATH_MAX];
+  struct stat st;
+  const char *name;
+  int32_t rval;
+
+  if (ent == NULL) {
+    return (RT_ERR_INVAL);
+  }
+  rval = host_path(buf, path);
+  if (rval != 0) {
+    return (rval);
+  }
+
+  /* The host caches directory entries */
+  if (stat(buf, &st) != 0) {
+    return (errno_to_rt_rval(errno));
+  }
+
+  name = strrchr(buf, '/');
+  host_dirent(ent, (name != NULL) ? (name + 1) : buf, &st);
+
+  return (0);
+}
+
+int32_t rt_fs_invalidate (const char *path) {
+  (void)path;
+
+  /* Lookups are cached by the host only */
+  return (0);
+}
+
+#if defined(RT_FS_VFS)
+/* Operations for rt_vfs_mount */
+RT_FS_VFS_OPS(posix);
+#endif
@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2023 ARM Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RT_SYS_H__
+#define RT_SYS_H__
+
+/*
+  Host replacement for the Arm Compiler rt_sys.h
+
+  Provides the open mode flags of _sys_open, which MDK-FS uses for
+  __sys_open (see retarget_mdk-fs.c and mdkfs_host.c).
+*/
+
+#define OPEN_R      0           /* Read                                     */
+#define OPEN_B      1           /* Binary                                   */
+#define OPEN_PLUS   2           /* Update (read and write)                  */
+#define OPEN_W      4           /* Write, truncate or create                */
+#define OPEN_A      8           /* Append, create                           */
+
+#endif /* RT_SYS_H__ */
@@ -0,0 +1,420 @@
+/*
+ * Copyright (C) 2023 ARM Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *      Name:    usart_host.c
+ *      Purpose: CMSIS-Driver USART stand-in for POSIX hosts
+ *
+ *---------------------------------------------------------------------------*/
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "Driver_USART.h"
+#include "cmsis_compiler.h"
+#include "usart_host.h"
+
+/*
+  Transmit data is written to USART_HOST_TX_FD and receive data is read
+  from USART_HOST_RX_FD. Event callbacks are executed from driver threads
+  in the interrupt context modelled by irq_host.c.
+
+  When USART_HOST_WIRE_TIME is non-zero, each transfer takes as long as it
+  would on the wire (10 bits per character at the configured baudrate), so
+  CPU time spent by the caller can be compared to the transmission time.
+
+  Between usart_host_capture_start and usart_host_capture_stop, transmitted
+  data is also copied into a buffer, so that tests can check the output.
+*/
+#ifndef USART_HOST_TX_FD
+#define USART_HOST_TX_FD        STDOUT_FILENO
+#endif
+#ifndef USART_HOST_RX_FD
+#define USART_HOST_RX_FD        STDIN_FILENO
+#endif
+#ifndef USART_HOST_WIRE_TIME
+#define USART_HOST_WIRE_TIME    1
+#endif
+
+#define ARM_USART_DRV_VERSION   ARM_DRIVER_VERSION_MAJOR_MINOR(1, 0)
+
+static const ARM_DRIVER_VERSION DriverVersion = {
+  ARM_USART_API_VERSION,
+  ARM_USART_DRV_VERSION
+};
+
+static const ARM_USART_CAPABILITIES DriverCapabilities = {
+  1, /* supports UART (Asynchronous) mode */
+  0, /* supports Synchronous Master mode */
+  0, /* supports Synchronous Slave mode */
+  0, /* supports UART Single-wire mode */
+  0, /* supports UART IrDA mode */
+  0, /* supports UART Smart Card mode */
+  0, /* Smart Card Clock generator available */
+  0, /* RTS Flow Control available */
+  0, /* CTS Flow Control available */
+  0, /* Transmit completed event: \ref ARM_USART_EVENT_TX_COMPLETE */
+  1, /* Signal receive character timeout event: \ref ARM_USART_EVENT_RX_TIMEOUT */
+  0, /* RTS Line: 0=not available, 1=available */
+  0, /* CTS Line: 0=not available, 1=available */
+  0, /* DTR Line: 0=not available, 1=available */
+  0, /* DSR Line: 0=not available, 1=available */
+  0, /* DCD Line: 0=not available, 1=available */
+  0, /* RI Line: 0=not available, 1=available */
+  0, /* Signal CTS change event: \ref ARM_USART_EVENT_CTS */
+  0, /* Signal DSR change event: \ref ARM_USART_EVENT_DSR */
+  0, /* Signal DCD change event: \ref ARM_USART_EVENT_DCD */
+  0, /* Signal RI change event: \ref ARM_USART_EVENT_RI */
+  0  /* Reserved (must be zero) */
+};
+
+/* Driver state */
+static struct {
+  ARM_USART_SignalEvent_t cb_event;
+  uint32_t                baudrate;
+  uint8_t                 tx_enabled;
+  uint8_t                 rx_enabled;
+  uint8_t                 powered;
+  /* Transmitter */
+  const uint8_t          *tx_buf;
+  uint32_t                tx_num;
+  volatile uint32_t       tx_cnt;
+  volatile uint8_t        tx_busy;
+  /* Receiver */
+  uint8_t                *rx_buf;
+  uint32_t                rx_num;
+  volatile uint32_t       rx_cnt;
+  volatile uint8_t        rx_busy;
+  /* Transmit capture */
+  uint8_t                *cap_buf;
+  uint32_t                cap_size;
+  uint32_t                cap_cnt;
+} usart;
+
+static pthread_mutex_t usart_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  usart_cond  = PTHREAD_COND_INITIALIZER;
+static pthread_t       tx_thread;
+static pthread_t       rx_thread;
+
+/* Signal event from the interrupt context */
+static void usart_signal (uint32_t event) {
+  ARM_USART_SignalEvent_t cb_event = usart.cb_event;
+
+  if (cb_event != NULL) {
+    host_irq_enter();
+    cb_event(event);
+    host_irq_exit();
+  }
+}
+
+/* Wait for the time needed to transfer cnt characters */
+static void usart_wire_delay (uint32_t cnt) {
+#if (USART_HOST_WIRE_TIME != 0)
+  struct timespec ts;
+  uint64_t ns;
+
+  if (usart.baudrate != 0U) {
+    ns = ((uint64_t)cnt * 10U * 1000000000U) / usart.baudrate;
+    ts.tv_sec  = (time_t)(ns / 1000000000U);
+    ts.tv_nsec = (long)  (ns % 1000000000U);
+    nanosleep(&ts, NULL);
+  }
+#else
+  (void)cnt;
+#endif
+}
+
+/* Copy transmitted data into the capture buffer */
+static void usart_capture (const uint8_t *data, uint32_t cnt) {
+  uint32_t num;
+
+  pthread_mutex_lock(&usart_mutex);
+  if (usart.cap_buf != NULL) {
+    num = usart.cap_size - usart.cap_cnt;
+    if (num > cnt) {
+      num = cnt;
+    }
+    memcpy(&usart.cap_buf[usart.cap_cnt], data, num);
+    usart.cap_cnt += num;
+  }
+  pthread_mutex_unlock(&usart_mutex);
+}
+
+/* Transmitter thread: drains buffers passed to Send */
+static void *usart_tx_thread (void *arg) {
+  const uint8_t *buf;
+  uint32_t num;
+  ssize_t n;
+
+  (void)arg;
+
+  for (;;) {
+    pthread_mutex_lock(&usart_mutex);
+    while (usart.tx_busy == 0U) {
+      pthread_cond_wait(&usart_cond, &usart_mutex);
+    }
+    buf = usart.tx_buf;
+    num = usart.tx_num;
+    pthread_mutex_unlock(&usart_mutex);
+
+    while (usart.tx_cnt < num) {
+      n = write(USART_HOST_TX_FD, &buf[usart.tx_cnt], num - usart.tx_cnt);
+      if (n <= 0) {
+        break;
+      }
+      usart_capture(&buf[usart.tx_cnt], (uint32_t)n);
+      usart_wire_delay((uint32_t)n);
+      usart.tx_cnt += (uint32_t)n;
+    }
+
+    usart.tx_busy = 0U;
+    usart_signal(ARM_USART_EVENT_SEND_COMPLETE);
+  }
+  return (NULL);
+}
+
+/* Receiver thread: fills buffers passed to Receive */
+static void *usart_rx_thread (void *arg) {
+  uint8_t *buf;
+  uint32_t num;
+  ssize_t n;
+
+  (void)arg;
+
+  for (;;) {
+    pthread_mutex_lock(&usart_mutex);
+    while (usart.rx_busy == 0U) {
+      pthread_cond_wait(&usart_cond, &usart_mutex);
+    }
+    buf = usart.rx_buf;
+    num = usart.rx_num;
+    pthread_mutex_unlock(&usart_mutex);
+
+    n = read(USART_HOST_RX_FD, &buf[usart.rx_cnt], num - usart.rx_cnt);
+    if (n <= 0) {
+      /* End of input */
+      break;
+    }
+    usart_wire_delay((uint32_t)n);
+    usart.rx_cnt += (uint32_t)n;
+
+    if (usart.rx_cnt == num) {
+      usart.rx_busy = 0U;
+      usart_signal(ARM_USART_EVENT_RECEIVE_COMPLETE);
+    } else {
+      /* Line is idle after a partial read */
+      usart_signal(ARM_USART_EVENT_RX_TIMEOUT);
+    }
+  }
+  return (NULL);
+}
+
+static ARM_DRIVER_VERSION USART_GetVersion (void) {
+  return (DriverVersion);
+}
+
+static ARM_USART_CAPABILITIES USART_GetCapabilities (void) {
+  return (DriverCapabilities);
+}
+
+static int32_t USART_Initialize (ARM_USART_SignalEvent_t cb_event) {
+  static uint8_t threads_created;
+
+  usart.cb_event = cb_event;
+
+  if (threads_created == 0U) {
+    if (pthread_create(&tx_thread, NULL, usart_tx_thread, NULL) != 0) {
+      return (ARM_DRIVER_ERROR);
+    }
+    if (pthread_create(&rx_thread, NULL, usart_rx_thread, NULL) != 0) {
+      return (ARM_DRIVER_ERROR);
+    }
+    threads_created = 1U;
+  }
+  return (ARM_DRIVER_OK);
+}
+
+static int32_t USART_Uninitialize (void) {
+  usart.cb_event = NULL;
+  return (ARM_DRIVER_OK);
+}
+
+static int32_t USART_PowerControl (ARM_POWER_STATE state) {
+  switch (state) {
+    case ARM_POWER_OFF:
+      usart.powered = 0U;
+      break;
+    case ARM_POWER_FULL:
+      usart.powered = 1U;
+      break;
+    case ARM_POWER_LOW:
+    default:
+      return (ARM_DRIVER_ERROR_UNSUPPORTED);
+  }
+  return (ARM_DRIVER_OK);
+}
+
+static int32_t USART_Send (const void *data, uint32_t num) {
+  int32_t rval;
+
+  if ((data == NULL) || (num == 0U)) {
+    return (ARM_DRIVER_ERROR_PARAMETER);
+  }
+
+  pthread_mutex_lock(&usart_mutex);
+  if ((usart.powered == 0U) || (usart.tx_enabled == 0U)) {
+    rval = ARM_DRIVER_ERROR;
+  } else if (usart.tx_busy != 0U) {
+    rval = ARM_DRIVER_ERROR_BUSY;
+  } else {
+    usart.tx_buf  = (const uint8_t *)data;
+    usart.tx_num  = num;
+    usart.tx_cnt  = 0U;
+    usart.tx_busy = 1U;
+    pthread_cond_broadcast(&usart_cond);
+    rval = ARM_DRIVER_OK;
+  }
+  pthread_mutex_unlock(&usart_mutex);
+
+  return (rval);
+}
+
+static int32_t USART_Receive (void *data, uint32_t num) {
+  int32_t rval;
+
+  if ((data == NULL) || (num == 0U)) {
+    return (ARM_DRIVER_ERROR_PARAMETER);
+  }
+
+  pthread_mutex_lock(&usart_mutex);
+  if ((usart.powered == 0U) || (usart.rx_enabled == 0U)) {
+    rval = ARM_DRIVER_ERROR;
+  } else if (usart.rx_busy != 0U) {
+    rval = ARM_DRIVER_ERROR_BUSY;
+  } else {
+    usart.rx_buf  = (uint8_t *)data;
+    usart.rx_num  = num;
+    usart.rx_cnt  = 0U;
+    usart.rx_busy = 1U;
+    pthread_cond_broadcast(&usart_cond);
+    rval = ARM_DRIVER_OK;
+  }
+  pthread_mutex_unlock(&usart_mutex);
+
+  return (rval);
+}
+
+static int32_t USART_Transfer (const void *data_out, void *data_in, uint32_t num) {
+  (void)data_out;
+  (void)data_in;
+  (void)num;
+  return (ARM_DRIVER_ERROR_UNSUPPORTED);
+}
+
+static uint32_t USART_GetTxCount (void) {
+  return (usart.tx_cnt);
+}
+
+static uint32_t USART_GetRxCount (void) {
+  return (usart.rx_cnt);
+}
+
+static int32_t USART_Control (uint32_t control, uint32_t arg) {
+
+  switch (control & ARM_USART_CONTROL_Msk) {
+    case ARM_USART_MODE_ASYNCHRONOUS:
+      usart.baudrate = arg;
+      break;
+    case ARM_USART_CONTROL_TX:
+      usart.tx_enabled = (arg != 0U) ? 1U : 0U;
+      break;
+    case ARM_USART_CONTROL_RX:
+      usart.rx_enabled = (arg != 0U) ? 1U : 0U;
+      break;
+    case ARM_USART_ABORT_RECEIVE:
+      pthread_mutex_lock(&usart_mutex);
+      usart.rx_busy = 0U;
+      pthread_mutex_unlock(&usart_mutex);
+      break;
+    default:
+      return (ARM_DRIVER_ERROR_UNSUPPORTED);
+  }
+  return (ARM_DRIVER_OK);
+}
+
+static ARM_USART_STATUS USART_GetStatus (void) {
+  ARM_USART_STATUS status;
+
+  memset(&status, 0, sizeof(status));
+  status.tx_busy = usart.tx_busy;
+  status.rx_busy = usart.rx_busy;
+
+  return (status);
+}
+
+static int32_t USART_SetModemControl (ARM_USART_MODEM_CONTROL control) {
+  (void)control;
+  return (ARM_DRIVER_ERROR_UNSUPPORTED);
+}
+
+static ARM_USART_MODEM_STATUS USART_GetModemStatus (void) {
+  ARM_USART_MODEM_STATUS status;
+
+  memset(&status, 0, sizeof(status));
+  return (status);
+}
+
+/* Start copying transmitted data into buf */
+void usart_host_capture_start (uint8_t *buf, uint32_t size) {
+  pthread_mutex_lock(&usart_mutex);
+  usart.cap_buf  = buf;
+  usart.cap_size = size;
+  usart.cap_cnt  = 0U;
+  pthread_mutex_unlock(&usart_mutex);
+}
+
+/* Stop the capture, return the number of bytes copied */
+uint32_t usart_host_capture_stop (void) {
+  uint32_t cnt;
+
+  pthread_mutex_lock(&usart_mutex);
+  cnt = usart.cap_cnt;
+  usart.cap_buf = NULL;
+  pthread_mutex_unlock(&usart_mutex);
+
+  return (cnt);
+}
+
+extern ARM_DRIVER_USART Driver_USART0;
+       ARM_DRIVER_USART Driver_USART0 = {
+  USART_GetVersion,
+  USART_GetCapabilities,
+  USART_Initialize,
+  USART_Uninitialize,
+  USART_PowerControl,
+  USART_Send,
+  USART_Receive,
+  USART_Transfer,
+  USART_GetTxCount,
+  USART_GetRxCount,
+  USART_Control,
+  USART_GetStatus,
+  USART_SetModemControl,
+  USART_GetModemStatus
+};
@@ -0,0 +1,32 @@
+/*
+ * Copyright (C) 2023 ARM Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *      Name:    usart_host.h
+ *      Purpose: CMSIS-Driver USART stand-in for POSIX hosts
+ *
+ *---------------------------------------------------------------------------*/
+
+#ifndef USART_HOST_H__
+#define USART_HOST_H__
+
+#include <stdint.h>
+
+/* Transmit capture: copy transmitted data also into buf (up to size bytes) */
+extern void     usart_host_capture_start (uint8_t *buf, uint32_t size);
+extern uint32_t usart_host_capture_stop  (void);
+
+#endif /* USART_HOST_H__ */
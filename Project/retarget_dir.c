@@ -0,0 +1,118 @@
+/*---------------------------------------------------------------------------
+ * Copyright (c) 2023 Arm Limited (or its affiliates). All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *      Name:    retarget_dir.c
+ *      Purpose: Library stat and mkdir functions retargeted to rt_fs
+ *
+ *---------------------------------------------------------------------------*/
+
+#include <errno.h>
+#include <string.h>
+
+#include "retarget_fs.h"
+#include "retarget_fs_ext.h"
+#include "retarget_errno.h"
+
+/*
+  newlib calls the system functions _stat (from stat) and _mkdir, which
+  are not provided by the CMSIS-Compiler retarget. They are implemented
+  here with rt_fs_lookup and rt_fs_mkdir; newlib has no mkdir function,
+  so it is provided as well.
+
+  Arm Compiler and IAR libraries have no stat and mkdir functions,
+  applications call rt_fs_lookup and rt_fs_mkdir directly.
+*/
+
+#if defined(__GNUC__) && !defined(__ARMCC_VERSION)
+
+#include <time.h>
+#include <sys/stat.h>
+
+extern int _stat  (const char *path, struct stat *st);
+extern int _mkdir (const char *path, mode_t mode);
+
+/* Convert retarget time to seconds since 1970 */
+static time_t rt_time_to_sec (const rt_fs_time_t *t) {
+  uint32_t y, m, days;
+
+  if ((t->year < 1970U) || (t->mon < 1U) || (t->mon > 12U)) {
+    /* No time */
+    return (0);
+  }
+
+  /* Days since 1970-01-01, years starting in March */
+  y = t->year;
+  m = t->mon;
+  if (m <= 2U) {
+    y -= 1U;
+    m += 12U;
+  }
+  days = (365U * y) + (y / 4U) - (y / 100U) + (y / 400U) + (((153U * (m - 3U)) + 2U) / 5U) + t->day - 719469U;
+
+  return (((time_t)days * 86400) + (t->hour * 3600) + (t->min * 60) + t->sec);
+}
+
+/* Get file status by path */
+int _stat (const char *path, struct stat *st) {
+  rt_fs_dirent_t ent;
+  int32_t rval;
+
+  rval = rt_fs_lookup(path, &ent);
+  if (rval < 0) {
+    errno = rt_rval_to_errno(rval);
+    return (-1);
+  }
+
+  memset(st, 0, sizeof(struct stat));
+  if ((ent.attr & RT_ATTR_DIR) != 0U) {
+    st->st_mode = S_IFDIR | S_IRWXU | S_IRWXG | S_IRWXO;
+  } else {
+    st->st_mode = S_IFREG | S_IRUSR | S_IRGRP | S_IROTH;
+    if ((ent.attr & RT_ATTR_RD) == 0U) {
+      st->st_mode |= S_IWUSR | S_IWGRP | S_IWOTH;
+    }
+  }
+  st->st_nlink = 1;
+  st->st_size  = (off_t)ent.size;
+  st->st_mtime = rt_time_to_sec(&ent.modify);
+  st->st_atime = st->st_mtime;
+  st->st_ctime = st->st_mtime;
+
+  return (0);
+}
+
+/* Create a directory */
+int _mkdir (const char *path, mode_t mode) {
+  int32_t rval;
+
+  /* FAT has no access permissions */
+  (void)mode;
+
+  rval = rt_fs_mkdir(path);
+  if (rval < 0) {
+    errno = rt_rval_to_errno(rval);
+    return (-1);
+  }
+  return (0);
+}
+
+/* Create a directory */
+int mkdir (const char *path, mode_t mode) {
+  return (_mkdir(path, mode));
+}
+
+#endif
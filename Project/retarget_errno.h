@@ -0,0 +1,56 @@
+/*---------------------------------------------------------------------------
+ * Copyright (c) 2023 Arm Limited (or its affiliates). All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *      Name:    retarget_errno.h
+ *      Purpose: Conversion of rt_fs return codes to errno values
+ *
+ *---------------------------------------------------------------------------*/
+
+#ifndef RETARGET_ERRNO_H__
+#define RETARGET_ERRNO_H__
+
+#include <stdint.h>
+#include <errno.h>
+
+#include "retarget_fs.h"
+
+/*
+  All library functions retargeted to rt_fs (rename, stat, mkdir, fsync,
+  lseek64) report errors with this mapping. Return codes not listed here
+  are reported as EIO.
+*/
+
+/* Convert retarget return code to errno value */
+static inline int rt_rval_to_errno (int32_t rval) {
+  int err;
+
+  if      (rval == RT_ERR_INVAL)    { err = EINVAL;    }
+  else if (rval == RT_ERR_NOTSUP)   { err = ENOSYS;    }
+  else if (rval == RT_ERR_NOTFOUND) { err = ENOENT;    }
+  else if (rval == RT_ERR_EXIST)    { err = EEXIST;    }
+  else if (rval == RT_ERR_ISDIR)    { err = EISDIR;    }
+  else if (rval == RT_ERR_NOTDIR)   { err = ENOTDIR;   }
+  else if (rval == RT_ERR_NOTEMPTY) { err = ENOTEMPTY; }
+  else if (rval == RT_ERR_BUSY)     { err = EBUSY;     }
+  else if (rval == RT_ERR_NOSPACE)  { err = ENOSPC;    }
+  else if (rval == RT_ERR_MAXFILES) { err = EMFILE;    }
+  else                              { err = EIO;       }
+
+  return (err);
+}
+
+#endif /* RETARGET_ERRNO_H__ */
@@ -22,7 +22,13 @@
  * limitations under the License.
  */
 
+#if defined(RT_FS_VFS)
+/* Backend of the mount table: functions are named fs_rt_fs_... */
+#define RT_FS_VFS_BACKEND       fs
+#include "retarget_vfs.h"
+#endif
 #include "retarget_fs.h"
+#include "retarget_fs_ext.h"
 
 /* Open a file */
 int32_t rt_fs_open (const char *path, int32_t mode) {
@@ -77,3 +83,92 @@ int32_t rt_fs_rename (const char *oldpath, const char *newpath) {
   // ...
   return (RT_ERR);
 }
+
+/* Write cached data of a file to the file system */
+int32_t rt_fs_flush (int32_t fd) {
+  // ...
+  return (RT_ERR_NOTSUP);
+}
+
+/* Write cached data of a file and commit it to the storage medium */
+int32_t rt_fs_sync (int32_t fd) {
+  // ...
+  return (RT_ERR_NOTSUP);
+}
+
+/* Get cache statistics */
+int32_t rt_fs_cache_get_stats (rt_fs_cache_stats_t *stats) {
+  // ...
+  return (RT_ERR_NOTSUP);
+}
+
+/* Map file data for reading */
+int32_t rt_fs_map (int32_t fd, int64_t offset, uint32_t len, const void **ptr) {
+  // ...
+  return (RT_ERR_NOTSUP);
+}
+
+/* Release mapped file data */
+int32_t rt_fs_unmap (int32_t fd, const void *ptr) {
+  // ...
+  return (RT_ERR_NOTSUP);
+}
+
+/* Write segments to a file */
+int32_t rt_fs_writev (int32_t fd, const rt_fs_iovec_t *iov, uint32_t iovcnt) {
+  // ...
+  return (RT_ERR_NOTSUP);
+}
+
+/* Read from a file into segments */
+int32_t rt_fs_readv (int32_t fd, const rt_fs_iovec_t *iov, uint32_t iovcnt) {
+  // ...
+  return (RT_ERR_NOTSUP);
+}
+
+/* Create a directory */
+int32_t rt_fs_mkdir (const char *path) {
+  // ...
+  return (RT_ERR_NOTSUP);
+}
+
+/* Remove an empty directory */
+int32_t rt_fs_rmdir (const char *path) {
+  // ...
+  return (RT_ERR_NOTSUP);
+}
+
+/* Open a directory */
+int32_t rt_fs_opendir (const char *path) {
+  // ...
+  return (RT_ERR_NOTSUP);
+}
+
+/* Read the next directory entry */
+int32_t rt_fs_readdir (int32_t dd, rt_fs_dirent_t *ent) {
+  // ...
+  return (RT_ERR_NOTSUP);
+}
+
+/* Close a directory */
+int32_t rt_fs_closedir (int32_t dd) {
+  // ...
+  return (RT_ERR_NOTSUP);
+}
+
+/* Get the directory entry of a path */
+int32_t rt_fs_lookup (const char *path, rt_fs_dirent_t *ent) {
+  // ...
+  return (RT_ERR_NOTSUP);
+}
+
+/* Drop cached lookup results */
+int32_t rt_fs_invalidate (const char *path) {
+  // ...
+  return (RT_ERR_NOTSUP);
+}
+
+#if defined(RT_FS_VFS)
+/* Operations for rt_vfs_mount */
+RT_FS_VFS_OPS(fs);
+#endif
@@ -0,0 +1,248 @@
+/*---------------------------------------------------------------------------
+ * Copyright (c) 2023 Arm Limited (or its affiliates). All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *      Name:    retarget_fs_aio.c
+ *      Purpose: Asynchronous file I/O with submission and completion rings
+ *
+ *---------------------------------------------------------------------------*/
+
+#include <stddef.h>
+#include <string.h>
+
+#include "RTE_Components.h"
+#include "cmsis_compiler.h"
+#include "retarget_fs.h"
+#include "retarget_fs_ext.h"
+#include "retarget_fs_aio.h"
+
+#if defined(RTE_CMSIS_RTOS2)
+#include "cmsis_os2.h"
+#endif
+
+/* Stack size of the worker thread in bytes */
+#ifndef RT_FS_AIO_STACK_SIZE
+#define RT_FS_AIO_STACK_SIZE    1024
+#endif
+
+/* Priority of the worker thread */
+#ifndef RT_FS_AIO_PRIORITY
+#define RT_FS_AIO_PRIORITY      osPriorityBelowNormal
+#endif
+
+#if ((RT_FS_AIO_SQ_NUM & (RT_FS_AIO_SQ_NUM - 1)) != 0)
+#error "RT_FS_AIO_SQ_NUM must be a power of 2."
+#endif
+#if ((RT_FS_AIO_CQ_NUM & (RT_FS_AIO_CQ_NUM - 1)) != 0)
+#error "RT_FS_AIO_CQ_NUM must be a power of 2."
+#endif
+
+/*
+  Submission and completion rings
+
+  The caller takes entries from the submission ring with rt_fs_aio_get_sqe,
+  fills them in and passes all taken entries to the worker thread with
+  rt_fs_aio_submit. The worker executes the operations in submission order
+  with the rt_fs functions and puts one entry per operation into the
+  completion ring, from where the caller collects them with rt_fs_aio_reap.
+  Buffers must stay valid until the completion of the operation.
+
+  Each ring has a single producer and a single consumer: one thread submits
+  and one thread reaps (may be the same). Indexes are free running. An entry
+  is only given out when the completion ring has room for its completion,
+  so the worker never waits for the caller.
+
+  Without CMSIS-RTOS2 (or before the kernel is started), the operations are
+  executed by rt_fs_aio_submit.
+*/
+
+/* Submission ring */
+static rt_fs_aio_sqe_t   sq[RT_FS_AIO_SQ_NUM];
+static uint32_t          sq_prep;       /* Entries taken by the caller      */
+static volatile uint32_t sq_tail;       /* Entries submitted                */
+static volatile uint32_t sq_head;       /* Entries taken by the worker      */
+
+/* Completion ring */
+static rt_fs_aio_cqe_t   cq[RT_FS_AIO_CQ_NUM];
+static volatile uint32_t cq_tail;       /* Entries completed                */
+static volatile uint32_t cq_head;       /* Entries reaped                   */
+
+#if defined(RTE_CMSIS_RTOS2)
+static osThreadId_t     aio_thread_id;
+static osEventFlagsId_t aio_evf;
+
+static uint64_t aio_stack[(RT_FS_AIO_STACK_SIZE + 7U) / 8U];
+
+static const osThreadAttr_t aio_attr = {
+  .name       = "rt_fs_aio",
+  .stack_mem  = aio_stack,
+  .stack_size = sizeof(aio_stack),
+  .priority   = RT_FS_AIO_PRIORITY
+};
+
+/* Flags */
+#define AIO_FLAG_SQ             (1UL << 0)  /* Thread flag: entries submitted   */
+#define AIO_FLAG_CQ             (1UL << 0)  /* Event flag: entries completed    */
+#endif
+
+/* Execute submitted operations */
+static void aio_process (void) {
+  rt_fs_aio_sqe_t e;
+  rt_fs_aio_cqe_t *c;
+  int32_t res;
+
+  while (sq_head != sq_tail) {
+    __DMB();
+    e = sq[sq_head & (RT_FS_AIO_SQ_NUM - 1U)];
+    __DMB();
+    sq_head++;
+
+    if      (e.op == RT_FS_AIO_OP_READ)  { res = rt_fs_read (e.fd, e.buf, e.len); }
+    else if (e.op == RT_FS_AIO_OP_WRITE) { res = rt_fs_write(e.fd, e.buf, e.len); }
+    else if (e.op == RT_FS_AIO_OP_FLUSH) { res = rt_fs_flush(e.fd);               }
+    else if (e.op == RT_FS_AIO_OP_CLOSE) { res = rt_fs_close(e.fd);               }
+    else if (e.op == RT_FS_AIO_OP_SYNC)  { res = rt_fs_sync (e.fd);               }
+    else                                 { res = RT_ERR_INVAL;                    }
+
+    /* Room for the completion was reserved by rt_fs_aio_get_sqe */
+    c = &cq[cq_tail & (RT_FS_AIO_CQ_NUM - 1U)];
+    c->user_data = e.user_data;
+    c->res       = res;
+    __DMB();
+    cq_tail++;
+
+#if defined(RTE_CMSIS_RTOS2)
+    if (aio_evf != NULL) {
+      osEventFlagsSet(aio_evf, AIO_FLAG_CQ);
+    }
+#endif
+  }
+}
+
+#if defined(RTE_CMSIS_RTOS2)
+/* Worker thread */
+static void aio_thread (void *arg) {
+
+  (void)arg;
+
+  for (;;) {
+    osThreadFlagsWait(AIO_FLAG_SQ, osFlagsWaitAny, osWaitForever);
+    aio_process();
+  }
+}
+#endif
+
+/**
+  Get a free submission ring entry
+
+  \return          Entry to be filled in, or NULL when the submission ring is
+                   full or too many completions are not yet collected.
+*/
+rt_fs_aio_sqe_t *rt_fs_aio_get_sqe (void) {
+  rt_fs_aio_sqe_t *e;
+
+  if (((sq_prep - sq_head) >= RT_FS_AIO_SQ_NUM) ||
+      ((sq_prep - cq_head) >= RT_FS_AIO_CQ_NUM)) {
+    return (NULL);
+  }
+
+  e = &sq[sq_prep & (RT_FS_AIO_SQ_NUM - 1U)];
+  memset(e, 0, sizeof(rt_fs_aio_sqe_t));
+  sq_prep++;
+
+  return (e);
+}
+
+/**
+  Pass all entries taken with rt_fs_aio_get_sqe to the worker thread
+
+  \return          Number of submitted entries.
+*/
+int32_t rt_fs_aio_submit (void) {
+  uint32_t n;
+
+  n = sq_prep - sq_tail;
+  if (n == 0U) {
+    return (0);
+  }
+
+  __DMB();
+  sq_tail = sq_prep;
+
+#if defined(RTE_CMSIS_RTOS2)
+  if (osKernelGetState() == osKernelRunning) {
+    if (aio_thread_id == NULL) {
+      /* Create worker thread on first use */
+      osKernelLock();
+      if (aio_thread_id == NULL) {
+        aio_evf = osEventFlagsNew(NULL);
+        if (aio_evf != NULL) {
+          aio_thread_id = osThreadNew(aio_thread, NULL, &aio_attr);
+        }
+      }
+      osKernelUnlock();
+    }
+    if (aio_thread_id != NULL) {
+      osThreadFlagsSet(aio_thread_id, AIO_FLAG_SQ);
+      return ((int32_t)n);
+    }
+  }
+#endif
+
+  /* No worker thread: execute the operations now */
+  aio_process();
+
+  return ((int32_t)n);
+}
+
+/**
+  Collect completed operations
+
+  \param[out]  cqe      Array receiving the completions
+  \param[in]   num      Maximum number of completions to collect
+  \param[in]   timeout  Time to wait for the first completion in kernel ticks
+                        (0: do not wait, osWaitForever: until one completes)
+  \return               Number of collected completions.
+*/
+uint32_t rt_fs_aio_reap (rt_fs_aio_cqe_t *cqe, uint32_t num, uint32_t timeout) {
+  uint32_t n;
+
+  n = 0U;
+  for (;;) {
+    while ((n < num) && (cq_head != cq_tail)) {
+      __DMB();
+      cqe[n++] = cq[cq_head & (RT_FS_AIO_CQ_NUM - 1U)];
+      __DMB();
+      cq_head++;
+    }
+    if ((n != 0U) || (num == 0U) || (timeout == 0U)) {
+      break;
+    }
+#if defined(RTE_CMSIS_RTOS2)
+    if (aio_evf == NULL) {
+      break;
+    }
+    /* The flag may be left from completions that were already collected */
+    if ((osEventFlagsWait(aio_evf, AIO_FLAG_CQ, osFlagsWaitAny, timeout) & 0x80000000U) != 0U) {
+      break;
+    }
+#else
+    break;
+#endif
+  }
+
+  return (n);
+}
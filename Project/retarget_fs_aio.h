@@ -0,0 +1,68 @@
+/*---------------------------------------------------------------------------
+ * Copyright (c) 2023 Arm Limited (or its affiliates). All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *      Name:    retarget_fs_aio.h
+ *      Purpose: Asynchronous file I/O with submission and completion rings
+ *
+ *---------------------------------------------------------------------------*/
+
+#ifndef RETARGET_FS_AIO_H__
+#define RETARGET_FS_AIO_H__
+
+#include <stdint.h>
+
+/* Number of submission ring entries (must be a power of 2) */
+#ifndef RT_FS_AIO_SQ_NUM
+#define RT_FS_AIO_SQ_NUM        16
+#endif
+
+/* Number of completion ring entries, limits the operations not yet reaped
+   (must be a power of 2) */
+#ifndef RT_FS_AIO_CQ_NUM
+#define RT_FS_AIO_CQ_NUM        32
+#endif
+
+/* Operations */
+#define RT_FS_AIO_OP_READ       1U    /* rt_fs_read (fd, buf, len)          */
+#define RT_FS_AIO_OP_WRITE      2U    /* rt_fs_write (fd, buf, len)         */
+#define RT_FS_AIO_OP_FLUSH      3U    /* rt_fs_flush (fd)                   */
+#define RT_FS_AIO_OP_CLOSE      4U    /* rt_fs_close (fd)                   */
+#define RT_FS_AIO_OP_SYNC       5U    /* rt_fs_sync (fd)                    */
+
+/* Submission ring entry */
+typedef struct {
+  uint32_t op;                  /* Operation (RT_FS_AIO_OP_...)             */
+  int32_t  fd;                  /* File handle                              */
+  void    *buf;                 /* Data buffer, valid until completion      */
+  uint32_t len;                 /* Number of bytes to read or write         */
+  void    *user_data;           /* Passed to the completion                 */
+} rt_fs_aio_sqe_t;
+
+/* Completion ring entry */
+typedef struct {
+  void    *user_data;           /* From the submission ring entry           */
+  int32_t  res;                 /* Return value of the operation            */
+} rt_fs_aio_cqe_t;
+
+/* Submission */
+extern rt_fs_aio_sqe_t *rt_fs_aio_get_sqe (void);
+extern int32_t          rt_fs_aio_submit  (void);
+
+/* Completion */
+extern uint32_t         rt_fs_aio_reap    (rt_fs_aio_cqe_t *cqe, uint32_t num, uint32_t timeout);
+
+#endif /* RETARGET_FS_AIO_H__ */
@@ -0,0 +1,138 @@
+/*---------------------------------------------------------------------------
+ * Copyright (c) 2023 Arm Limited (or its affiliates). All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *      Name:    retarget_fs_ext.h
+ *      Purpose: File Interface Retarget extensions
+ *
+ *---------------------------------------------------------------------------*/
+
+#ifndef RETARGET_FS_EXT_H__
+#define RETARGET_FS_EXT_H__
+
+#include <stdint.h>
+
+#include "retarget_fs.h"
+
+/*
+  Functions in this file extend the rt_fs file interface of CMSIS-Compiler.
+  A file system retarget without support for a function returns
+  RT_ERR_NOTSUP.
+
+  rt_fs_map gives read access to file data without copying it to a buffer
+  of the caller. The returned pointer addresses the data in the storage
+  when it is contiguous in memory, otherwise the retarget copies the data
+  to memory of its own (i.e. a cache block). Less than len bytes may be
+  mapped (end of file, end of a cache block); the caller maps the rest
+  with further calls. Mapped data stays valid until rt_fs_unmap, also
+  when the file is closed meanwhile. Data written to a mapped range of
+  the file may or may not be seen through the mapping.
+
+  rt_fs_sync writes cached data of a file like rt_fs_flush and returns
+  when the data and the size of the file are committed to the storage
+  medium, so they are kept when power is lost; it is a write barrier for
+  the data written before the call. A file system retarget may commit
+  sync requests of several threads together (group commit): a file synced
+  by several threads at once is committed to the medium only once.
+
+  Directories are created and removed with rt_fs_mkdir and rt_fs_rmdir,
+  rt_fs_opendir, rt_fs_readdir and rt_fs_closedir list the entries of a
+  directory ("." and ".." are not listed). rt_fs_lookup returns the entry
+  of a path without opening it; a file system retarget may cache results
+  of lookups, including paths that do not exist. rt_fs_invalidate drops
+  cached results of a path (all paths when path is NULL), after the file
+  system is changed other than through rt_fs or its media is changed.
+*/
+
+/* Maximum length of a directory entry name, including the terminating null */
+#ifndef RT_FS_NAME_MAX
+#define RT_FS_NAME_MAX          64
+#endif
+
+/* Cache statistics */
+typedef struct {
+  uint32_t hits;                /* Writes into an already cached block      */
+  uint32_t misses;              /* Writes that required a new cache block   */
+  uint32_t evictions;           /* Blocks with dirty data reused for others */
+  uint32_t writes;              /* Write calls to the file system           */
+  uint32_t ra_blocks;           /* Blocks read ahead                        */
+  uint32_t ra_hits;             /* Read ahead blocks used by reads          */
+  uint32_t ra_misses;           /* Sequential reads not served by the cache */
+  uint32_t map_hits;            /* Maps of data already in the cache        */
+  uint32_t map_loads;           /* Blocks read from the file system by maps */
+  uint32_t dc_hits;             /* Lookups served by the directory cache    */
+  uint32_t dc_misses;           /* Lookups searched in the directory        */
+  uint32_t syncs;               /* rt_fs_sync calls                         */
+  uint32_t commits;             /* Files committed to the storage medium    */
+} rt_fs_cache_stats_t;
+
+/* I/O vector element for rt_fs_readv and rt_fs_writev */
+typedef struct {
+  void    *base;                /* Start of the segment                     */
+  uint32_t len;                 /* Length of the segment in bytes           */
+} rt_fs_iovec_t;
+
+/* Directory entry */
+typedef struct {
+  char     name[RT_FS_NAME_MAX];  /* Entry name, truncated when longer */
+  uint32_t attr;                /* Attributes (RT_ATTR_...)                 */
+  int64_t  size;                /* File size in bytes                       */
+  rt_fs_time_t modify;          /* Time of last modification                */
+} rt_fs_dirent_t;
+
+/* Write cached data of a file to the file system */
+extern int32_t rt_fs_flush (int32_t fd);
+
+/* Write cached data of a file and commit it to the storage medium */
+extern int32_t rt_fs_sync (int32_t fd);
+
+/* Get cache statistics */
+extern int32_t rt_fs_cache_get_stats (rt_fs_cache_stats_t *stats);
+
+/* Map file data for reading, return number of bytes mapped (0 at end of file) */
+extern int32_t rt_fs_map (int32_t fd, int64_t offset, uint32_t len, const void **ptr);
+
+/* Release data mapped with rt_fs_map */
+extern int32_t rt_fs_unmap (int32_t fd, const void *ptr);
+
+/* Write segments to a file in one call, return number of bytes written */
+extern int32_t rt_fs_writev (int32_t fd, const rt_fs_iovec_t *iov, uint32_t iovcnt);
+
+/* Read into segments in one call, return number of bytes read */
+extern int32_t rt_fs_readv (int32_t fd, const rt_fs_iovec_t *iov, uint32_t iovcnt);
+
+/* Create a directory */
+extern int32_t rt_fs_mkdir (const char *path);
+
+/* Remove an empty directory */
+extern int32_t rt_fs_rmdir (const char *path);
+
+/* Open a directory for reading its entries, return directory handle */
+extern int32_t rt_fs_opendir (const char *path);
+
+/* Read the next directory entry, return 1 when read, 0 when no more entries */
+extern int32_t rt_fs_readdir (int32_t dd, rt_fs_dirent_t *ent);
+
+/* Close a directory */
+extern int32_t rt_fs_closedir (int32_t dd);
+
+/* Get the directory entry of a path */
+extern int32_t rt_fs_lookup (const char *path, rt_fs_dirent_t *ent);
+
+/* Drop cached lookup results of a path, of all paths when path is NULL */
+extern int32_t rt_fs_invalidate (const char *path);
+
+#endif /* RETARGET_FS_EXT_H__ */
@@ -0,0 +1,69 @@
+/*---------------------------------------------------------------------------
+ * Copyright (c) 2023 Arm Limited (or its affiliates). All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *      Name:    retarget_fsync.c
+ *      Purpose: Library file synchronization functions retargeted to rt_fs_sync
+ *
+ *---------------------------------------------------------------------------*/
+
+#include <errno.h>
+
+#include "retarget_fs.h"
+#include "retarget_fs_ext.h"
+#include "retarget_errno.h"
+
+/*
+  newlib declares fsync and fdatasync but provides no implementation. They
+  are implemented here with rt_fs_sync, which writes the data of the file
+  and commits it to the storage medium:
+
+    fflush (f); fsync (fileno (f)) -> rt_fs_sync
+
+  fflush only passes buffered stream data to _write, the data may still be
+  held by the file system. Arm Compiler and IAR libraries have no fsync,
+  applications call rt_fs_sync directly.
+*/
+
+#if defined(__GNUC__) && !defined(__ARMCC_VERSION)
+
+#include <unistd.h>
+
+/* Write the data and attributes of a file to the storage medium */
+int fsync (int fd) {
+  int32_t rval;
+
+  if (fd <= STDERR_FILENO) {
+    /* Standard streams are not synchronized */
+    errno = EINVAL;
+    return (-1);
+  }
+
+  rval = rt_fs_sync(fd);
+  if (rval < 0) {
+    errno = rt_rval_to_errno(rval);
+    return (-1);
+  }
+  return (0);
+}
+
+/* Write the data of a file to the storage medium */
+int fdatasync (int fd) {
+  /* The file size is committed with the data */
+  return (fsync(fd));
+}
+
+#endif
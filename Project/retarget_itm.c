@@ -0,0 +1,358 @@
+/*---------------------------------------------------------------------------
+ * Copyright (c) 2023 Arm Limited (or its affiliates). All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *      Name:    retarget_itm.c
+ *      Purpose: ITM stimulus port output
+ *
+ *---------------------------------------------------------------------------*/
+
+#include <stddef.h>
+
+#include "RTE_Components.h"
+#include "retarget_itm.h"
+
+#if defined(ITM_HOST_MODEL)
+/* Software model of the ITM FIFO (Project/Host/itm_host.c) */
+#include "itm_host.h"
+#include "cmsis_compiler.h"
+
+#define ITM_PORT_ENABLED(n)     (itm_host_enabled(n) != 0U)
+#define ITM_PORT_READY(n)       (itm_host_ready(n) != 0U)
+#define ITM_PORT_WRITE(n,v,s)   itm_host_write((n), (v), (s))
+#else
+#include CMSIS_device_header
+
+#define ITM_PORT_ENABLED(n)     (((ITM->TCR & ITM_TCR_ITMENA_Msk) != 0UL) && \
+                                 ((ITM->TER & (1UL << (n))) != 0UL))
+#define ITM_PORT_READY(n)       (ITM->PORT[n].u32 != 0UL)
+#define ITM_PORT_WRITE(n,v,s)   itm_port_write((n), (v), (s))
+
+/* Write to a stimulus port with the access size that selects the packet size */
+__STATIC_FORCEINLINE void itm_port_write (uint32_t port, uint32_t val, uint32_t size) {
+  switch (size) {
+    case 4U:  ITM->PORT[port].u32 = val;           break;
+    case 2U:  ITM->PORT[port].u16 = (uint16_t)val; break;
+    default:  ITM->PORT[port].u8  = (uint8_t)val;  break;
+  }
+}
+#endif
+
+#if defined(RTE_CMSIS_RTOS2)
+#include "cmsis_os2.h"
+#endif
+
+#define ITM_PORT_NUM            32U
+
+#if ((ITM_PORT_STDOUT >= ITM_PORT_NUM) || (ITM_PORT_STDERR >= ITM_PORT_NUM) || \
+     ((ITM_PORT_TRACE + ITM_PORT_TRACE_NUM) > ITM_PORT_NUM) || (ITM_PORT_TRACE_NUM == 0))
+#error "ITM stimulus port configuration out of range."
+#endif
+
+/* Characters collected by itm_putchar, sent as one word */
+static uint32_t itm_word[ITM_PORT_NUM];
+static uint8_t  itm_word_cnt[ITM_PORT_NUM];
+
+/* Statistics */
+static itm_stats_t itm_stats;
+
+#if defined(RTE_CMSIS_RTOS2)
+/* Threads assigned to trace ports */
+static osThreadId_t itm_trace_owner[ITM_PORT_TRACE_NUM];
+#endif
+
+/**
+  Write one packet to a stimulus port
+
+  The FIFO is polled with interrupts enabled. The port is checked again and
+  written with interrupts disabled, so that a packet is never lost to a
+  write from an interrupting context.
+
+  \param[in]   port  Stimulus port number
+  \param[in]   val   Packet data, lowest byte first
+  \param[in]   size  Packet size: 1, 2 or 4 bytes
+*/
+static void itm_put (uint32_t port, uint32_t val, uint32_t size) {
+  uint32_t primask;
+  uint32_t done;
+
+  done = 0U;
+
+  while (done == 0U) {
+    while (!ITM_PORT_READY(port)) {
+      __NOP();
+    }
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (ITM_PORT_READY(port)) {
+      ITM_PORT_WRITE(port, val, size);
+
+      itm_stats.bytes += size;
+      itm_stats.writes++;
+      done = 1U;
+    }
+
+    __set_PRIMASK(primask);
+  }
+}
+
+/* Send cnt characters collected by itm_putchar */
+static void itm_put_word (uint32_t port, uint32_t val, uint32_t cnt) {
+
+  if (cnt == 4U) {
+    itm_put(port, val, 4U);
+    return;
+  }
+  if (cnt >= 2U) {
+    itm_put(port, val, 2U);
+    val >>= 16;
+  }
+  if ((cnt & 1U) != 0U) {
+    itm_put(port, val, 1U);
+  }
+}
+
+/**
+  Write data to a stimulus port
+
+  Data is packed into 32-bit stimulus port writes, the remainder is written
+  with 16-bit and 8-bit writes. Data for a disabled port is discarded.
+
+  \param[in]   port  Stimulus port number
+  \param[in]   buf   Data to output
+  \param[in]   len   Number of bytes to output
+  \return           Number of bytes consumed.
+*/
+uint32_t itm_write (uint32_t port, const uint8_t *buf, uint32_t len) {
+  uint32_t n;
+
+  if ((port >= ITM_PORT_NUM) || (buf == NULL)) {
+    return (0U);
+  }
+
+  if (!ITM_PORT_ENABLED(port)) {
+    itm_word_cnt[port] = 0U;
+    itm_word[port]     = 0U;
+    itm_stats.drops += len;
+    return (len);
+  }
+
+  /* Keep the order with characters from itm_putchar */
+  itm_flush(port);
+
+  for (n = 0U; (len - n) >= 4U; n += 4U) {
+    itm_put(port, (uint32_t)buf[n]              |
+                  ((uint32_t)buf[n + 1U] <<  8) |
+                  ((uint32_t)buf[n + 2U] << 16) |
+                  ((uint32_t)buf[n + 3U] << 24), 4U);
+  }
+  if ((len - n) >= 2U) {
+    itm_put(port, (uint32_t)buf[n] | ((uint32_t)buf[n + 1U] << 8), 2U);
+    n += 2U;
+  }
+  if (n < len) {
+    itm_put(port, buf[n], 1U);
+  }
+
+  return (len);
+}
+
+/**
+  Write a character to a stimulus port
+
+  Characters are collected and sent with one 32-bit write per four
+  characters. A new line character sends the collected characters at once.
+
+  \param[in]   port  Stimulus port number
+  \param[in]   ch    Character to output
+  \return           The character written, or -1 on write error.
+*/
+int itm_putchar (uint32_t port, int ch) {
+  uint32_t primask;
+  uint32_t cnt, val;
+
+  if (port >= ITM_PORT_NUM) {
+    return (-1);
+  }
+
+  if (!ITM_PORT_ENABLED(port)) {
+    itm_stats.drops++;
+    return (ch);
+  }
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+
+  cnt = itm_word_cnt[port];
+  val = itm_word[port] | ((uint32_t)(uint8_t)ch << (cnt * 8U));
+  cnt++;
+
+  if ((cnt == 4U) || (ch == '\n')) {
+    /* Take the collected characters, they are sent below */
+    itm_word_cnt[port] = 0U;
+    itm_word[port]     = 0U;
+  } else {
+    itm_word_cnt[port] = (uint8_t)cnt;
+    itm_word[port]     = val;
+    cnt = 0U;
+  }
+
+  __set_PRIMASK(primask);
+
+  if (cnt != 0U) {
+    itm_put_word(port, val, cnt);
+  }
+
+  return (ch);
+}
+
+/**
+  Send characters collected by itm_putchar
+
+  \param[in]   port  Stimulus port number
+*/
+void itm_flush (uint32_t port) {
+  uint32_t primask;
+  uint32_t cnt, val;
+
+  if (port < ITM_PORT_NUM) {
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    cnt = itm_word_cnt[port];
+    val = itm_word[port];
+    itm_word_cnt[port] = 0U;
+    itm_word[port]     = 0U;
+
+    __set_PRIMASK(primask);
+
+    if (cnt != 0U) {
+      itm_put_word(port, val, cnt);
+    }
+  }
+}
+
+#if defined(RTE_CMSIS_RTOS2)
+/* Find or assign the trace port of a thread, ITM_PORT_TRACE_NUM when all are assigned */
+static uint32_t itm_trace_find (osThreadId_t thread_id) {
+  uint32_t primask;
+  uint32_t i, idx;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+
+  idx = ITM_PORT_TRACE_NUM;
+  for (i = 0U; i < ITM_PORT_TRACE_NUM; i++) {
+    if (itm_trace_owner[i] == thread_id) {
+      idx = i;
+      break;
+    }
+    if ((itm_trace_owner[i] == NULL) && (idx == ITM_PORT_TRACE_NUM)) {
+      idx = i;
+    }
+  }
+  if (idx != ITM_PORT_TRACE_NUM) {
+    itm_trace_owner[idx] = thread_id;
+  }
+
+  __set_PRIMASK(primask);
+
+  return (idx);
+}
+
+/* Release trace ports of threads that have terminated (thread mode only) */
+static void itm_trace_release (void) {
+  osThreadId_t owner;
+  osThreadState_t state;
+  uint32_t primask;
+  uint32_t i;
+
+  for (i = 0U; i < ITM_PORT_TRACE_NUM; i++) {
+    owner = itm_trace_owner[i];
+    if (owner != NULL) {
+      state = osThreadGetState(owner);
+      if ((state == osThreadTerminated) || (state == osThreadError)) {
+        primask = __get_PRIMASK();
+        __disable_irq();
+        if (itm_trace_owner[i] == owner) {
+          itm_trace_owner[i] = NULL;
+        }
+        __set_PRIMASK(primask);
+      }
+    }
+  }
+}
+#endif
+
+/**
+  Write trace data of the calling thread
+
+  Each thread is assigned its own trace stimulus port on first use. When all
+  trace ports are assigned, ports of terminated threads are released and
+  assigned again. When all owners are still running, threads share ports.
+
+  \param[in]   buf   Data to output
+  \param[in]   len   Number of bytes to output
+  \return           Number of bytes consumed.
+*/
+uint32_t itm_trace_write (const uint8_t *buf, uint32_t len) {
+  uint32_t port;
+#if defined(RTE_CMSIS_RTOS2)
+  osThreadId_t thread_id;
+  uint32_t i;
+
+  port      = ITM_PORT_TRACE;
+  thread_id = osThreadGetId();
+
+  if (thread_id != NULL) {
+    i = itm_trace_find(thread_id);
+
+    if ((i == ITM_PORT_TRACE_NUM) && (__get_IPSR() == 0U)) {
+      /* Owners that have terminated do not need their ports anymore */
+      itm_trace_release();
+      i = itm_trace_find(thread_id);
+    }
+    if (i == ITM_PORT_TRACE_NUM) {
+      /* All ports assigned, share them */
+      i = (uint32_t)(((uintptr_t)thread_id / sizeof(void *)) % ITM_PORT_TRACE_NUM);
+    }
+
+    port = ITM_PORT_TRACE + i;
+  }
+#else
+  port = ITM_PORT_TRACE;
+#endif
+
+  return (itm_write(port, buf, len));
+}
+
+/**
+  Get output statistics
+
+  \param[out]  stats  Statistics counters
+*/
+void itm_get_stats (itm_stats_t *stats) {
+  uint32_t primask;
+
+  if (stats != NULL) {
+    primask = __get_PRIMASK();
+    __disable_irq();
+    *stats = itm_stats;
+    __set_PRIMASK(primask);
+  }
+}
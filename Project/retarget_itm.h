@@ -0,0 +1,64 @@
+/*---------------------------------------------------------------------------
+ * Copyright (c) 2023 Arm Limited (or its affiliates). All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *      Name:    retarget_itm.h
+ *      Purpose: ITM stimulus port output
+ *
+ *---------------------------------------------------------------------------*/
+
+#ifndef RETARGET_ITM_H__
+#define RETARGET_ITM_H__
+
+#include <stdint.h>
+
+/* Stimulus port used for stdout */
+#ifndef ITM_PORT_STDOUT
+#define ITM_PORT_STDOUT         0U
+#endif
+
+/* Stimulus port used for stderr */
+#ifndef ITM_PORT_STDERR
+#define ITM_PORT_STDERR         1U
+#endif
+
+/* First stimulus port used for per-thread traces */
+#ifndef ITM_PORT_TRACE
+#define ITM_PORT_TRACE          8U
+#endif
+
+/* Number of stimulus ports used for per-thread traces */
+#ifndef ITM_PORT_TRACE_NUM
+#define ITM_PORT_TRACE_NUM      8U
+#endif
+
+/* Output statistics */
+typedef struct {
+  uint32_t bytes;               /* Number of bytes written to stimulus ports */
+  uint32_t writes;              /* Number of stimulus port writes           */
+  uint32_t drops;               /* Number of bytes for disabled ports       */
+} itm_stats_t;
+
+/* Output */
+extern uint32_t itm_write       (uint32_t port, const uint8_t *buf, uint32_t len);
+extern int      itm_putchar     (uint32_t port, int ch);
+extern void     itm_flush       (uint32_t port);
+extern uint32_t itm_trace_write (const uint8_t *buf, uint32_t len);
+
+/* Statistics */
+extern void     itm_get_stats   (itm_stats_t *stats);
+
+#endif /* RETARGET_ITM_H__ */
@@ -0,0 +1,246 @@
+/*---------------------------------------------------------------------------
+ * Copyright (c) 2023 Arm Limited (or its affiliates). All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *      Name:    retarget_log.c
+ *      Purpose: Deferred (host formatted) logging over stdout
+ *
+ *---------------------------------------------------------------------------*/
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "retarget_log.h"
+#include "retarget_stdio.h"
+
+/* Maximum number of argument bytes in a frame (up to 255) */
+#ifndef LOG_ARG_SIZE
+#define LOG_ARG_SIZE            58
+#endif
+
+#if (LOG_ARG_SIZE > 255)
+#error "LOG_ARG_SIZE must not exceed 255."
+#endif
+
+/* Frame header size: start, argument size, format string offset */
+#define LOG_HDR_SIZE            4U
+
+/* Reference of the format string offsets */
+LOG_FMT_ATTR const char log_fmt_base[] = "";
+
+/* Frame being encoded */
+typedef struct {
+  uint32_t len;                         /* Number of argument bytes         */
+  uint8_t  buf[LOG_HDR_SIZE + LOG_ARG_SIZE];
+} log_frame_t;
+
+/* Append a value of size bytes, return 0 when it does not fit */
+static uint32_t log_put (log_frame_t *frm, const void *val, uint32_t size) {
+
+  if ((frm->len + size) > LOG_ARG_SIZE) {
+    return (0U);
+  }
+  memcpy(&frm->buf[LOG_HDR_SIZE + frm->len], val, size);
+  frm->len += size;
+
+  return (size);
+}
+
+/* Append a 32-bit value in little endian byte order */
+static uint32_t log_put_u32 (log_frame_t *frm, uint32_t val) {
+  uint8_t b[4];
+
+  b[0] = (uint8_t)(val);
+  b[1] = (uint8_t)(val >>  8);
+  b[2] = (uint8_t)(val >> 16);
+  b[3] = (uint8_t)(val >> 24);
+
+  return (log_put(frm, b, 4U));
+}
+
+/* Append a 64-bit value in little endian byte order */
+static uint32_t log_put_u64 (log_frame_t *frm, uint64_t val) {
+
+  if (log_put_u32(frm, (uint32_t)val) == 0U) {
+    return (0U);
+  }
+  return (log_put_u32(frm, (uint32_t)(val >> 32)));
+}
+
+/* Append an integer argument of size bytes (4 or 8) */
+static uint32_t log_put_int (log_frame_t *frm, uint64_t val, uint32_t size) {
+
+  if (size > 4U) {
+    return (log_put_u64(frm, val));
+  }
+  return (log_put_u32(frm, (uint32_t)val));
+}
+
+/* Append a string, truncated to the free space in the frame */
+static uint32_t log_put_str (log_frame_t *frm, const char *str) {
+  uint8_t  n;
+  uint32_t len;
+
+  if (str == NULL) {
+    str = "(null)";
+  }
+  len = LOG_ARG_SIZE - frm->len;
+  if (len == 0U) {
+    return (0U);
+  }
+  len -= 1U;
+
+  for (n = 0U; (n < len) && (str[n] != '\0'); n++);
+
+  frm->buf[LOG_HDR_SIZE + frm->len] = n;
+  frm->len += 1U;
+
+  return (log_put(frm, str, n) + 1U);
+}
+
+/**
+  Encode and output a log frame
+
+  Only the format string is scanned to find argument types, the text is
+  formatted by the host decoder. Arguments that do not fit into the frame
+  are omitted and shown as missing by the decoder.
+
+  \param[in]   fmt  printf format string located in LOG_FMT_SECTION
+  \param[in]   ...  Arguments
+  \return          Number of bytes written, or -1 on write error, when the
+                   format string contains the %n conversion or is not
+                   within 32 KB of log_fmt_base.
+*/
+int32_t log_printf (const char *fmt, ...) {
+  log_frame_t frm;
+  const char *p;
+  uint32_t lng, ok;
+  int32_t ofs;
+  union {
+    double   d;
+    uint64_t u;
+  } f;
+  va_list args;
+
+  if (fmt == NULL) {
+    return (-1);
+  }
+
+  /* Offset from log_fmt_base, computed from the addresses of the two objects */
+  ofs = (int32_t)((uint32_t)(uintptr_t)fmt - (uint32_t)(uintptr_t)log_fmt_base);
+  if ((ofs < INT16_MIN) || (ofs > INT16_MAX)) {
+    return (-1);
+  }
+
+  frm.len = 0U;
+  ok      = 1U;
+
+  va_start(args, fmt);
+
+  for (p = fmt; (*p != '\0') && (ok != 0U); p++) {
+    if (*p != '%') {
+      continue;
+    }
+    p++;
+    if (*p == '%') {
+      continue;
+    }
+
+    /* Flags */
+    while ((*p == '-') || (*p == '+') || (*p == ' ') || (*p == '#') || (*p == '0')) {
+      p++;
+    }
+
+    /* Width and precision */
+    while (((*p >= '0') && (*p <= '9')) || (*p == '.') || (*p == '*')) {
+      if (*p == '*') {
+        ok = log_put_u32(&frm, (uint32_t)va_arg(args, int));
+      }
+      p++;
+    }
+
+    /* Length modifier: 'q' for ll */
+    lng = '\0';
+    while ((*p == 'h') || (*p == 'l') || (*p == 'L') || (*p == 'z') || (*p == 'j') || (*p == 't')) {
+      if ((*p == 'l') && (lng == 'l')) {
+        lng = 'q';
+      } else if (*p != 'h') {
+        lng = (uint32_t)*p;
+      } else {
+        /* Argument promoted to int */
+      }
+      p++;
+    }
+
+    /* Conversion, integers are encoded with their size on this target */
+    switch (*p) {
+      case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': case 'c':
+        switch (lng) {
+          case 'l':
+            ok = log_put_int(&frm, (uint64_t)va_arg(args, unsigned long), sizeof(long));
+            break;
+          case 'q':
+          case 'L':
+            ok = log_put_int(&frm, (uint64_t)va_arg(args, unsigned long long), 8U);
+            break;
+          case 'j':
+            ok = log_put_int(&frm, (uint64_t)va_arg(args, uintmax_t), 8U);
+            break;
+          case 'z':
+            ok = log_put_int(&frm, (uint64_t)va_arg(args, size_t), sizeof(size_t));
+            break;
+          case 't':
+            ok = log_put_int(&frm, (uint64_t)va_arg(args, ptrdiff_t), sizeof(ptrdiff_t));
+            break;
+          default:
+            ok = log_put_u32(&frm, (uint32_t)va_arg(args, int));
+            break;
+        }
+        break;
+      case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+        f.d = (lng == 'L') ? (double)va_arg(args, long double) : va_arg(args, double);
+        ok  = log_put_u64(&frm, f.u);
+        break;
+      case 's':
+        ok = log_put_str(&frm, va_arg(args, const char *));
+        break;
+      case 'p':
+        ok = log_put_int(&frm, (uint64_t)(uintptr_t)va_arg(args, void *), sizeof(void *));
+        break;
+      case 'n':
+        /* Not supported (LOG_PRINTF refuses it at compile time with GCC) */
+        va_end(args);
+        return (-1);
+      case '\0':
+        /* Incomplete conversion at the end of the format string */
+        p--;
+        break;
+      default:
+        /* Unsupported conversion, no argument */
+        break;
+    }
+  }
+
+  va_end(args);
+
+  frm.buf[0] = LOG_FRAME_START;
+  frm.buf[1] = (uint8_t)frm.len;
+  frm.buf[2] = (uint8_t)((uint16_t)ofs);
+  frm.buf[3] = (uint8_t)((uint16_t)ofs >> 8);
+
+  return (stdout_write_record(frm.buf, LOG_HDR_SIZE + frm.len));
+}
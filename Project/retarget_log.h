@@ -0,0 +1,100 @@
+/*---------------------------------------------------------------------------
+ * Copyright (c) 2023 Arm Limited (or its affiliates). All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *      Name:    retarget_log.h
+ *      Purpose: Deferred (host formatted) logging over stdout
+ *
+ *---------------------------------------------------------------------------*/
+
+#ifndef RETARGET_LOG_H__
+#define RETARGET_LOG_H__
+
+#include <stdint.h>
+
+/*
+  Log frame layout (all values little endian):
+
+    offset  size  content
+    0       1     LOG_FRAME_START
+    1       1     Number of argument bytes (n)
+    2       2     Offset of the format string from log_fmt_base (signed)
+    4       n     Arguments in order of the format string conversions:
+                    - integer, character, '*': 4 bytes, with length modifier
+                      l, z, t the size of long, size_t, ptrdiff_t on the
+                      target (8 bytes on 64-bit targets), 8 bytes for ll, j
+                    - pointer: size of a pointer on the target
+                    - floating point: 8 bytes (IEEE 754 double)
+                    - string: 1 byte length followed by the characters
+
+  LOG_FRAME_START never occurs in text output, so frames can be mixed with
+  ordinary stdout text. Frames are decoded with Project/Host/log_decode.py.
+
+  The offset is relative to log_fmt_base, which is placed into the same
+  section: all format strings must be within 32 KB of it, so the section
+  must not exceed 32 KB. Relative offsets also do not depend on where the
+  image is loaded.
+*/
+#define LOG_FRAME_START         0xFFU
+
+/* Section holding the format strings, read by the host decoder */
+#define LOG_FMT_SECTION         ".log_fmt"
+
+/* Place the format string into LOG_FMT_SECTION and keep it in the image */
+#if defined(__ICCARM__)
+#define LOG_FMT_ATTR            _Pragma("location=\".log_fmt\"") __root
+#else
+#define LOG_FMT_ATTR            __attribute__((section(LOG_FMT_SECTION), used))
+#endif
+
+/* Refuse the %n conversion at compile time (GCC folds __builtin_strstr into a
+   constant), other compilers only check it in log_printf. A literal '%' in
+   front of an 'n' ("%%n") is refused as well. */
+#if defined(__GNUC__) && !defined(__clang__)
+#define LOG_FMT_CHECK(fmt)                                        \
+  _Static_assert((__builtin_strstr(fmt, "%n")   == 0) &&          \
+                 (__builtin_strstr(fmt, "%hn")  == 0) &&          \
+                 (__builtin_strstr(fmt, "%hhn") == 0) &&          \
+                 (__builtin_strstr(fmt, "%ln")  == 0) &&          \
+                 (__builtin_strstr(fmt, "%lln") == 0) &&          \
+                 (__builtin_strstr(fmt, "%jn")  == 0) &&          \
+                 (__builtin_strstr(fmt, "%zn")  == 0) &&          \
+                 (__builtin_strstr(fmt, "%tn")  == 0),            \
+                 "LOG_PRINTF does not support the %n conversion")
+#else
+#define LOG_FMT_CHECK(fmt)
+#endif
+
+/**
+  Output a log message formatted on the host
+
+  \param[in]   fmt  printf format string (string literal), without %n
+  \param[in]   ...  Arguments
+*/
+#define LOG_PRINTF(fmt, ...)                                      \
+  do {                                                            \
+    LOG_FMT_CHECK(fmt);                                           \
+    LOG_FMT_ATTR static const char log_fmt_[] = fmt;              \
+    log_printf(log_fmt_, ##__VA_ARGS__);                          \
+  } while (0)
+
+/* Reference of the format string offsets, in LOG_FMT_SECTION */
+extern const char log_fmt_base[];
+
+/* Encode and output a log frame, use LOG_PRINTF instead */
+extern int32_t log_printf (const char *fmt, ...);
+
+#endif /* RETARGET_LOG_H__ */
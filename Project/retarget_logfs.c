@@ -0,0 +1,1802 @@
+/*-----------------------------------------------------------------------------
+ * Name:    retarget_logfs.c
+ * Purpose: File Interface Retarget to a log-structured file system on NOR flash
+ * Rev.:    1.0.0
+ *-----------------------------------------------------------------------------*/
+
+/*
+ * Copyright (C) 2023 ARM Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "RTE_Components.h"
+#if defined(RT_FS_VFS)
+/* Backend of the mount table: functions are named logfs_rt_fs_... */
+#define RT_FS_VFS_BACKEND       logfs
+#include "retarget_vfs.h"
+#endif
+#include "retarget_fs.h"
+#include "retarget_fs_ext.h"
+#include "retarget_logfs.h"
+#include "Driver_Flash.h"
+
+#if defined(RTE_CMSIS_RTOS2)
+#include "cmsis_os2.h"
+#endif
+
+/* Flash driver number (Driver_Flash#) */
+#ifndef RT_LOGFS_FLASH_DRV
+#define RT_LOGFS_FLASH_DRV      0
+#endif
+
+/* Maximum number of flash sectors used */
+#ifndef RT_LOGFS_SECTOR_MAX
+#define RT_LOGFS_SECTOR_MAX     256
+#endif
+
+/* Number of files */
+#ifndef RT_LOGFS_FILE_NUM
+#define RT_LOGFS_FILE_NUM       16
+#endif
+
+/* Number of open file handles */
+#ifndef RT_LOGFS_OPEN_NUM
+#define RT_LOGFS_OPEN_NUM       4
+#endif
+
+/* Maximum length of a file name, including the terminating null */
+#ifndef RT_LOGFS_NAME_MAX
+#define RT_LOGFS_NAME_MAX       32
+#endif
+
+/* Write buffer of a handle in bytes, the largest data record (multiple of 4) */
+#ifndef RT_LOGFS_BUF_SIZE
+#define RT_LOGFS_BUF_SIZE       256
+#endif
+
+/* Number of data records in the RAM index (12 bytes each), every flush
+   writes a record: size it for the file data divided by the flush size */
+#ifndef RT_LOGFS_INDEX_NUM
+#define RT_LOGFS_INDEX_NUM      512
+#endif
+
+/* Number of open directories */
+#ifndef RT_LOGFS_DIR_NUM
+#define RT_LOGFS_DIR_NUM        2
+#endif
+
+/* Number of erased sectors kept by background garbage collection */
+#ifndef RT_LOGFS_GC_FREE
+#define RT_LOGFS_GC_FREE        4
+#endif
+
+/* Garbage collection thread stack size in bytes */
+#ifndef RT_LOGFS_GC_STACK_SIZE
+#define RT_LOGFS_GC_STACK_SIZE  512
+#endif
+
+/* Garbage collection thread priority */
+#ifndef RT_LOGFS_GC_PRIORITY
+#define RT_LOGFS_GC_PRIORITY    osPriorityLow
+#endif
+
+#if (RT_LOGFS_FILE_NUM < 1) || (RT_LOGFS_FILE_NUM > 255)
+#error "RT_LOGFS_FILE_NUM must be in range 1 to 255."
+#endif
+#if ((RT_LOGFS_BUF_SIZE % 4) != 0) || (RT_LOGFS_BUF_SIZE < RT_LOGFS_NAME_MAX) || (RT_LOGFS_BUF_SIZE > 65532)
+#error "RT_LOGFS_BUF_SIZE must be a multiple of 4 in range RT_LOGFS_NAME_MAX to 65532."
+#endif
+#if (RT_LOGFS_INDEX_NUM < 1) || (RT_LOGFS_INDEX_NUM > 65535)
+#error "RT_LOGFS_INDEX_NUM must be in range 1 to 65535."
+#endif
+#if (RT_LOGFS_GC_FREE < 2)
+#error "RT_LOGFS_GC_FREE must be at least 2."
+#endif
+
+/*
+  Log-structured file system on NOR flash
+
+  The flash sectors form a log. Each change is appended as a record to the
+  newest sector (the head): file data, a file name (create and rename), a
+  truncation or a removal. Nothing is updated in place, so appending to a
+  file programs its data and a 12 byte record header only, and every sector
+  is erased at the same rate.
+
+  Writes go to a buffer of RT_LOGFS_BUF_SIZE bytes in the handle, a data
+  record is appended when it is full, on rt_fs_flush, rt_fs_sync and on
+  rt_fs_close; a record once appended is found again after power loss.
+  Data is written at the end of file only: writes after a seek to another
+  position return RT_ERR_NOTSUP. Only one handle of a file may be open for
+  writing.
+
+  A RAM index lists the data records of each file in file order, it is
+  rebuilt from the log when the file system is mounted on first use.
+  Records superseded by a later one are dead; garbage collection copies
+  the live records of the oldest sector to the head and erases it. The
+  log is collected in order, so truncation and removal records never
+  need to be copied: all records they supersede are in older sectors.
+
+  Garbage collection keeps RT_LOGFS_GC_FREE sectors erased, in a thread
+  of low priority with CMSIS-RTOS2 or through rt_logfs_gc. A write that
+  finds only the sector reserved for garbage collection erased reclaims
+  sectors itself. New head sectors are the erased sectors with the lowest
+  erase count.
+
+  Names are flat like in retarget_ramfs.c: a drive prefix ("R:") and
+  leading slashes are removed, other characters are part of the name.
+
+  The flash layout is a sector header (magic, erase count, sequence
+  number and its complement) followed by records, each a header (type,
+  file, length, file offset, check value) and data padded to 4 bytes.
+  The sequence number is programmed when the sector becomes the head, so
+  that an erased sector keeps its erase count. The erase count is
+  programmed before the magic; a sector without a valid magic (an erase or
+  header program interrupted by reset) is assumed to have the highest
+  erase count. A record with an invalid check value ends the log of a
+  sector (a write interrupted by reset).
+*/
+
+#define _Flash_Driver_(n)  Driver_Flash##n
+#define  Flash_Driver_(n) _Flash_Driver_(n)
+
+extern ARM_DRIVER_FLASH  Flash_Driver_(RT_LOGFS_FLASH_DRV);
+#define ptrFlash       (&Flash_Driver_(RT_LOGFS_FLASH_DRV))
+
+/* Sector header */
+typedef struct {
+  uint32_t magic;               /* LOGFS_MAGIC                              */
+  uint32_t erase;               /* Erase count                              */
+  uint32_t seq;                 /* Sequence number in the log               */
+  uint32_t seq_inv;             /* Complement of seq                        */
+} logfs_sector_t;
+
+/* Record header */
+typedef struct {
+  uint8_t  type;                /* Record type                              */
+  uint8_t  file;                /* File index                               */
+  uint16_t len;                 /* Number of data bytes                     */
+  uint32_t ofs;                 /* File offset of the data                  */
+  uint32_t check;               /* Check value of header and data           */
+} logfs_rec_t;
+
+/* Index entry: a data record */
+typedef struct {
+  uint32_t addr;                /* Flash address of the record              */
+  uint32_t ofs;                 /* File offset of the data                  */
+  uint16_t len;                 /* Number of data bytes                     */
+  uint16_t next;                /* Next entry of the file                   */
+} logfs_index_t;
+
+/* File */
+typedef struct {
+  char     name[RT_LOGFS_NAME_MAX];  /* File name, empty until named */
+  uint32_t name_addr;           /* Flash address of the name record         */
+  uint32_t size;                /* Size of the data on flash                */
+  uint16_t first;               /* First index entry                        */
+  uint16_t last;                /* Last index entry                         */
+  uint8_t  used;                /* File exists                              */
+  uint8_t  open;                /* Number of open handles                   */
+  uint8_t  wr;                  /* Handle open for writing + 1, 0: none     */
+} logfs_file_t;
+
+/* Open file handle */
+typedef struct {
+  uint8_t  used;                /* Handle in use                            */
+  uint8_t  file;                /* File index                               */
+  uint8_t  rd;                  /* Opened for reading                       */
+  uint8_t  append;              /* Opened in append mode                    */
+  uint32_t pos;                 /* File position                            */
+  uint16_t idx;                 /* Index entry of the last read             */
+  uint16_t cnt;                 /* Number of bytes in the write buffer      */
+  uint32_t buf[(sizeof(logfs_rec_t) + RT_LOGFS_BUF_SIZE) / 4];  /* Record */
+} logfs_handle_t;
+
+#define LOGFS_MAGIC             0x53464C52U     /* "RLFS" */
+#define LOGFS_SEQ_FREE          0xFFFFFFFFU
+
+#define LOGFS_SEC_HDR           sizeof(logfs_sector_t)
+#define LOGFS_REC_HDR           sizeof(logfs_rec_t)
+#define LOGFS_REC_SIZE(len)     (LOGFS_REC_HDR + (((uint32_t)(len) + 3U) & ~3U))
+#define LOGFS_NONE              0xFFFFU
+
+/* Record types (an erased byte ends the log of a sector) */
+#define REC_NAME                0x01U
+#define REC_DATA                0x02U
+#define REC_TRUNC               0x03U
+#define REC_REMOVE              0x04U
+#define REC_END                 0xFFU
+
+/* Sector states */
+#define SEC_BLANK               0U      /* Contents unknown, erase before use */
+#define SEC_FREE                1U      /* Erased, with erase count           */
+#define SEC_USED                2U      /* Part of the log                    */
+
+/* Erased sectors for garbage collection: writes do not take the last one */
+#define LOGFS_GC_RESERVE        1U
+
+/* File descriptor: index into the handle table plus LOGFS_FD_BASE, so that
+   descriptors never collide with the standard stream handles 0 to 2 */
+#define LOGFS_FD_BASE           3
+#define logfs_fd_make(idx)      ((int32_t)(idx) + LOGFS_FD_BASE)
+#define logfs_fd_index(fd)      ((fd) - LOGFS_FD_BASE)
+
+static logfs_file_t   logfs_file[RT_LOGFS_FILE_NUM];
+static logfs_handle_t logfs_handle[RT_LOGFS_OPEN_NUM];
+static logfs_index_t  logfs_index[RT_LOGFS_INDEX_NUM];
+static uint16_t       logfs_index_free;
+static uint32_t       logfs_dir[RT_LOGFS_DIR_NUM];  /* Next file index + 1, 0: not used */
+
+static uint8_t  sec_state[RT_LOGFS_SECTOR_MAX];
+static uint32_t sec_seq  [RT_LOGFS_SECTOR_MAX];
+static uint32_t sec_erase[RT_LOGFS_SECTOR_MAX];
+static uint32_t sec_live [RT_LOGFS_SECTOR_MAX];     /* Bytes in live records */
+
+static uint32_t sec_size;               /* Sector size in bytes                 */
+static uint32_t sec_num;                /* Number of sectors                    */
+static uint32_t sec_free;               /* Number of blank and erased sectors   */
+static uint32_t data_width;             /* Flash data width (0: 8, 1: 16, 2: 32 bits) */
+static uint32_t log_head;               /* Head sector, sec_num: none           */
+static uint32_t log_wp;                 /* Write offset in the head sector      */
+static uint32_t log_seq;                /* Sequence number of the next head     */
+static int32_t  logfs_mounted;          /* 1: mounted, 0: not yet               */
+
+static rt_logfs_stats_t logfs_stats;
+
+/* Record read by garbage collection and mount */
+static uint32_t logfs_buf[(sizeof(logfs_rec_t) + RT_LOGFS_BUF_SIZE) / 4];
+
+#define LOGFS_USABLE            (sec_size - LOGFS_SEC_HDR)
+#define LOGFS_SECTOR(addr)      ((addr) / sec_size)
+
+#if defined(RTE_CMSIS_RTOS2)
+static osMutexId_t  logfs_mutex;
+static osThreadId_t logfs_gc_id;
+
+static uint64_t logfs_gc_stack[(RT_LOGFS_GC_STACK_SIZE + 7U) / 8U];
+
+static const osThreadAttr_t logfs_gc_attr = {
+  .name       = "rt_logfs_gc",
+  .stack_mem  = logfs_gc_stack,
+  .stack_size = sizeof(logfs_gc_stack),
+  .priority   = RT_LOGFS_GC_PRIORITY
+};
+
+/* Thread flag: sectors to reclaim */
+#define LOGFS_FLAG_GC           (1UL << 0)
+
+static void logfs_gc_thread (void *arg);
+#endif
+
+/* Lock the file system */
+static void logfs_lock (void) {
+#if defined(RTE_CMSIS_RTOS2)
+  if (osKernelGetState() == osKernelRunning) {
+    if (logfs_mutex == NULL) {
+      /* Create mutex and garbage collection thread on first use */
+      osKernelLock();
+      if (logfs_mutex == NULL) {
+        logfs_gc_id = osThreadNew(logfs_gc_thread, NULL, &logfs_gc_attr);
+        logfs_mutex = osMutexNew(NULL);
+      }
+      osKernelUnlock();
+    }
+    if (logfs_mutex != NULL) {
+      osMutexAcquire(logfs_mutex, osWaitForever);
+    }
+  }
+#endif
+}
+
+/* Unlock the file system */
+static void logfs_unlock (void) {
+#if defined(RTE_CMSIS_RTOS2)
+  if (logfs_mutex != NULL) {
+    osMutexRelease(logfs_mutex);
+  }
+#endif
+}
+
+/* Wait for the end of a flash operation, return 0 or RT_ERR_IO */
+static int32_t flash_wait (void) {
+  ARM_FLASH_STATUS status;
+
+  for (;;) {
+    status = ptrFlash->GetStatus();
+    if (status.busy == 0U) {
+      break;
+    }
+#if defined(RTE_CMSIS_RTOS2)
+    if (osKernelGetState() == osKernelRunning) {
+      osThreadYield();
+    }
+#endif
+  }
+  return ((status.error != 0U) ? RT_ERR_IO : 0);
+}
+
+/* Read from flash with addresses and sizes aligned to the data width */
+static int32_t flash_read_aligned (uint32_t addr, void *buf, uint32_t len) {
+  int32_t n;
+
+  n = ptrFlash->ReadData(addr, buf, len >> data_width);
+  if ((n == ARM_DRIVER_OK) && (len != 0U)) {
+    /* Driver with events: completed when no longer busy */
+    return (flash_wait());
+  }
+  return ((n == (int32_t)(len >> data_width)) ? 0 : RT_ERR_IO);
+}
+
+/* Read from flash at any address */
+static int32_t flash_read (uint32_t addr, void *buf, uint32_t len) {
+  uint32_t tmp[8];
+  uint32_t a, o, n;
+  uint8_t *p = buf;
+  int32_t rval;
+
+  if (data_width == 0U) {
+    return (flash_read_aligned(addr, buf, len));
+  }
+
+  /* Wider data: read aligned words */
+  for (; len != 0U; len -= n, addr += n, p += n) {
+    a = addr & ~3U;
+    o = addr - a;
+    n = sizeof(tmp) - o;
+    if (n > len) {
+      n = len;
+    }
+    rval = flash_read_aligned(a, tmp, (o + n + 3U) & ~3U);
+    if (rval < 0) {
+      return (rval);
+    }
+    memcpy(p, (uint8_t *)tmp + o, n);
+  }
+  return (0);
+}
+
+/* Program flash, address and size aligned to 4 bytes */
+static int32_t flash_program (uint32_t addr, const void *buf, uint32_t len) {
+  int32_t n;
+
+  logfs_stats.prog_bytes += len;
+
+  n = ptrFlash->ProgramData(addr, buf, len >> data_width);
+  if ((n == ARM_DRIVER_OK) && (len != 0U)) {
+    return (flash_wait());
+  }
+  return ((n == (int32_t)(len >> data_width)) ? 0 : RT_ERR_IO);
+}
+
+/* Erase a sector and write its header with the erase count */
+static int32_t sector_erase (uint32_t sec) {
+  logfs_sector_t hdr;
+  int32_t rval;
+
+  if (ptrFlash->EraseSector(sec * sec_size) != ARM_DRIVER_OK) {
+    return (RT_ERR_IO);
+  }
+  rval = flash_wait();
+  if (rval < 0) {
+    return (rval);
+  }
+  logfs_stats.erases++;
+
+  /* Erase count before magic: a valid magic has a complete erase count */
+  sec_erase[sec]++;
+  hdr.magic = LOGFS_MAGIC;
+  hdr.erase = sec_erase[sec];
+  rval = flash_program((sec * sec_size) + 4U, &hdr.erase, 4U);
+  if (rval == 0) {
+    rval = flash_program(sec * sec_size, &hdr.magic, 4U);
+  }
+  if (rval < 0) {
+    return (rval);
+  }
+
+  if (sec_state[sec] == SEC_USED) {
+    sec_free++;
+  }
+  sec_state[sec] = SEC_FREE;
+  sec_live[sec]  = 0U;
+
+  return (0);
+}
+
+/* Check value of a record (FNV-1a of the header fields and the data) */
+static uint32_t rec_check (const logfs_rec_t *rec) {
+  const uint8_t *p = (const uint8_t *)rec;
+  uint32_t h = 2166136261U;
+  uint32_t i;
+
+  for (i = 0U; i < 8U; i++) {
+    h ^= p[i];
+    h *= 16777619U;
+  }
+  for (p += LOGFS_REC_HDR, i = 0U; i < rec->len; i++) {
+    h ^= p[i];
+    h *= 16777619U;
+  }
+  return (h);
+}
+
+/* Check that a record header fits the file system, return its size or 0 */
+static uint32_t rec_valid (const logfs_rec_t *rec, uint32_t ofs) {
+  uint32_t max;
+
+  if (rec->file >= RT_LOGFS_FILE_NUM) {
+    return (0U);
+  }
+  if      (rec->type == REC_NAME)   { max = RT_LOGFS_NAME_MAX - 1U; }
+  else if (rec->type == REC_DATA)   { max = RT_LOGFS_BUF_SIZE;      }
+  else if (rec->type == REC_TRUNC)  { max = 0U;                     }
+  else if (rec->type == REC_REMOVE) { max = 0U;                     }
+  else                              { return (0U);                  }
+
+  if ((rec->len > max) || ((rec->type == REC_NAME) && (rec->len == 0U)) ||
+      (LOGFS_REC_SIZE(rec->len) > (sec_size - ofs))) {
+    return (0U);
+  }
+  return (LOGFS_REC_SIZE(rec->len));
+}
+
+/* Oldest sector of the log other than the head, sec_num when none */
+static uint32_t sector_oldest (void) {
+  uint32_t i, sec;
+
+  sec = sec_num;
+  for (i = 0U; i < sec_num; i++) {
+    if ((sec_state[i] == SEC_USED) && (i != log_head) &&
+        ((sec == sec_num) || (sec_seq[i] < sec_seq[sec]))) {
+      sec = i;
+    }
+  }
+  return (sec);
+}
+
+/* Bytes that garbage collection can reclaim */
+static uint32_t sector_dead (void) {
+  uint32_t i, n;
+
+  for (i = 0U, n = 0U; i < sec_num; i++) {
+    if ((sec_state[i] == SEC_USED) && (i != log_head)) {
+      n += LOGFS_USABLE - sec_live[i];
+    }
+  }
+  return (n);
+}
+
+/* Make an erased sector the head of the log */
+static int32_t sector_take (void) {
+  logfs_sector_t hdr;
+  uint32_t i, sec;
+  int32_t rval;
+
+  /* Wear leveling: erased sector with the lowest erase count */
+  sec = sec_num;
+  for (i = 0U; i < sec_num; i++) {
+    if ((sec_state[i] != SEC_USED) &&
+        ((sec == sec_num) || (sec_erase[i] < sec_erase[sec]))) {
+      sec = i;
+    }
+  }
+  if (sec == sec_num) {
+    return (RT_ERR_NOSPACE);
+  }
+
+  if (sec_state[sec] == SEC_BLANK) {
+    rval = sector_erase(sec);
+    if (rval < 0) {
+      return (rval);
+    }
+  }
+
+  hdr.seq     = log_seq;
+  hdr.seq_inv = ~log_seq;
+  rval = flash_program((sec * sec_size) + 8U, &hdr.seq, 8U);
+  if (rval < 0) {
+    /* Sector is erased before its next use */
+    sec_state[sec] = SEC_BLANK;
+    return (rval);
+  }
+
+  sec_state[sec] = SEC_USED;
+  sec_seq[sec]   = log_seq++;
+  sec_live[sec]  = 0U;
+  sec_free--;
+  log_head = sec;
+  log_wp   = LOGFS_SEC_HDR;
+
+#if defined(RTE_CMSIS_RTOS2)
+  if ((sec_free < RT_LOGFS_GC_FREE) && (logfs_gc_id != NULL)) {
+    osThreadFlagsSet(logfs_gc_id, LOGFS_FLAG_GC);
+  }
+#endif
+  return (0);
+}
+
+static int32_t gc_step (void);
+
+/* Open a new head sector, reclaiming sectors first when needed */
+static int32_t log_next (uint32_t gc) {
+  uint32_t n;
+  int32_t rval;
+
+  if (gc == 0U) {
+    for (n = 0U; sec_free <= LOGFS_GC_RESERVE; n++) {
+      if ((n > sec_num) || (sector_dead() < LOGFS_USABLE)) {
+        return (RT_ERR_NOSPACE);
+      }
+      rval = gc_step();
+      if (rval < 0) {
+        return (rval);
+      }
+    }
+  }
+  return (sector_take());
+}
+
+/* Append a record to the log, return its flash address in addr */
+static int32_t log_write (const logfs_rec_t *rec, uint32_t gc, uint32_t *addr) {
+  uint32_t size;
+  int32_t rval;
+
+  size = LOGFS_REC_SIZE(rec->len);
+  if ((log_head == sec_num) || (size > (sec_size - log_wp))) {
+    rval = log_next(gc);
+    if (rval < 0) {
+      return (rval);
+    }
+  }
+
+  *addr = (log_head * sec_size) + log_wp;
+  rval  = flash_program(*addr, rec, size);
+  if (rval < 0) {
+    /* The rest of the sector is not used */
+    log_wp = sec_size;
+    return (rval);
+  }
+  log_wp += size;
+
+  if ((rec->type == REC_NAME) || (rec->type == REC_DATA)) {
+    sec_live[log_head] += size;
+  }
+  return (0);
+}
+
+/* Fill in a record header and append the record */
+static int32_t log_append (logfs_rec_t *rec, uint32_t type, uint32_t file, uint32_t ofs, uint32_t len, uint32_t *addr) {
+  uint8_t *p = (uint8_t *)rec + LOGFS_REC_HDR;
+
+  rec->type = (uint8_t)type;
+  rec->file = (uint8_t)file;
+  rec->len  = (uint16_t)len;
+  rec->ofs  = ofs;
+  /* Padding is not programmed */
+  for (; (len & 3U) != 0U; len++) {
+    p[len] = 0xFFU;
+  }
+  rec->check = rec_check(rec);
+
+  return (log_write(rec, 0U, addr));
+}
+
+/* Mark a record dead */
+static void rec_dead (uint32_t addr, uint32_t len) {
+  sec_live[LOGFS_SECTOR(addr)] -= LOGFS_REC_SIZE(len);
+}
+
+/* Release all index entries of a file */
+static void file_drop (logfs_file_t *f) {
+  uint32_t i;
+  uint16_t n;
+
+  for (n = f->first; n != LOGFS_NONE; n = logfs_index[n].next) {
+    rec_dead(logfs_index[n].addr, logfs_index[n].len);
+    if (logfs_index[n].next == LOGFS_NONE) {
+      logfs_index[n].next = logfs_index_free;
+      logfs_index_free    = f->first;
+      break;
+    }
+  }
+  f->first = LOGFS_NONE;
+  f->last  = LOGFS_NONE;
+  f->size  = 0U;
+
+  /* Read positions of handles are no longer valid */
+  for (i = 0U; i < RT_LOGFS_OPEN_NUM; i++) {
+    if (logfs_handle[i].file == (uint8_t)(f - logfs_file)) {
+      logfs_handle[i].idx = LOGFS_NONE;
+    }
+  }
+}
+
+/* Enter a data record into the index of a file (in file order), return 0 or RT_ERR_NOSPACE */
+static int32_t file_insert (logfs_file_t *f, uint32_t addr, uint32_t ofs, uint32_t len) {
+  logfs_index_t *e;
+  uint16_t n, p, i;
+
+  /* A record copied by garbage collection before a reset replaces the original */
+  for (n = f->first; n != LOGFS_NONE; n = logfs_index[n].next) {
+    e = &logfs_index[n];
+    if ((e->ofs == ofs) && (e->len == len)) {
+      rec_dead(e->addr, e->len);
+      e->addr = addr;
+      return (0);
+    }
+  }
+
+  i = logfs_index_free;
+  if (i == LOGFS_NONE) {
+    return (RT_ERR_NOSPACE);
+  }
+  logfs_index_free = logfs_index[i].next;
+
+  e = &logfs_index[i];
+  e->addr = addr;
+  e->ofs  = ofs;
+  e->len  = (uint16_t)len;
+
+  if ((f->last == LOGFS_NONE) || (logfs_index[f->last].ofs < ofs)) {
+    /* Append */
+    e->next = LOGFS_NONE;
+    if (f->last == LOGFS_NONE) {
+      f->first = i;
+    } else {
+      logfs_index[f->last].next = i;
+    }
+    f->last = i;
+  } else {
+    /* Records copied by garbage collection are out of order in the log */
+    for (p = LOGFS_NONE, n = f->first; (n != LOGFS_NONE) && (logfs_index[n].ofs < ofs); p = n, n = logfs_index[n].next);
+    e->next = n;
+    if (p == LOGFS_NONE) {
+      f->first = i;
+    } else {
+      logfs_index[p].next = i;
+    }
+  }
+
+  if (f->size < (ofs + len)) {
+    f->size = ofs + len;
+  }
+  return (0);
+}
+
+/* Reclaim the oldest sector of the log */
+static int32_t gc_step (void) {
+  logfs_rec_t *rec = (logfs_rec_t *)logfs_buf;
+  logfs_file_t *f;
+  uint32_t sec, ofs, addr, size, live;
+  uint16_t n;
+  int32_t rval;
+
+  sec = sector_oldest();
+  if (sec == sec_num) {
+    return (RT_ERR_NOSPACE);
+  }
+
+  /* Copy live records to the head */
+  for (ofs = LOGFS_SEC_HDR; (sec_live[sec] != 0U) && (ofs <= (sec_size - LOGFS_REC_HDR)); ofs += size) {
+    addr = (sec * sec_size) + ofs;
+    rval = flash_read(addr, rec, LOGFS_REC_HDR);
+    if (rval < 0) {
+      return (rval);
+    }
+    size = rec_valid(rec, ofs);
+    if (size == 0U) {
+      break;
+    }
+
+    f    = &logfs_file[rec->file];
+    live = 0U;
+    n    = LOGFS_NONE;
+    if (rec->type == REC_NAME) {
+      live = ((f->used != 0U) && (f->name_addr == addr)) ? 1U : 0U;
+    } else
+    if ((rec->type == REC_DATA) && (f->used != 0U)) {
+      for (n = f->first; (n != LOGFS_NONE) && (logfs_index[n].addr != addr); n = logfs_index[n].next);
+      live = (n != LOGFS_NONE) ? 1U : 0U;
+    }
+    if (live == 0U) {
+      continue;
+    }
+
+    rval = flash_read(addr + LOGFS_REC_HDR, (uint8_t *)rec + LOGFS_REC_HDR, size - LOGFS_REC_HDR);
+    if (rval < 0) {
+      return (rval);
+    }
+    rval = log_write(rec, 1U, &addr);
+    if (rval < 0) {
+      return (rval);
+    }
+    sec_live[sec] -= size;
+    logfs_stats.gc_bytes += size;
+
+    if (rec->type == REC_NAME) {
+      f->name_addr = addr;
+    } else {
+      logfs_index[n].addr = addr;
+    }
+  }
+
+  rval = sector_erase(sec);
+  if (rval < 0) {
+    return (rval);
+  }
+  logfs_stats.gc_sectors++;
+
+  return (0);
+}
+
+/* Reclaim a sector when fewer than RT_LOGFS_GC_FREE are erased, return 1 when reclaimed */
+static int32_t gc_background (void) {
+  int32_t rval;
+
+  if ((logfs_mounted <= 0) || (sec_free >= RT_LOGFS_GC_FREE) || (sector_dead() < LOGFS_USABLE)) {
+    return (0);
+  }
+  rval = gc_step();
+  return ((rval < 0) ? rval : 1);
+}
+
+#if defined(RTE_CMSIS_RTOS2)
+/* Garbage collection thread */
+static void logfs_gc_thread (void *arg) {
+  int32_t rval;
+
+  (void)arg;
+
+  for (;;) {
+    osThreadFlagsWait(LOGFS_FLAG_GC, osFlagsWaitAny, osWaitForever);
+    do {
+      /* One sector at a time, writes continue in between */
+      logfs_lock();
+      rval = gc_background();
+      logfs_unlock();
+    } while (rval > 0);
+  }
+}
+#endif
+
+/* Replay the records of a sector into the file table and index */
+static void mount_sector (uint32_t sec) {
+  logfs_rec_t *rec = (logfs_rec_t *)logfs_buf;
+  logfs_file_t *f;
+  uint32_t ofs, addr, size;
+
+  for (ofs = LOGFS_SEC_HDR; ofs <= (sec_size - LOGFS_REC_HDR); ofs += size) {
+    addr = (sec * sec_size) + ofs;
+    if (flash_read(addr, rec, LOGFS_REC_HDR) < 0) {
+      break;
+    }
+    size = rec_valid(rec, ofs);
+    if ((size == 0U) ||
+        (flash_read(addr + LOGFS_REC_HDR, (uint8_t *)rec + LOGFS_REC_HDR, size - LOGFS_REC_HDR) < 0) ||
+        (rec_check(rec) != rec->check)) {
+      /* End of the log of this sector */
+      break;
+    }
+
+    f = &logfs_file[rec->file];
+    if ((f->used == 0U) && ((rec->type == REC_NAME) || (rec->type == REC_DATA))) {
+      /* Data may precede the name record copied by garbage collection */
+      memset(f, 0, sizeof(logfs_file_t));
+      f->first = LOGFS_NONE;
+      f->last  = LOGFS_NONE;
+      f->used  = 1U;
+    }
+
+    if (rec->type == REC_NAME) {
+      if (f->name[0] != '\0') {
+        /* Renamed */
+        rec_dead(f->name_addr, (uint32_t)strlen(f->name));
+      }
+      memcpy(f->name, (uint8_t *)rec + LOGFS_REC_HDR, rec->len);
+      f->name[rec->len] = '\0';
+      f->name_addr = addr;
+      sec_live[sec] += size;
+    } else
+    if (rec->type == REC_DATA) {
+      if (file_insert(f, addr, rec->ofs, rec->len) == 0) {
+        sec_live[sec] += size;
+      }
+    } else
+    if (f->used != 0U) {
+      file_drop(f);
+      if (rec->type == REC_REMOVE) {
+        if (f->name[0] != '\0') {
+          rec_dead(f->name_addr, (uint32_t)strlen(f->name));
+        }
+        f->name[0] = '\0';
+        f->used    = 0U;
+      }
+    }
+  }
+
+  if (sec == log_head) {
+    log_wp = ofs;
+  }
+}
+
+/* Mount the file system on first use, return 0 or RT_ERR_IO */
+static int32_t logfs_mount (void) {
+  ARM_FLASH_INFO *info;
+  logfs_sector_t hdr;
+  uint32_t i, n, sec, seq, ofs;
+  uint8_t *p;
+
+  if (logfs_mounted > 0) {
+    return (0);
+  }
+
+  if ((ptrFlash->Initialize(NULL) != ARM_DRIVER_OK) ||
+      (ptrFlash->PowerControl(ARM_POWER_FULL) != ARM_DRIVER_OK)) {
+    return (RT_ERR_IO);
+  }
+  info = ptrFlash->GetInfo();
+  data_width = ptrFlash->GetCapabilities().data_width;
+
+  /* Uniform sectors, programmed in units of up to 4 bytes */
+  if ((info == NULL) || (info->sector_info != NULL) || (info->erased_value != 0xFFU) ||
+      (info->program_unit > 4U) || (data_width > 2U) ||
+      (info->sector_size < (LOGFS_SEC_HDR + LOGFS_REC_SIZE(RT_LOGFS_BUF_SIZE))) ||
+      (info->sector_count < (LOGFS_GC_RESERVE + 2U))) {
+    return (RT_ERR_IO);
+  }
+  sec_size = info->sector_size;
+  sec_num  = info->sector_count;
+  if (sec_num > RT_LOGFS_SECTOR_MAX) {
+    sec_num = RT_LOGFS_SECTOR_MAX;
+  }
+
+  memset(logfs_file,   0, sizeof(logfs_file));
+  memset(logfs_handle, 0, sizeof(logfs_handle));
+  for (i = 0U; i < RT_LOGFS_FILE_NUM; i++) {
+    logfs_file[i].first = LOGFS_NONE;
+    logfs_file[i].last  = LOGFS_NONE;
+  }
+  for (i = 0U; i < RT_LOGFS_INDEX_NUM; i++) {
+    logfs_index[i].next = (uint16_t)(i + 1U);
+  }
+  logfs_index[RT_LOGFS_INDEX_NUM - 1U].next = LOGFS_NONE;
+  logfs_index_free = 0U;
+
+  /* Sector headers, n: highest erase count */
+  n        = 0U;
+  sec_free = 0U;
+  log_seq  = 0U;
+  log_head = sec_num;
+  for (sec = 0U; sec < sec_num; sec++) {
+    if (flash_read(sec * sec_size, &hdr, sizeof(hdr)) < 0) {
+      return (RT_ERR_IO);
+    }
+    sec_live[sec]  = 0U;
+    sec_erase[sec] = (hdr.magic == LOGFS_MAGIC) ? hdr.erase : 0U;
+    if ((hdr.magic == LOGFS_MAGIC) && (hdr.seq == LOGFS_SEQ_FREE) && (hdr.seq_inv == LOGFS_SEQ_FREE)) {
+      sec_state[sec] = SEC_FREE;
+      sec_free++;
+    } else
+    if ((hdr.magic == LOGFS_MAGIC) && (hdr.seq == ~hdr.seq_inv)) {
+      sec_state[sec] = SEC_USED;
+      sec_seq[sec]   = hdr.seq;
+      if ((log_head == sec_num) || (hdr.seq > sec_seq[log_head])) {
+        log_head = sec;
+      }
+    } else {
+      sec_state[sec] = SEC_BLANK;
+      sec_free++;
+    }
+    if ((hdr.magic == LOGFS_MAGIC) && (hdr.erase > n)) {
+      n = hdr.erase;
+    }
+  }
+
+  /* Sectors without header: erase count is assumed to be the highest one */
+  for (sec = 0U; sec < sec_num; sec++) {
+    if (sec_erase[sec] == 0U) {
+      sec_erase[sec] = n;
+    }
+  }
+
+  /* Replay the log from the oldest sector */
+  for (seq = 0U; ; seq = sec_seq[sec] + 1U) {
+    sec = sec_num;
+    for (i = 0U; i < sec_num; i++) {
+      if ((sec_state[i] == SEC_USED) && (sec_seq[i] >= seq) &&
+          ((sec == sec_num) || (sec_seq[i] < sec_seq[sec]))) {
+        sec = i;
+      }
+    }
+    if (sec == sec_num) {
+      break;
+    }
+    mount_sector(sec);
+    log_seq = sec_seq[sec] + 1U;
+  }
+
+  /* Files without a name are incomplete */
+  for (i = 0U; i < RT_LOGFS_FILE_NUM; i++) {
+    if ((logfs_file[i].used != 0U) && (logfs_file[i].name[0] == '\0')) {
+      file_drop(&logfs_file[i]);
+      logfs_file[i].used = 0U;
+    }
+  }
+
+  /* Appends continue in the head sector when the rest of it is erased */
+  if (log_head != sec_num) {
+    p = (uint8_t *)logfs_buf;
+    for (ofs = log_wp; ofs < sec_size; ofs += n) {
+      n = sec_size - ofs;
+      if (n > sizeof(logfs_buf)) {
+        n = sizeof(logfs_buf);
+      }
+      if (flash_read((log_head * sec_size) + ofs, p, n) < 0) {
+        return (RT_ERR_IO);
+      }
+      for (i = 0U; (i < n) && (p[i] == 0xFFU); i++);
+      if (i != n) {
+        /* A new head sector is taken on the first write */
+        log_head = sec_num;
+        break;
+      }
+    }
+  }
+
+  memset(&logfs_stats, 0, sizeof(logfs_stats));
+  logfs_mounted = 1;
+
+  return (0);
+}
+
+/* Remove drive prefix and leading slashes, an empty result is the root directory */
+static const char *name_skip (const char *path) {
+  const char *p;
+
+  p = strchr(path, ':');
+  if ((p != NULL) && ((p - path) <= 2)) {
+    path = p + 1;
+  }
+  while (*path == '/') {
+    path++;
+  }
+  return (path);
+}
+
+/* Get the file name of a path, return NULL for an invalid name */
+static const char *name_get (const char *path) {
+  size_t len;
+
+  if (path == NULL) {
+    return (NULL);
+  }
+  path = name_skip(path);
+
+  len = strlen(path);
+  if ((len == 0U) || (len >= RT_LOGFS_NAME_MAX)) {
+    return (NULL);
+  }
+  return (path);
+}
+
+/* Find a file by name, return NULL when not found */
+static logfs_file_t *file_find (const char *name) {
+  uint32_t i;
+
+  for (i = 0U; i < RT_LOGFS_FILE_NUM; i++) {
+    if ((logfs_file[i].used != 0U) && (strcmp(logfs_file[i].name, name) == 0)) {
+      return (&logfs_file[i]);
+    }
+  }
+  return (NULL);
+}
+
+/* Append a name record for a file */
+static int32_t file_name (logfs_file_t *f, const char *name) {
+  uint32_t rec[(sizeof(logfs_rec_t) + RT_LOGFS_NAME_MAX + 3U) / 4U];
+  uint32_t len, addr;
+  int32_t rval;
+
+  len = (uint32_t)strlen(name);
+  memcpy((uint8_t *)rec + LOGFS_REC_HDR, name, len);
+  rval = log_append((logfs_rec_t *)rec, REC_NAME, (uint32_t)(f - logfs_file), 0U, len, &addr);
+  if (rval == 0) {
+    if (f->name[0] != '\0') {
+      rec_dead(f->name_addr, (uint32_t)strlen(f->name));
+    }
+    strcpy(f->name, name);
+    f->name_addr = addr;
+  }
+  return (rval);
+}
+
+/* Append a truncation or removal record for a file */
+static int32_t file_mark (logfs_file_t *f, uint32_t type) {
+  logfs_rec_t rec;
+  uint32_t addr;
+
+  return (log_append(&rec, type, (uint32_t)(f - logfs_file), 0U, 0U, &addr));
+}
+
+/* Get handle of an open file */
+static logfs_handle_t *handle_get (int32_t fd) {
+
+  if ((fd < LOGFS_FD_BASE) || (logfs_fd_index(fd) >= RT_LOGFS_OPEN_NUM) ||
+      (logfs_handle[logfs_fd_index(fd)].used == 0U)) {
+    return (NULL);
+  }
+  return (&logfs_handle[logfs_fd_index(fd)]);
+}
+
+/* Get the size of a file, including data in the write buffer */
+static uint32_t file_size (const logfs_file_t *f) {
+  uint32_t size = f->size;
+
+  if (f->wr != 0U) {
+    size += logfs_handle[f->wr - 1U].cnt;
+  }
+  return (size);
+}
+
+/* Append the data in the write buffer to the log */
+static int32_t handle_flush (logfs_handle_t *h) {
+  logfs_file_t *f = &logfs_file[h->file];
+  uint32_t addr;
+  int32_t rval;
+
+  if (h->cnt == 0U) {
+    return (0);
+  }
+  if (logfs_index_free == LOGFS_NONE) {
+    return (RT_ERR_NOSPACE);
+  }
+
+  rval = log_append((logfs_rec_t *)h->buf, REC_DATA, h->file, f->size, h->cnt, &addr);
+  if (rval < 0) {
+    return (rval);
+  }
+  /* An index entry is free */
+  (void)file_insert(f, addr, f->size, h->cnt);
+
+  logfs_stats.data_bytes += h->cnt;
+  h->cnt = 0U;
+
+  return (0);
+}
+
+/* Write to a file at the handle position */
+static int32_t handle_write (logfs_handle_t *h, const void *buf, uint32_t cnt) {
+  logfs_file_t *f = &logfs_file[h->file];
+  const uint8_t *p = buf;
+  uint32_t n, num;
+  int32_t rval;
+
+  if (f->wr != (uint8_t)((h - logfs_handle) + 1)) {
+    return (RT_ERR_INVAL);
+  }
+  if (h->append != 0U) {
+    h->pos = file_size(f);
+  }
+  if (h->pos != file_size(f)) {
+    /* Data is appended only */
+    return (RT_ERR_NOTSUP);
+  }
+  if (cnt > (UINT32_MAX - h->pos)) {
+    cnt = UINT32_MAX - h->pos;
+  }
+  if (cnt > INT32_MAX) {
+    cnt = INT32_MAX;
+  }
+
+  rval = 0;
+  for (num = 0U; num < cnt; num += n) {
+    if (h->cnt == RT_LOGFS_BUF_SIZE) {
+      rval = handle_flush(h);
+      if (rval < 0) {
+        break;
+      }
+    }
+    n = RT_LOGFS_BUF_SIZE - h->cnt;
+    if (n > (cnt - num)) {
+      n = cnt - num;
+    }
+    memcpy((uint8_t *)h->buf + LOGFS_REC_HDR + h->cnt, &p[num], n);
+    h->cnt += (uint16_t)n;
+    h->pos += n;
+  }
+
+  if ((num == 0U) && (rval < 0)) {
+    return (rval);
+  }
+  return ((int32_t)num);
+}
+
+/* Find the index entry holding a file offset (below the size on flash) */
+static uint16_t index_find (const logfs_file_t *f, uint32_t ofs, uint16_t hint) {
+  const logfs_index_t *e;
+  uint16_t n;
+
+  /* Sequential reads stay in the same or move to the next entry */
+  if (hint != LOGFS_NONE) {
+    e = &logfs_index[hint];
+    if (ofs >= e->ofs) {
+      if (ofs < (e->ofs + e->len)) {
+        return (hint);
+      }
+      if ((e->next != LOGFS_NONE) && (ofs < (logfs_index[e->next].ofs + logfs_index[e->next].len))) {
+        return (e->next);
+      }
+    }
+  }
+
+  for (n = f->first; (n != LOGFS_NONE) && (ofs >= (logfs_index[n].ofs + logfs_index[n].len)); n = logfs_index[n].next);
+  return (n);
+}
+
+/* Read from a file at the handle position */
+static int32_t handle_read (logfs_handle_t *h, void *buf, uint32_t cnt) {
+  const logfs_file_t *f = &logfs_file[h->file];
+  const logfs_index_t *e;
+  uint8_t *p = buf;
+  uint32_t n, num, size;
+  int32_t rval;
+
+  if (h->rd == 0U) {
+    return (RT_ERR_INVAL);
+  }
+  size = file_size(f);
+  if (h->pos >= size) {
+    return (0);
+  }
+  if (cnt > (size - h->pos)) {
+    cnt = size - h->pos;
+  }
+  if (cnt > INT32_MAX) {
+    cnt = INT32_MAX;
+  }
+
+  rval = 0;
+  for (num = 0U; num < cnt; num += n) {
+    if (h->pos >= f->size) {
+      /* Data in the write buffer */
+      n = cnt - num;
+      memcpy(&p[num], (uint8_t *)logfs_handle[f->wr - 1U].buf + LOGFS_REC_HDR + (h->pos - f->size), n);
+    } else {
+      h->idx = index_find(f, h->pos, h->idx);
+      if (h->idx == LOGFS_NONE) {
+        rval = RT_ERR_IO;
+        break;
+      }
+      e = &logfs_index[h->idx];
+      n = (e->ofs + e->len) - h->pos;
+      if (n > (cnt - num)) {
+        n = cnt - num;
+      }
+      rval = flash_read(e->addr + LOGFS_REC_HDR + (h->pos - e->ofs), &p[num], n);
+      if (rval < 0) {
+        break;
+      }
+    }
+    h->pos += n;
+  }
+
+  if ((num == 0U) && (rval < 0)) {
+    return (rval);
+  }
+  return ((int32_t)num);
+}
+
+/* Open a file */
+int32_t rt_fs_open (const char *path, int32_t mode) {
+  const char *name;
+  logfs_file_t *f;
+  logfs_handle_t *h;
+  int32_t fd, rval;
+  uint32_t i, acc, wr;
+
+  name = name_get(path);
+  if (name == NULL) {
+    return (RT_ERR_INVAL);
+  }
+  acc = (uint32_t)mode & (RT_OPEN_RDONLY | RT_OPEN_WRONLY | RT_OPEN_RDWR);
+  wr  = ((acc != RT_OPEN_RDONLY) || ((mode & RT_OPEN_APPEND) != 0)) ? 1U : 0U;
+
+  logfs_lock();
+
+  f    = NULL;
+  fd   = RT_ERR_MAXFILES;
+  rval = logfs_mount();
+  if (rval == 0) {
+    /* Free handle */
+    for (i = 0U; i < RT_LOGFS_OPEN_NUM; i++) {
+      if (logfs_handle[i].used == 0U) {
+        fd = logfs_fd_make(i);
+        break;
+      }
+    }
+    if (fd < 0) {
+      rval = fd;
+    }
+  }
+
+  if (rval == 0) {
+    f = file_find(name);
+    if (f != NULL) {
+      if ((mode & (RT_OPEN_CREATE | RT_OPEN_EXCL)) == (RT_OPEN_CREATE | RT_OPEN_EXCL)) {
+        rval = RT_ERR_EXIST;
+      } else
+      if ((wr != 0U) && (f->wr != 0U)) {
+        /* One handle writes */
+        rval = RT_ERR_BUSY;
+      } else
+      if ((wr != 0U) && ((mode & RT_OPEN_TRUNCATE) != 0) && (f->first != LOGFS_NONE)) {
+        rval = file_mark(f, REC_TRUNC);
+        if (rval == 0) {
+          file_drop(f);
+        }
+      }
+    } else
+    if ((mode & RT_OPEN_CREATE) == 0) {
+      rval = RT_ERR_NOTFOUND;
+    } else {
+      for (i = 0U; i < RT_LOGFS_FILE_NUM; i++) {
+        if (logfs_file[i].used == 0U) {
+          f = &logfs_file[i];
+          break;
+        }
+      }
+      if (f == NULL) {
+        rval = RT_ERR_MAXFILES;
+      } else {
+        memset(f, 0, sizeof(logfs_file_t));
+        f->first = LOGFS_NONE;
+        f->last  = LOGFS_NONE;
+        rval = file_name(f, name);
+        if (rval == 0) {
+          f->used = 1U;
+        }
+      }
+    }
+  }
+
+  if (rval == 0) {
+    h = &logfs_handle[logfs_fd_index(fd)];
+    h->used   = 1U;
+    h->file   = (uint8_t)(f - logfs_file);
+    h->rd     = (acc != RT_OPEN_WRONLY) ? 1U : 0U;
+    h->append = ((mode & RT_OPEN_APPEND) != 0) ? 1U : 0U;
+    h->idx    = LOGFS_NONE;
+    h->cnt    = 0U;
+    h->pos    = (h->append != 0U) ? f->size : 0U;
+    if (wr != 0U) {
+      f->wr = (uint8_t)((h - logfs_handle) + 1);
+    }
+    f->open++;
+  } else {
+    fd = rval;
+  }
+
+  logfs_unlock();
+
+  return (fd);
+}
+
+/* Close a file */
+int32_t rt_fs_close (int32_t fd) {
+  logfs_handle_t *h;
+  logfs_file_t *f;
+  int32_t rval;
+
+  logfs_lock();
+  h = handle_get(fd);
+  if (h != NULL) {
+    f = &logfs_file[h->file];
+    rval = 0;
+    if (f->wr == (uint8_t)((h - logfs_handle) + 1)) {
+      rval = handle_flush(h);
+      f->wr = 0U;
+    }
+    f->open--;
+    h->used = 0U;
+    h->file = 0xFFU;
+  } else {
+    rval = RT_ERR_INVAL;
+  }
+  logfs_unlock();
+
+  return (rval);
+}
+
+/* Write to a file */
+int32_t rt_fs_write (int32_t fd, const void *buf, uint32_t cnt) {
+  logfs_handle_t *h;
+  int32_t rval;
+
+  logfs_lock();
+  h = handle_get(fd);
+  rval = (h != NULL) ? handle_write(h, buf, cnt) : RT_ERR_INVAL;
+  logfs_unlock();
+
+  return (rval);
+}
+
+/* Read from a file */
+int32_t rt_fs_read (int32_t fd, void *buf, uint32_t cnt) {
+  logfs_handle_t *h;
+  int32_t rval;
+
+  logfs_lock();
+  h = handle_get(fd);
+  rval = (h != NULL) ? handle_read(h, buf, cnt) : RT_ERR_INVAL;
+  logfs_unlock();
+
+  return (rval);
+}
+
+/* Move the file position pointer */
+int64_t rt_fs_seek (int32_t fd, int64_t offset, int32_t whence) {
+  logfs_handle_t *h;
+  int64_t pos;
+
+  logfs_lock();
+  h = handle_get(fd);
+  if (h == NULL) {
+    pos = RT_ERR_INVAL;
+  } else {
+    if      (whence == RT_SEEK_SET) { pos = 0;                                         }
+    else if (whence == RT_SEEK_CUR) { pos = (int64_t)h->pos;                           }
+    else if (whence == RT_SEEK_END) { pos = (int64_t)file_size(&logfs_file[h->file]);  }
+    else                            { pos = -1;                                        }
+
+    if ((pos >= 0) && (offset >= -pos) && (offset <= ((int64_t)UINT32_MAX - pos))) {
+      pos   += offset;
+      h->pos = (uint32_t)pos;
+    } else {
+      pos = RT_ERR_INVAL;
+    }
+  }
+  logfs_unlock();
+
+  return (pos);
+}
+
+/* Get file size */
+int64_t rt_fs_size (int32_t fd) {
+  logfs_handle_t *h;
+  int64_t sz;
+
+  logfs_lock();
+  h = handle_get(fd);
+  sz = (h != NULL) ? (int64_t)file_size(&logfs_file[h->file]) : RT_ERR_INVAL;
+  logfs_unlock();
+
+  return (sz);
+}
+
+/* Get file status information */
+int32_t rt_fs_stat (int32_t fd, rt_fs_stat_t *stat) {
+  logfs_handle_t *h;
+  int32_t rval;
+
+  if (stat == NULL) {
+    return (RT_ERR_INVAL);
+  }
+
+  logfs_lock();
+  h = handle_get(fd);
+  if (h != NULL) {
+    /* No real-time clock: times are zero */
+    memset(stat, 0, sizeof(rt_fs_stat_t));
+    stat->attr     = RT_ATTR_FILE;
+    stat->blksize  = RT_LOGFS_BUF_SIZE;
+    stat->blkcount = (file_size(&logfs_file[h->file]) + (RT_LOGFS_BUF_SIZE - 1U)) / RT_LOGFS_BUF_SIZE;
+    rval = 0;
+  } else {
+    rval = RT_ERR_INVAL;
+  }
+  logfs_unlock();
+
+  return (rval);
+}
+
+/* Remove a file */
+int32_t rt_fs_remove (const char *path) {
+  const char *name;
+  logfs_file_t *f;
+  int32_t rval;
+
+  name = name_get(path);
+  if (name == NULL) {
+    return (RT_ERR_INVAL);
+  }
+
+  logfs_lock();
+  rval = logfs_mount();
+  if (rval == 0) {
+    f = file_find(name);
+    if (f == NULL) {
+      rval = RT_ERR_NOTFOUND;
+    } else
+    if (f->open != 0U) {
+      rval = RT_ERR_BUSY;
+    } else {
+      rval = file_mark(f, REC_REMOVE);
+      if (rval == 0) {
+        file_drop(f);
+        rec_dead(f->name_addr, (uint32_t)strlen(f->name));
+        f->name[0] = '\0';
+        f->used    = 0U;
+      }
+    }
+  }
+  logfs_unlock();
+
+  return (rval);
+}
+
+/* Rename a file */
+int32_t rt_fs_rename (const char *oldpath, const char *newpath) {
+  const char *name_old, *name_new;
+  logfs_file_t *f;
+  int32_t rval;
+
+  name_old = name_get(oldpath);
+  name_new = name_get(newpath);
+  if ((name_old == NULL) || (name_new == NULL)) {
+    return (RT_ERR_INVAL);
+  }
+
+  logfs_lock();
+  rval = logfs_mount();
+  if (rval == 0) {
+    f = file_find(name_old);
+    if (f == NULL) {
+      rval = RT_ERR_NOTFOUND;
+    } else
+    if (strcmp(name_old, name_new) == 0) {
+      rval = 0;
+    } else
+    if (file_find(name_new) != NULL) {
+      rval = RT_ERR_EXIST;
+    } else {
+      rval = file_name(f, name_new);
+    }
+  }
+  logfs_unlock();
+
+  return (rval);
+}
+
+/* Write cached data of a file to the file system */
+int32_t rt_fs_flush (int32_t fd) {
+  logfs_handle_t *h;
+  int32_t rval;
+
+  logfs_lock();
+  h = handle_get(fd);
+  if (h == NULL) {
+    rval = RT_ERR_INVAL;
+  } else
+  if (logfs_file[h->file].wr == (uint8_t)((h - logfs_handle) + 1)) {
+    rval = handle_flush(h);
+  } else {
+    rval = 0;
+  }
+  logfs_unlock();
+
+  return (rval);
+}
+
+/* Write cached data of a file and commit it to the storage medium */
+int32_t rt_fs_sync (int32_t fd) {
+
+  /* A flushed record is programmed to flash and found again on mount */
+  return (rt_fs_flush(fd));
+}
+
+/* Get cache statistics */
+int32_t rt_fs_cache_get_stats (rt_fs_cache_stats_t *stats) {
+  (void)stats;
+
+  /* No cache, see rt_logfs_get_stats */
+  return (RT_ERR_NOTSUP);
+}
+
+/* Map file data for reading */
+int32_t rt_fs_map (int32_t fd, int64_t offset, uint32_t len, const void **ptr) {
+  (void)fd;
+  (void)offset;
+  (void)len;
+  (void)ptr;
+
+  /* Flash is accessed through the driver */
+  return (RT_ERR_NOTSUP);
+}
+
+/* Release mapped file data */
+int32_t rt_fs_unmap (int32_t fd, const void *ptr) {
+  (void)fd;
+  (void)ptr;
+
+  return (RT_ERR_NOTSUP);
+}
+
+/* Write segments to a file */
+int32_t rt_fs_writev (int32_t fd, const rt_fs_iovec_t *iov, uint32_t iovcnt) {
+  logfs_handle_t *h;
+  uint32_t i, n;
+  int32_t rval;
+
+  if ((iov == NULL) && (iovcnt != 0U)) {
+    return (RT_ERR_INVAL);
+  }
+
+  logfs_lock();
+  h = handle_get(fd);
+  rval = (h != NULL) ? 0 : RT_ERR_INVAL;
+  for (i = 0U, n = 0U; (h != NULL) && (i < iovcnt); i++) {
+    if (iov[i].len > ((uint32_t)INT32_MAX - n)) {
+      break;
+    }
+    rval = handle_write(h, iov[i].base, iov[i].len);
+    if (rval < 0) {
+      break;
+    }
+    n += (uint32_t)rval;
+    if ((uint32_t)rval != iov[i].len) {
+      break;
+    }
+  }
+  logfs_unlock();
+
+  if ((h != NULL) && ((n != 0U) || (rval >= 0))) {
+    /* Return number of bytes written */
+    rval = (int32_t)n;
+  }
+  return (rval);
+}
+
+/* Read from a file into segments */
+int32_t rt_fs_readv (int32_t fd, const rt_fs_iovec_t *iov, uint32_t iovcnt) {
+  logfs_handle_t *h;
+  uint32_t i, n;
+  int32_t rval;
+
+  if ((iov == NULL) && (iovcnt != 0U)) {
+    return (RT_ERR_INVAL);
+  }
+
+  logfs_lock();
+  h = handle_get(fd);
+  rval = (h != NULL) ? 0 : RT_ERR_INVAL;
+  for (i = 0U, n = 0U; (h != NULL) && (i < iovcnt); i++) {
+    if (iov[i].len > ((uint32_t)INT32_MAX - n)) {
+      break;
+    }
+    rval = handle_read(h, iov[i].base, iov[i].len);
+    if (rval < 0) {
+      break;
+    }
+    n += (uint32_t)rval;
+    if ((uint32_t)rval != iov[i].len) {
+      break;
+    }
+  }
+  logfs_unlock();
+
+  if ((h != NULL) && ((n != 0U) || (rval >= 0))) {
+    /* Return number of bytes read */
+    rval = (int32_t)n;
+  }
+  return (rval);
+}
+
+/* Create a directory */
+int32_t rt_fs_mkdir (const char *path) {
+  (void)path;
+
+  /* Flat name space */
+  return (RT_ERR_NOTSUP);
+}
+
+/* Remove an empty directory */
+int32_t rt_fs_rmdir (const char *path) {
+  (void)path;
+
+  /* Flat name space */
+  return (RT_ERR_NOTSUP);
+}
+
+/* Open a directory */
+int32_t rt_fs_opendir (const char *path) {
+  const char *name;
+  int32_t dd;
+
+  if (path == NULL) {
+    return (RT_ERR_INVAL);
+  }
+
+  logfs_lock();
+  dd = logfs_mount();
+  if (dd == 0) {
+    name = name_get(path);
+    if (name != NULL) {
+      /* Only the root directory exists */
+      dd = (file_find(name) != NULL) ? RT_ERR_NOTDIR : RT_ERR_NOTFOUND;
+    } else
+    if (*name_skip(path) != '\0') {
+      dd = RT_ERR_INVAL;
+    } else {
+      for (dd = 0; dd < RT_LOGFS_DIR_NUM; dd++) {
+        if (logfs_dir[dd] == 0U) {
+          logfs_dir[dd] = 1U;
+          break;
+        }
+      }
+      if (dd == RT_LOGFS_DIR_NUM) {
+        dd = RT_ERR_MAXFILES;
+      }
+    }
+  }
+  logfs_unlock();
+
+  return (dd);
+}
+
+/* Read the next directory entry */
+int32_t rt_fs_readdir (int32_t dd, rt_fs_dirent_t *ent) {
+  const logfs_file_t *f;
+  int32_t rval;
+
+  if ((dd < 0) || (dd >= RT_LOGFS_DIR_NUM) || (ent == NULL)) {
+    return (RT_ERR_INVAL);
+  }
+
+  logfs_lock();
+  if (logfs_dir[dd] == 0U) {
+    rval = RT_ERR_INVAL;
+  } else {
+    rval = 0;
+    while ((logfs_dir[dd] - 1U) < RT_LOGFS_FILE_NUM) {
+      f = &logfs_file[logfs_dir[dd] - 1U];
+      logfs_dir[dd]++;
+      if (f->used != 0U) {
+        memset(ent, 0, sizeof(rt_fs_dirent_t));
+        strncpy(ent->name, f->name, RT_FS_NAME_MAX - 1U);
+        ent->attr = RT_ATTR_FILE;
+        ent->size = (int64_t)file_size(f);
+        rval = 1;
+        break;
+      }
+    }
+  }
+  logfs_unlock();
+
+  return (rval);
+}
+
+/* Close a directory */
+int32_t rt_fs_closedir (int32_t dd) {
+  int32_t rval;
+
+  if ((dd < 0) || (dd >= RT_LOGFS_DIR_NUM)) {
+    return (RT_ERR_INVAL);
+  }
+
+  logfs_lock();
+  rval = (logfs_dir[dd] != 0U) ? 0 : RT_ERR_INVAL;
+  logfs_dir[dd] = 0U;
+  logfs_unlock();
+
+  return (rval);
+}
+
+/* Get the directory entry of a path */
+int32_t rt_fs_lookup (const char *path, rt_fs_dirent_t *ent) {
+  const char *name;
+  const logfs_file_t *f;
+  int32_t rval;
+
+  if ((path == NULL) || (ent == NULL)) {
+    return (RT_ERR_INVAL);
+  }
+
+  memset(ent, 0, sizeof(rt_fs_dirent_t));
+
+  name = name_get(path);
+  if (name == NULL) {
+    if (*name_skip(path) != '\0') {
+      return (RT_ERR_INVAL);
+    }
+    /* Root directory */
+    ent->attr = RT_ATTR_DIR;
+    return (0);
+  }
+
+  logfs_lock();
+  rval = logfs_mount();
+  if (rval == 0) {
+    f = file_find(name);
+    if (f != NULL) {
+      strncpy(ent->name, name, RT_FS_NAME_MAX - 1U);
+      ent->attr = RT_ATTR_FILE;
+      ent->size = (int64_t)file_size(f);
+    } else {
+      rval = RT_ERR_NOTFOUND;
+    }
+  }
+  logfs_unlock();
+
+  return (rval);
+}
+
+/* Get flash and garbage collection statistics */
+int32_t rt_logfs_get_stats (rt_logfs_stats_t *stats) {
+  uint32_t i;
+  int32_t rval;
+
+  if (stats == NULL) {
+    return (RT_ERR_INVAL);
+  }
+
+  logfs_lock();
+  rval = logfs_mount();
+  if (rval == 0) {
+    *stats = logfs_stats;
+    stats->sector_num  = sec_num;
+    stats->sector_free = sec_free;
+    stats->erase_min   = UINT32_MAX;
+    stats->erase_max   = 0U;
+    for (i = 0U; i < sec_num; i++) {
+      if (sec_erase[i] < stats->erase_min) {
+        stats->erase_min = sec_erase[i];
+      }
+      if (sec_erase[i] > stats->erase_max) {
+        stats->erase_max = sec_erase[i];
+      }
+    }
+  }
+  logfs_unlock();
+
+  return (rval);
+}
+
+/* Reclaim one sector when fewer than RT_LOGFS_GC_FREE are erased */
+int32_t rt_logfs_gc (void) {
+  int32_t rval;
+
+  logfs_lock();
+  rval = logfs_mount();
+  if (rval == 0) {
+    rval = gc_background();
+  }
+  logfs_unlock();
+
+  return (rval);
+}
+
+int32_t rt_fs_invalidate (const char *path) {
+  (void)path;
+
+  /* Lookups are not cached */
+  return (0);
+}
+
+#if defined(RT_FS_VFS)
+/* Operations for rt_vfs_mount */
+RT_FS_VFS_OPS(logfs);
+#endif
@@ -0,0 +1,48 @@
+/*---------------------------------------------------------------------------
+ * Copyright (c) 2023 Arm Limited (or its affiliates). All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *      Name:    retarget_logfs.h
+ *      Purpose: Log-structured file system on NOR flash, extensions
+ *
+ *---------------------------------------------------------------------------*/
+
+#ifndef RETARGET_LOGFS_H__
+#define RETARGET_LOGFS_H__
+
+#include <stdint.h>
+
+/* Flash and garbage collection statistics */
+typedef struct {
+  uint32_t sector_num;          /* Number of flash sectors used             */
+  uint32_t sector_free;         /* Number of erased sectors                 */
+  uint32_t erase_min;           /* Lowest erase count of a sector           */
+  uint32_t erase_max;           /* Highest erase count of a sector          */
+  uint32_t erases;              /* Sectors erased since mount               */
+  uint32_t data_bytes;          /* File data written by applications        */
+  uint32_t prog_bytes;          /* Bytes programmed to flash                */
+  uint32_t gc_sectors;          /* Sectors reclaimed by garbage collection  */
+  uint32_t gc_bytes;            /* Bytes copied by garbage collection       */
+} rt_logfs_stats_t;
+
+/* Get flash and garbage collection statistics, counters are cumulative since mount */
+extern int32_t rt_logfs_get_stats (rt_logfs_stats_t *stats);
+
+/* Reclaim one sector when fewer than RT_LOGFS_GC_FREE are erased, return 1 when
+   reclaimed, 0 when there is nothing to do (for the idle loop without an RTOS) */
+extern int32_t rt_logfs_gc (void);
+
+#endif /* RETARGET_LOGFS_H__ */
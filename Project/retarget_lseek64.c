@@ -0,0 +1,78 @@
+/*---------------------------------------------------------------------------
+ * Copyright (c) 2023 Arm Limited (or its affiliates). All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *      Name:    retarget_lseek64.c
+ *      Purpose: Library 64-bit seek function retargeted to rt_fs_seek
+ *
+ *---------------------------------------------------------------------------*/
+
+#include <errno.h>
+
+#include "retarget_fs.h"
+#include "retarget_errno.h"
+
+/*
+  newlib seeks with _lseek, which takes and returns a 32-bit offset, so
+  fseek, fseeko and ftello reach positions up to 2 GB only. newlib built
+  with large file support (__LARGE64_FILES) provides fseeko64 and ftello64
+  for files opened with fopen64; they seek with _lseek64, implemented here
+  with rt_fs_seek:
+
+    fseeko64 -> _fseeko64_r -> __sseek64 -> _lseek64_r -> _lseek64 -> rt_fs_seek
+    ftello64 -> _ftello64_r -> __sseek64 -> _lseek64_r -> _lseek64 -> rt_fs_seek
+
+  Standard streams are passed to _lseek. Without large file support and
+  with Arm Compiler and IAR libraries, applications call rt_fs_seek and
+  rt_fs_size directly for files of 2 GB and more.
+*/
+
+#if defined(__GNUC__) && !defined(__ARMCC_VERSION) && defined(__LARGE64_FILES)
+
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/types.h>
+
+extern int      _lseek   (int fd, int offset, int whence);
+extern _off64_t _lseek64 (int fd, _off64_t offset, int whence);
+
+/* Set the file position with a 64-bit offset */
+_off64_t _lseek64 (int fd, _off64_t offset, int whence) {
+  int64_t rval;
+  int32_t w;
+
+  if (fd <= STDERR_FILENO) {
+    /* Standard streams are handled by _lseek */
+    return ((_off64_t)_lseek(fd, (int)offset, whence));
+  }
+
+  if      (whence == SEEK_SET) { w = RT_SEEK_SET; }
+  else if (whence == SEEK_CUR) { w = RT_SEEK_CUR; }
+  else if (whence == SEEK_END) { w = RT_SEEK_END; }
+  else {
+    errno = EINVAL;
+    return (-1);
+  }
+
+  rval = rt_fs_seek(fd, (int64_t)offset, w);
+  if (rval < 0) {
+    errno = rt_rval_to_errno((int32_t)rval);
+    return (-1);
+  }
+  return ((_off64_t)rval);
+}
+
+#endif
@@ -17,13 +17,386 @@
  */
 
 #include <stddef.h>
+#include <string.h>
 #include <rt_sys.h>
+#include "RTE_Components.h"
+#if defined(RT_FS_VFS)
+/* Backend of the mount table: functions are named mdk_rt_fs_... */
+#define RT_FS_VFS_BACKEND       mdk
+#include "retarget_vfs.h"
+#endif
 #include "retarget_fs.h"
+#include "retarget_fs_ext.h"
 #include "rl_fs_lib.h"
 #include "rl_fs.h"
 
-#define fd_rval(fd) (((fd >> 8) & 0x0000FF00) | (fd & 0x000000FF))
-#define fd_arg(fd)  (((fd & 0x0000FF00) << 8) | (fd & 0x000000FF))
+#if defined(RTE_CMSIS_RTOS2)
+#include "cmsis_os2.h"
+#endif
+
+/* Number of open files (maximum 256) */
+#ifndef RT_FS_FILE_NUM
+#define RT_FS_FILE_NUM          8
+#endif
+
+/* Maximum length of a path kept for rt_fs_stat */
+#ifndef RT_FS_PATH_MAX
+#define RT_FS_PATH_MAX          64
+#endif
+
+/* Preferred I/O size reported by rt_fs_stat, set to the cluster size of the drive */
+#ifndef RT_FS_STAT_BLKSIZE
+#define RT_FS_STAT_BLKSIZE      512
+#endif
+
+/* Write-back cache: number of cache blocks, 0 disables the cache */
+#ifndef RT_FS_CACHE_BLOCK_NUM
+#define RT_FS_CACHE_BLOCK_NUM   4
+#endif
+
+/* Write-back cache: size of a cache block in bytes */
+#ifndef RT_FS_CACHE_BLOCK_SIZE
+#define RT_FS_CACHE_BLOCK_SIZE  512
+#endif
+
+/* Read-ahead: amount of data read ahead of sequential reads in blocks, 0 disables read-ahead.
+   Reads of up to this size are served from the cache. Larger reads, such as
+   the buffer refills of the C library (BUFSIZ), only use the first blocks. */
+#ifndef RT_FS_READAHEAD_NUM
+#define RT_FS_READAHEAD_NUM     2
+#endif
+
+/* Read-ahead: stack size of the read-ahead thread in bytes. The thread reads
+   with __sys_read: MDK-FS needs at least 1 KB of stack in threads calling
+   file system functions (FAT with long file names, drivers included). */
+#ifndef RT_FS_READAHEAD_STACK_SIZE
+#define RT_FS_READAHEAD_STACK_SIZE  1024
+#endif
+
+/* Directory cache: number of cached path lookups, 0 disables the cache */
+#ifndef RT_FS_DCACHE_NUM
+#define RT_FS_DCACHE_NUM        16
+#endif
+
+/* Directory cache: 1 caches paths not found, opening them fails without searching the
+   directory; files created other than through rt_fs are then not found until
+   rt_fs_invalidate is called */
+#ifndef RT_FS_DCACHE_NEG
+#define RT_FS_DCACHE_NEG        0
+#endif
+
+/* Number of open directories */
+#ifndef RT_FS_DIR_NUM
+#define RT_FS_DIR_NUM           2
+#endif
+
+/* Locking: 1 locks each open file on its own, 0 serializes calls on all open files
+   with one lock (for comparison, a thread waiting for the drive blocks all files) */
+#ifndef RT_FS_FILE_LOCK
+#define RT_FS_FILE_LOCK         1
+#endif
+
+/* Group commit: number of rt_fs_sync calls waiting for a commit at the same time,
+   0 disables group commit */
+#ifndef RT_FS_SYNC_NUM
+#define RT_FS_SYNC_NUM          8
+#endif
+
+/* Group commit: time in kernel ticks the leader of a group waits for further rt_fs_sync calls */
+#ifndef RT_FS_SYNC_WINDOW
+#define RT_FS_SYNC_WINDOW       0
+#endif
+
+/* Group commit: thread flag used to wake threads waiting in rt_fs_sync */
+#ifndef RT_FS_SYNC_FLAG
+#define RT_FS_SYNC_FLAG         (1UL << 30)
+#endif
+
+#if (RT_FS_FILE_NUM < 1) || (RT_FS_FILE_NUM > 256)
+#error "RT_FS_FILE_NUM must be in the range 1 to 256."
+#endif
+
+#if (RT_FS_DCACHE_NUM > 255)
+#error "RT_FS_DCACHE_NUM must not exceed 255."
+#endif
+
+#if (RT_FS_CACHE_BLOCK_NUM > 0) && (RT_FS_CACHE_BLOCK_SIZE < 16)
+#error "Write-back cache configuration out of range."
+#endif
+
+#if (RT_FS_CACHE_BLOCK_NUM == 0)
+#undef  RT_FS_READAHEAD_NUM
+#define RT_FS_READAHEAD_NUM     0
+#endif
+
+#if !defined(RTE_CMSIS_RTOS2)
+#undef  RT_FS_SYNC_NUM
+#define RT_FS_SYNC_NUM          0
+#endif
+
+#if (RT_FS_CACHE_BLOCK_NUM > 0) && (RT_FS_READAHEAD_NUM >= RT_FS_CACHE_BLOCK_NUM)
+#error "Read-ahead needs less blocks than available in the cache."
+#endif
+
+#if (RT_FS_READAHEAD_NUM > 0) && (RT_FS_READAHEAD_STACK_SIZE < 1024)
+#error "RT_FS_READAHEAD_STACK_SIZE is below the 1 KB of stack needed by MDK-FS."
+#endif
+
+/* Maximum number of mapped cache blocks: one block is kept for writes and
+   one for the block being read ahead */
+#if (RT_FS_READAHEAD_NUM > 0)
+#define RT_FS_MAP_MAX           (RT_FS_CACHE_BLOCK_NUM - 2)
+#else
+#define RT_FS_MAP_MAX           (RT_FS_CACHE_BLOCK_NUM - 1)
+#endif
+
+/* File descriptor: generation in bits 8..22, index into the file table in
+   bits 0..7. The generation is never 0, so descriptors are at least 256. */
+#define FD_GEN_MAX              0x7FFFU
+#define fd_make(idx, gen)       ((int32_t)(((uint32_t)(gen) << 8) | (uint32_t)(idx)))
+#define fd_index(fd)            ((uint32_t)(fd) & 0xFFU)
+#define fd_gen(fd)              ((uint32_t)(fd) >> 8)
+
+/* Largest file size and file position of FAT */
+#define FS_FILE_SIZE_MAX        0xFFFFFFFFULL
+
+/* __sys_flen returns sizes from 2 GB as negative values; values from -1 to
+   -255 are taken as error codes unless the directory entry has that size */
+#define FS_FLEN_ERR_MIN         (-255)
+
+/*
+  Open files
+
+  Open files are kept in a table of RT_FS_FILE_NUM entries; opening more
+  files fails with RT_ERR_MAXFILES. The file descriptor holds the index of
+  the entry and its generation, which changes when the entry is released,
+  so each call finds its entry with one indexed access and a descriptor
+  used after close is rejected with RT_ERR_INVAL. The fields used on every
+  access are placed at the start of the entry.
+
+  The file position seen by the caller (pos) and the file size are kept in
+  the entry as 64-bit values. Position queries and seeks within the file
+  are answered without calling the file system; the position of the file
+  system (mpos) is set on the next access that needs it. FAT limits files
+  to 4 GB - 1: seeks beyond are rejected with RT_ERR_INVAL and writes are
+  shortened, or fail with RT_ERR_NOSPACE at the limit.
+
+  Write-back cache
+
+  Small writes are collected in cache blocks and written to the file system
+  when a block is needed for other data, before reading, before seeking
+  beyond the end of file and when the file is flushed or closed. Writes of
+  at least one block size go to the file system directly. Dirty blocks of
+  a file are always written in ascending order, so the file grows without
+  gaps. Data of a block already written is not written again, so flushing
+  after each small write adds only the new data. A file opened more than
+  once is not kept coherent between handles.
+
+  File attributes and time are read with ffind on the first rt_fs_stat and
+  kept until the file is written.
+
+  Reads are served from cache blocks when possible. For files opened for
+  reading only, sequential reads are detected and the next
+  RT_FS_READAHEAD_NUM blocks are read ahead into the cache. With RTOS2 the
+  read-ahead is done by a background thread so that reading from the file
+  system overlaps with processing of the data by the caller, otherwise it
+  is done at the end of rt_fs_read. The read-ahead thread holds the lock of
+  the file while it reads, other accesses to the file wait. It runs below
+  normal priority, so it reads while the caller waits (i.e. for the data to
+  be sent on); a caller reading back to back reads the blocks itself.
+
+  rt_fs_map returns a pointer into the cache block holding the data, the
+  block is read from the file system first when needed. A mapped block is
+  not replaced until it is unmapped; when the file is closed or the range
+  is overwritten by a large write, the block is detached from the file and
+  stays valid for the mapping. MDK-FS does not expose where file data is
+  located on the drive, so data is not mapped in place.
+
+  Directory cache
+
+  Results of path lookups are kept in RT_FS_DCACHE_NUM entries, found with
+  a hash of the path; the least recently used entry is replaced. Entries
+  are added by rt_fs_lookup and by rt_fs_readdir for the listed entries.
+  Paths are compared without case and with '\' equal to '/', as in FAT; a
+  path spelled differently otherwise (with and without drive) is a
+  different entry.
+
+  With RT_FS_DCACHE_NEG, paths not found are cached too, also by rt_fs_open
+  for a path not found when opening for reading; opening a path cached as
+  not found for reading then fails without searching the directory. This
+  is off by default: a file created other than through rt_fs (by another
+  user of MDK-FS, or on a card written elsewhere) would not be found. When
+  off, rt_fs_open does not use the directory cache and adds no calls to
+  the file system (no media check, no search after a failed open).
+
+  The entry of a file is dropped when the file is opened for writing and
+  when it is closed again, creating a file or directory drops all entries
+  of paths not found, removing or renaming clears the cache. Changes not
+  made through rt_fs are not seen: rt_fs_invalidate drops the entry of a
+  path, or all entries, and is called after such changes and after a
+  drive is mounted again. The cache is cleared when a drive reports no
+  media or a media error, and a cached entry is used only when the drive
+  reports its media present (fmedia), so entries of a removed card are
+  not used.
+
+  Locking
+
+  With RTOS2, each entry of the file table has a lock, held for the whole
+  call on a descriptor, so calls on one file are executed in order. The
+  file table, the assignment of cache blocks to files, the directory cache
+  and the open directories are protected by a second lock, which is
+  released while reading from or writing to the file system and while
+  searching a directory (ffind): a thread waiting for the drive does not
+  block calls on other files. A block being written or read meanwhile is
+  marked busy and not replaced, as is an open directory being read. A
+  lookup result is entered into the directory cache only when no entry was
+  dropped meanwhile (rt_fs_dc_epoch), so a result overtaken by a change is
+  not cached. The file lock
+  is always taken before the second lock; a dirty block of another file is
+  written to make room only when the lock of that file is free, otherwise
+  the data is written without the cache. With RT_FS_FILE_LOCK set to 0 all
+  entries share one lock, as a baseline for comparing throughput.
+
+  Group commit
+
+  rt_fs_sync writes the cached data of the file and commits the file with
+  __sys_ensure. With RTOS2 the request is queued in one of RT_FS_SYNC_NUM
+  entries and the lock of the file released; the first thread finding no
+  commit in progress becomes the leader of a group. It waits
+  RT_FS_SYNC_WINDOW ticks, takes all queued requests and commits each of
+  their files once, however many threads requested it, waking the threads
+  of a file when it is committed. Requests queued meanwhile form the next
+  group, the leader hands over to one of their threads. When all entries
+  are in use, rt_fs_sync commits the file on its own. Threads appending
+  to a log and syncing it therefore wait for at most two commits instead
+  of one commit per thread.
+
+  The leader does not take the lock of a file it commits, so other threads
+  keep writing to the file and queue the next group meanwhile (MDK-FS
+  serializes accesses to the drive); closing the file waits for the
+  commit. A file closed before it is committed is not committed again,
+  closing has done that. The thread flag RT_FS_SYNC_FLAG is reserved for
+  rt_fs_sync.
+*/
+
+/* Open file */
+typedef struct {
+  uint64_t pos;                 /* File position of the caller              */
+  uint64_t mpos;                /* File position of the file system         */
+  uint64_t size;                /* File size, including cached data         */
+  int32_t  handle;              /* File handle of MDK-FS                    */
+  uint16_t gen;                 /* Generation, part of the file descriptor  */
+  uint8_t  used;                /* Entry in use                             */
+  uint8_t  append;              /* Opened in append mode                    */
+  uint8_t  rdonly;              /* Opened for reading only                  */
+  uint8_t  ra_req;              /* Read-ahead requested                     */
+  uint8_t  meta;                /* Attributes and time are valid            */
+  uint64_t ra_pos;              /* Position following the last read         */
+  uint32_t attr;                /* File attributes (RT_ATTR_...)            */
+  rt_fs_time_t time;            /* Time of last modification                */
+#if defined(RTE_CMSIS_RTOS2)
+  osMutexId_t mutex;            /* Lock of the entry                        */
+#endif
+#if (RT_FS_SYNC_NUM > 0)
+  uint32_t commit;              /* Being committed by the leader of a group */
+  osThreadId_t close_wait;      /* Thread closing the file meanwhile        */
+#endif
+  char     path[RT_FS_PATH_MAX];  /* Path used to open the file, or empty */
+} rt_fs_file_t;
+
+static rt_fs_file_t        rt_fs_file[RT_FS_FILE_NUM];
+static rt_fs_cache_stats_t rt_fs_stats;
+
+#if (RT_FS_DCACHE_NUM > 0)
+/* Directory cache entry */
+typedef struct {
+  uint32_t hash;                /* Hash of the path                         */
+  uint32_t used;                /* Time of last use, 0 when not used        */
+  uint8_t  next;                /* Next entry with the same hash index + 1  */
+  uint8_t  neg;                 /* Path not found                           */
+  uint32_t attr;                /* Attributes (RT_ATTR_...)                 */
+  uint64_t size;                /* File size                                */
+  rt_fs_time_t time;            /* Time of last modification                */
+  char     path[RT_FS_PATH_MAX];
+} rt_fs_dentry_t;
+
+static rt_fs_dentry_t      rt_fs_dc[RT_FS_DCACHE_NUM];
+static uint8_t             rt_fs_dc_head[RT_FS_DCACHE_NUM];  /* First entry per hash index + 1 */
+static uint32_t            rt_fs_dc_time;
+static uint32_t            rt_fs_dc_epoch;  /* Incremented when entries are dropped */
+#endif
+
+/* Open directory */
+typedef struct {
+  uint32_t   used;              /* Entry in use                             */
+  uint32_t   busy;              /* Searched without the file system lock    */
+  uint32_t   len;               /* Length of the directory path with separator */
+  char       pattern[RT_FS_PATH_MAX + 2];  /* Directory path followed by "*" */
+  fsFileInfo info;              /* Search state                             */
+} rt_fs_dir_t;
+
+static rt_fs_dir_t         rt_fs_dir[RT_FS_DIR_NUM];
+
+#if (RT_FS_CACHE_BLOCK_NUM > 0)
+/* Cache block */
+typedef struct {
+  rt_fs_file_t *file;           /* Owner, NULL when the block is free or detached */
+  uint32_t blk;                 /* Block number within the file             */
+  uint32_t lo;                  /* Start of valid data within the block     */
+  uint32_t hi;                  /* End of valid data within the block       */
+  uint32_t dlo;                 /* Start of the data not yet written        */
+  uint32_t dirty;               /* Valid data not yet written               */
+  uint32_t used;                /* Time of last use, for LRU replacement    */
+  uint32_t ahead;               /* Read ahead, not yet used                 */
+  uint32_t busy;                /* Read or written with the lock released   */
+  uint32_t map;                 /* Number of mappings of the block          */
+  uint8_t  buf[RT_FS_CACHE_BLOCK_SIZE];
+} rt_fs_block_t;
+
+static rt_fs_block_t       rt_fs_block[RT_FS_CACHE_BLOCK_NUM];
+static uint32_t            rt_fs_time;
+#endif
+
+#if (RT_FS_SYNC_NUM > 0)
+/* Sync request */
+typedef struct {
+  osThreadId_t thread;          /* Calling thread                           */
+  int32_t  fd;                  /* File descriptor                          */
+  int32_t  rval;                /* Result of the commit                     */
+  uint32_t state;               /* State (SYNC_...)                         */
+} rt_fs_sync_t;
+
+/* Sync request states */
+#define SYNC_FREE               0U  /* Entry not used                       */
+#define SYNC_QUEUED             1U  /* Waiting for the next group           */
+#define SYNC_GROUP              2U  /* Taken by the leader of a group       */
+#define SYNC_DONE               3U  /* Committed, rval is valid             */
+
+static rt_fs_sync_t        rt_fs_sync_req[RT_FS_SYNC_NUM];
+static uint32_t            rt_fs_sync_leader;   /* A group is being committed */
+#endif
+
+#if defined(RTE_CMSIS_RTOS2)
+static osMutexId_t       rt_fs_mutex;
+#if (RT_FS_READAHEAD_NUM > 0)
+static osEventFlagsId_t  rt_fs_evf;
+static osThreadId_t      rt_fs_ra_thread_id;
+
+static uint64_t rt_fs_ra_stack[(RT_FS_READAHEAD_STACK_SIZE + 7U) / 8U];
+
+static const osThreadAttr_t rt_fs_ra_attr = {
+  .name       = "rt_fs_readahead",
+  .stack_mem  = rt_fs_ra_stack,
+  .stack_size = sizeof(rt_fs_ra_stack),
+  .priority   = osPriorityBelowNormal
+};
+
+/* Event flags */
+#define RT_FS_FLAG_REQ          (1UL << 0)  /* Read-ahead requested  */
+
+static void rt_fs_ra_thread (void *arg);
+#endif
+#endif
 
 /* Convert fsStatus value to retarget return code */
 static int32_t fs_to_rt_rval (fsStatus fs_rval) {
@@ -45,10 +418,1155 @@ static int32_t fs_to_rt_rval (fsStatus fs_rval) {
   else if (fs_rval == fsAlreadyExists)      { rt_rval = RT_ERR_EXIST;    }
   else                                      { rt_rval = RT_ERR;          }
 
-  return (rt_rval);
+  return (rt_rval);
+}
+
+/* Write to the file system, return number of bytes written or error */
+static int32_t media_write (int32_t handle, const void *buf, uint32_t cnt) {
+  int32_t rval;
+  int32_t n;
+
+  n = __sys_write(handle, buf, cnt);
+
+  if (n >= 0) {
+    /* Return number of bytes written */
+    rval = (int32_t)cnt - n;
+  } else {
+    /* Indicate write error */
+    rval = fs_to_rt_rval ((fsStatus)-n);
+  }
+
+  return (rval);
+}
+
+/* Read from the file system, return number of bytes read or error */
+static int32_t media_read (int32_t handle, void *buf, uint32_t cnt) {
+  int32_t rval;
+  int32_t n;
+
+  n = __sys_read(handle, buf, cnt);
+
+  n &= ~0x80000000;
+
+  if (n >= 0) {
+    /* Return number of bytes read */
+    rval = (int32_t)cnt - n;
+  } else {
+    /* Indicate read error */
+    rval = fs_to_rt_rval ((fsStatus)-n);
+  }
+
+  return (rval);
+}
+
+/* Set the file position of the file system */
+static int32_t media_seek (int32_t handle, uint64_t pos) {
+  int32_t rval;
+
+  if (pos > FS_FILE_SIZE_MAX) {
+    return (RT_ERR_INVAL);
+  }
+
+  rval = __sys_seek(handle, (uint32_t)pos);
+
+  if (rval != 0) {
+    rval = fs_to_rt_rval ((fsStatus)-rval);
+  }
+
+  return (rval);
+}
+
+/* Get the file size from the file system, return size or error */
+static int64_t media_size (int32_t handle, const char *path) {
+  fsFileInfo info;
+  int32_t n;
+
+  n = __sys_flen(handle);
+
+  if ((n < 0) && (n >= FS_FLEN_ERR_MIN)) {
+    /* Error code, or a size less than 256 bytes below 4 GB */
+    info.fileID = 0U;
+    if ((path[0] != '\0') && (ffind(path, &info) == fsOK) && (info.size == (uint32_t)n)) {
+      return ((int64_t)info.size);
+    }
+    /* Indicate error */
+    return (fs_to_rt_rval ((fsStatus)-n));
+  }
+
+  /* Return size, up to 4 GB - 1 */
+  return ((int64_t)(uint32_t)n);
+}
+
+/* Lock the open file table, the cache and the directory cache */
+static void fs_lock (void) {
+#if defined(RTE_CMSIS_RTOS2)
+  if (osKernelGetState() == osKernelRunning) {
+    if (rt_fs_mutex == NULL) {
+      /* Create mutex and read-ahead thread on first use */
+      osKernelLock();
+      if (rt_fs_mutex == NULL) {
+#if (RT_FS_READAHEAD_NUM > 0)
+        rt_fs_evf = osEventFlagsNew(NULL);
+        if (rt_fs_evf != NULL) {
+          rt_fs_ra_thread_id = osThreadNew(rt_fs_ra_thread, NULL, &rt_fs_ra_attr);
+        }
+#endif
+        rt_fs_mutex = osMutexNew(NULL);
+      }
+      osKernelUnlock();
+    }
+    if (rt_fs_mutex != NULL) {
+      osMutexAcquire(rt_fs_mutex, osWaitForever);
+    }
+  }
+#endif
+}
+
+/* Unlock the open file table, the cache and the directory cache */
+static void fs_unlock (void) {
+#if defined(RTE_CMSIS_RTOS2)
+  if (rt_fs_mutex != NULL) {
+    osMutexRelease(rt_fs_mutex);
+  }
+#endif
+}
+
+#if (RT_FS_FILE_LOCK == 0)
+/* All file table entries share the lock of the first entry */
+#define file_lock_entry(file)   ((void)(file), &rt_fs_file[0])
+#else
+#define file_lock_entry(file)   (file)
+#endif
+
+#if defined(RTE_CMSIS_RTOS2)
+/* Get the lock of a file table entry, created on first use */
+static osMutexId_t file_mutex (rt_fs_file_t *file) {
+
+  file = file_lock_entry(file);
+
+  if (file->mutex == NULL) {
+    osKernelLock();
+    if (file->mutex == NULL) {
+      file->mutex = osMutexNew(NULL);
+    }
+    osKernelUnlock();
+  }
+  return (file->mutex);
+}
+#endif
+
+/* Lock a file table entry, the file system lock must not be held */
+static void file_lock (rt_fs_file_t *file) {
+#if defined(RTE_CMSIS_RTOS2)
+  if (osKernelGetState() == osKernelRunning) {
+    if (file_mutex(file) != NULL) {
+      osMutexAcquire(file_mutex(file), osWaitForever);
+    }
+  }
+#else
+  (void)file;
+#endif
+}
+
+#if (RT_FS_CACHE_BLOCK_NUM > 0)
+/* Lock a file table entry when it is not locked, return 1 when locked */
+static uint32_t file_trylock (rt_fs_file_t *file) {
+#if defined(RTE_CMSIS_RTOS2)
+  if (osKernelGetState() == osKernelRunning) {
+    if ((file_mutex(file) != NULL) && (osMutexAcquire(file_mutex(file), 0U) != osOK)) {
+      return (0U);
+    }
+  }
+#else
+  (void)file;
+#endif
+  return (1U);
+}
+#endif
+
+/* Unlock a file table entry */
+static void file_unlock (rt_fs_file_t *file) {
+#if defined(RTE_CMSIS_RTOS2)
+  if (file_lock_entry(file)->mutex != NULL) {
+    osMutexRelease(file_lock_entry(file)->mutex);
+  }
+#else
+  (void)file;
+#endif
+}
+
+/* Get the open file of a file descriptor, NULL if not open or closed */
+static rt_fs_file_t *file_get (int32_t fd) {
+  rt_fs_file_t *file;
+
+  if ((fd < 0) || (fd_index(fd) >= RT_FS_FILE_NUM)) {
+    return (NULL);
+  }
+  file = &rt_fs_file[fd_index(fd)];
+  if ((file->used == 0U) || (file->gen != fd_gen(fd))) {
+    return (NULL);
+  }
+  return (file);
+}
+
+/* Lock the open file of a file descriptor and the file system, NULL if not open or closed */
+static rt_fs_file_t *file_acquire (int32_t fd) {
+  rt_fs_file_t *file;
+
+  fs_lock();
+  file = file_get(fd);
+  fs_unlock();
+  if (file == NULL) {
+    return (NULL);
+  }
+
+  file_lock(file);
+  fs_lock();
+  if (file_get(fd) != file) {
+    /* Closed while waiting for the lock */
+    fs_unlock();
+    file_unlock(file);
+    return (NULL);
+  }
+  return (file);
+}
+
+/* Unlock the file system and an open file */
+static void file_release (rt_fs_file_t *file) {
+  fs_unlock();
+  file_unlock(file);
+}
+
+/* Write to the file system at the file position, the file system lock is released meanwhile */
+static int32_t file_write (rt_fs_file_t *file, const void *buf, uint32_t cnt) {
+  uint32_t writes;
+  int32_t rval;
+
+  fs_unlock();
+  writes = 0U;
+  rval   = 0;
+  if (file->mpos != file->pos) {
+    rval = media_seek(file->handle, file->pos);
+  }
+  if (rval == 0) {
+    file->mpos = file->pos;
+    rval = media_write(file->handle, buf, cnt);
+    writes = 1U;
+  }
+  fs_lock();
+  rt_fs_stats.writes += writes;
+  if (rval > 0) {
+    file->pos += (uint32_t)rval;
+    file->mpos = file->pos;
+    if (file->size < file->pos) {
+      file->size = file->pos;
+    }
+  }
+  return (rval);
+}
+
+/* Read from the file system at the file position, the file system lock is released meanwhile */
+static int32_t file_read (rt_fs_file_t *file, void *buf, uint32_t cnt) {
+  int32_t rval;
+
+  fs_unlock();
+  rval = 0;
+  if (file->mpos != file->pos) {
+    rval = media_seek(file->handle, file->pos);
+  }
+  if (rval == 0) {
+    file->mpos = file->pos;
+    rval = media_read(file->handle, buf, cnt);
+  }
+  fs_lock();
+  if (rval > 0) {
+    file->pos += (uint32_t)rval;
+    file->mpos = file->pos;
+  }
+  return (rval);
+}
+
+/* Commit a file to the drive, the file system lock is released meanwhile */
+static int32_t file_commit (rt_fs_file_t *file) {
+  int32_t rval;
+
+  fs_unlock();
+  rval = __sys_ensure(file->handle);
+  fs_lock();
+  rt_fs_stats.commits++;
+
+  if (rval != 0) {
+    rval = fs_to_rt_rval ((fsStatus)-rval);
+  }
+  return (rval);
+}
+
+#if (RT_FS_CACHE_BLOCK_NUM > 0)
+/* Find cache block of a file */
+static rt_fs_block_t *block_find (const rt_fs_file_t *file, uint32_t blk) {
+  uint32_t i;
+
+  for (i = 0U; i < RT_FS_CACHE_BLOCK_NUM; i++) {
+    if ((rt_fs_block[i].file == file) && (rt_fs_block[i].blk == blk)) {
+      return (&rt_fs_block[i]);
+    }
+  }
+  return (NULL);
+}
+#endif
+
+/* Write dirty cache blocks of a file, in ascending order. The caller holds
+   the lock of the file, the file system lock is released while writing. */
+static int32_t cache_flush (rt_fs_file_t *file) {
+#if (RT_FS_CACHE_BLOCK_NUM > 0)
+  rt_fs_block_t *b;
+  uint64_t ofs;
+  uint32_t i;
+  int32_t rval;
+
+  for (;;) {
+    b = NULL;
+    for (i = 0U; i < RT_FS_CACHE_BLOCK_NUM; i++) {
+      if ((rt_fs_block[i].file == file) && (rt_fs_block[i].dirty != 0U)) {
+        if ((b == NULL) || (rt_fs_block[i].blk < b->blk)) {
+          b = &rt_fs_block[i];
+        }
+      }
+    }
+    if (b == NULL) {
+      break;
+    }
+
+    b->busy = 1U;
+    fs_unlock();
+
+    rval = 0;
+    ofs  = ((uint64_t)b->blk * RT_FS_CACHE_BLOCK_SIZE) + b->dlo;
+    if (file->mpos != ofs) {
+      rval = media_seek(file->handle, ofs);
+    }
+    if (rval == 0) {
+      file->mpos = ofs;
+      /* Data before dlo has been written already: in append mode the file
+         system would add it once more */
+      rval = media_write(file->handle, &b->buf[b->dlo], b->hi - b->dlo);
+    }
+
+    fs_lock();
+    b->busy = 0U;
+    if (rval < 0) {
+      return (rval);
+    }
+    rt_fs_stats.writes++;
+    file->mpos += (uint32_t)rval;
+    b->dlo     += (uint32_t)rval;
+    if (b->dlo != b->hi) {
+      return (RT_ERR_NOSPACE);
+    }
+    b->dirty = 0U;
+  }
+#else
+  (void)file;
+#endif
+
+  return (0);
+}
+
+/* Release cache blocks of a file within a byte range */
+static void cache_drop (const rt_fs_file_t *file, uint64_t from, uint64_t to) {
+#if (RT_FS_CACHE_BLOCK_NUM > 0)
+  uint64_t ofs;
+  uint32_t i;
+
+  for (i = 0U; i < RT_FS_CACHE_BLOCK_NUM; i++) {
+    if (rt_fs_block[i].file == file) {
+      ofs = (uint64_t)rt_fs_block[i].blk * RT_FS_CACHE_BLOCK_SIZE;
+      if ((ofs < to) && ((ofs + RT_FS_CACHE_BLOCK_SIZE) > from)) {
+        rt_fs_block[i].file = NULL;
+      }
+    }
+  }
+#else
+  (void)file;
+  (void)from;
+  (void)to;
+#endif
+}
+
+#if (RT_FS_CACHE_BLOCK_NUM > 0)
+/* Get a free or the least recently used cache block, NULL with *rval set
+   to 0 when all blocks are in use by other threads */
+static rt_fs_block_t *block_alloc (rt_fs_file_t *file, uint32_t blk, int32_t *rval) {
+  rt_fs_block_t *b;
+  rt_fs_file_t *owner;
+  uint32_t i;
+
+  for (;;) {
+    /* A block being read, written or mapped is not replaced */
+    b = NULL;
+    for (i = 0U; i < RT_FS_CACHE_BLOCK_NUM; i++) {
+      if ((rt_fs_block[i].busy != 0U) || (rt_fs_block[i].map != 0U)) {
+        continue;
+      }
+      if (rt_fs_block[i].file == NULL) {
+        b = &rt_fs_block[i];
+        break;
+      }
+      if ((b == NULL) || (rt_fs_block[i].used < b->used)) {
+        b = &rt_fs_block[i];
+      }
+    }
+
+    if ((b == NULL) || ((b->file != NULL) && (b->file != file) && (b->dirty != 0U) && (file_trylock(b->file) == 0U))) {
+      /* No block, or the owner is in use by another thread */
+      *rval = 0;
+      return (NULL);
+    }
+    if ((b->file == NULL) || (b->dirty == 0U)) {
+      break;
+    }
+
+    /* Write all dirty blocks of the owner to keep the write order, then
+       select again since the lock is released meanwhile */
+    owner = b->file;
+    rt_fs_stats.evictions++;
+    *rval = cache_flush(owner);
+    if (owner != file) {
+      file_unlock(owner);
+    }
+    if (*rval != 0) {
+      return (NULL);
+    }
+  }
+
+  b->file  = file;
+  b->blk   = blk;
+  b->lo    = 0U;
+  b->hi    = 0U;
+  b->dlo   = 0U;
+  b->dirty = 0U;
+  b->ahead = 0U;
+
+  return (b);
+}
+#endif
+
+/* Write to a file through the cache */
+static int32_t cache_write (rt_fs_file_t *file, const uint8_t *buf, uint32_t cnt) {
+#if (RT_FS_CACHE_BLOCK_NUM > 0)
+  rt_fs_block_t *b;
+  uint32_t blk, ofs, len, n;
+#endif
+  int32_t rval;
+
+  if (file->append != 0U) {
+    file->pos = file->size;
+  }
+
+  if (cnt > (FS_FILE_SIZE_MAX - file->pos)) {
+    /* File size limit of FAT */
+    cnt = (uint32_t)(FS_FILE_SIZE_MAX - file->pos);
+    if (cnt == 0U) {
+      return (RT_ERR_NOSPACE);
+    }
+  }
+
+#if (RT_FS_CACHE_BLOCK_NUM > 0)
+  if (cnt < RT_FS_CACHE_BLOCK_SIZE) {
+    rval = 0;
+    for (n = 0U; n < cnt; n += len) {
+      blk = (uint32_t)(file->pos / RT_FS_CACHE_BLOCK_SIZE);
+      ofs = (uint32_t)(file->pos % RT_FS_CACHE_BLOCK_SIZE);
+      len = RT_FS_CACHE_BLOCK_SIZE - ofs;
+      if (len > (cnt - n)) {
+        len = cnt - n;
+      }
+
+      b = block_find(file, blk);
+      if ((b != NULL) && ((ofs > b->hi) || ((ofs + len) < b->lo))) {
+        /* Block holds one range of valid data: write the current one first */
+        if (b->dirty != 0U) {
+          rval = cache_flush(file);
+          if (rval != 0) {
+            break;
+          }
+          /* Block may be replaced while the lock is released */
+          b = block_find(file, blk);
+        }
+        if (b != NULL) {
+          b->lo = ofs;
+          b->hi = ofs;
+        }
+      }
+
+      if (b != NULL) {
+        rt_fs_stats.hits++;
+      } else {
+        rt_fs_stats.misses++;
+        b = block_alloc(file, blk, &rval);
+        if ((b == NULL) && (rval == 0)) {
+          /* No block available: write the rest without the cache */
+          rval = cache_flush(file);
+          if (rval == 0) {
+            cache_drop(file, file->pos, file->pos + (cnt - n));
+            rval = file_write(file, &buf[n], cnt - n);
+          }
+          if (rval > 0) {
+            n += (uint32_t)rval;
+          }
+        }
+        if (b == NULL) {
+          break;
+        }
+        b->lo = ofs;
+        b->hi = ofs;
+      }
+
+      memcpy(&b->buf[ofs], &buf[n], len);
+      if (b->lo > ofs) {
+        b->lo = ofs;
+      }
+      if (b->hi < (ofs + len)) {
+        b->hi = ofs + len;
+      }
+      if ((b->dirty == 0U) || (b->dlo > ofs)) {
+        b->dlo = ofs;
+      }
+      b->dirty = 1U;
+      b->used  = ++rt_fs_time;
+
+      file->pos += len;
+      if (file->size < file->pos) {
+        file->size = file->pos;
+      }
+    }
+
+    if (n != 0U) {
+      /* Return number of bytes written */
+      rval = (int32_t)n;
+    }
+    return (rval);
+  }
+#endif
+
+  /* Large write: bypass the cache */
+  rval = cache_flush(file);
+  if (rval == 0) {
+    cache_drop(file, file->pos, file->pos + cnt);
+    rval = file_write(file, buf, cnt);
+  }
+  return (rval);
+}
+
+#if (RT_FS_READAHEAD_NUM > 0)
+/* Read the blocks holding RT_FS_READAHEAD_NUM block sizes of data following the file position */
+static void cache_readahead (rt_fs_file_t *file) {
+  rt_fs_block_t *b;
+  uint32_t blk, end;
+  uint64_t ofs;
+  int32_t rval;
+
+  blk = (uint32_t)(file->pos / RT_FS_CACHE_BLOCK_SIZE);
+  end = (uint32_t)((file->pos + (RT_FS_READAHEAD_NUM * RT_FS_CACHE_BLOCK_SIZE) - 1U) / RT_FS_CACHE_BLOCK_SIZE);
+
+  for (; blk <= end; blk++) {
+    ofs = (uint64_t)blk * RT_FS_CACHE_BLOCK_SIZE;
+    if (ofs >= file->size) {
+      break;
+    }
+    if (block_find(file, blk) != NULL) {
+      continue;
+    }
+
+    b = block_alloc(file, blk, &rval);
+    if (b == NULL) {
+      break;
+    }
+    b->busy = 1U;
+    fs_unlock();
+
+    rval = 0;
+    if (file->mpos != ofs) {
+      rval = media_seek(file->handle, ofs);
+    }
+    if (rval == 0) {
+      file->mpos = ofs;
+      rval = media_read(file->handle, b->buf, RT_FS_CACHE_BLOCK_SIZE);
+    }
+
+    fs_lock();
+    if (rval > 0) {
+      file->mpos += (uint32_t)rval;
+      b->hi    = (uint32_t)rval;
+      b->ahead = 1U;
+      b->used  = ++rt_fs_time;
+      rt_fs_stats.ra_blocks++;
+    } else {
+      b->file  = NULL;
+    }
+    b->busy  = 0U;
+    if (rval <= 0) {
+      break;
+    }
+  }
+}
+
+#if defined(RTE_CMSIS_RTOS2)
+/* Read-ahead thread */
+static void rt_fs_ra_thread (void *arg) {
+  rt_fs_file_t *file;
+  uint32_t i, n;
+  int32_t fd;
+
+  (void)arg;
+
+  for (;;) {
+    osEventFlagsWait(rt_fs_evf, RT_FS_FLAG_REQ, osFlagsWaitAny, osWaitForever);
+
+    do {
+      n = 0U;
+      for (i = 0U; i < RT_FS_FILE_NUM; i++) {
+        fs_lock();
+        fd = ((rt_fs_file[i].used != 0U) && (rt_fs_file[i].ra_req != 0U)) ? fd_make(i, rt_fs_file[i].gen) : -1;
+        fs_unlock();
+        if (fd < 0) {
+          continue;
+        }
+        file = file_acquire(fd);
+        if (file != NULL) {
+          if (file->ra_req != 0U) {
+            file->ra_req = 0U;
+            cache_readahead(file);
+            n++;
+          }
+          file_release(file);
+        }
+      }
+    } while (n != 0U);
+  }
+}
+#endif
+#endif /* RT_FS_READAHEAD_NUM > 0 */
+
+/* Read from a file through the cache */
+static int32_t cache_read (rt_fs_file_t *file, uint8_t *buf, uint32_t cnt) {
+#if (RT_FS_CACHE_BLOCK_NUM > 0)
+  rt_fs_block_t *b;
+  uint32_t blk, ofs, len;
+#endif
+  uint32_t n;
+  uint32_t seq;
+  int32_t rval;
+
+  /* Sequential access: read continues where the last read ended */
+  seq = ((file->rdonly != 0U) && (file->pos == file->ra_pos)) ? 1U : 0U;
+
+  n = 0U;
+#if (RT_FS_CACHE_BLOCK_NUM > 0)
+  for (; (n < cnt) && (file->pos < file->size); n += len) {
+    blk = (uint32_t)(file->pos / RT_FS_CACHE_BLOCK_SIZE);
+    ofs = (uint32_t)(file->pos % RT_FS_CACHE_BLOCK_SIZE);
+    len = RT_FS_CACHE_BLOCK_SIZE - ofs;
+    if (len > (cnt - n)) {
+      len = cnt - n;
+    }
+
+    b = block_find(file, blk);
+    if ((b == NULL) || (ofs < b->lo) || ((ofs + len) > b->hi)) {
+      break;
+    }
+
+    memcpy(&buf[n], &b->buf[ofs], len);
+    if (b->ahead != 0U) {
+      b->ahead = 0U;
+      rt_fs_stats.ra_hits++;
+    }
+    b->used = ++rt_fs_time;
+
+    file->pos += len;
+  }
+#endif
+
+  rval = 0;
+  if (n < cnt) {
+    /* Not cached: read the rest from the file system */
+    if ((seq != 0U) && (RT_FS_READAHEAD_NUM > 0)) {
+      rt_fs_stats.ra_misses++;
+    }
+    rval = cache_flush(file);
+    if (rval == 0) {
+      rval = file_read(file, &buf[n], cnt - n);
+    }
+    if (rval > 0) {
+      n += (uint32_t)rval;
+    }
+  }
+  file->ra_pos = file->pos;
+
+#if (RT_FS_READAHEAD_NUM > 0)
+  if ((seq != 0U) && (file->pos < file->size)) {
+#if defined(RTE_CMSIS_RTOS2)
+    if ((rt_fs_ra_thread_id != NULL) && (osKernelGetState() == osKernelRunning)) {
+      file->ra_req = 1U;
+      osEventFlagsSet(rt_fs_evf, RT_FS_FLAG_REQ);
+    } else {
+      cache_readahead(file);
+    }
+#else
+    cache_readahead(file);
+#endif
+  }
+#else
+  (void)seq;
+#endif
+
+  if ((n != 0U) || (rval >= 0)) {
+    /* Return number of bytes read */
+    rval = (int32_t)n;
+  }
+  return (rval);
+}
+
+#if (RT_FS_SYNC_NUM > 0)
+/* Commit the files of the queued sync requests as leader of a group, the
+   caller holds the file system lock */
+static void sync_group (void) {
+  rt_fs_file_t *file;
+  uint32_t i, k;
+  int32_t fd, rval;
+
+  rt_fs_sync_leader = 1U;
+#if (RT_FS_SYNC_WINDOW > 0)
+  /* Collect further requests */
+  fs_unlock();
+  osDelay(RT_FS_SYNC_WINDOW);
+  fs_lock();
+#endif
+  for (i = 0U; i < RT_FS_SYNC_NUM; i++) {
+    if (rt_fs_sync_req[i].state == SYNC_QUEUED) {
+      rt_fs_sync_req[i].state = SYNC_GROUP;
+    }
+  }
+
+  for (i = 0U; i < RT_FS_SYNC_NUM; i++) {
+    if (rt_fs_sync_req[i].state != SYNC_GROUP) {
+      continue;
+    }
+    fd   = rt_fs_sync_req[i].fd;
+    file = file_get(fd);
+    if (file != NULL) {
+      /* The lock of the file is not taken: other threads write to the
+         file meanwhile, closing it waits for the commit */
+      file->commit = 1U;
+      rval = file_commit(file);
+      file->commit = 0U;
+      if (file->close_wait != NULL) {
+        osThreadFlagsSet(file->close_wait, RT_FS_SYNC_FLAG);
+        file->close_wait = NULL;
+      }
+    } else {
+      /* Closed meanwhile, which has committed the file */
+      rval = 0;
+    }
+
+    /* One commit for all requests of the file */
+    for (k = i; k < RT_FS_SYNC_NUM; k++) {
+      if ((rt_fs_sync_req[k].state == SYNC_GROUP) && (rt_fs_sync_req[k].fd == fd)) {
+        rt_fs_sync_req[k].rval  = rval;
+        rt_fs_sync_req[k].state = SYNC_DONE;
+        if (rt_fs_sync_req[k].thread != osThreadGetId()) {
+          osThreadFlagsSet(rt_fs_sync_req[k].thread, RT_FS_SYNC_FLAG);
+        }
+      }
+    }
+  }
+
+  rt_fs_sync_leader = 0U;
+  for (i = 0U; i < RT_FS_SYNC_NUM; i++) {
+    if (rt_fs_sync_req[i].state == SYNC_QUEUED) {
+      /* Hand over to a thread of the next group */
+      osThreadFlagsSet(rt_fs_sync_req[i].thread, RT_FS_SYNC_FLAG);
+      break;
+    }
+  }
+}
+#endif
+
+/* Convert FAT attributes to retarget attributes */
+static uint32_t fs_attr (uint32_t attrib) {
+  uint32_t attr;
+
+  attr = RT_ATTR_FILE;
+  if (attrib & FS_FAT_ATTR_DIRECTORY) { attr  = RT_ATTR_DIR;     }
+  if (attrib & FS_FAT_ATTR_READ_ONLY) { attr |= RT_ATTR_RD;      }
+  if (attrib & FS_FAT_ATTR_HIDDEN)    { attr |= RT_ATTR_HIDDEN;  }
+  if (attrib & FS_FAT_ATTR_SYSTEM)    { attr |= RT_ATTR_SYSTEM;  }
+  if (attrib & FS_FAT_ATTR_ARCHIVE)   { attr |= RT_ATTR_ARCHIVE; }
+
+  return (attr);
+}
+
+/* Convert file system time to retarget time */
+static void fs_time (rt_fs_time_t *t, const fsTime *time) {
+  memset(t, 0, sizeof(rt_fs_time_t));
+  t->year = time->year;
+  t->mon  = time->mon;
+  t->day  = time->day;
+  t->hour = time->hr;
+  t->min  = time->min;
+  t->sec  = time->sec;
+}
+
+/* Read attributes and time of a file, the file system lock is released meanwhile;
+   the file lock is held, so the file and its path stay the same */
+static void file_meta (rt_fs_file_t *file) {
+  fsFileInfo info;
+  fsStatus stat;
+
+  file->attr = RT_ATTR_FILE;
+  memset(&file->time, 0, sizeof(file->time));
+
+  if (file->path[0] != '\0') {
+    fs_unlock();
+    info.fileID = 0U;
+    stat = ffind(file->path, &info);
+    fs_lock();
+    if (stat == fsOK) {
+      file->attr = fs_attr(info.attrib);
+      fs_time(&file->time, &info.time);
+    }
+  }
+  file->meta = 1U;
+}
+
+/* Fill in a directory entry */
+static void dirent_set (rt_fs_dirent_t *ent, const char *name, uint32_t attr, uint64_t size, const rt_fs_time_t *time) {
+  strncpy(ent->name, name, RT_FS_NAME_MAX - 1U);
+  ent->name[RT_FS_NAME_MAX - 1U] = '\0';
+  ent->attr   = attr;
+  ent->size   = (int64_t)size;
+  ent->modify = *time;
+}
+
+/* Fold a path character: FAT names are not case sensitive */
+static char dc_fold (char c) {
+
+  if ((c >= 'A') && (c <= 'Z')) {
+    c = (char)(c + ('a' - 'A'));
+  } else
+  if (c == '\\') {
+    c = '/';
+  }
+  return (c);
+}
+
+/* Compare paths, return 1 when equal */
+static uint32_t dc_equal (const char *a, const char *b) {
+
+  while (dc_fold(*a) == dc_fold(*b)) {
+    if (*a == '\0') {
+      return (1U);
+    }
+    a++;
+    b++;
+  }
+  return (0U);
+}
+
+#if (RT_FS_DCACHE_NUM > 0)
+/* Name of the last element of a path */
+static const char *path_name (const char *path) {
+  const char *name;
+
+  for (name = path; *path != '\0'; path++) {
+    if ((*path == '/') || (*path == '\\') || (*path == ':')) {
+      name = path + 1;
+    }
+  }
+  return (name);
+}
+
+/* Hash of a path (FNV-1a) */
+static uint32_t dc_hash (const char *path) {
+  uint32_t h = 2166136261U;
+
+  while (*path != '\0') {
+    h ^= (uint8_t)dc_fold(*path++);
+    h *= 16777619U;
+  }
+  return (h);
+}
+
+/* Find the cached entry of a path */
+static rt_fs_dentry_t *dc_find (const char *path) {
+  rt_fs_dentry_t *e;
+  uint32_t h, i;
+
+  h = dc_hash(path);
+  for (i = rt_fs_dc_head[h % RT_FS_DCACHE_NUM]; i != 0U; i = e->next) {
+    e = &rt_fs_dc[i - 1U];
+    if ((e->hash == h) && (dc_equal(e->path, path) != 0U)) {
+      e->used = ++rt_fs_dc_time;
+      return (e);
+    }
+  }
+  return (NULL);
+}
+
+/* Remove an entry from the cache */
+static void dc_remove (rt_fs_dentry_t *e) {
+  uint8_t *link;
+  uint32_t idx;
+
+  idx = (uint32_t)(e - rt_fs_dc) + 1U;
+  for (link = &rt_fs_dc_head[e->hash % RT_FS_DCACHE_NUM]; *link != 0U; ) {
+    if (*link == idx) {
+      *link = e->next;
+      break;
+    }
+    link = &rt_fs_dc[*link - 1U].next;
+  }
+  e->used = 0U;
+}
+#endif
+
+/* Enter the result of a lookup into the directory cache, info is NULL for a path not found */
+static void dc_insert (const char *path, const fsFileInfo *info) {
+#if (RT_FS_DCACHE_NUM > 0)
+  rt_fs_dentry_t *e;
+  uint32_t i;
+
+  if (strlen(path) >= RT_FS_PATH_MAX) {
+    return;
+  }
+#if (RT_FS_DCACHE_NEG == 0)
+  if (info == NULL) {
+    return;
+  }
+#endif
+
+  e = dc_find(path);
+  if (e == NULL) {
+    /* Free or least recently used entry */
+    e = &rt_fs_dc[0];
+    for (i = 0U; i < RT_FS_DCACHE_NUM; i++) {
+      if (rt_fs_dc[i].used < e->used) {
+        e = &rt_fs_dc[i];
+      }
+    }
+    if (e->used != 0U) {
+      dc_remove(e);
+    }
+    strcpy(e->path, path);
+    e->hash = dc_hash(path);
+    e->next = rt_fs_dc_head[e->hash % RT_FS_DCACHE_NUM];
+    rt_fs_dc_head[e->hash % RT_FS_DCACHE_NUM] = (uint8_t)((e - rt_fs_dc) + 1);
+    e->used = ++rt_fs_dc_time;
+  }
+
+  if (info != NULL) {
+    e->neg  = 0U;
+    e->attr = fs_attr(info->attrib);
+    e->size = info->size;
+    fs_time(&e->time, &info->time);
+  } else {
+    e->neg  = 1U;
+  }
+#else
+  (void)path;
+  (void)info;
+#endif
+}
+
+#if (RT_FS_DCACHE_NUM > 0) && (RT_FS_DCACHE_NEG != 0)
+/* Check if a path is cached as not found */
+static uint32_t dc_notfound (const char *path) {
+  const rt_fs_dentry_t *e;
+
+  e = dc_find(path);
+  if ((e != NULL) && (e->neg != 0U)) {
+    rt_fs_stats.dc_hits++;
+    return (1U);
+  }
+  return (0U);
+}
+#endif
+
+/* Drop cached entries: of a path, of all paths not found (path is NULL) */
+static void dc_drop (const char *path) {
+#if (RT_FS_DCACHE_NUM > 0)
+  rt_fs_dentry_t *e;
+  uint32_t i;
+
+  rt_fs_dc_epoch++;
+  if (path != NULL) {
+    e = dc_find(path);
+    if (e != NULL) {
+      dc_remove(e);
+    }
+  } else {
+    for (i = 0U; i < RT_FS_DCACHE_NUM; i++) {
+      if ((rt_fs_dc[i].used != 0U) && (rt_fs_dc[i].neg != 0U)) {
+        dc_remove(&rt_fs_dc[i]);
+      }
+    }
+  }
+#else
+  (void)path;
+#endif
+}
+
+/* Drop all cached entries */
+static void dc_clear (void) {
+#if (RT_FS_DCACHE_NUM > 0)
+  rt_fs_dc_epoch++;
+  memset(rt_fs_dc,      0, sizeof(rt_fs_dc));
+  memset(rt_fs_dc_head, 0, sizeof(rt_fs_dc_head));
+#endif
+}
+
+/* Current directory cache epoch, taken before the file system lock is released for ffind */
+static uint32_t dc_epoch (void) {
+#if (RT_FS_DCACHE_NUM > 0)
+  return (rt_fs_dc_epoch);
+#else
+  return (0U);
+#endif
+}
+
+/* Check the media of the drive of a path before cached entries are used,
+   clear the directory cache when the drive has no media (card removed) */
+static void dc_media (const char *path) {
+#if (RT_FS_DCACHE_NUM > 0)
+  char drive[4];
+  const char *p;
+  uint32_t n;
+
+  /* Drive prefix ("M0:"), empty for the current drive */
+  p = strchr(path, ':');
+  n = (p != NULL) ? ((uint32_t)(p - path) + 1U) : 0U;
+  if (n >= sizeof(drive)) {
+    return;
+  }
+  memcpy(drive, path, n);
+  drive[n] = '\0';
+
+  if (fmedia(drive) == fsNoMedia) {
+    fs_lock();
+    dc_clear();
+    fs_unlock();
+  }
+#else
+  (void)path;
+#endif
+}
+
+/* Look up a path, in the directory cache first; called with the file system
+   lock held, which is released while the directory is searched */
+static int32_t path_lookup (const char *path, rt_fs_dirent_t *ent) {
+  fsFileInfo info;
+  fsStatus stat;
+  uint32_t epoch;
+#if (RT_FS_DCACHE_NUM > 0)
+  const rt_fs_dentry_t *e;
+
+  e = dc_find(path);
+  if (e != NULL) {
+    rt_fs_stats.dc_hits++;
+    if (e->neg != 0U) {
+      return (RT_ERR_NOTFOUND);
+    }
+    dirent_set(ent, path_name(path), e->attr, e->size, &e->time);
+    return (0);
+  }
+  rt_fs_stats.dc_misses++;
+#endif
+
+  epoch = dc_epoch();
+  fs_unlock();
+  info.fileID = 0U;
+  stat = ffind(path, &info);
+  fs_lock();
+
+  if (epoch != dc_epoch()) {
+    /* Entries dropped meanwhile, the result may be out of date: not cached */
+  } else
+  if (stat == fsOK) {
+    dc_insert(path, &info);
+  } else
+  if (stat == fsFileNotFound) {
+    dc_insert(path, NULL);
+  } else
+  if ((stat == fsNoMedia) || (stat == fsMediaError) || (stat == fsUninitializedDrive)) {
+    /* Media removed or changed */
+    dc_clear();
+  }
+
+  if (stat == fsOK) {
+    fs_time(&ent->modify, &info.time);
+    dirent_set(ent, info.name, fs_attr(info.attrib), info.size, &ent->modify);
+  }
+  return ((stat == fsOK) ? 0 : fs_to_rt_rval(stat));
+}
+
+/* Enter an opened file into the file table, return file descriptor or error */
+static int32_t file_open (int32_t handle, const char *path, uint32_t append, uint32_t rdonly) {
+  rt_fs_file_t *file;
+  int64_t sz;
+  uint32_t i;
+
+  sz = media_size(handle, path);
+  if (sz < 0) {
+    (void)__sys_close(handle);
+    return ((int32_t)sz);
+  }
+
+  fs_lock();
+
+  file = NULL;
+  for (i = 0U; i < RT_FS_FILE_NUM; i++) {
+    if (rt_fs_file[i].used == 0U) {
+      file = &rt_fs_file[i];
+      break;
+    }
+  }
+
+  if (file == NULL) {
+    fs_unlock();
+    (void)__sys_close(handle);
+    return (RT_ERR_MAXFILES);
+  }
+
+  /* Position is at the end of file in append mode */
+  if (file->gen == 0U) {
+    file->gen = 1U;
+  }
+  file->handle = handle;
+  file->used   = 1U;
+  file->size   = (uint64_t)sz;
+  file->append = (uint8_t)append;
+  file->rdonly = (uint8_t)rdonly;
+  file->pos    = (append != 0U) ? (uint64_t)sz : 0U;
+  file->mpos   = file->pos;
+  file->ra_pos = file->pos;
+  file->ra_req = 0U;
+  file->meta   = 0U;
+
+  /* Path is kept for ffind, a path that does not fit is not kept */
+  file->path[0] = '\0';
+  if (strlen(path) < RT_FS_PATH_MAX) {
+    strcpy(file->path, path);
+  }
+
+  fs_unlock();
+
+  return (fd_make(i, file->gen));
 }
 
 int32_t rt_fs_open (const char *path, int32_t mode) {
+#if (RT_FS_DCACHE_NUM > 0) && (RT_FS_DCACHE_NEG != 0)
+  rt_fs_dirent_t ent;
+#endif
   int openmode;
   int flag;
   int rval;
@@ -71,106 +1589,226 @@ int32_t rt_fs_open (const char *path, int32_t mode) {
     openmode = OPEN_A;
   }
 
+#if (RT_FS_DCACHE_NUM > 0) && (RT_FS_DCACHE_NEG != 0)
+  if (openmode == OPEN_R) {
+    dc_media(path);
+    fs_lock();
+    rval = (int)dc_notfound(path);
+    fs_unlock();
+    if (rval != 0) {
+      /* Path cached as not found */
+      return (RT_ERR_NOTFOUND);
+    }
+  }
+#endif
+
   rval = __sys_open(path, openmode| flag);
 
   if (rval > 0) {
-    rval = fd_rval(rval);
+    rval = file_open(rval, path, (openmode == OPEN_A) ? 1U : 0U, (openmode == OPEN_R) ? 1U : 0U);
+    if ((rval >= 0) && (openmode != OPEN_R)) {
+      /* File may be created, size changes */
+      fs_lock();
+      dc_drop(path);
+      dc_drop(NULL);
+      fs_unlock();
+    }
   } else {
     rval = fs_to_rt_rval ((fsStatus)rval);
+#if (RT_FS_DCACHE_NUM > 0) && (RT_FS_DCACHE_NEG != 0)
+    if (openmode == OPEN_R) {
+      /* Enter the path into the directory cache when not found */
+      fs_lock();
+      if (path_lookup(path, &ent) == RT_ERR_NOTFOUND) {
+        rval = RT_ERR_NOTFOUND;
+      }
+      fs_unlock();
+    }
+#endif
   }
 
   return (rval);
 }
 
 int32_t rt_fs_close (int32_t fd) {
+  rt_fs_file_t *file;
+  int32_t handle;
   int32_t rval;
+  int32_t err;
+
+  file = file_acquire(fd);
+  if (file == NULL) {
+    return (RT_ERR_INVAL);
+  }
+
+#if (RT_FS_SYNC_NUM > 0)
+  while (file->commit != 0U) {
+    /* Wait until the leader of a group has committed the file */
+    file->close_wait = osThreadGetId();
+    fs_unlock();
+    osThreadFlagsWait(RT_FS_SYNC_FLAG, osFlagsWaitAny, osWaitForever);
+    fs_lock();
+  }
+#endif
 
-  rval = __sys_close(fd_arg(fd));
+  /* Write cached data and release the entry, the descriptor becomes stale */
+  file->ra_req = 0U;
+  err = cache_flush(file);
+  cache_drop(file, 0U, UINT64_MAX);
+  if (file->rdonly == 0U) {
+    dc_drop(file->path);
+  }
+  handle     = file->handle;
+  file->used = 0U;
+  file->gen  = (file->gen < FD_GEN_MAX) ? (uint16_t)(file->gen + 1U) : 1U;
+  file_release(file);
+
+  rval = __sys_close(handle);
 
   if (rval != 0) {
     rval = fs_to_rt_rval ((fsStatus)rval);
   }
 
+  if (rval == 0) {
+    rval = err;
+  }
+
   return (rval);
 }
 
 int32_t rt_fs_write (int32_t fd, const void *buf, uint32_t cnt) {
+  rt_fs_file_t *file;
   int32_t rval;
-  int32_t n;
-
-  n =__sys_write(fd_arg(fd), buf, cnt);
 
-  if (n >= 0) {
-    /* Return number of bytes written */
-    rval = (int32_t)cnt - n;
+  file = file_acquire(fd);
+  if (file != NULL) {
+    /* Modification time changes */
+    file->meta = 0U;
+    rval = cache_write(file, buf, cnt);
+    file_release(file);
   } else {
-    /* Indicate write error */
-    rval = fs_to_rt_rval ((fsStatus)-n);
+    rval = RT_ERR_INVAL;
   }
 
   return (rval);
 }
 
 int32_t rt_fs_read (int32_t fd, void *buf, uint32_t cnt) {
+  rt_fs_file_t *file;
   int32_t rval;
-  int32_t n;
 
-  n = __sys_read(fd_arg(fd), buf, cnt);
-
-  n &= ~0x80000000;
-
-  if (n >= 0) {
-    /* Return number of bytes read */
-    rval = (int32_t)cnt - n;
+  file = file_acquire(fd);
+  if (file != NULL) {
+    rval = cache_read(file, buf, cnt);
+    file_release(file);
   } else {
-    /* Indicate read error */
-    rval = fs_to_rt_rval ((fsStatus)-n);
+    rval = RT_ERR_INVAL;
   }
 
   return (rval);
 }
 
 int64_t rt_fs_seek (int32_t fd, int64_t offset, int32_t whence) {
+  rt_fs_file_t *file;
   int64_t rval;
+  int64_t pos;
+  int64_t sz;
 
-  if ((whence == RT_SEEK_SET) && (offset <= UINT32_MAX)) {
-    /* Seek from the start of the file */
-    rval = __sys_seek(fd_arg(fd), (uint32_t)offset);
+  file = file_acquire(fd);
 
-    if (rval != 0) {
-      rval = fs_to_rt_rval ((fsStatus)-rval);
+  if (file != NULL) {
+    if      (whence == RT_SEEK_SET) { pos = 0;                  }
+    else if (whence == RT_SEEK_CUR) { pos = (int64_t)file->pos;  }
+    else if (whence == RT_SEEK_END) { pos = (int64_t)file->size; }
+    else                            { pos = -1;                 }
+
+    if ((pos >= 0) && (offset >= -pos) && (offset <= (INT64_MAX - pos))) {
+      pos += offset;
+    } else {
+      pos = -1;
     }
 
+    if (pos < 0) {
+      rval = RT_ERR_INVAL;
+    } else
+    if ((uint64_t)pos <= file->size) {
+      /* Within the file: the file system position is set on next access */
+      file->pos = (uint64_t)pos;
+      rval = pos;
+    } else {
+      /* Beyond the end of file: let the file system decide */
+      rval = cache_flush(file);
+      if (rval == 0) {
+        fs_unlock();
+        rval = media_seek(file->handle, (uint64_t)pos);
+        sz   = (rval == 0) ? media_size(file->handle, file->path) : -1;
+        fs_lock();
+      }
+      if (rval == 0) {
+        file->pos  = (uint64_t)pos;
+        file->mpos = file->pos;
+        if (sz >= 0) {
+          file->size = (uint64_t)sz;
+        }
+        rval = pos;
+      }
+    }
+    file_release(file);
   } else {
-    /* Not supported: RT_SEEK_CUR, RT_SEEK_END */
-    rval = RT_ERR_NOTSUP;
+    rval = RT_ERR_INVAL;
   }
 
   return (rval);
 }
 
 int64_t rt_fs_size (int32_t fd) {
-  int32_t rval;
+  rt_fs_file_t *file;
   int64_t sz;
 
-  rval = __sys_flen(fd_arg(fd));
-
-  if (rval >= 0) {
-    /* Size was returned */
-    sz = (int64_t)rval;
+  /* The size is changed with the file system lock held, a write to the
+     drive in progress on the file is not waited for */
+  fs_lock();
+  file = file_get(fd);
+  if (file != NULL) {
+    /* Size includes cached data */
+    sz = (int64_t)file->size;
   } else {
-    /* Indicate error */
-    sz = fs_to_rt_rval ((fsStatus)-rval);
+    sz = RT_ERR_INVAL;
   }
+  fs_unlock();
 
   return (sz);
 }
 
 int32_t rt_fs_stat (int32_t fd, rt_fs_stat_t *stat) {
-  (void)fd;
-  (void)stat;
+  rt_fs_file_t *file;
+  int32_t rval;
+
+  if (stat == NULL) {
+    return (RT_ERR_INVAL);
+  }
+
+  file = file_acquire(fd);
+  if (file != NULL) {
+    if (file->meta == 0U) {
+      /* Written data must be in the file system for the current time */
+      (void)cache_flush(file);
+      file_meta(file);
+    }
+
+    stat->attr     = file->attr;
+    stat->access   = file->time;
+    stat->modify   = file->time;
+    stat->change   = file->time;
+    stat->blksize  = RT_FS_STAT_BLKSIZE;
+    stat->blkcount = (uint32_t)((file->size + (RT_FS_STAT_BLKSIZE - 1U)) / RT_FS_STAT_BLKSIZE);
+    file_release(file);
+    rval = 0;
+  } else {
+    rval = RT_ERR_INVAL;
+  }
 
-  return RT_ERR_NOTSUP;
+  return (rval);
 }
 
 int32_t rt_fs_remove (const char *path) {
@@ -181,6 +1819,9 @@ int32_t rt_fs_remove (const char *path) {
 
   if (stat == fsOK) {
     /* File or directory deleted */
+    fs_lock();
+    dc_clear();
+    fs_unlock();
     rval = 0;
   } else {
     /* Indicate error */
@@ -198,6 +1839,380 @@ int32_t rt_fs_rename (const char *oldpath, const char *newpath) {
 
   if (stat == fsOK) {
     /* File or directory renamed */
+    fs_lock();
+    dc_clear();
+    fs_unlock();
+    rval = 0;
+  } else {
+    /* Indicate error */
+    rval = fs_to_rt_rval ((fsStatus)stat);
+  }
+
+  return (rval);
+}
+
+int32_t rt_fs_flush (int32_t fd) {
+  rt_fs_file_t *file;
+  int32_t rval;
+
+  file = file_acquire(fd);
+  if (file != NULL) {
+    rval = cache_flush(file);
+    file_release(file);
+  } else {
+    rval = RT_ERR_INVAL;
+  }
+
+  return (rval);
+}
+
+int32_t rt_fs_sync (int32_t fd) {
+  rt_fs_file_t *file;
+  int32_t rval;
+#if (RT_FS_SYNC_NUM > 0)
+  rt_fs_sync_t *req;
+  uint32_t i;
+#endif
+
+  file = file_acquire(fd);
+  if (file == NULL) {
+    return (RT_ERR_INVAL);
+  }
+  rt_fs_stats.syncs++;
+
+  /* Data written before the call reaches the file system first */
+  rval = cache_flush(file);
+
+#if (RT_FS_SYNC_NUM > 0)
+  req = NULL;
+  if ((rval == 0) && (osKernelGetState() == osKernelRunning)) {
+    for (i = 0U; i < RT_FS_SYNC_NUM; i++) {
+      if (rt_fs_sync_req[i].state == SYNC_FREE) {
+        req = &rt_fs_sync_req[i];
+        break;
+      }
+    }
+  }
+  if (req != NULL) {
+    /* Queue the request, the file is committed by the leader of a group */
+    req->thread = osThreadGetId();
+    req->fd     = fd;
+    req->state  = SYNC_QUEUED;
+    file_unlock(file);
+
+    while (req->state != SYNC_DONE) {
+      if (rt_fs_sync_leader == 0U) {
+        sync_group();
+      } else {
+        fs_unlock();
+        osThreadFlagsWait(RT_FS_SYNC_FLAG, osFlagsWaitAny, osWaitForever);
+        fs_lock();
+      }
+    }
+    rval = req->rval;
+    req->state = SYNC_FREE;
+    fs_unlock();
+
+    return (rval);
+  }
+#endif
+
+  if (rval == 0) {
+    rval = file_commit(file);
+  }
+  file_release(file);
+
+  return (rval);
+}
+
+int32_t rt_fs_cache_get_stats (rt_fs_cache_stats_t *stats) {
+#if (RT_FS_CACHE_BLOCK_NUM > 0) || (RT_FS_DCACHE_NUM > 0)
+  if (stats == NULL) {
+    return (RT_ERR_INVAL);
+  }
+
+  fs_lock();
+  *stats = rt_fs_stats;
+  fs_unlock();
+
+  return (0);
+#else
+  (void)stats;
+
+  return (RT_ERR_NOTSUP);
+#endif
+}
+
+int32_t rt_fs_map (int32_t fd, int64_t offset, uint32_t len, const void **ptr) {
+#if (RT_FS_MAP_MAX > 0)
+  rt_fs_file_t *file;
+  rt_fs_block_t *b;
+  uint32_t blk, ofs, i, n;
+  uint64_t pos;
+  int32_t rval;
+
+  if ((ptr == NULL) || (offset < 0)) {
+    return (RT_ERR_INVAL);
+  }
+
+  file = file_acquire(fd);
+
+  if (file == NULL) {
+    return (RT_ERR_INVAL);
+  }
+
+  if ((uint64_t)offset >= file->size) {
+    /* End of file */
+    rval = 0;
+  } else {
+    pos = (uint64_t)offset;
+    blk = (uint32_t)(pos / RT_FS_CACHE_BLOCK_SIZE);
+    ofs = (uint32_t)(pos % RT_FS_CACHE_BLOCK_SIZE);
+    if (len > (RT_FS_CACHE_BLOCK_SIZE - ofs)) {
+      len = RT_FS_CACHE_BLOCK_SIZE - ofs;
+    }
+    if (len > (file->size - pos)) {
+      len = (uint32_t)(file->size - pos);
+    }
+
+    b = block_find(file, blk);
+
+    rval = 0;
+    if ((b == NULL) || (b->map == 0U)) {
+      n = 0U;
+      for (i = 0U; i < RT_FS_CACHE_BLOCK_NUM; i++) {
+        if (rt_fs_block[i].map != 0U) {
+          n++;
+        }
+      }
+      if (n >= RT_FS_MAP_MAX) {
+        rval = RT_ERR_BUSY;
+      }
+    }
+
+    if ((rval == 0) && ((b == NULL) || (ofs < b->lo) || ((ofs + len) > b->hi))) {
+      /* Read the whole block, cached data is written first */
+      b = NULL;
+      rval = cache_flush(file);
+      if (rval == 0) {
+        b = block_find(file, blk);
+        if (b == NULL) {
+          b = block_alloc(file, blk, &rval);
+          if ((b == NULL) && (rval == 0)) {
+            rval = RT_ERR_BUSY;
+          }
+        }
+      }
+      if (b != NULL) {
+        b->busy = 1U;
+        fs_unlock();
+        pos = (uint64_t)blk * RT_FS_CACHE_BLOCK_SIZE;
+        if (file->mpos != pos) {
+          rval = media_seek(file->handle, pos);
+        }
+        if (rval == 0) {
+          file->mpos = pos;
+          rval = media_read(file->handle, b->buf, RT_FS_CACHE_BLOCK_SIZE);
+        }
+        fs_lock();
+        b->busy = 0U;
+        if (rval > 0) {
+          file->mpos += (uint32_t)rval;
+          b->lo = 0U;
+          b->hi = (uint32_t)rval;
+          rt_fs_stats.map_loads++;
+          rval = 0;
+          if ((ofs + len) > b->hi) {
+            len = (b->hi > ofs) ? (b->hi - ofs) : 0U;
+          }
+        } else {
+          b->file = NULL;
+          if (rval == 0) {
+            len = 0U;
+          }
+        }
+      }
+    } else
+    if (rval == 0) {
+      rt_fs_stats.map_hits++;
+    }
+
+    if ((rval == 0) && (len != 0U)) {
+      if (b->ahead != 0U) {
+        b->ahead = 0U;
+        rt_fs_stats.ra_hits++;
+      }
+      b->map++;
+      b->used = ++rt_fs_time;
+      *ptr = &b->buf[ofs];
+      /* Return number of bytes mapped */
+      rval = (int32_t)len;
+    }
+  }
+  file_release(file);
+
+  return (rval);
+#else
+  (void)fd;
+  (void)offset;
+  (void)len;
+  (void)ptr;
+
+  return (RT_ERR_NOTSUP);
+#endif
+}
+
+int32_t rt_fs_unmap (int32_t fd, const void *ptr) {
+#if (RT_FS_MAP_MAX > 0)
+  const uint8_t *p = ptr;
+  int32_t rval;
+  uint32_t i;
+
+  (void)fd;
+
+  rval = RT_ERR_INVAL;
+
+  fs_lock();
+  for (i = 0U; i < RT_FS_CACHE_BLOCK_NUM; i++) {
+    if ((rt_fs_block[i].map != 0U) &&
+        (p >= &rt_fs_block[i].buf[0]) && (p < &rt_fs_block[i].buf[RT_FS_CACHE_BLOCK_SIZE])) {
+      /* Block may be replaced when no longer mapped */
+      rt_fs_block[i].map--;
+      rval = 0;
+      break;
+    }
+  }
+  fs_unlock();
+
+  return (rval);
+#else
+  (void)fd;
+  (void)ptr;
+
+  return (RT_ERR_NOTSUP);
+#endif
+}
+
+int32_t rt_fs_writev (int32_t fd, const rt_fs_iovec_t *iov, uint32_t iovcnt) {
+  rt_fs_file_t *file;
+  uint32_t i, n;
+  int32_t rval;
+
+  if ((iov == NULL) && (iovcnt != 0U)) {
+    return (RT_ERR_INVAL);
+  }
+  for (i = 0U, n = 0U; i < iovcnt; i++) {
+    if (iov[i].len > ((uint32_t)INT32_MAX - n)) {
+      return (RT_ERR_INVAL);
+    }
+    n += iov[i].len;
+  }
+
+  /* Segments are written under one lock, small ones are collected in the cache */
+  file = file_acquire(fd);
+  if (file == NULL) {
+    return (RT_ERR_INVAL);
+  }
+  file->meta = 0U;
+
+  rval = 0;
+  for (i = 0U, n = 0U; i < iovcnt; i++) {
+    if (iov[i].len == 0U) {
+      continue;
+    }
+    rval = cache_write(file, iov[i].base, iov[i].len);
+    if (rval < 0) {
+      break;
+    }
+    n += (uint32_t)rval;
+    if ((uint32_t)rval != iov[i].len) {
+      break;
+    }
+  }
+  file_release(file);
+
+  if ((n != 0U) || (rval >= 0)) {
+    /* Return number of bytes written */
+    rval = (int32_t)n;
+  }
+  return (rval);
+}
+
+int32_t rt_fs_readv (int32_t fd, const rt_fs_iovec_t *iov, uint32_t iovcnt) {
+  rt_fs_file_t *file;
+  uint32_t i, n;
+  int32_t rval;
+
+  if ((iov == NULL) && (iovcnt != 0U)) {
+    return (RT_ERR_INVAL);
+  }
+  for (i = 0U, n = 0U; i < iovcnt; i++) {
+    if (iov[i].len > ((uint32_t)INT32_MAX - n)) {
+      return (RT_ERR_INVAL);
+    }
+    n += iov[i].len;
+  }
+
+  file = file_acquire(fd);
+  if (file == NULL) {
+    return (RT_ERR_INVAL);
+  }
+
+  rval = 0;
+  for (i = 0U, n = 0U; i < iovcnt; i++) {
+    if (iov[i].len == 0U) {
+      continue;
+    }
+    rval = cache_read(file, iov[i].base, iov[i].len);
+    if (rval < 0) {
+      break;
+    }
+    n += (uint32_t)rval;
+    if ((uint32_t)rval != iov[i].len) {
+      /* End of file */
+      break;
+    }
+  }
+  file_release(file);
+
+  if ((n != 0U) || (rval >= 0)) {
+    /* Return number of bytes read */
+    rval = (int32_t)n;
+  }
+  return (rval);
+}
+
+int32_t rt_fs_mkdir (const char *path) {
+  int32_t rval;
+  fsStatus stat;
+
+  stat = fmkdir (path);
+
+  if (stat == fsOK) {
+    /* Directory created */
+    fs_lock();
+    dc_drop(NULL);
+    fs_unlock();
+    rval = 0;
+  } else {
+    /* Indicate error */
+    rval = fs_to_rt_rval ((fsStatus)stat);
+  }
+
+  return (rval);
+}
+
+int32_t rt_fs_rmdir (const char *path) {
+  int32_t rval;
+  fsStatus stat;
+
+  stat = frmdir (path, NULL);
+
+  if (stat == fsOK) {
+    /* Directory removed */
+    fs_lock();
+    dc_clear();
+    fs_unlock();
     rval = 0;
   } else {
     /* Indicate error */
@@ -206,3 +2221,188 @@ int32_t rt_fs_rename (const char *oldpath, const char *newpath) {
 
   return (rval);
 }
+
+int32_t rt_fs_opendir (const char *path) {
+  rt_fs_dirent_t ent;
+  rt_fs_dir_t *dir;
+  uint32_t len, i;
+  int32_t rval;
+
+  if (path == NULL) {
+    return (RT_ERR_INVAL);
+  }
+
+  /* Trailing separators are ignored */
+  len = strlen(path);
+  while ((len != 0U) && ((path[len - 1U] == '/') || (path[len - 1U] == '\\'))) {
+    len--;
+  }
+  if (len >= RT_FS_PATH_MAX) {
+    return (RT_ERR_INVAL);
+  }
+
+  fs_lock();
+
+  dir = NULL;
+  for (i = 0U; i < RT_FS_DIR_NUM; i++) {
+    if (rt_fs_dir[i].used == 0U) {
+      dir = &rt_fs_dir[i];
+      break;
+    }
+  }
+
+  if (dir == NULL) {
+    rval = RT_ERR_MAXFILES;
+  } else {
+    memcpy(dir->pattern, path, len);
+    dir->pattern[len] = '\0';
+
+    /* Reserved while the path is looked up without the lock */
+    dir->used = 1U;
+    dir->busy = 1U;
+
+    rval = 0;
+    if ((len != 0U) && (path[len - 1U] != ':')) {
+      /* Not the root directory of a drive */
+      rval = path_lookup(dir->pattern, &ent);
+      if ((rval == 0) && ((ent.attr & RT_ATTR_DIR) == 0U)) {
+        rval = RT_ERR_NOTDIR;
+      }
+      dir->pattern[len++] = '/';
+    }
+
+    dir->busy = 0U;
+    if (rval == 0) {
+      dir->pattern[len]      = '*';
+      dir->pattern[len + 1U] = '\0';
+      dir->len         = len;
+      dir->info.fileID = 0U;
+      rval = (int32_t)i;
+    } else {
+      dir->used = 0U;
+    }
+  }
+
+  fs_unlock();
+
+  return (rval);
+}
+
+int32_t rt_fs_readdir (int32_t dd, rt_fs_dirent_t *ent) {
+  rt_fs_dir_t *dir;
+  fsStatus stat;
+  uint32_t epoch;
+  int32_t rval;
+
+  if ((dd < 0) || (dd >= RT_FS_DIR_NUM) || (ent == NULL)) {
+    return (RT_ERR_INVAL);
+  }
+
+  fs_lock();
+  dir = &rt_fs_dir[dd];
+  if (dir->used == 0U) {
+    rval = RT_ERR_INVAL;
+  } else
+  if (dir->busy != 0U) {
+    /* Read by another thread */
+    rval = RT_ERR_BUSY;
+  } else {
+    /* The directory is searched without the lock, busy keeps it open */
+    dir->busy = 1U;
+    epoch     = dc_epoch();
+    fs_unlock();
+    do {
+      stat = ffind(dir->pattern, &dir->info);
+    } while ((stat == fsOK) && ((strcmp(dir->info.name, ".") == 0) || (strcmp(dir->info.name, "..") == 0)));
+    fs_lock();
+    dir->busy = 0U;
+
+    if (stat == fsOK) {
+      fs_time(&ent->modify, &dir->info.time);
+      dirent_set(ent, dir->info.name, fs_attr(dir->info.attrib), dir->info.size, &ent->modify);
+
+      /* Listed entries are found in the directory cache */
+      if ((epoch == dc_epoch()) && ((dir->len + strlen(dir->info.name)) < RT_FS_PATH_MAX)) {
+        strcpy(&dir->pattern[dir->len], dir->info.name);
+        dc_insert(dir->pattern, &dir->info);
+        strcpy(&dir->pattern[dir->len], "*");
+      }
+      rval = 1;
+    } else
+    if (stat == fsFileNotFound) {
+      /* No more entries */
+      rval = 0;
+    } else {
+      rval = fs_to_rt_rval(stat);
+    }
+  }
+  fs_unlock();
+
+  return (rval);
+}
+
+int32_t rt_fs_closedir (int32_t dd) {
+  int32_t rval;
+
+  if ((dd < 0) || (dd >= RT_FS_DIR_NUM)) {
+    return (RT_ERR_INVAL);
+  }
+
+  fs_lock();
+  if (rt_fs_dir[dd].used == 0U) {
+    rval = RT_ERR_INVAL;
+  } else
+  if (rt_fs_dir[dd].busy != 0U) {
+    /* Being read by another thread */
+    rval = RT_ERR_BUSY;
+  } else {
+    rt_fs_dir[dd].used = 0U;
+    rval = 0;
+  }
+  fs_unlock();
+
+  return (rval);
+}
+
+int32_t rt_fs_lookup (const char *path, rt_fs_dirent_t *ent) {
+  uint32_t i;
+  int32_t rval;
+
+  if ((path == NULL) || (ent == NULL) || (strpbrk(path, "*?") != NULL)) {
+    return (RT_ERR_INVAL);
+  }
+
+  dc_media(path);
+  fs_lock();
+  rval = path_lookup(path, ent);
+  if (rval == 0) {
+    /* Size of a file open for writing includes cached data */
+    for (i = 0U; i < RT_FS_FILE_NUM; i++) {
+      if ((rt_fs_file[i].used != 0U) && (rt_fs_file[i].rdonly == 0U) &&
+          (dc_equal(rt_fs_file[i].path, path) != 0U)) {
+        ent->size = (int64_t)rt_fs_file[i].size;
+      }
+    }
+  }
+  fs_unlock();
+
+  return (rval);
+}
+
+int32_t rt_fs_invalidate (const char *path) {
+
+  fs_lock();
+  if (path == NULL) {
+    dc_clear();
+  } else {
+    dc_drop(path);
+  }
+  fs_unlock();
+
+  return (0);
+}
+
+#if defined(RT_FS_VFS)
+/* Operations for rt_vfs_mount */
+RT_FS_VFS_OPS(mdk);
+#endif
@@ -0,0 +1,1064 @@
+/*-----------------------------------------------------------------------------
+ * Name:    retarget_ramfs.c
+ * Purpose: File Interface Retarget to a RAM file system
+ * Rev.:    1.0.0
+ *-----------------------------------------------------------------------------*/
+
+/*
+ * Copyright (C) 2023 ARM Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "RTE_Components.h"
+#if defined(RT_FS_VFS)
+/* Backend of the mount table: functions are named ramfs_rt_fs_... */
+#define RT_FS_VFS_BACKEND       ramfs
+#include "retarget_vfs.h"
+#endif
+#include "retarget_fs.h"
+#include "retarget_fs_ext.h"
+
+#if defined(RTE_CMSIS_RTOS2)
+#include "cmsis_os2.h"
+#endif
+
+/* Size of the memory holding file data in bytes */
+#ifndef RT_RAMFS_SIZE
+#define RT_RAMFS_SIZE           32768
+#endif
+
+/* Allocation unit in bytes */
+#ifndef RT_RAMFS_BLOCK_SIZE
+#define RT_RAMFS_BLOCK_SIZE     256
+#endif
+
+/* Number of files */
+#ifndef RT_RAMFS_FILE_NUM
+#define RT_RAMFS_FILE_NUM       16
+#endif
+
+/* Number of open file handles */
+#ifndef RT_RAMFS_OPEN_NUM
+#define RT_RAMFS_OPEN_NUM       8
+#endif
+
+/* Maximum length of a file name, including the terminating null */
+#ifndef RT_RAMFS_NAME_MAX
+#define RT_RAMFS_NAME_MAX       32
+#endif
+
+/* Maximum number of extents of a file */
+#ifndef RT_RAMFS_EXTENT_NUM
+#define RT_RAMFS_EXTENT_NUM     8
+#endif
+
+/* Number of open directories */
+#ifndef RT_RAMFS_DIR_NUM
+#define RT_RAMFS_DIR_NUM        2
+#endif
+
+/* Number of name table entries (must be a power of 2 and larger than RT_RAMFS_FILE_NUM) */
+#ifndef RT_RAMFS_HASH_NUM
+#define RT_RAMFS_HASH_NUM       32
+#endif
+
+#define RAMFS_BLOCK_NUM         (RT_RAMFS_SIZE / RT_RAMFS_BLOCK_SIZE)
+
+#if (RAMFS_BLOCK_NUM < 1)
+#error "RT_RAMFS_SIZE must hold at least one block."
+#endif
+#if (RT_RAMFS_FILE_NUM < 1) || (RT_RAMFS_FILE_NUM > 254)
+#error "RT_RAMFS_FILE_NUM must be in range 1 to 254."
+#endif
+#if ((RT_RAMFS_HASH_NUM & (RT_RAMFS_HASH_NUM - 1)) != 0) || (RT_RAMFS_HASH_NUM <= RT_RAMFS_FILE_NUM)
+#error "RT_RAMFS_HASH_NUM must be a power of 2 and larger than RT_RAMFS_FILE_NUM."
+#endif
+
+/*
+  RAM file system
+
+  File data is kept in blocks of RT_RAMFS_BLOCK_SIZE bytes within a static
+  memory area. A file consists of up to RT_RAMFS_EXTENT_NUM extents, runs
+  of consecutive blocks, listed in file order with the file offset of each
+  extent. A file that grows first extends its last extent in place; a new
+  extent is at least as large as the previous one, so the number of
+  extents stays small.
+
+  Accesses start at the extent of the previous access of the handle, so
+  sequential reads and appends do not search. Other positions are found
+  with a binary search of the extent list.
+
+  File names are found with a hash table (open addressing, linear
+  probing). The name space is flat: a drive prefix ("R:") and leading
+  slashes are removed, other characters are part of the name.
+
+  There are no subdirectories, rt_fs_opendir lists the files of the root
+  directory.
+
+  Data written beyond the end of file is preceded by zeros. Files are
+  lost on reset. rt_fs_map returns a pointer into the file memory, valid
+  until the file is removed or truncated.
+*/
+
+/* Extent */
+typedef struct {
+  uint32_t blk;                 /* First block                              */
+  uint32_t num;                 /* Number of blocks                         */
+  uint32_t ofs;                 /* File offset of the first byte            */
+} ramfs_extent_t;
+
+/* File */
+typedef struct {
+  char     name[RT_RAMFS_NAME_MAX];  /* File name, empty when not used */
+  uint32_t size;                /* File size in bytes                       */
+  uint32_t open;                /* Number of open handles                   */
+  uint32_t ext_num;             /* Number of extents                        */
+  ramfs_extent_t ext[RT_RAMFS_EXTENT_NUM];
+} ramfs_file_t;
+
+/* Open file handle */
+typedef struct {
+  uint32_t used;                /* Handle in use                            */
+  uint32_t file;                /* File index                               */
+  uint32_t pos;                 /* File position                            */
+  uint32_t rd;                  /* Opened for reading                       */
+  uint32_t wr;                  /* Opened for writing                       */
+  uint32_t append;              /* Opened in append mode                    */
+  uint32_t ext;                 /* Extent of the last access                */
+} ramfs_handle_t;
+
+/* File descriptor: index into the handle table plus RAMFS_FD_BASE, so that
+   descriptors never collide with the standard stream handles 0 to 2 */
+#define RAMFS_FD_BASE           3
+#define ramfs_fd_make(idx)      ((int32_t)(idx) + RAMFS_FD_BASE)
+#define ramfs_fd_index(fd)      ((fd) - RAMFS_FD_BASE)
+
+/* Name table entry values */
+#define HASH_FREE               0x00U
+#define HASH_DELETED            0xFFU
+
+static uint64_t       ramfs_mem[(RAMFS_BLOCK_NUM * RT_RAMFS_BLOCK_SIZE + 7) / 8];
+static uint32_t       ramfs_bmp[(RAMFS_BLOCK_NUM + 31) / 32];
+static uint32_t       ramfs_next;
+static ramfs_file_t   ramfs_file[RT_RAMFS_FILE_NUM];
+static ramfs_handle_t ramfs_handle[RT_RAMFS_OPEN_NUM];
+static uint8_t        ramfs_hash[RT_RAMFS_HASH_NUM];
+static uint32_t       ramfs_dir[RT_RAMFS_DIR_NUM];  /* Next file index + 1, 0: not used */
+
+#define RAMFS_DATA(blk)         (&((uint8_t *)ramfs_mem)[(blk) * RT_RAMFS_BLOCK_SIZE])
+
+#if defined(RTE_CMSIS_RTOS2)
+static osMutexId_t ramfs_mutex;
+#endif
+
+/* Lock the file system */
+static void ramfs_lock (void) {
+#if defined(RTE_CMSIS_RTOS2)
+  if (osKernelGetState() == osKernelRunning) {
+    if (ramfs_mutex == NULL) {
+      /* Create mutex on first use */
+      osKernelLock();
+      if (ramfs_mutex == NULL) {
+        ramfs_mutex = osMutexNew(NULL);
+      }
+      osKernelUnlock();
+    }
+    if (ramfs_mutex != NULL) {
+      osMutexAcquire(ramfs_mutex, osWaitForever);
+    }
+  }
+#endif
+}
+
+/* Unlock the file system */
+static void ramfs_unlock (void) {
+#if defined(RTE_CMSIS_RTOS2)
+  if (ramfs_mutex != NULL) {
+    osMutexRelease(ramfs_mutex);
+  }
+#endif
+}
+
+/* Remove drive prefix and leading slashes, an empty result is the root directory */
+static const char *name_skip (const char *path) {
+  const char *p;
+
+  p = strchr(path, ':');
+  if ((p != NULL) && ((p - path) <= 2)) {
+    path = p + 1;
+  }
+  while (*path == '/') {
+    path++;
+  }
+  return (path);
+}
+
+/* Get the file name of a path, return NULL for an invalid name */
+static const char *name_get (const char *path) {
+  size_t len;
+
+  if (path == NULL) {
+    return (NULL);
+  }
+  path = name_skip(path);
+
+  len = strlen(path);
+  if ((len == 0U) || (len >= RT_RAMFS_NAME_MAX)) {
+    return (NULL);
+  }
+  return (path);
+}
+
+/* Hash of a file name (FNV-1a) */
+static uint32_t name_hash (const char *name) {
+  uint32_t h = 2166136261U;
+
+  while (*name != '\0') {
+    h ^= (uint8_t)*name++;
+    h *= 16777619U;
+  }
+  return (h);
+}
+
+/* Find the name table entry of a file, return entry index or -1 */
+static int32_t hash_find (const char *name) {
+  uint32_t i, n;
+  uint8_t  v;
+
+  i = name_hash(name);
+  for (n = 0U; n < RT_RAMFS_HASH_NUM; n++, i++) {
+    v = ramfs_hash[i & (RT_RAMFS_HASH_NUM - 1U)];
+    if (v == HASH_FREE) {
+      break;
+    }
+    if ((v != HASH_DELETED) && (strcmp(ramfs_file[v - 1U].name, name) == 0)) {
+      return ((int32_t)(i & (RT_RAMFS_HASH_NUM - 1U)));
+    }
+  }
+  return (-1);
+}
+
+/* Enter a file into the name table (a free entry always exists) */
+static void hash_insert (const char *name, uint32_t file) {
+  uint32_t i;
+
+  i = name_hash(name);
+  while ((ramfs_hash[i & (RT_RAMFS_HASH_NUM - 1U)] != HASH_FREE) &&
+         (ramfs_hash[i & (RT_RAMFS_HASH_NUM - 1U)] != HASH_DELETED)) {
+    i++;
+  }
+  ramfs_hash[i & (RT_RAMFS_HASH_NUM - 1U)] = (uint8_t)(file + 1U);
+}
+
+/* Remove an entry from the name table */
+static void hash_remove (int32_t idx) {
+
+  if (ramfs_hash[(idx + 1) & (RT_RAMFS_HASH_NUM - 1)] == HASH_FREE) {
+    /* End of a probe sequence */
+    ramfs_hash[idx] = HASH_FREE;
+  } else {
+    ramfs_hash[idx] = HASH_DELETED;
+  }
+}
+
+/* Check if a block is free */
+static uint32_t block_free (uint32_t blk) {
+  return (((ramfs_bmp[blk / 32U] & (1UL << (blk % 32U))) == 0U) ? 1U : 0U);
+}
+
+/* Mark blocks allocated or free */
+static void block_mark (uint32_t blk, uint32_t num, uint32_t used) {
+
+  for (; num != 0U; num--, blk++) {
+    if (used != 0U) {
+      ramfs_bmp[blk / 32U] |=  (1UL << (blk % 32U));
+    } else {
+      ramfs_bmp[blk / 32U] &= ~(1UL << (blk % 32U));
+    }
+  }
+}
+
+/* Allocate a run of up to num consecutive blocks, return number of blocks allocated */
+static uint32_t block_alloc (uint32_t num, uint32_t *blk) {
+  uint32_t i, b, n;
+
+  /* Next fit: search starts after the previous allocation */
+  for (i = 0U; i < RAMFS_BLOCK_NUM; i++) {
+    b = (ramfs_next + i) % RAMFS_BLOCK_NUM;
+    if (block_free(b) != 0U) {
+      for (n = 1U; (n < num) && ((b + n) < RAMFS_BLOCK_NUM) && (block_free(b + n) != 0U); n++);
+      block_mark(b, n, 1U);
+      ramfs_next = (b + n) % RAMFS_BLOCK_NUM;
+      *blk = b;
+      return (n);
+    }
+  }
+  return (0U);
+}
+
+/* Release all blocks of a file */
+static void file_free (ramfs_file_t *f) {
+  uint32_t i;
+
+  for (i = 0U; i < f->ext_num; i++) {
+    block_mark(f->ext[i].blk, f->ext[i].num, 0U);
+  }
+  f->ext_num = 0U;
+  f->size    = 0U;
+}
+
+/* Allocated size of a file in bytes */
+static uint32_t file_capacity (const ramfs_file_t *f) {
+  const ramfs_extent_t *e;
+
+  if (f->ext_num == 0U) {
+    return (0U);
+  }
+  e = &f->ext[f->ext_num - 1U];
+  return (e->ofs + (e->num * RT_RAMFS_BLOCK_SIZE));
+}
+
+/* Allocate blocks for file data up to end, return allocated size */
+static uint32_t file_grow (ramfs_file_t *f, uint32_t end) {
+  ramfs_extent_t *e;
+  uint32_t cap, num, want, n, blk;
+
+  cap = file_capacity(f);
+  while (cap < end) {
+    num = ((end - cap) + (RT_RAMFS_BLOCK_SIZE - 1U)) / RT_RAMFS_BLOCK_SIZE;
+
+    if (f->ext_num != 0U) {
+      /* Extend the last extent in place */
+      e = &f->ext[f->ext_num - 1U];
+      for (n = 0U; (n < num) && ((e->blk + e->num) < RAMFS_BLOCK_NUM) && (block_free(e->blk + e->num) != 0U); n++) {
+        block_mark(e->blk + e->num, 1U, 1U);
+        e->num++;
+      }
+      cap += n * RT_RAMFS_BLOCK_SIZE;
+      if (n == num) {
+        break;
+      }
+      num -= n;
+    }
+
+    if (f->ext_num == RT_RAMFS_EXTENT_NUM) {
+      break;
+    }
+
+    /* New extent, at least the size of the previous one */
+    want = num;
+    if ((f->ext_num != 0U) && (f->ext[f->ext_num - 1U].num > want)) {
+      want = f->ext[f->ext_num - 1U].num;
+    }
+    n = block_alloc(want, &blk);
+    if (n == 0U) {
+      break;
+    }
+    e = &f->ext[f->ext_num++];
+    e->blk = blk;
+    e->num = n;
+    e->ofs = cap;
+    cap += n * RT_RAMFS_BLOCK_SIZE;
+  }
+  return (cap);
+}
+
+/* Find the extent holding a file offset (below the allocated size), starting at a hint */
+static uint32_t extent_find (const ramfs_file_t *f, uint32_t ofs, uint32_t hint) {
+  const ramfs_extent_t *e;
+  uint32_t lo, hi, mid;
+
+  /* Sequential access stays in the same or moves to the next extent */
+  for (mid = hint; (mid < f->ext_num) && (mid <= (hint + 1U)); mid++) {
+    e = &f->ext[mid];
+    if ((ofs >= e->ofs) && (ofs < (e->ofs + (e->num * RT_RAMFS_BLOCK_SIZE)))) {
+      return (mid);
+    }
+  }
+
+  /* Binary search: last extent starting at or before ofs */
+  lo = 0U;
+  hi = f->ext_num - 1U;
+  while (lo < hi) {
+    mid = (lo + hi + 1U) / 2U;
+    if (f->ext[mid].ofs <= ofs) {
+      lo = mid;
+    } else {
+      hi = mid - 1U;
+    }
+  }
+  return (lo);
+}
+
+/* Copy data between a buffer and a file at the handle position */
+static void file_copy (ramfs_handle_t *h, uint8_t *buf, uint32_t cnt, uint32_t wr) {
+  const ramfs_file_t *f = &ramfs_file[h->file];
+  const ramfs_extent_t *e;
+  uint32_t ofs, n;
+
+  while (cnt != 0U) {
+    h->ext = extent_find(f, h->pos, h->ext);
+    e   = &f->ext[h->ext];
+    ofs = h->pos - e->ofs;
+    n   = (e->num * RT_RAMFS_BLOCK_SIZE) - ofs;
+    if (n > cnt) {
+      n = cnt;
+    }
+    if (wr != 0U) {
+      if (buf != NULL) {
+        memcpy(RAMFS_DATA(e->blk) + ofs, buf, n);
+      } else {
+        memset(RAMFS_DATA(e->blk) + ofs, 0, n);
+      }
+    } else {
+      memcpy(buf, RAMFS_DATA(e->blk) + ofs, n);
+    }
+    if (buf != NULL) {
+      buf += n;
+    }
+    h->pos += n;
+    cnt    -= n;
+  }
+}
+
+/* Get handle of an open file */
+static ramfs_handle_t *handle_get (int32_t fd) {
+
+  if ((fd < RAMFS_FD_BASE) || (ramfs_fd_index(fd) >= RT_RAMFS_OPEN_NUM) ||
+      (ramfs_handle[ramfs_fd_index(fd)].used == 0U)) {
+    return (NULL);
+  }
+  return (&ramfs_handle[ramfs_fd_index(fd)]);
+}
+
+/* Write to a file at the handle position */
+static int32_t handle_write (ramfs_handle_t *h, const void *buf, uint32_t cnt) {
+  ramfs_file_t *f = &ramfs_file[h->file];
+  uint32_t cap, pos;
+
+  if (h->wr == 0U) {
+    return (RT_ERR_INVAL);
+  }
+  if (h->append != 0U) {
+    h->pos = f->size;
+  }
+  if (cnt > (UINT32_MAX - h->pos)) {
+    cnt = UINT32_MAX - h->pos;
+  }
+  if (cnt > INT32_MAX) {
+    cnt = INT32_MAX;
+  }
+  if (cnt == 0U) {
+    return (0);
+  }
+
+  cap = file_grow(f, h->pos + cnt);
+  if (cap <= h->pos) {
+    return (RT_ERR_NOSPACE);
+  }
+  if (cnt > (cap - h->pos)) {
+    cnt = cap - h->pos;
+  }
+
+  if (h->pos > f->size) {
+    /* Fill the gap after the end of file */
+    pos    = h->pos;
+    h->pos = f->size;
+    file_copy(h, NULL, pos - f->size, 1U);
+  }
+  file_copy(h, (uint8_t *)(uintptr_t)buf, cnt, 1U);
+
+  if (f->size < h->pos) {
+    f->size = h->pos;
+  }
+  return ((int32_t)cnt);
+}
+
+/* Read from a file at the handle position */
+static int32_t handle_read (ramfs_handle_t *h, void *buf, uint32_t cnt) {
+  const ramfs_file_t *f = &ramfs_file[h->file];
+
+  if (h->rd == 0U) {
+    return (RT_ERR_INVAL);
+  }
+  if (h->pos >= f->size) {
+    return (0);
+  }
+  if (cnt > (f->size - h->pos)) {
+    cnt = f->size - h->pos;
+  }
+  if (cnt > INT32_MAX) {
+    cnt = INT32_MAX;
+  }
+  file_copy(h, buf, cnt, 0U);
+
+  return ((int32_t)cnt);
+}
+
+/* Open a file */
+int32_t rt_fs_open (const char *path, int32_t mode) {
+  const char *name;
+  ramfs_file_t *f;
+  ramfs_handle_t *h;
+  int32_t idx, fd;
+  uint32_t i, acc;
+
+  name = name_get(path);
+  if (name == NULL) {
+    return (RT_ERR_INVAL);
+  }
+  acc = (uint32_t)mode & (RT_OPEN_RDONLY | RT_OPEN_WRONLY | RT_OPEN_RDWR);
+
+  ramfs_lock();
+
+  /* Free handle */
+  fd = RT_ERR_MAXFILES;
+  for (i = 0U; i < RT_RAMFS_OPEN_NUM; i++) {
+    if (ramfs_handle[i].used == 0U) {
+      fd = ramfs_fd_make(i);
+      break;
+    }
+  }
+
+  f   = NULL;
+  idx = hash_find(name);
+  if (idx >= 0) {
+    if ((mode & (RT_OPEN_CREATE | RT_OPEN_EXCL)) == (RT_OPEN_CREATE | RT_OPEN_EXCL)) {
+      fd = RT_ERR_EXIST;
+    } else
+    if (fd >= 0) {
+      f = &ramfs_file[ramfs_hash[idx] - 1U];
+    }
+  } else
+  if ((mode & RT_OPEN_CREATE) == 0) {
+    fd = RT_ERR_NOTFOUND;
+  } else
+  if (fd >= 0) {
+    for (i = 0U; i < RT_RAMFS_FILE_NUM; i++) {
+      if (ramfs_file[i].name[0] == '\0') {
+        f = &ramfs_file[i];
+        strcpy(f->name, name);
+        f->size    = 0U;
+        f->open    = 0U;
+        f->ext_num = 0U;
+        hash_insert(name, i);
+        break;
+      }
+    }
+    if (f == NULL) {
+      fd = RT_ERR_MAXFILES;
+    }
+  }
+
+  if (f != NULL) {
+    h = &ramfs_handle[ramfs_fd_index(fd)];
+    h->used   = 1U;
+    h->file   = (uint32_t)(f - ramfs_file);
+    h->rd     = (acc != RT_OPEN_WRONLY) ? 1U : 0U;
+    h->wr     = ((acc != RT_OPEN_RDONLY) || ((mode & RT_OPEN_APPEND) != 0)) ? 1U : 0U;
+    h->append = ((mode & RT_OPEN_APPEND) != 0) ? 1U : 0U;
+    h->ext    = 0U;
+
+    if (((mode & RT_OPEN_TRUNCATE) != 0) && (h->wr != 0U)) {
+      file_free(f);
+    }
+    h->pos = (h->append != 0U) ? f->size : 0U;
+    f->open++;
+  }
+
+  ramfs_unlock();
+
+  return (fd);
+}
+
+/* Close a file */
+int32_t rt_fs_close (int32_t fd) {
+  ramfs_handle_t *h;
+  int32_t rval;
+
+  ramfs_lock();
+  h = handle_get(fd);
+  if (h != NULL) {
+    ramfs_file[h->file].open--;
+    h->used = 0U;
+    rval = 0;
+  } else {
+    rval = RT_ERR_INVAL;
+  }
+  ramfs_unlock();
+
+  return (rval);
+}
+
+/* Write to a file */
+int32_t rt_fs_write (int32_t fd, const void *buf, uint32_t cnt) {
+  ramfs_handle_t *h;
+  int32_t rval;
+
+  ramfs_lock();
+  h = handle_get(fd);
+  rval = (h != NULL) ? handle_write(h, buf, cnt) : RT_ERR_INVAL;
+  ramfs_unlock();
+
+  return (rval);
+}
+
+/* Read from a file */
+int32_t rt_fs_read (int32_t fd, void *buf, uint32_t cnt) {
+  ramfs_handle_t *h;
+  int32_t rval;
+
+  ramfs_lock();
+  h = handle_get(fd);
+  rval = (h != NULL) ? handle_read(h, buf, cnt) : RT_ERR_INVAL;
+  ramfs_unlock();
+
+  return (rval);
+}
+
+/* Move the file position pointer */
+int64_t rt_fs_seek (int32_t fd, int64_t offset, int32_t whence) {
+  ramfs_handle_t *h;
+  int64_t pos;
+
+  ramfs_lock();
+  h = handle_get(fd);
+  if (h == NULL) {
+    pos = RT_ERR_INVAL;
+  } else {
+    if      (whence == RT_SEEK_SET) { pos = 0;                                  }
+    else if (whence == RT_SEEK_CUR) { pos = (int64_t)h->pos;                    }
+    else if (whence == RT_SEEK_END) { pos = (int64_t)ramfs_file[h->file].size;  }
+    else                            { pos = -1;                                 }
+
+    if ((pos >= 0) && (offset >= -pos) && (offset <= ((int64_t)UINT32_MAX - pos))) {
+      /* The extent is found on the next access */
+      pos   += offset;
+      h->pos = (uint32_t)pos;
+    } else {
+      pos = RT_ERR_INVAL;
+    }
+  }
+  ramfs_unlock();
+
+  return (pos);
+}
+
+/* Get file size */
+int64_t rt_fs_size (int32_t fd) {
+  ramfs_handle_t *h;
+  int64_t sz;
+
+  ramfs_lock();
+  h = handle_get(fd);
+  sz = (h != NULL) ? (int64_t)ramfs_file[h->file].size : RT_ERR_INVAL;
+  ramfs_unlock();
+
+  return (sz);
+}
+
+/* Get file status information */
+int32_t rt_fs_stat (int32_t fd, rt_fs_stat_t *stat) {
+  ramfs_handle_t *h;
+  int32_t rval;
+
+  if (stat == NULL) {
+    return (RT_ERR_INVAL);
+  }
+
+  ramfs_lock();
+  h = handle_get(fd);
+  if (h != NULL) {
+    /* No real-time clock: times are zero */
+    memset(stat, 0, sizeof(rt_fs_stat_t));
+    stat->attr     = RT_ATTR_FILE;
+    stat->blksize  = RT_RAMFS_BLOCK_SIZE;
+    stat->blkcount = file_capacity(&ramfs_file[h->file]) / RT_RAMFS_BLOCK_SIZE;
+    rval = 0;
+  } else {
+    rval = RT_ERR_INVAL;
+  }
+  ramfs_unlock();
+
+  return (rval);
+}
+
+/* Remove a file */
+int32_t rt_fs_remove (const char *path) {
+  const char *name;
+  ramfs_file_t *f;
+  int32_t idx, rval;
+
+  name = name_get(path);
+  if (name == NULL) {
+    return (RT_ERR_INVAL);
+  }
+
+  ramfs_lock();
+  idx = hash_find(name);
+  if (idx < 0) {
+    rval = RT_ERR_NOTFOUND;
+  } else {
+    f = &ramfs_file[ramfs_hash[idx] - 1U];
+    if (f->open != 0U) {
+      rval = RT_ERR_BUSY;
+    } else {
+      file_free(f);
+      f->name[0] = '\0';
+      hash_remove(idx);
+      rval = 0;
+    }
+  }
+  ramfs_unlock();
+
+  return (rval);
+}
+
+/* Rename a file */
+int32_t rt_fs_rename (const char *oldpath, const char *newpath) {
+  const char *name_old, *name_new;
+  ramfs_file_t *f;
+  int32_t idx, rval;
+
+  name_old = name_get(oldpath);
+  name_new = name_get(newpath);
+  if ((name_old == NULL) || (name_new == NULL)) {
+    return (RT_ERR_INVAL);
+  }
+
+  ramfs_lock();
+  idx = hash_find(name_old);
+  if (idx < 0) {
+    rval = RT_ERR_NOTFOUND;
+  } else
+  if (strcmp(name_old, name_new) == 0) {
+    rval = 0;
+  } else
+  if (hash_find(name_new) >= 0) {
+    rval = RT_ERR_EXIST;
+  } else {
+    f = &ramfs_file[ramfs_hash[idx] - 1U];
+    hash_remove(idx);
+    strcpy(f->name, name_new);
+    hash_insert(f->name, (uint32_t)(f - ramfs_file));
+    rval = 0;
+  }
+  ramfs_unlock();
+
+  return (rval);
+}
+
+/* Write cached data of a file to the file system */
+int32_t rt_fs_flush (int32_t fd) {
+  int32_t rval;
+
+  /* Nothing cached */
+  ramfs_lock();
+  rval = (handle_get(fd) != NULL) ? 0 : RT_ERR_INVAL;
+  ramfs_unlock();
+
+  return (rval);
+}
+
+/* Write cached data of a file and commit it to the storage medium */
+int32_t rt_fs_sync (int32_t fd) {
+
+  /* Data is kept in RAM only, there is nothing to commit */
+  return (rt_fs_flush(fd));
+}
+
+/* Get cache statistics */
+int32_t rt_fs_cache_get_stats (rt_fs_cache_stats_t *stats) {
+  (void)stats;
+
+  /* No cache */
+  return (RT_ERR_NOTSUP);
+}
+
+/* Map file data for reading */
+int32_t rt_fs_map (int32_t fd, int64_t offset, uint32_t len, const void **ptr) {
+  ramfs_handle_t *h;
+  const ramfs_file_t *f;
+  const ramfs_extent_t *e;
+  uint32_t ofs, x;
+  int32_t rval;
+
+  if ((ptr == NULL) || (offset < 0)) {
+    return (RT_ERR_INVAL);
+  }
+
+  ramfs_lock();
+  h = handle_get(fd);
+  if (h == NULL) {
+    rval = RT_ERR_INVAL;
+  } else {
+    f = &ramfs_file[h->file];
+    if (offset >= (int64_t)f->size) {
+      /* End of file */
+      rval = 0;
+    } else {
+      /* Data is mapped in place, up to the end of the extent */
+      ofs = (uint32_t)offset;
+      x   = extent_find(f, ofs, h->ext);
+      e   = &f->ext[x];
+      if (len > ((e->ofs + (e->num * RT_RAMFS_BLOCK_SIZE)) - ofs)) {
+        len = (e->ofs + (e->num * RT_RAMFS_BLOCK_SIZE)) - ofs;
+      }
+      if (len > (f->size - ofs)) {
+        len = f->size - ofs;
+      }
+      if (len > INT32_MAX) {
+        len = INT32_MAX;
+      }
+      *ptr = RAMFS_DATA(e->blk) + (ofs - e->ofs);
+      rval = (int32_t)len;
+    }
+  }
+  ramfs_unlock();
+
+  return (rval);
+}
+
+/* Release mapped file data */
+int32_t rt_fs_unmap (int32_t fd, const void *ptr) {
+  const uint8_t *p = ptr;
+
+  (void)fd;
+
+  if ((p < (const uint8_t *)ramfs_mem) || (p >= ((const uint8_t *)ramfs_mem + sizeof(ramfs_mem)))) {
+    return (RT_ERR_INVAL);
+  }
+  /* Nothing to release */
+  return (0);
+}
+
+/* Write segments to a file */
+int32_t rt_fs_writev (int32_t fd, const rt_fs_iovec_t *iov, uint32_t iovcnt) {
+  ramfs_handle_t *h;
+  uint32_t i, n;
+  int32_t rval;
+
+  if ((iov == NULL) && (iovcnt != 0U)) {
+    return (RT_ERR_INVAL);
+  }
+
+  ramfs_lock();
+  h = handle_get(fd);
+  rval = (h != NULL) ? 0 : RT_ERR_INVAL;
+  for (i = 0U, n = 0U; (h != NULL) && (i < iovcnt); i++) {
+    if (iov[i].len > ((uint32_t)INT32_MAX - n)) {
+      break;
+    }
+    rval = handle_write(h, iov[i].base, iov[i].len);
+    if (rval < 0) {
+      break;
+    }
+    n += (uint32_t)rval;
+    if ((uint32_t)rval != iov[i].len) {
+      break;
+    }
+  }
+  ramfs_unlock();
+
+  if ((h != NULL) && ((n != 0U) || (rval >= 0))) {
+    /* Return number of bytes written */
+    rval = (int32_t)n;
+  }
+  return (rval);
+}
+
+/* Read from a file into segments */
+int32_t rt_fs_readv (int32_t fd, const rt_fs_iovec_t *iov, uint32_t iovcnt) {
+  ramfs_handle_t *h;
+  uint32_t i, n;
+  int32_t rval;
+
+  if ((iov == NULL) && (iovcnt != 0U)) {
+    return (RT_ERR_INVAL);
+  }
+
+  ramfs_lock();
+  h = handle_get(fd);
+  rval = (h != NULL) ? 0 : RT_ERR_INVAL;
+  for (i = 0U, n = 0U; (h != NULL) && (i < iovcnt); i++) {
+    if (iov[i].len > ((uint32_t)INT32_MAX - n)) {
+      break;
+    }
+    rval = handle_read(h, iov[i].base, iov[i].len);
+    if (rval < 0) {
+      break;
+    }
+    n += (uint32_t)rval;
+    if ((uint32_t)rval != iov[i].len) {
+      break;
+    }
+  }
+  ramfs_unlock();
+
+  if ((h != NULL) && ((n != 0U) || (rval >= 0))) {
+    /* Return number of bytes read */
+    rval = (int32_t)n;
+  }
+  return (rval);
+}
+
+/* Create a directory */
+int32_t rt_fs_mkdir (const char *path) {
+  (void)path;
+
+  /* Flat name space */
+  return (RT_ERR_NOTSUP);
+}
+
+/* Remove an empty directory */
+int32_t rt_fs_rmdir (const char *path) {
+  (void)path;
+
+  /* Flat name space */
+  return (RT_ERR_NOTSUP);
+}
+
+/* Open a directory */
+int32_t rt_fs_opendir (const char *path) {
+  const char *name;
+  int32_t dd;
+
+  if (path == NULL) {
+    return (RT_ERR_INVAL);
+  }
+
+  ramfs_lock();
+  name = name_get(path);
+  if (name != NULL) {
+    /* Only the root directory exists */
+    dd = (hash_find(name) >= 0) ? RT_ERR_NOTDIR : RT_ERR_NOTFOUND;
+  } else
+  if (*name_skip(path) != '\0') {
+    dd = RT_ERR_INVAL;
+  } else {
+    for (dd = 0; dd < RT_RAMFS_DIR_NUM; dd++) {
+      if (ramfs_dir[dd] == 0U) {
+        ramfs_dir[dd] = 1U;
+        break;
+      }
+    }
+    if (dd == RT_RAMFS_DIR_NUM) {
+      dd = RT_ERR_MAXFILES;
+    }
+  }
+  ramfs_unlock();
+
+  return (dd);
+}
+
+/* Read the next directory entry */
+int32_t rt_fs_readdir (int32_t dd, rt_fs_dirent_t *ent) {
+  const ramfs_file_t *f;
+  int32_t rval;
+
+  if ((dd < 0) || (dd >= RT_RAMFS_DIR_NUM) || (ent == NULL)) {
+    return (RT_ERR_INVAL);
+  }
+
+  ramfs_lock();
+  if (ramfs_dir[dd] == 0U) {
+    rval = RT_ERR_INVAL;
+  } else {
+    rval = 0;
+    while ((ramfs_dir[dd] - 1U) < RT_RAMFS_FILE_NUM) {
+      f = &ramfs_file[ramfs_dir[dd] - 1U];
+      ramfs_dir[dd]++;
+      if (f->name[0] != '\0') {
+        memset(ent, 0, sizeof(rt_fs_dirent_t));
+        strncpy(ent->name, f->name, RT_FS_NAME_MAX - 1U);
+        ent->attr = RT_ATTR_FILE;
+        ent->size = (int64_t)f->size;
+        rval = 1;
+        break;
+      }
+    }
+  }
+  ramfs_unlock();
+
+  return (rval);
+}
+
+/* Close a directory */
+int32_t rt_fs_closedir (int32_t dd) {
+  int32_t rval;
+
+  if ((dd < 0) || (dd >= RT_RAMFS_DIR_NUM)) {
+    return (RT_ERR_INVAL);
+  }
+
+  ramfs_lock();
+  rval = (ramfs_dir[dd] != 0U) ? 0 : RT_ERR_INVAL;
+  ramfs_dir[dd] = 0U;
+  ramfs_unlock();
+
+  return (rval);
+}
+
+/* Get the directory entry of a path */
+int32_t rt_fs_lookup (const char *path, rt_fs_dirent_t *ent) {
+  const char *name;
+  int32_t idx, rval;
+
+  if ((path == NULL) || (ent == NULL)) {
+    return (RT_ERR_INVAL);
+  }
+
+  memset(ent, 0, sizeof(rt_fs_dirent_t));
+
+  name = name_get(path);
+  if (name == NULL) {
+    if (*name_skip(path) != '\0') {
+      return (RT_ERR_INVAL);
+    }
+    /* Root directory */
+    ent->attr = RT_ATTR_DIR;
+    return (0);
+  }
+
+  /* Names are found through the hash table */
+  ramfs_lock();
+  idx = hash_find(name);
+  if (idx >= 0) {
+    strncpy(ent->name, name, RT_FS_NAME_MAX - 1U);
+    ent->attr = RT_ATTR_FILE;
+    ent->size = (int64_t)ramfs_file[ramfs_hash[idx] - 1U].size;
+    rval = 0;
+  } else {
+    rval = RT_ERR_NOTFOUND;
+  }
+  ramfs_unlock();
+
+  return (rval);
+}
+
+int32_t rt_fs_invalidate (const char *path) {
+  (void)path;
+
+  /* Lookups are not cached */
+  return (0);
+}
+
+#if defined(RT_FS_VFS)
+/* Operations for rt_vfs_mount */
+RT_FS_VFS_OPS(ramfs);
+#endif
@@ -0,0 +1,85 @@
+/*---------------------------------------------------------------------------
+ * Copyright (c) 2023 Arm Limited (or its affiliates). All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *      Name:    retarget_rename.c
+ *      Purpose: Library rename function retargeted to rt_fs_rename
+ *
+ *---------------------------------------------------------------------------*/
+
+#include <errno.h>
+
+#include "RTE_Components.h"
+#include "retarget_fs.h"
+#include "retarget_errno.h"
+
+/*
+  newlib implements rename with _link followed by _unlink. File systems
+  without hard links (FAT) can only emulate _link with a copy of the file,
+  so every rename copies the file data and writes directory entries twice.
+  Newlib calls _rename_r from rename; providing it here replaces the
+  emulation with a single rt_fs_rename call.
+
+  Arm Compiler and IAR libraries call the low-level function rename
+  directly. It is implemented here only when the CMSIS-Compiler I/O File
+  component, which provides it, is not used.
+*/
+
+#if (defined(__GNUC__) && !defined(__ARMCC_VERSION)) || !defined(RTE_Compiler_IO_File)
+
+#if defined(__GNUC__) && !defined(__ARMCC_VERSION)
+
+#include <sys/reent.h>
+
+extern int _rename_r (struct _reent *r, const char *oldpath, const char *newpath);
+extern int _rename   (const char *oldpath, const char *newpath);
+
+/* Rename a file (reentrant) */
+int _rename_r (struct _reent *r, const char *oldpath, const char *newpath) {
+  int32_t rval;
+
+  rval = rt_fs_rename(oldpath, newpath);
+  if (rval < 0) {
+    r->_errno = rt_rval_to_errno(rval);
+    return (-1);
+  }
+  return (0);
+}
+
+/* Rename a file */
+int _rename (const char *oldpath, const char *newpath) {
+  return (_rename_r(_REENT, oldpath, newpath));
+}
+
+#elif !defined(RTE_Compiler_IO_File)
+
+#include <stdio.h>
+
+/* Rename a file */
+int rename (const char *oldpath, const char *newpath) {
+  int32_t rval;
+
+  rval = rt_fs_rename(oldpath, newpath);
+  if (rval < 0) {
+    errno = rt_rval_to_errno(rval);
+    return (-1);
+  }
+  return (0);
+}
+
+#endif
+
+#endif
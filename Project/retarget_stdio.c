@@ -22,31 +22,932 @@
 
 #include "RTE_Components.h"
 
+/* Define RETARGET_IO_USART to retarget stdio to the CMSIS-Driver USART */
+#if !defined(RETARGET_IO_USART)
 #define RETARGET_IO_User_Stub
+#endif
 
 #if (defined(RTE_Compiler_IO_STDERR) && defined(RTE_Compiler_IO_STDERR_User)) || \
     (defined(RTE_Compiler_IO_STDIN)  && defined(RTE_Compiler_IO_STDIN_User))  || \
     (defined(RTE_Compiler_IO_STDOUT) && defined(RTE_Compiler_IO_STDOUT_User))
 
-/* Prototypes */
-int stdio_init     (void);
-int stderr_putchar (int ch);
-int stdout_putchar (int ch);
-int stdin_getchar  (void);
+#include "retarget_stdio.h"
 
 #if !defined(RETARGET_IO_User_Stub)
 
+#include <string.h>
+
 #include "Driver_USART.h"
+#include "cmsis_compiler.h"
+
+#if defined(RTE_CMSIS_RTOS2)
+#include "cmsis_os2.h"
+#endif
 
 #define USART_DRV_NUM           0
 #define USART_BAUDRATE          115200
 
+/* Size of the transmit ring buffer in bytes (must be a power of 2) */
+#ifndef STDIO_TX_BUF_SIZE
+#define STDIO_TX_BUF_SIZE       256
+#endif
+
+/* Size of the stderr transmit ring buffer in bytes (must be a power of 2) */
+#ifndef STDIO_ERR_BUF_SIZE
+#define STDIO_ERR_BUF_SIZE      64
+#endif
+
+/* Maximum number of stdout bytes passed with one Send call. Together with the
+   length of the stdout line in flight it bounds the time stderr output waits. */
+#ifndef STDIO_TX_CHUNK_SIZE
+#define STDIO_TX_CHUNK_SIZE     64
+#endif
+
+/* Size of the receive ring buffer in bytes (must be a power of 2) */
+#ifndef STDIO_RX_BUF_SIZE
+#define STDIO_RX_BUF_SIZE       64
+#endif
+
+/* Number of per-thread stdout staging buffers (0: disabled, requires CMSIS-RTOS2).
+   Threads that find no free staging buffer write directly to the ring buffer. */
+#ifndef STDIO_STAGE_NUM
+#if defined(RTE_CMSIS_RTOS2)
+#define STDIO_STAGE_NUM         4
+#else
+#define STDIO_STAGE_NUM         0
+#endif
+#endif
+
+/* Size of a staging buffer in bytes (longest line committed atomically) */
+#ifndef STDIO_STAGE_SIZE
+#define STDIO_STAGE_SIZE        128
+#endif
+
+/* Default output mode: STDIO_MODE_BLOCK or STDIO_MODE_DROP */
+#ifndef STDIO_TX_MODE
+#define STDIO_TX_MODE           STDIO_MODE_BLOCK
+#endif
+
+/* Longest time in kernel ticks a blocked thread waits before it checks the
+   buffer state again (bounds the delay of a missed wake-up) */
+#ifndef STDIO_WAIT_TIMEOUT
+#define STDIO_WAIT_TIMEOUT      10
+#endif
+
+#if ((STDIO_TX_BUF_SIZE & (STDIO_TX_BUF_SIZE - 1)) != 0)
+#error "STDIO_TX_BUF_SIZE must be a power of 2."
+#endif
+#if ((STDIO_ERR_BUF_SIZE & (STDIO_ERR_BUF_SIZE - 1)) != 0)
+#error "STDIO_ERR_BUF_SIZE must be a power of 2."
+#endif
+#if ((STDIO_RX_BUF_SIZE & (STDIO_RX_BUF_SIZE - 1)) != 0)
+#error "STDIO_RX_BUF_SIZE must be a power of 2."
+#endif
+#if (STDIO_TX_CHUNK_SIZE == 0)
+#error "STDIO_TX_CHUNK_SIZE must not be 0."
+#endif
+#if (STDIO_STAGE_NUM > 0) && !defined(RTE_CMSIS_RTOS2)
+#error "STDIO_STAGE_NUM requires CMSIS-RTOS2."
+#endif
+#if (STDIO_STAGE_SIZE > STDIO_TX_BUF_SIZE)
+#error "STDIO_STAGE_SIZE must not exceed STDIO_TX_BUF_SIZE."
+#endif
+
 #define _USART_Driver_(n)  Driver_USART##n
 #define  USART_Driver_(n) _USART_Driver_(n)
  
 extern ARM_DRIVER_USART  USART_Driver_(USART_DRV_NUM);
 #define ptrUSART       (&USART_Driver_(USART_DRV_NUM))
 
+/* Ring buffer: head and tail are free running indexes */
+typedef struct {
+  uint8_t          *buf;        /* Buffer memory                            */
+  uint32_t          mask;       /* Buffer size - 1                          */
+  volatile uint32_t head;       /* Write index, advanced by the producer    */
+  volatile uint32_t tail;       /* Read index, advanced by the consumer     */
+} stdio_ring_t;
+
+static uint8_t      tx_mem[STDIO_TX_BUF_SIZE];
+static stdio_ring_t tx_ring = { tx_mem, STDIO_TX_BUF_SIZE - 1U, 0U, 0U };
+
+static uint8_t      err_mem[STDIO_ERR_BUF_SIZE];
+static stdio_ring_t err_ring = { err_mem, STDIO_ERR_BUF_SIZE - 1U, 0U, 0U };
+
+static uint8_t      rx_mem[STDIO_RX_BUF_SIZE];
+static stdio_ring_t rx_ring = { rx_mem, STDIO_RX_BUF_SIZE - 1U, 0U, 0U };
+
+/* Number of bytes currently handed to the driver Send function */
+static volatile uint32_t tx_active;
+
+/* Ring buffer the active Send transfers from */
+static stdio_ring_t *tx_cur;
+
+/* Last stdout byte passed to the driver did not end a line */
+static uint8_t tx_line_open;
+
+/* Number of bytes currently requested with the driver Receive function */
+static volatile uint32_t rx_active;
+
+/* Maximum number of bytes requested with one Receive call */
+static uint32_t rx_chunk;
+
+/* Statistics */
+static stdio_stats_t stdio_stats;
+
+/* Output line state */
+#define STDIO_LINE_START        0U      /* At the beginning of a line       */
+#define STDIO_LINE_PARTIAL      1U      /* Line partially written           */
+#define STDIO_LINE_DROP         2U      /* Dropping the whole line          */
+#define STDIO_LINE_TRUNC        3U      /* Dropping the rest of the line    */
+
+/* Output stream state */
+typedef struct {
+  stdio_ring_t      *ring;      /* Transmit ring buffer                     */
+  uint8_t            mode;      /* STDIO_MODE_BLOCK or STDIO_MODE_DROP      */
+  uint8_t            line;      /* Output line state                        */
+  stdio_drop_stats_t drop;      /* Dropped data counters                    */
+} stdio_stream_t;
+
+static stdio_stream_t stdio_stream[2] = {
+  { &tx_ring,  STDIO_TX_MODE, STDIO_LINE_START, { 0U, 0U } },
+  { &err_ring, STDIO_TX_MODE, STDIO_LINE_START, { 0U, 0U } }
+};
+
+/* Event flags used to block the calling thread */
+#define STDIO_FLAG_TX           (1UL << 0)
+#define STDIO_FLAG_RX           (1UL << 1)
+
+#if defined(RTE_CMSIS_RTOS2)
+static osEventFlagsId_t stdio_evf;
+
+/**
+  Block the calling thread until one of the flags is set
+
+  Several threads may wait for the same flag, for example in stdout_flush.
+  Flags are therefore not cleared by the wait, which would release only the
+  first waiting thread, but by each woken thread before it checks the buffer
+  state again. A flag set after the check returns the next wait at once. A
+  thread that has checked the state and is preempted before waiting can
+  still miss a wake-up when another thread clears the flag meanwhile, the
+  wait is therefore limited to STDIO_WAIT_TIMEOUT ticks.
+*/
+static void stdio_wait (uint32_t flags) {
+
+  if ((__get_IPSR() == 0U) && (osKernelGetState() == osKernelRunning)) {
+    if (stdio_evf == NULL) {
+      /* Create event flags on first use, kernel is not running at stdio_init */
+      osKernelLock();
+      if (stdio_evf == NULL) {
+        stdio_evf = osEventFlagsNew(NULL);
+      }
+      osKernelUnlock();
+    }
+    if (stdio_evf != NULL) {
+      osEventFlagsWait(stdio_evf, flags, osFlagsWaitAny | osFlagsNoClear, STDIO_WAIT_TIMEOUT);
+      osEventFlagsClear(stdio_evf, flags);
+    }
+  }
+}
+
+/* Wake up threads waiting for one of the flags */
+static void stdio_signal (uint32_t flags) {
+
+  if (stdio_evf != NULL) {
+    osEventFlagsSet(stdio_evf, flags);
+  }
+}
+#else
+/* No RTOS: the caller busy waits */
+#define stdio_wait(flags)
+#define stdio_signal(flags)
+#endif
+
+/* Check if the stdout ring holds a new line character (interrupts disabled) */
+static uint32_t tx_line_end (void) {
+  uint32_t idx, cnt, n;
+
+  cnt = tx_ring.head - tx_ring.tail;
+  idx = tx_ring.tail & tx_ring.mask;
+  n   = tx_ring.mask + 1U - idx;
+  if (n > cnt) {
+    n = cnt;
+  }
+  if ((memchr(&tx_ring.buf[idx], '\n', n) != NULL) ||
+      (memchr(&tx_ring.buf[0],   '\n', cnt - n) != NULL)) {
+    return (1U);
+  }
+  return (0U);
+}
+
+/**
+  Start sending the next contiguous part of a ring (interrupts disabled)
+
+  Pending stderr data is sent first, but not within a stdout line: when the
+  last stdout byte sent did not end a line and the rest of the line is
+  already buffered, stdout is sent up to the end of that line before. A
+  stdout line that is still being written does not hold stderr back.
+
+  Stdout data is sent in chunks of at most STDIO_TX_CHUNK_SIZE bytes, so
+  that stderr overtakes the stdout backlog at the next line end. A limited
+  stdout chunk ends after the last complete line when possible.
+*/
+static void tx_start (void) {
+  stdio_ring_t *ring;
+  const uint8_t *nl;
+  uint32_t idx, cnt, n;
+
+  if (tx_active == 0U) {
+    ring = &tx_ring;
+    if ((err_ring.head != err_ring.tail) && ((tx_line_open == 0U) || (tx_line_end() == 0U))) {
+      ring = &err_ring;
+    }
+    cnt  = ring->head - ring->tail;
+
+    if (cnt != 0U) {
+      idx = ring->tail & ring->mask;
+
+      if (cnt > (ring->mask + 1U - idx)) {
+        /* Send up to the end of buffer memory, remainder follows */
+        cnt = ring->mask + 1U - idx;
+      }
+
+      if (ring == &err_ring) {
+        stdio_stats.err_bytes += cnt;
+      } else {
+        if (cnt > STDIO_TX_CHUNK_SIZE) {
+          cnt = STDIO_TX_CHUNK_SIZE;
+          for (n = cnt; n != 0U; n--) {
+            if (ring->buf[idx + n - 1U] == '\n') {
+              cnt = n;
+              break;
+            }
+          }
+        }
+        if (err_ring.head != err_ring.tail) {
+          /* Only finish the line in flight, stderr is waiting */
+          nl = memchr(&ring->buf[idx], '\n', cnt);
+          if (nl != NULL) {
+            cnt = (uint32_t)(nl - &ring->buf[idx]) + 1U;
+          }
+        }
+        tx_line_open = (ring->buf[idx + cnt - 1U] != '\n') ? 1U : 0U;
+      }
+
+      tx_cur    = ring;
+      tx_active = cnt;
+
+      stdio_stats.tx_bytes += cnt;
+      stdio_stats.send_calls++;
+
+      if (ptrUSART->Send(&ring->buf[idx], cnt) != ARM_DRIVER_OK) {
+        /* Driver rejected the data, discard it to prevent a lockup */
+        ring->tail += cnt;
+        tx_active = 0U;
+      }
+    }
+  }
+}
+
+/* Arm the receiver with the next contiguous free part of the ring (interrupts disabled) */
+static void rx_start (void) {
+  uint32_t idx, cnt;
+
+  if (rx_active == 0U) {
+    cnt = rx_ring.mask + 1U - (rx_ring.head - rx_ring.tail);
+
+    if (cnt != 0U) {
+      idx = rx_ring.head & rx_ring.mask;
+
+      if (cnt > (rx_ring.mask + 1U - idx)) {
+        cnt = rx_ring.mask + 1U - idx;
+      }
+      if (cnt > rx_chunk) {
+        cnt = rx_chunk;
+      }
+
+      if (ptrUSART->Receive(&rx_ring.buf[idx], cnt) == ARM_DRIVER_OK) {
+        rx_active = cnt;
+      }
+    }
+  }
+}
+
+/* Number of bytes available in the receive ring (interrupts disabled) */
+static uint32_t rx_count (void) {
+  uint32_t cnt;
+
+  cnt = rx_ring.head - rx_ring.tail;
+
+  if (rx_active != 0U) {
+    /* Include bytes already received by the pending Receive */
+    cnt += ptrUSART->GetRxCount();
+  }
+  return (cnt);
+}
+
+/* USART event callback */
+static void usart_event (uint32_t event) {
+
+  if ((event & ARM_USART_EVENT_SEND_COMPLETE) != 0U) {
+    tx_cur->tail += tx_active;
+    tx_active = 0U;
+
+    tx_start();
+    stdio_signal(STDIO_FLAG_TX);
+  }
+
+  if ((event & ARM_USART_EVENT_RECEIVE_COMPLETE) != 0U) {
+    rx_ring.head += rx_active;
+    stdio_stats.rx_bytes += rx_active;
+    rx_active = 0U;
+
+    rx_start();
+    stdio_signal(STDIO_FLAG_RX);
+  }
+
+  if ((event & ARM_USART_EVENT_RX_TIMEOUT) != 0U) {
+    /* Partially filled receive buffer, wake up the reader */
+    stdio_signal(STDIO_FLAG_RX);
+  }
+
+  if ((event & ARM_USART_EVENT_RX_OVERFLOW) != 0U) {
+    stdio_stats.rx_overflows++;
+  }
+}
+
+/* Put data into a transmit ring, cnt must not exceed free space (interrupts disabled) */
+static void tx_put (stdio_ring_t *ring, const uint8_t *buf, uint32_t cnt) {
+  uint32_t idx, n;
+
+  idx = ring->head & ring->mask;
+  n   = ring->mask + 1U - idx;
+  if (n > cnt) {
+    n = cnt;
+  }
+  memcpy(&ring->buf[idx], &buf[0], n);
+  memcpy(&ring->buf[0],   &buf[n], cnt - n);
+
+  ring->head += cnt;
+}
+
+/**
+  Copy data into the transmit ring buffer (blocking mode)
+
+  Data is copied in contiguous blocks and transmission is triggered once per
+  block. The calling thread is blocked only when the ring buffer is full.
+
+  \param[in]   strm  Stream state
+  \param[in]   buf   Data to output
+  \param[in]   len   Number of bytes to output
+  \return           Number of bytes written.
+*/
+static uint32_t tx_write_block (stdio_stream_t *strm, const uint8_t *buf, uint32_t len) {
+  stdio_ring_t *ring = strm->ring;
+  uint32_t primask;
+  uint32_t num, cnt;
+
+  num = 0U;
+
+  while (num < len) {
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    cnt = ring->mask + 1U - (ring->head - ring->tail);
+    if (cnt > (len - num)) {
+      cnt = len - num;
+    }
+
+    if (cnt != 0U) {
+      tx_put(ring, &buf[num], cnt);
+      num += cnt;
+
+      tx_start();
+    }
+
+    __set_PRIMASK(primask);
+
+    if (cnt == 0U) {
+      stdio_wait(STDIO_FLAG_TX);
+    }
+  }
+
+  if (len != 0U) {
+    strm->line = (buf[len - 1U] == '\n') ? STDIO_LINE_START : STDIO_LINE_PARTIAL;
+  }
+
+  return (num);
+}
+
+/**
+  Copy data into the transmit ring buffer (drop-on-full mode)
+
+  The caller is never blocked. A line that does not fit into the ring buffer
+  is dropped as a whole when it starts in this call, otherwise it is
+  truncated and terminated with a new line character when space permits.
+
+  \param[in]   strm  Stream state
+  \param[in]   buf   Data to output
+  \param[in]   len   Number of bytes to output
+  \return           Number of bytes consumed (written or dropped).
+*/
+static uint32_t tx_write_drop (stdio_stream_t *strm, const uint8_t *buf, uint32_t len) {
+  stdio_ring_t *ring = strm->ring;
+  const uint8_t *nl;
+  uint32_t primask;
+  uint32_t num, len_seg, seg, cnt;
+
+  num = 0U;
+
+  while (num < len) {
+    /* Segment up to and including the next new line character */
+    nl  = memchr(&buf[num], '\n', len - num);
+    seg = (nl != NULL) ? ((uint32_t)(nl - &buf[num]) + 1U) : (len - num);
+    len_seg = seg;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    cnt = ring->mask + 1U - (ring->head - ring->tail);
+
+    if ((strm->line == STDIO_LINE_START) || (strm->line == STDIO_LINE_PARTIAL)) {
+      /* Unterminated data must leave space for a terminating new line */
+      if ((seg < cnt) || ((seg == cnt) && (nl != NULL))) {
+        tx_put(ring, &buf[num], seg);
+        tx_start();
+
+        strm->line = (nl != NULL) ? STDIO_LINE_START : STDIO_LINE_PARTIAL;
+        seg = 0U;
+      } else {
+        /* Line does not fit: drop it or truncate it if partially written */
+        strm->line = (strm->line == STDIO_LINE_START) ? STDIO_LINE_DROP : STDIO_LINE_TRUNC;
+        strm->drop.lines++;
+      }
+    }
+
+    if (seg != 0U) {
+      /* Discard the rest of the line */
+      if (nl != NULL) {
+        if ((strm->line == STDIO_LINE_TRUNC) && (cnt != 0U)) {
+          /* Terminate the truncated line */
+          tx_put(ring, nl, 1U);
+          tx_start();
+          seg--;
+        }
+        strm->line = STDIO_LINE_START;
+      }
+      strm->drop.bytes += seg;
+    }
+
+    __set_PRIMASK(primask);
+
+    num += len_seg;
+  }
+
+  return (num);
+}
+
+/**
+  Write data to a stream
+
+  \param[in]   strm  Stream state
+  \param[in]   buf   Data to output
+  \param[in]   len   Number of bytes to output
+  \return           Number of bytes consumed.
+*/
+static uint32_t tx_write (stdio_stream_t *strm, const uint8_t *buf, uint32_t len) {
+
+  if ((strm->mode == STDIO_MODE_DROP) || (__get_IPSR() != 0U)) {
+    /* Caller must not block */
+    return (tx_write_drop(strm, buf, len));
+  }
+  return (tx_write_block(strm, buf, len));
+}
+
+/**
+  Put a character into the transmit ring buffer
+
+  \param[in]   strm  Stream state
+  \param[in]   ch    Character to output
+  \return           The character written, or -1 on write error.
+*/
+static int tx_putchar (stdio_stream_t *strm, int ch) {
+  uint8_t buf[1];
+
+  buf[0] = (uint8_t)ch;
+  if (tx_write(strm, buf, 1U) != 1U) {
+    return (-1);
+  }
+  return (ch);
+}
+
+/**
+  Put a record into the transmit ring buffer as one unit
+
+  A record is binary data that must not be split or truncated. In
+  drop-on-full mode or in an ISR a record that does not fit is dropped.
+
+  \param[in]   strm  Stream state
+  \param[in]   buf   Record data
+  \param[in]   len   Record length (not more than buffer size)
+  \return           Number of bytes consumed (written or dropped).
+*/
+static uint32_t tx_write_record (stdio_stream_t *strm, const uint8_t *buf, uint32_t len) {
+  stdio_ring_t *ring = strm->ring;
+  uint32_t primask;
+  uint32_t done;
+
+  done = 0U;
+
+  while (done == 0U) {
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    if ((ring->mask + 1U - (ring->head - ring->tail)) >= len) {
+      tx_put(ring, buf, len);
+      tx_start();
+      done = 1U;
+    } else if ((strm->mode == STDIO_MODE_DROP) || (__get_IPSR() != 0U)) {
+      strm->drop.bytes += len;
+      strm->drop.lines++;
+      done = 1U;
+    } else {
+      /* Wait for space */
+    }
+
+    __set_PRIMASK(primask);
+
+    if (done == 0U) {
+      stdio_wait(STDIO_FLAG_TX);
+    }
+  }
+
+  return (len);
+}
+
+#if (STDIO_STAGE_NUM > 0)
+/* Per-thread staging buffer */
+typedef struct {
+  osThreadId_t owner;                   /* Owner thread, NULL when free     */
+  uint32_t     len;                     /* Number of staged bytes           */
+  uint32_t     open;                    /* Incomplete line committed        */
+  uint32_t     busy;                    /* Used by a write of the owner     */
+  uint8_t      buf[STDIO_STAGE_SIZE];   /* Staged data                      */
+} stdio_stage_t;
+
+static stdio_stage_t stdio_stage[STDIO_STAGE_NUM];
+
+/**
+  Check staging buffers of other threads
+
+  \param[in]   stg   Staging buffer of the calling thread
+  \param[in]   open  0: any assigned buffer, 1: only buffers with an incomplete line committed
+  \return      1 when another thread holds such a buffer, otherwise 0.
+*/
+static uint32_t stage_other (const stdio_stage_t *stg, uint32_t open) {
+  uint32_t i;
+
+  for (i = 0U; i < STDIO_STAGE_NUM; i++) {
+    if ((&stdio_stage[i] != stg) && (stdio_stage[i].owner != NULL)) {
+      if ((open == 0U) || (stdio_stage[i].open != 0U)) {
+        return (1U);
+      }
+    }
+  }
+  return (0U);
+}
+
+/* Conditions for committing staged data */
+#define STAGE_COMMIT_ALWAYS     0U      /* Commit unconditionally           */
+#define STAGE_COMMIT_LINE       1U      /* No other thread has a line open  */
+#define STAGE_COMMIT_ALONE      2U      /* No other thread holds a buffer   */
+
+/**
+  Commit data to the transmit ring buffer as one unit
+
+  In blocking mode the caller waits until the whole block fits and then
+  copies it within a single critical section, so output of other threads is
+  never inserted in between. The commit condition is checked in the same
+  critical section.
+
+  \param[in]   stg   Staging buffer of the calling thread
+  \param[in]   buf   Data to output
+  \param[in]   len   Number of bytes to output (not more than buffer size)
+  \param[in]   cond  Commit condition (STAGE_COMMIT_...)
+  \return      1 when data was committed, 0 when the condition is not met.
+*/
+static uint32_t tx_commit (stdio_stage_t *stg, const uint8_t *buf, uint32_t len, uint32_t cond) {
+  stdio_stream_t *strm = &stdio_stream[STDIO_STDOUT];
+  stdio_ring_t   *ring = strm->ring;
+  uint32_t primask;
+  uint32_t done, rval;
+
+  done = 0U;
+  rval = 0U;
+
+  while (done == 0U) {
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    if ((cond != STAGE_COMMIT_ALWAYS) &&
+        (stage_other(stg, (cond == STAGE_COMMIT_LINE) ? 1U : 0U) != 0U)) {
+      done = 1U;
+    } else if (strm->mode == STDIO_MODE_DROP) {
+      /* Lines are put into the ring only as a whole */
+      tx_write_drop(strm, buf, len);
+      done = 1U;
+      rval = 1U;
+    } else if ((ring->mask + 1U - (ring->head - ring->tail)) >= len) {
+      tx_put(ring, buf, len);
+      tx_start();
+
+      strm->line = (buf[len - 1U] == '\n') ? STDIO_LINE_START : STDIO_LINE_PARTIAL;
+      done = 1U;
+      rval = 1U;
+    } else {
+      /* Wait for space */
+    }
+
+    if (rval != 0U) {
+      stg->open = (buf[len - 1U] != '\n') ? 1U : 0U;
+    }
+
+    __set_PRIMASK(primask);
+
+    if (done == 0U) {
+      stdio_wait(STDIO_FLAG_TX);
+    }
+  }
+
+  return (rval);
+}
+
+/* Marker of a staging buffer that is being reclaimed */
+#define STAGE_RECLAIM           ((osThreadId_t)stdio_stage)
+
+/**
+  Reclaim staging buffers of threads that have terminated (thread mode only)
+
+  Data staged by a terminated thread is committed and its buffer is freed on
+  the next write of any thread, so that it is neither held forever nor left
+  to a new thread that is given the same thread id.
+
+  \param[in]   thread_id  Calling thread
+*/
+static void stage_reclaim (osThreadId_t thread_id) {
+  stdio_stage_t *stg;
+  osThreadId_t owner;
+  osThreadState_t state;
+  uint32_t primask;
+  uint32_t i;
+
+  for (i = 0U; i < STDIO_STAGE_NUM; i++) {
+    stg   = &stdio_stage[i];
+    owner = stg->owner;
+    if ((owner != NULL) && (owner != thread_id) && (owner != STAGE_RECLAIM)) {
+      state = osThreadGetState(owner);
+      if ((state == osThreadTerminated) || (state == osThreadError)) {
+        primask = __get_PRIMASK();
+        __disable_irq();
+        if (stg->owner == owner) {
+          stg->owner = STAGE_RECLAIM;
+          stg->busy  = 1U;
+        } else {
+          owner = NULL;
+        }
+        __set_PRIMASK(primask);
+
+        if (owner != NULL) {
+          if (stg->len != 0U) {
+            (void)tx_commit(stg, stg->buf, stg->len, STAGE_COMMIT_ALWAYS);
+          }
+          stg->len   = 0U;
+          stg->open  = 0U;
+          stg->busy  = 0U;
+          stg->owner = NULL;
+        }
+      }
+    }
+  }
+}
+
+/**
+  Get staging buffer of the calling thread
+
+  A free buffer is assigned to the thread when it has none. The buffer stays
+  assigned after use, so that a thread writing alone can be recognized. When
+  no buffer is free, an idle buffer of another thread without staged data is
+  taken over. Buffers of terminated threads are reclaimed first.
+
+  \return pointer to staging buffer, or NULL when not available.
+*/
+static stdio_stage_t *stage_get (void) {
+  stdio_stage_t *stg, *stg_free, *stg_idle;
+  osThreadId_t thread_id;
+  uint32_t primask;
+  uint32_t i;
+
+  if ((__get_IPSR() != 0U) || (osKernelGetState() != osKernelRunning)) {
+    return (NULL);
+  }
+
+  thread_id = osThreadGetId();
+
+  stage_reclaim(thread_id);
+
+  stg       = NULL;
+  stg_free  = NULL;
+  stg_idle  = NULL;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+
+  for (i = 0U; i < STDIO_STAGE_NUM; i++) {
+    if (stdio_stage[i].owner == thread_id) {
+      stg = &stdio_stage[i];
+      break;
+    }
+    if ((stdio_stage[i].owner == NULL) && (stg_free == NULL)) {
+      stg_free = &stdio_stage[i];
+    }
+    if ((stdio_stage[i].busy == 0U) && (stdio_stage[i].len  == 0U) &&
+        (stdio_stage[i].open == 0U) && (stg_idle == NULL)) {
+      stg_idle = &stdio_stage[i];
+    }
+  }
+
+  if (stg == NULL) {
+    stg = (stg_free != NULL) ? stg_free : stg_idle;
+    if (stg != NULL) {
+      stg->owner = thread_id;
+    }
+  }
+  if (stg != NULL) {
+    stg->busy = 1U;
+  }
+
+  __set_PRIMASK(primask);
+
+  return (stg);
+}
+
+/* Commit all staged data when the condition is met */
+static void stage_commit (stdio_stage_t *stg, uint32_t cond) {
+
+  if ((stg->len != 0U) && (tx_commit(stg, stg->buf, stg->len, cond) != 0U)) {
+    stg->len = 0U;
+  }
+}
+
+/**
+  Release staging buffer after a write
+
+  With flush set, an incomplete line is committed when no other thread holds
+  a staging buffer, so that a block written by a single thread, i.e. on a
+  stream flush, is not held back.
+
+  \param[in]   stg    Staging buffer of the calling thread
+  \param[in]   flush  Commit an incomplete line when possible
+*/
+static void stage_release (stdio_stage_t *stg, uint32_t flush) {
+
+  if (flush != 0U) {
+    stage_commit(stg, STAGE_COMMIT_ALONE);
+  }
+  stg->busy = 0U;
+}
+
+/**
+  Commit the incomplete line of the calling thread
+
+  Used before reading and flushing: the staged data is transmitted and the
+  line is no longer held open for the calling thread.
+*/
+static void stage_flush (void) {
+  stdio_stage_t *stg;
+
+  stg = stage_get();
+  if (stg != NULL) {
+    stage_commit(stg, STAGE_COMMIT_ALWAYS);
+    stg->open = 0U;
+    stage_release(stg, 0U);
+  }
+}
+
+/**
+  Write data through a staging buffer
+
+  Complete lines are committed to the transmit ring buffer atomically, an
+  incomplete line is kept in the staging buffer until it is terminated or
+  the buffer is full. While another thread has an incomplete line in the
+  ring buffer, complete lines are also kept in the staging buffer.
+
+  \param[in]   stg   Staging buffer of the calling thread
+  \param[in]   buf   Data to output
+  \param[in]   len   Number of bytes to output
+*/
+static void stage_write (stdio_stage_t *stg, const uint8_t *buf, uint32_t len) {
+  const uint8_t *nl;
+  uint32_t num, seg;
+
+  num = 0U;
+
+  while (num < len) {
+    nl  = memchr(&buf[num], '\n', len - num);
+    seg = (nl != NULL) ? ((uint32_t)(nl - &buf[num]) + 1U) : (len - num);
+
+    if ((stg->len == 0U) && (nl != NULL) && (seg <= STDIO_STAGE_SIZE) &&
+        (tx_commit(stg, &buf[num], seg, STAGE_COMMIT_LINE) != 0U)) {
+      /* Complete line committed from the caller buffer without copying */
+    } else {
+      if (seg > (STDIO_STAGE_SIZE - stg->len)) {
+        seg = STDIO_STAGE_SIZE - stg->len;
+        nl  = NULL;
+      }
+      memcpy(&stg->buf[stg->len], &buf[num], seg);
+      stg->len += seg;
+
+      if (stg->len == STDIO_STAGE_SIZE) {
+        /* Staging buffer full */
+        stage_commit(stg, STAGE_COMMIT_ALWAYS);
+      } else if (nl != NULL) {
+        /* Line complete */
+        stage_commit(stg, STAGE_COMMIT_LINE);
+      } else {
+        /* Keep staged */
+      }
+    }
+
+    num += seg;
+  }
+}
+#endif
+
+
+#if defined(RTE_Compiler_IO_STDIN) && defined(RTE_Compiler_IO_STDIN_User)
+/**
+  Read data from the receive ring buffer
+
+  Returns all data already received, up to len bytes. The calling thread is
+  blocked until at least one byte is available.
+
+  \param[out]  buf  Buffer for received data
+  \param[in]   len  Size of the buffer in bytes
+  \return          Number of bytes read, or -1 on read error.
+*/
+static int32_t rx_read (uint8_t *buf, uint32_t len) {
+  uint32_t primask;
+  uint32_t num, idx, cnt;
+  int32_t rval;
+
+#if (STDIO_STAGE_NUM > 0)
+  /* Show a prompt staged by the calling thread before waiting for input */
+  stage_flush();
+#endif
+
+  rval = 0;
+
+  while (rval == 0) {
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    num = rx_count();
+    if (num > len) {
+      num = len;
+    }
+
+    /* Copy data in up to two contiguous blocks */
+    idx = rx_ring.tail & rx_ring.mask;
+    cnt = rx_ring.mask + 1U - idx;
+    if (cnt > num) {
+      cnt = num;
+    }
+    memcpy(&buf[0],   &rx_ring.buf[idx], cnt);
+    memcpy(&buf[cnt], &rx_ring.buf[0],   num - cnt);
+    rx_ring.tail += num;
+
+    /* Re-arm the receiver if it stopped on a full ring */
+    rx_start();
+
+    if (num != 0U) {
+      rval = (int32_t)num;
+    } else if ((rx_active == 0U) || (__get_IPSR() != 0U)) {
+      /* Receiver cannot be armed or caller cannot wait in an ISR */
+      rval = -1;
+    } else {
+      /* Wait for data */
+    }
+
+    __set_PRIMASK(primask);
+
+    if (rval == 0) {
+      stdio_wait(STDIO_FLAG_RX);
+    }
+  }
+
+  return (rval);
+}
+#endif
+
 
 /**
   Initialize stdio
@@ -54,9 +955,21 @@ extern ARM_DRIVER_USART  USART_Driver_(USART_DRV_NUM);
   \return          0 on success, or -1 on error.
 */
 int stdio_init (void) {
+  ARM_USART_CAPABILITIES capab;
+  uint32_t primask;
   int32_t status;
  
-  status = ptrUSART->Initialize(NULL);
+  /* Receive into the whole ring if the driver signals receive timeout,
+     otherwise each byte must complete a Receive to wake up the reader */
+  capab = ptrUSART->GetCapabilities();
+
+  if (capab.event_rx_timeout != 0U) {
+    rx_chunk = STDIO_RX_BUF_SIZE;
+  } else {
+    rx_chunk = 1U;
+  }
+
+  status = ptrUSART->Initialize(usart_event);
   if (status != ARM_DRIVER_OK) return (-1);
  
   status = ptrUSART->PowerControl(ARM_POWER_FULL);
@@ -70,8 +983,17 @@ int stdio_init (void) {
                              USART_BAUDRATE);
   if (status != ARM_DRIVER_OK) return (-1);
  
+  status = ptrUSART->Control(ARM_USART_CONTROL_TX, 1);
+  if (status != ARM_DRIVER_OK) return (-1);
+
   status = ptrUSART->Control(ARM_USART_CONTROL_RX, 1);
   if (status != ARM_DRIVER_OK) return (-1);
+
+  /* Keep the receiver armed continuously */
+  primask = __get_PRIMASK();
+  __disable_irq();
+  rx_start();
+  __set_PRIMASK(primask);
  
   return (0);
 }
@@ -85,14 +1007,7 @@ int stdio_init (void) {
   \return          The character written, or -1 on write error.
 */
 int stderr_putchar (int ch) {
-  uint8_t buf[1];
- 
-  buf[0] = (uint8_t)ch;
-  if (ptrUSART->Send(buf, 1) != ARM_DRIVER_OK) {
-    return (-1);
-  }
-  while (ptrUSART->GetTxCount() != 1);
-  return (ch);
+  return (tx_putchar(&stdio_stream[STDIO_STDERR], ch));
 }
 #endif
 
@@ -105,12 +1020,26 @@ int stderr_putchar (int ch) {
 int stdin_getchar (void) {
   uint8_t buf[1];
  
-  if (ptrUSART->Receive(buf, 1) != ARM_DRIVER_OK) {
+  if (rx_read(buf, 1U) != 1) {
     return (-1);
   }
-  while (ptrUSART->GetRxCount() != 1);
   return (buf[0]);
 }
+
+/**
+  Read a block of data from the stdin
+
+  \param[out]  buf  Buffer for received data
+  \param[in]   len  Size of the buffer in bytes
+  \return          Number of bytes read, or -1 on read error.
+*/
+int32_t stdin_read (uint8_t *buf, uint32_t len) {
+
+  if ((buf == NULL) || (len == 0U)) {
+    return (-1);
+  }
+  return (rx_read(buf, len));
+}
 #endif
 
 #if defined(RTE_Compiler_IO_STDOUT) && defined(RTE_Compiler_IO_STDOUT_User)
@@ -121,24 +1050,174 @@ int stdin_getchar (void) {
   \return          The character written, or -1 on write error.
 */
 int stdout_putchar (int ch) {
+#if (STDIO_STAGE_NUM > 0)
+  stdio_stage_t *stg;
   uint8_t buf[1];
- 
-  buf[0] = (uint8_t)ch;
-  if (ptrUSART->Send(buf, 1) != ARM_DRIVER_OK) {
+
+  stg = stage_get();
+  if (stg != NULL) {
+    buf[0] = (uint8_t)ch;
+    stage_write(stg, buf, 1U);
+    stage_release(stg, 0U);
+    return (ch);
+  }
+#endif
+  return (tx_putchar(&stdio_stream[STDIO_STDOUT], ch));
+}
+#endif
+
+/**
+  Write a block of data to the stdout
+
+  \param[in]   buf  Data to output
+  \param[in]   len  Number of bytes to output
+  \return          Number of bytes written, or -1 on write error.
+*/
+int32_t stdout_write (const uint8_t *buf, uint32_t len) {
+#if (STDIO_STAGE_NUM > 0)
+  stdio_stage_t *stg;
+#endif
+  uint32_t num;
+
+  if (buf == NULL) {
     return (-1);
   }
-  while (ptrUSART->GetTxCount() != 1);
-  return (ch);
+
+#if (STDIO_STAGE_NUM > 0)
+  stg = stage_get();
+  if (stg != NULL) {
+    stage_write(stg, buf, len);
+    stage_release(stg, 1U);
+    return ((int32_t)len);
+  }
+#endif
+
+  num = tx_write(&stdio_stream[STDIO_STDOUT], buf, len);
+  if ((num == 0U) && (len != 0U)) {
+    return (-1);
+  }
+  return ((int32_t)num);
 }
+
+/**
+  Write a binary record to the stdout
+
+  The record is put into the transmit buffer as one unit, after any
+  incomplete line staged by the calling thread.
+
+  \param[in]   buf  Record data
+  \param[in]   len  Record length in bytes
+  \return          Number of bytes written or dropped, or -1 on write error.
+*/
+int32_t stdout_write_record (const uint8_t *buf, uint32_t len) {
+
+  if ((buf == NULL) || (len == 0U) || (len > STDIO_TX_BUF_SIZE)) {
+    return (-1);
+  }
+
+#if (STDIO_STAGE_NUM > 0)
+  stage_flush();
+#endif
+
+  return ((int32_t)tx_write_record(&stdio_stream[STDIO_STDOUT], buf, len));
+}
+
+/**
+  Wait until all buffered output is transmitted
+
+  An incomplete line staged by the calling thread is committed first.
+*/
+void stdout_flush (void) {
+#if (STDIO_STAGE_NUM > 0)
+  stage_flush();
 #endif
 
+  while ((tx_ring.head != tx_ring.tail) || (tx_active != 0U)) {
+    if (__get_IPSR() != 0U) {
+      break;
+    }
+    stdio_wait(STDIO_FLAG_TX);
+  }
+}
+
+/**
+  Get stdio statistics
+
+  \param[out]  stats  Statistics counters
+*/
+void stdio_get_stats (stdio_stats_t *stats) {
+  uint32_t primask;
+
+  if (stats != NULL) {
+    primask = __get_PRIMASK();
+    __disable_irq();
+    *stats = stdio_stats;
+    __set_PRIMASK(primask);
+  }
+}
+
+/**
+  Set output mode of a stream
+
+  \param[in]   stream  STDIO_STDOUT or STDIO_STDERR
+  \param[in]   mode    STDIO_MODE_BLOCK or STDIO_MODE_DROP
+  \return             0 on success, or -1 on error.
+*/
+int32_t stdio_set_mode (uint32_t stream, uint32_t mode) {
+
+  if ((stream > STDIO_STDERR) || (mode > STDIO_MODE_DROP)) {
+    return (-1);
+  }
+  stdio_stream[stream].mode = (uint8_t)mode;
+
+  return (0);
+}
+
+/**
+  Get dropped data counters of a stream
+
+  \param[in]   stream  STDIO_STDOUT or STDIO_STDERR
+  \param[out]  stats   Dropped data counters
+*/
+void stdio_get_drop_stats (uint32_t stream, stdio_drop_stats_t *stats) {
+  uint32_t primask;
+
+  if ((stream <= STDIO_STDERR) && (stats != NULL)) {
+    primask = __get_PRIMASK();
+    __disable_irq();
+    *stats = stdio_stream[stream].drop;
+    __set_PRIMASK(primask);
+  }
+}
+
 #else /* defined(RETARGET_IO_User_Stub) */
 
+#include <stddef.h>
 #include <stdint.h>
 
-int32_t ITM_SendChar (int32_t ch);
+#if defined(RTE_CMSIS_RTOS2)
+#include "cmsis_os2.h"
+#endif
+
+#include "retarget_itm.h"
+
 int32_t ITM_ReceiveChar (void);
 
+/* Statistics */
+static stdio_stats_t stub_stats;
+
+#if defined(RTE_Compiler_IO_STDIN) && defined(RTE_Compiler_IO_STDIN_User)
+/* Wait before polling the ITM receive buffer again */
+static void itm_poll_wait (void) {
+#if defined(RTE_CMSIS_RTOS2)
+  if (osKernelGetState() == osKernelRunning) {
+    /* Let other threads run instead of spinning */
+    osDelay(1U);
+  }
+#endif
+}
+#endif
+
 /**
   Initialize stdio
  
@@ -157,7 +1236,9 @@ int stdio_init (void) {
 */
 int stderr_putchar (int ch) {
   #warning "Using stderr_putchar stub"
-  return (ITM_SendChar(ch));
+  stub_stats.tx_bytes++;
+  stub_stats.err_bytes++;
+  return (itm_putchar(ITM_PORT_STDERR, ch));
   //return (-1);
 }
 #endif
@@ -172,12 +1253,46 @@ int stdin_getchar (void) {
   #warning "Using stdin_getchar stub"
   int32_t ch;
 
-  do {
-    ch = ITM_ReceiveChar();
-  } while (ch == -1);
+  /* Show collected output, i.e. a prompt, before waiting for input */
+  itm_flush(ITM_PORT_STDOUT);
+
+  for (ch = ITM_ReceiveChar(); ch == -1; ch = ITM_ReceiveChar()) {
+    itm_poll_wait();
+  }
+  stub_stats.rx_bytes++;
   return (ch);
   //return (-1);
 }
+
+/**
+  Read a block of data from the stdin
+
+  \param[out]  buf  Buffer for received data
+  \param[in]   len  Size of the buffer in bytes
+  \return          Number of bytes read, or -1 on read error.
+*/
+int32_t stdin_read (uint8_t *buf, uint32_t len) {
+  uint32_t n;
+  int32_t ch;
+
+  if ((buf == NULL) || (len == 0U)) {
+    return (-1);
+  }
+
+  /* Wait for the first character, then take what is already available */
+  buf[0] = (uint8_t)stdin_getchar();
+
+  for (n = 1U; n < len; n++) {
+    ch = ITM_ReceiveChar();
+    if (ch == -1) {
+      break;
+    }
+    buf[n] = (uint8_t)ch;
+  }
+  stub_stats.rx_bytes += n - 1U;
+
+  return ((int32_t)n);
+}
 #endif
 
 #if defined(RTE_Compiler_IO_STDOUT) && defined(RTE_Compiler_IO_STDOUT_User)
@@ -189,10 +1304,99 @@ int stdin_getchar (void) {
 */
 int stdout_putchar (int ch) {
   #warning "Using stdout_putchar stub"
-  return (ITM_SendChar(ch));
+  stub_stats.tx_bytes++;
+  return (itm_putchar(ITM_PORT_STDOUT, ch));
   //return (-1);
 }
 #endif
 
+/**
+  Write a block of data to the stdout
+
+  \param[in]   buf  Data to output
+  \param[in]   len  Number of bytes to output
+  \return          Number of bytes written, or -1 on write error.
+*/
+int32_t stdout_write (const uint8_t *buf, uint32_t len) {
+
+  if (buf == NULL) {
+    return (-1);
+  }
+
+  itm_write(ITM_PORT_STDOUT, buf, len);
+  stub_stats.tx_bytes += len;
+
+  return ((int32_t)len);
+}
+
+/**
+  Write a binary record to the stdout
+
+  \param[in]   buf  Record data
+  \param[in]   len  Record length in bytes
+  \return          Number of bytes written, or -1 on write error.
+*/
+int32_t stdout_write_record (const uint8_t *buf, uint32_t len) {
+
+  if (len == 0U) {
+    return (-1);
+  }
+  return (stdout_write(buf, len));
+}
+
+/**
+  Wait until all buffered output is transmitted
+*/
+void stdout_flush (void) {
+  /* Stimulus port writes wait for the ITM FIFO, only collected characters are pending */
+  itm_flush(ITM_PORT_STDOUT);
+  itm_flush(ITM_PORT_STDERR);
+}
+
+/**
+  Get stdio statistics
+
+  \param[out]  stats  Statistics counters
+*/
+void stdio_get_stats (stdio_stats_t *stats) {
+  itm_stats_t itm;
+
+  if (stats != NULL) {
+    itm_get_stats(&itm);
+    *stats = stub_stats;
+    stats->send_calls = itm.writes;
+  }
+}
+
+/**
+  Set output mode of a stream
+
+  \param[in]   stream  STDIO_STDOUT or STDIO_STDERR
+  \param[in]   mode    STDIO_MODE_BLOCK or STDIO_MODE_DROP
+  \return             0 on success, or -1 on error.
+*/
+int32_t stdio_set_mode (uint32_t stream, uint32_t mode) {
+
+  if ((stream > STDIO_STDERR) || (mode != STDIO_MODE_BLOCK)) {
+    /* Stimulus port writes always wait for the ITM FIFO */
+    return (-1);
+  }
+  return (0);
+}
+
+/**
+  Get dropped data counters of a stream
+
+  \param[in]   stream  STDIO_STDOUT or STDIO_STDERR
+  \param[out]  stats   Dropped data counters
+*/
+void stdio_get_drop_stats (uint32_t stream, stdio_drop_stats_t *stats) {
+
+  if ((stream <= STDIO_STDERR) && (stats != NULL)) {
+    stats->bytes = 0U;
+    stats->lines = 0U;
+  }
+}
+
 #endif /* !defined(RETARGET_IO_User_Stub) */
 #endif
@@ -0,0 +1,70 @@
+/*---------------------------------------------------------------------------
+ * Copyright (c) 2021 Arm Limited (or its affiliates). All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *      Name:    retarget_stdio.h
+ *      Purpose: Retarget stdio interface
+ *
+ *---------------------------------------------------------------------------*/
+
+#ifndef RETARGET_STDIO_H__
+#define RETARGET_STDIO_H__
+
+#include <stdint.h>
+
+/* Output streams */
+#define STDIO_STDOUT            0U
+#define STDIO_STDERR            1U
+
+/* Output modes */
+#define STDIO_MODE_BLOCK        0U      /* Block the caller while buffer is full  */
+#define STDIO_MODE_DROP         1U      /* Never block, drop lines that don't fit */
+
+/* Dropped data counters */
+typedef struct {
+  uint32_t bytes;               /* Number of bytes dropped                  */
+  uint32_t lines;               /* Number of lines dropped or truncated     */
+} stdio_drop_stats_t;
+
+/* Statistics */
+typedef struct {
+  uint32_t tx_bytes;            /* Number of bytes passed to the driver     */
+  uint32_t send_calls;          /* Number of driver send calls              */
+  uint32_t err_bytes;           /* Number of stderr bytes passed to driver  */
+  uint32_t rx_bytes;            /* Number of bytes received                 */
+  uint32_t rx_overflows;        /* Number of receiver overflow events       */
+} stdio_stats_t;
+
+/* Character interface */
+extern int stdio_init     (void);
+extern int stderr_putchar (int ch);
+extern int stdout_putchar (int ch);
+extern int stdin_getchar  (void);
+
+/* Block interface */
+extern int32_t stdout_write        (const uint8_t *buf, uint32_t len);
+extern int32_t stdout_write_record (const uint8_t *buf, uint32_t len);
+extern void    stdout_flush        (void);
+extern int32_t stdin_read          (uint8_t *buf, uint32_t len);
+
+/* Output mode */
+extern int32_t stdio_set_mode  (uint32_t stream, uint32_t mode);
+
+/* Statistics */
+extern void    stdio_get_stats      (stdio_stats_t *stats);
+extern void    stdio_get_drop_stats (uint32_t stream, stdio_drop_stats_t *stats);
+
+#endif /* RETARGET_STDIO_H__ */
@@ -0,0 +1,179 @@
+/*---------------------------------------------------------------------------
+ * Copyright (c) 2023 Arm Limited (or its affiliates). All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *      Name:    retarget_stdio_lib.c
+ *      Purpose: Library stdout and stdin block I/O retargeted to
+ *               stdout_write and stdin_read
+ *
+ *---------------------------------------------------------------------------*/
+
+#include "RTE_Components.h"
+
+/*
+  The CMSIS-Compiler retarget passes the buffer of a stream write to
+  stdout_putchar one character at a time, and reads stdin with
+  stdin_getchar. The library functions are patched here so that standard
+  stream buffers reach stdout_write and stdin_read with one call:
+
+    GCC (newlib), linked with -Wl,--wrap=_write,--wrap=_read:
+      printf -> ... -> _write_r -> __wrap__write -> stdout_write
+      getchar -> ... -> _read_r -> __wrap__read -> stdin_read
+
+    Arm Compiler, with $Sub$$ patches of the CMSIS-Compiler functions:
+      printf -> ... -> _sys_write -> $Sub$$_sys_write -> stdout_write
+      getchar -> ... -> _sys_read -> $Sub$$_sys_read -> stdin_read
+
+  Other handles, stderr and files, are passed to the original functions.
+
+  The IAR linker cannot call the original __write from a replacement
+  (--redirect applies to all references); IAR applications keep the
+  character interface or call stdout_write directly.
+*/
+
+#if (defined(RTE_Compiler_IO_STDIN)  && defined(RTE_Compiler_IO_STDIN_User))  || \
+    (defined(RTE_Compiler_IO_STDOUT) && defined(RTE_Compiler_IO_STDOUT_User))
+
+#include "retarget_stdio.h"
+
+#if defined(RTE_Compiler_IO_STDIN) && defined(RTE_Compiler_IO_STDIN_User)
+#define STDIO_LIB_STDIN
+#endif
+#if defined(RTE_Compiler_IO_STDOUT) && defined(RTE_Compiler_IO_STDOUT_User)
+#define STDIO_LIB_STDOUT
+#endif
+
+#if defined(__GNUC__) && !defined(__ARMCC_VERSION)
+
+#include <errno.h>
+#include <unistd.h>
+
+#if defined(STDIO_LIB_STDOUT)
+extern int __real__write (int fd, char *ptr, int len);
+extern int __wrap__write (int fd, char *ptr, int len);
+
+/* Write a stream buffer, stdout with one stdout_write call */
+int __wrap__write (int fd, char *ptr, int len) {
+  int32_t n;
+
+  if (fd != STDOUT_FILENO) {
+    return (__real__write(fd, ptr, len));
+  }
+
+  n = stdout_write((const uint8_t *)ptr, (uint32_t)len);
+  if (n < 0) {
+    errno = EIO;
+    return (-1);
+  }
+  return ((int)n);
+}
+#endif
+
+#if defined(STDIO_LIB_STDIN)
+extern int __real__read (int fd, char *ptr, int len);
+extern int __wrap__read (int fd, char *ptr, int len);
+
+/* Fill a stream buffer, from stdin with the data already received */
+int __wrap__read (int fd, char *ptr, int len) {
+  int32_t n;
+
+  if (fd != STDIN_FILENO) {
+    return (__real__read(fd, ptr, len));
+  }
+
+  n = stdin_read((uint8_t *)ptr, (uint32_t)len);
+  if (n < 0) {
+    errno = EIO;
+    return (-1);
+  }
+  return ((int)n);
+}
+#endif
+
+#elif defined(__ARMCC_VERSION)
+
+#include <string.h>
+#include <rt_sys.h>
+
+extern const char __stdin_name[];
+extern const char __stdout_name[];
+
+extern FILEHANDLE $Super$$_sys_open  (const char *name, int openmode);
+extern FILEHANDLE $Sub$$_sys_open    (const char *name, int openmode);
+extern int        $Super$$_sys_write (FILEHANDLE fh, const unsigned char *buf, unsigned len, int mode);
+extern int        $Sub$$_sys_write   (FILEHANDLE fh, const unsigned char *buf, unsigned len, int mode);
+extern int        $Super$$_sys_read  (FILEHANDLE fh, unsigned char *buf, unsigned len, int mode);
+extern int        $Sub$$_sys_read    (FILEHANDLE fh, unsigned char *buf, unsigned len, int mode);
+
+/* Handles returned for the standard streams, -1 until opened */
+static FILEHANDLE stdio_lib_fh_stdin  = -1;
+static FILEHANDLE stdio_lib_fh_stdout = -1;
+
+/* Open a file, remember the handles of stdin and stdout */
+FILEHANDLE $Sub$$_sys_open (const char *name, int openmode) {
+  FILEHANDLE fh;
+
+  fh = $Super$$_sys_open(name, openmode);
+
+  if ((fh >= 0) && (name != NULL)) {
+    /* stdin is opened for reading, stdout for writing, stderr for appending */
+    if ((strcmp(name, __stdin_name) == 0) && ((openmode & (OPEN_W | OPEN_A)) == 0)) {
+      stdio_lib_fh_stdin = fh;
+    }
+    if ((strcmp(name, __stdout_name) == 0) && ((openmode & OPEN_W) != 0)) {
+      stdio_lib_fh_stdout = fh;
+    }
+  }
+  return (fh);
+}
+
+/* Write a stream buffer, stdout with one stdout_write call */
+int $Sub$$_sys_write (FILEHANDLE fh, const unsigned char *buf, unsigned len, int mode) {
+#if defined(STDIO_LIB_STDOUT)
+  int32_t n;
+
+  if ((fh == stdio_lib_fh_stdout) && (fh >= 0)) {
+    n = stdout_write(buf, len);
+    if (n < 0) {
+      return (-1);
+    }
+    /* Return number of characters not written */
+    return ((int)(len - (uint32_t)n));
+  }
+#endif
+  return ($Super$$_sys_write(fh, buf, len, mode));
+}
+
+/* Fill a stream buffer, from stdin with the data already received */
+int $Sub$$_sys_read (FILEHANDLE fh, unsigned char *buf, unsigned len, int mode) {
+#if defined(STDIO_LIB_STDIN)
+  int32_t n;
+
+  if ((fh == stdio_lib_fh_stdin) && (fh >= 0)) {
+    n = stdin_read(buf, len);
+    if (n < 0) {
+      return (-1);
+    }
+    /* Return number of characters not read */
+    return ((int)(len - (uint32_t)n));
+  }
+#endif
+  return ($Super$$_sys_read(fh, buf, len, mode));
+}
+
+#endif
+
+#endif
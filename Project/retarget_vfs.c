@@ -0,0 +1,607 @@
+/*---------------------------------------------------------------------------
+ * Copyright (c) 2023 Arm Limited (or its affiliates). All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *      Name:    retarget_vfs.c
+ *      Purpose: Mount table routing rt_fs calls to file system backends
+ *
+ *---------------------------------------------------------------------------*/
+
+#include <stddef.h>
+#include <string.h>
+
+#include "retarget_fs.h"
+#include "retarget_fs_ext.h"
+#include "retarget_vfs.h"
+
+/*
+  Mount table
+
+  With RT_FS_VFS defined, this file provides the rt_fs functions and the
+  file system retargets are built as backends (see retarget_vfs.h). Each
+  backend is mounted with rt_vfs_mount at a prefix, which is either a
+  drive ("R0:") or a first directory ("/tmp"). The mount of a path is
+  found with a hash of its prefix; paths without a mounted prefix go to
+  the mount with the prefix "". Drive prefixes are passed on with the
+  path, directory prefixes are removed ("/tmp/log.txt" is "log.txt" on
+  the backend). Mounts are not listed by rt_fs_readdir.
+
+  File and directory handles hold the mount table index in bits 24..30
+  and the handle of the backend in bits 0..23, so calls with a handle
+  reach the backend with one indexed access.
+
+  Mount flags select the caching policy per mount: writes are flushed to
+  the file system before they return with RT_VFS_WRITE_THROUGH, otherwise
+  the backend caches them as it does without the mount table. Mounts with
+  RT_VFS_RDONLY reject opening for writing and changes of entries with
+  RT_ERR_BUSY.
+
+  The mount table is set up before files are opened and is not locked;
+  the backends lock their own state.
+*/
+
+#if defined(RT_FS_VFS)
+
+#if (RT_VFS_MOUNT_NUM < 1) || (RT_VFS_MOUNT_NUM > 127)
+#error "RT_VFS_MOUNT_NUM must be in the range 1 to 127."
+#endif
+
+/* Handle: mount table index + 1 in bits 24..30, backend handle in bits 0..23 */
+#define VFS_FD_MAX              0x00FFFFFF
+#define vfs_fd_make(idx, fd)    ((int32_t)((((uint32_t)(idx) + 1U) << 24) | (uint32_t)(fd)))
+#define vfs_fd_index(fd)        (((uint32_t)(fd) >> 24) - 1U)
+#define vfs_fd_arg(fd)          ((int32_t)((uint32_t)(fd) & VFS_FD_MAX))
+
+/* Open modes that modify the file */
+#define VFS_OPEN_MODIFY         (RT_OPEN_WRONLY | RT_OPEN_RDWR | RT_OPEN_APPEND | RT_OPEN_CREATE | RT_OPEN_TRUNCATE)
+
+/* Mount table entry */
+typedef struct {
+  const rt_fs_ops_t *ops;       /* Backend operations, NULL when not used   */
+  uint32_t flags;               /* Mount flags (RT_VFS_...)                 */
+  uint32_t hash;                /* Hash of the prefix                       */
+  uint8_t  len;                 /* Length of the prefix                     */
+  uint8_t  next;                /* Next entry with the same hash index + 1  */
+  char     prefix[RT_VFS_PREFIX_MAX];
+} rt_vfs_mount_t;
+
+static rt_vfs_mount_t rt_vfs_mnt[RT_VFS_MOUNT_NUM];
+static uint8_t        rt_vfs_head[RT_VFS_MOUNT_NUM];  /* First entry per hash index + 1 */
+static uint8_t        rt_vfs_default;                 /* Entry with prefix "" + 1 */
+
+/* Length of the mount prefix of a path, 0 when it has none */
+static uint32_t vfs_prefix_len (const char *path) {
+  uint32_t n;
+
+  if (path[0] == '/') {
+    /* First directory */
+    for (n = 1U; (path[n] != '\0') && (path[n] != '/'); n++);
+    return (n);
+  }
+  for (n = 0U; (path[n] != '\0') && (path[n] != '/') && (path[n] != '\\'); n++) {
+    if (path[n] == ':') {
+      /* Drive */
+      return (n + 1U);
+    }
+  }
+  return (0U);
+}
+
+/* Hash of a prefix (FNV-1a) */
+static uint32_t vfs_hash (const char *prefix, uint32_t len) {
+  uint32_t h;
+  uint32_t i;
+
+  h = 2166136261U;
+  for (i = 0U; i < len; i++) {
+    h = (h ^ (uint8_t)prefix[i]) * 16777619U;
+  }
+  return (h);
+}
+
+/* Find the mount of a path, return mount table index or -1 */
+static int32_t vfs_find (const char *path, const char **rest) {
+  const rt_vfs_mount_t *m;
+  uint32_t len, h, i;
+
+  len = vfs_prefix_len(path);
+  if ((len != 0U) && (len < RT_VFS_PREFIX_MAX)) {
+    h = vfs_hash(path, len);
+    for (i = rt_vfs_head[h % RT_VFS_MOUNT_NUM]; i != 0U; i = m->next) {
+      m = &rt_vfs_mnt[i - 1U];
+      if ((m->hash == h) && (m->len == len) && (memcmp(m->prefix, path, len) == 0)) {
+        if (path[0] == '/') {
+          /* Directory prefix is removed */
+          path += len;
+          if (*path == '/') {
+            path++;
+          }
+        }
+        *rest = path;
+        return ((int32_t)i - 1);
+      }
+    }
+  }
+
+  *rest = path;
+  return ((int32_t)rt_vfs_default - 1);
+}
+
+/* Get the mount of a file or directory handle, NULL if not valid */
+static const rt_vfs_mount_t *vfs_get (int32_t fd) {
+  uint32_t i;
+
+  if (fd < 0) {
+    return (NULL);
+  }
+  i = vfs_fd_index(fd);
+  if ((i >= RT_VFS_MOUNT_NUM) || (rt_vfs_mnt[i].ops == NULL)) {
+    return (NULL);
+  }
+  return (&rt_vfs_mnt[i]);
+}
+
+/* Enter a backend handle into a handle of the mount table */
+static int32_t vfs_handle (int32_t idx, int32_t fd, int32_t (*close) (int32_t fd)) {
+
+  if (fd < 0) {
+    return (fd);
+  }
+  if (fd > VFS_FD_MAX) {
+    /* Backend handle does not fit */
+    (void)close(fd);
+    return (RT_ERR_MAXFILES);
+  }
+  return (vfs_fd_make(idx, fd));
+}
+
+/**
+  Mount a file system backend
+
+  \param[in]   prefix   Drive ("R0:"), first directory ("/tmp") or "" for
+                        paths without another mounted prefix
+  \param[in]   ops      Operations of the backend (rt_fs_ops_<name>)
+  \param[in]   flags    Mount flags (RT_VFS_WRITE_THROUGH, RT_VFS_RDONLY)
+  \return      0 on success or a negative error code
+*/
+int32_t rt_vfs_mount (const char *prefix, const rt_fs_ops_t *ops, uint32_t flags) {
+  rt_vfs_mount_t *m;
+  uint32_t len, i;
+
+  if ((prefix == NULL) || (ops == NULL) ||
+      (ops->open  == NULL) || (ops->close == NULL) || (ops->write  == NULL) ||
+      (ops->read  == NULL) || (ops->seek  == NULL) || (ops->size   == NULL) ||
+      (ops->stat  == NULL) || (ops->remove == NULL) || (ops->rename == NULL)) {
+    return (RT_ERR_INVAL);
+  }
+
+  len = strlen(prefix);
+  if ((len >= RT_VFS_PREFIX_MAX) || (vfs_prefix_len(prefix) != len) || (strcmp(prefix, "/") == 0)) {
+    return (RT_ERR_INVAL);
+  }
+
+  for (i = 0U; i < RT_VFS_MOUNT_NUM; i++) {
+    if ((rt_vfs_mnt[i].ops != NULL) && (strcmp(rt_vfs_mnt[i].prefix, prefix) == 0)) {
+      return (RT_ERR_EXIST);
+    }
+  }
+
+  m = NULL;
+  for (i = 0U; i < RT_VFS_MOUNT_NUM; i++) {
+    if (rt_vfs_mnt[i].ops == NULL) {
+      m = &rt_vfs_mnt[i];
+      break;
+    }
+  }
+  if (m == NULL) {
+    return (RT_ERR_NOSPACE);
+  }
+
+  memcpy(m->prefix, prefix, len + 1U);
+  m->len   = (uint8_t)len;
+  m->flags = flags;
+  m->hash  = vfs_hash(prefix, len);
+  m->ops   = ops;
+
+  if (len == 0U) {
+    rt_vfs_default = (uint8_t)(i + 1U);
+  } else {
+    m->next = rt_vfs_head[m->hash % RT_VFS_MOUNT_NUM];
+    rt_vfs_head[m->hash % RT_VFS_MOUNT_NUM] = (uint8_t)(i + 1U);
+  }
+
+  return (0);
+}
+
+int32_t rt_fs_open (const char *path, int32_t mode) {
+  const rt_vfs_mount_t *m;
+  const char *p;
+  int32_t idx;
+
+  if (path == NULL) {
+    return (RT_ERR_INVAL);
+  }
+  idx = vfs_find(path, &p);
+  if (idx < 0) {
+    return (RT_ERR_NOTFOUND);
+  }
+  m = &rt_vfs_mnt[idx];
+  if (((m->flags & RT_VFS_RDONLY) != 0U) && ((mode & VFS_OPEN_MODIFY) != 0)) {
+    return (RT_ERR_BUSY);
+  }
+
+  return (vfs_handle(idx, m->ops->open(p, mode), m->ops->close));
+}
+
+int32_t rt_fs_close (int32_t fd) {
+  const rt_vfs_mount_t *m;
+
+  m = vfs_get(fd);
+  if (m == NULL) {
+    return (RT_ERR_INVAL);
+  }
+  return (m->ops->close(vfs_fd_arg(fd)));
+}
+
+int32_t rt_fs_write (int32_t fd, const void *buf, uint32_t cnt) {
+  const rt_vfs_mount_t *m;
+  int32_t rval;
+  int32_t err;
+
+  m = vfs_get(fd);
+  if (m == NULL) {
+    return (RT_ERR_INVAL);
+  }
+  rval = m->ops->write(vfs_fd_arg(fd), buf, cnt);
+
+  if ((rval > 0) && ((m->flags & RT_VFS_WRITE_THROUGH) != 0U) && (m->ops->flush != NULL)) {
+    err = m->ops->flush(vfs_fd_arg(fd));
+    if (err < 0) {
+      rval = err;
+    }
+  }
+  return (rval);
+}
+
+int32_t rt_fs_read (int32_t fd, void *buf, uint32_t cnt) {
+  const rt_vfs_mount_t *m;
+
+  m = vfs_get(fd);
+  if (m == NULL) {
+    return (RT_ERR_INVAL);
+  }
+  return (m->ops->read(vfs_fd_arg(fd), buf, cnt));
+}
+
+int64_t rt_fs_seek (int32_t fd, int64_t offset, int32_t whence) {
+  const rt_vfs_mount_t *m;
+
+  m = vfs_get(fd);
+  if (m == NULL) {
+    return (RT_ERR_INVAL);
+  }
+  return (m->ops->seek(vfs_fd_arg(fd), offset, whence));
+}
+
+int64_t rt_fs_size (int32_t fd) {
+  const rt_vfs_mount_t *m;
+
+  m = vfs_get(fd);
+  if (m == NULL) {
+    return (RT_ERR_INVAL);
+  }
+  return (m->ops->size(vfs_fd_arg(fd)));
+}
+
+int32_t rt_fs_stat (int32_t fd, rt_fs_stat_t *stat) {
+  const rt_vfs_mount_t *m;
+
+  m = vfs_get(fd);
+  if (m == NULL) {
+    return (RT_ERR_INVAL);
+  }
+  return (m->ops->stat(vfs_fd_arg(fd), stat));
+}
+
+int32_t rt_fs_remove (const char *path) {
+  const char *p;
+  int32_t idx;
+
+  if (path == NULL) {
+    return (RT_ERR_INVAL);
+  }
+  idx = vfs_find(path, &p);
+  if (idx < 0) {
+    return (RT_ERR_NOTFOUND);
+  }
+  if ((rt_vfs_mnt[idx].flags & RT_VFS_RDONLY) != 0U) {
+    return (RT_ERR_BUSY);
+  }
+  return (rt_vfs_mnt[idx].ops->remove(p));
+}
+
+int32_t rt_fs_rename (const char *oldpath, const char *newpath) {
+  const char *p_old, *p_new;
+  int32_t idx;
+
+  if ((oldpath == NULL) || (newpath == NULL)) {
+    return (RT_ERR_INVAL);
+  }
+  idx = vfs_find(oldpath, &p_old);
+  if (idx < 0) {
+    return (RT_ERR_NOTFOUND);
+  }
+  if (vfs_find(newpath, &p_new) != idx) {
+    /* Files are not moved between mounts */
+    return (RT_ERR_NOTSUP);
+  }
+  if ((rt_vfs_mnt[idx].flags & RT_VFS_RDONLY) != 0U) {
+    return (RT_ERR_BUSY);
+  }
+  return (rt_vfs_mnt[idx].ops->rename(p_old, p_new));
+}
+
+int32_t rt_fs_flush (int32_t fd) {
+  const rt_vfs_mount_t *m;
+
+  m = vfs_get(fd);
+  if (m == NULL) {
+    return (RT_ERR_INVAL);
+  }
+  if (m->ops->flush == NULL) {
+    return (RT_ERR_NOTSUP);
+  }
+  return (m->ops->flush(vfs_fd_arg(fd)));
+}
+
+int32_t rt_fs_sync (int32_t fd) {
+  const rt_vfs_mount_t *m;
+
+  m = vfs_get(fd);
+  if (m == NULL) {
+    return (RT_ERR_INVAL);
+  }
+  if (m->ops->sync == NULL) {
+    return (RT_ERR_NOTSUP);
+  }
+  return (m->ops->sync(vfs_fd_arg(fd)));
+}
+
+int32_t rt_fs_cache_get_stats (rt_fs_cache_stats_t *stats) {
+  rt_fs_cache_stats_t s;
+  uint32_t *sum;
+  const uint32_t *val;
+  uint32_t i, j, k;
+  int32_t rval;
+
+  if (stats == NULL) {
+    return (RT_ERR_INVAL);
+  }
+
+  /* Statistics of all backends are added, all fields are uint32_t counters */
+  memset(stats, 0, sizeof(rt_fs_cache_stats_t));
+  sum  = (uint32_t *)stats;
+  val  = (const uint32_t *)&s;
+  rval = RT_ERR_NOTSUP;
+
+  for (i = 0U; i < RT_VFS_MOUNT_NUM; i++) {
+    if ((rt_vfs_mnt[i].ops == NULL) || (rt_vfs_mnt[i].ops->cache_get_stats == NULL)) {
+      continue;
+    }
+    for (j = 0U; j < i; j++) {
+      if (rt_vfs_mnt[j].ops == rt_vfs_mnt[i].ops) {
+        /* Backend mounted more than once */
+        break;
+      }
+    }
+    if ((j == i) && (rt_vfs_mnt[i].ops->cache_get_stats(&s) == 0)) {
+      for (k = 0U; k < (sizeof(rt_fs_cache_stats_t) / sizeof(uint32_t)); k++) {
+        sum[k] += val[k];
+      }
+      rval = 0;
+    }
+  }
+
+  return (rval);
+}
+
+int32_t rt_fs_map (int32_t fd, int64_t offset, uint32_t len, const void **ptr) {
+  const rt_vfs_mount_t *m;
+
+  m = vfs_get(fd);
+  if (m == NULL) {
+    return (RT_ERR_INVAL);
+  }
+  if (m->ops->map == NULL) {
+    return (RT_ERR_NOTSUP);
+  }
+  return (m->ops->map(vfs_fd_arg(fd), offset, len, ptr));
+}
+
+int32_t rt_fs_unmap (int32_t fd, const void *ptr) {
+  const rt_vfs_mount_t *m;
+
+  m = vfs_get(fd);
+  if (m == NULL) {
+    return (RT_ERR_INVAL);
+  }
+  if (m->ops->unmap == NULL) {
+    return (RT_ERR_NOTSUP);
+  }
+  return (m->ops->unmap(vfs_fd_arg(fd), ptr));
+}
+
+int32_t rt_fs_writev (int32_t fd, const rt_fs_iovec_t *iov, uint32_t iovcnt) {
+  const rt_vfs_mount_t *m;
+  int32_t rval;
+  int32_t err;
+
+  m = vfs_get(fd);
+  if (m == NULL) {
+    return (RT_ERR_INVAL);
+  }
+  if (m->ops->writev == NULL) {
+    return (RT_ERR_NOTSUP);
+  }
+  rval = m->ops->writev(vfs_fd_arg(fd), iov, iovcnt);
+
+  if ((rval > 0) && ((m->flags & RT_VFS_WRITE_THROUGH) != 0U) && (m->ops->flush != NULL)) {
+    err = m->ops->flush(vfs_fd_arg(fd));
+    if (err < 0) {
+      rval = err;
+    }
+  }
+  return (rval);
+}
+
+int32_t rt_fs_readv (int32_t fd, const rt_fs_iovec_t *iov, uint32_t iovcnt) {
+  const rt_vfs_mount_t *m;
+
+  m = vfs_get(fd);
+  if (m == NULL) {
+    return (RT_ERR_INVAL);
+  }
+  if (m->ops->readv == NULL) {
+    return (RT_ERR_NOTSUP);
+  }
+  return (m->ops->readv(vfs_fd_arg(fd), iov, iovcnt));
+}
+
+int32_t rt_fs_mkdir (const char *path) {
+  const char *p;
+  int32_t idx;
+
+  if (path == NULL) {
+    return (RT_ERR_INVAL);
+  }
+  idx = vfs_find(path, &p);
+  if (idx < 0) {
+    return (RT_ERR_NOTFOUND);
+  }
+  if ((rt_vfs_mnt[idx].flags & RT_VFS_RDONLY) != 0U) {
+    return (RT_ERR_BUSY);
+  }
+  if (rt_vfs_mnt[idx].ops->mkdir == NULL) {
+    return (RT_ERR_NOTSUP);
+  }
+  return (rt_vfs_mnt[idx].ops->mkdir(p));
+}
+
+int32_t rt_fs_rmdir (const char *path) {
+  const char *p;
+  int32_t idx;
+
+  if (path == NULL) {
+    return (RT_ERR_INVAL);
+  }
+  idx = vfs_find(path, &p);
+  if (idx < 0) {
+    return (RT_ERR_NOTFOUND);
+  }
+  if ((rt_vfs_mnt[idx].flags & RT_VFS_RDONLY) != 0U) {
+    return (RT_ERR_BUSY);
+  }
+  if (rt_vfs_mnt[idx].ops->rmdir == NULL) {
+    return (RT_ERR_NOTSUP);
+  }
+  return (rt_vfs_mnt[idx].ops->rmdir(p));
+}
+
+int32_t rt_fs_opendir (const char *path) {
+  const rt_vfs_mount_t *m;
+  const char *p;
+  int32_t idx;
+
+  if (path == NULL) {
+    return (RT_ERR_INVAL);
+  }
+  idx = vfs_find(path, &p);
+  if (idx < 0) {
+    return (RT_ERR_NOTFOUND);
+  }
+  m = &rt_vfs_mnt[idx];
+  if ((m->ops->opendir == NULL) || (m->ops->closedir == NULL)) {
+    return (RT_ERR_NOTSUP);
+  }
+  return (vfs_handle(idx, m->ops->opendir(p), m->ops->closedir));
+}
+
+int32_t rt_fs_readdir (int32_t dd, rt_fs_dirent_t *ent) {
+  const rt_vfs_mount_t *m;
+
+  m = vfs_get(dd);
+  if ((m == NULL) || (m->ops->readdir == NULL)) {
+    return (RT_ERR_INVAL);
+  }
+  return (m->ops->readdir(vfs_fd_arg(dd), ent));
+}
+
+int32_t rt_fs_closedir (int32_t dd) {
+  const rt_vfs_mount_t *m;
+
+  m = vfs_get(dd);
+  if ((m == NULL) || (m->ops->closedir == NULL)) {
+    return (RT_ERR_INVAL);
+  }
+  return (m->ops->closedir(vfs_fd_arg(dd)));
+}
+
+int32_t rt_fs_lookup (const char *path, rt_fs_dirent_t *ent) {
+  const char *p;
+  int32_t idx;
+
+  if (path == NULL) {
+    return (RT_ERR_INVAL);
+  }
+  idx = vfs_find(path, &p);
+  if (idx < 0) {
+    return (RT_ERR_NOTFOUND);
+  }
+  if (rt_vfs_mnt[idx].ops->lookup == NULL) {
+    return (RT_ERR_NOTSUP);
+  }
+  return (rt_vfs_mnt[idx].ops->lookup(p, ent));
+}
+
+int32_t rt_fs_invalidate (const char *path) {
+  const char *p;
+  int32_t idx, rval, r;
+  uint32_t i;
+
+  if (path == NULL) {
+    /* All mounts, backends without a cache are skipped */
+    rval = 0;
+    for (i = 0U; i < RT_VFS_MOUNT_NUM; i++) {
+      if ((rt_vfs_mnt[i].ops != NULL) && (rt_vfs_mnt[i].ops->invalidate != NULL)) {
+        r = rt_vfs_mnt[i].ops->invalidate(NULL);
+        if ((r != 0) && (r != RT_ERR_NOTSUP)) {
+          rval = r;
+        }
+      }
+    }
+    return (rval);
+  }
+  idx = vfs_find(path, &p);
+  if (idx < 0) {
+    return (RT_ERR_NOTFOUND);
+  }
+  if (rt_vfs_mnt[idx].ops->invalidate == NULL) {
+    return (RT_ERR_NOTSUP);
+  }
+  return (rt_vfs_mnt[idx].ops->invalidate(p));
+}
+
+#endif
@@ -0,0 +1,132 @@
+/*---------------------------------------------------------------------------
+ * Copyright (c) 2023 Arm Limited (or its affiliates). All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *      Name:    retarget_vfs.h
+ *      Purpose: Mount table routing rt_fs calls to file system backends
+ *
+ *---------------------------------------------------------------------------*/
+
+/*
+  A file system retarget built with RT_FS_VFS defined is a backend of the
+  mount table in retarget_vfs.c. Before it includes retarget_fs.h it
+  defines RT_FS_VFS_BACKEND to its name and includes this file, which
+  renames its rt_fs functions to <name>_rt_fs_...; at its end it defines
+  the operations table rt_fs_ops_<name> with RT_FS_VFS_OPS(<name>).
+*/
+
+#if defined(RT_FS_VFS_BACKEND) && !defined(RETARGET_VFS_BACKEND_NAMES)
+#define RETARGET_VFS_BACKEND_NAMES
+
+#define RT_FS_VFS_NAME_(b, f)       b##_##f
+#define RT_FS_VFS_NAME(b, f)        RT_FS_VFS_NAME_(b, f)
+
+#define rt_fs_open                  RT_FS_VFS_NAME(RT_FS_VFS_BACKEND, rt_fs_open)
+#define rt_fs_close                 RT_FS_VFS_NAME(RT_FS_VFS_BACKEND, rt_fs_close)
+#define rt_fs_write                 RT_FS_VFS_NAME(RT_FS_VFS_BACKEND, rt_fs_write)
+#define rt_fs_read                  RT_FS_VFS_NAME(RT_FS_VFS_BACKEND, rt_fs_read)
+#define rt_fs_seek                  RT_FS_VFS_NAME(RT_FS_VFS_BACKEND, rt_fs_seek)
+#define rt_fs_size                  RT_FS_VFS_NAME(RT_FS_VFS_BACKEND, rt_fs_size)
+#define rt_fs_stat                  RT_FS_VFS_NAME(RT_FS_VFS_BACKEND, rt_fs_stat)
+#define rt_fs_remove                RT_FS_VFS_NAME(RT_FS_VFS_BACKEND, rt_fs_remove)
+#define rt_fs_rename                RT_FS_VFS_NAME(RT_FS_VFS_BACKEND, rt_fs_rename)
+#define rt_fs_flush                 RT_FS_VFS_NAME(RT_FS_VFS_BACKEND, rt_fs_flush)
+#define rt_fs_sync                  RT_FS_VFS_NAME(RT_FS_VFS_BACKEND, rt_fs_sync)
+#define rt_fs_cache_get_stats       RT_FS_VFS_NAME(RT_FS_VFS_BACKEND, rt_fs_cache_get_stats)
+#define rt_fs_map                   RT_FS_VFS_NAME(RT_FS_VFS_BACKEND, rt_fs_map)
+#define rt_fs_unmap                 RT_FS_VFS_NAME(RT_FS_VFS_BACKEND, rt_fs_unmap)
+#define rt_fs_writev                RT_FS_VFS_NAME(RT_FS_VFS_BACKEND, rt_fs_writev)
+#define rt_fs_readv                 RT_FS_VFS_NAME(RT_FS_VFS_BACKEND, rt_fs_readv)
+#define rt_fs_mkdir                 RT_FS_VFS_NAME(RT_FS_VFS_BACKEND, rt_fs_mkdir)
+#define rt_fs_rmdir                 RT_FS_VFS_NAME(RT_FS_VFS_BACKEND, rt_fs_rmdir)
+#define rt_fs_opendir               RT_FS_VFS_NAME(RT_FS_VFS_BACKEND, rt_fs_opendir)
+#define rt_fs_readdir               RT_FS_VFS_NAME(RT_FS_VFS_BACKEND, rt_fs_readdir)
+#define rt_fs_closedir              RT_FS_VFS_NAME(RT_FS_VFS_BACKEND, rt_fs_closedir)
+#define rt_fs_lookup                RT_FS_VFS_NAME(RT_FS_VFS_BACKEND, rt_fs_lookup)
+#define rt_fs_invalidate            RT_FS_VFS_NAME(RT_FS_VFS_BACKEND, rt_fs_invalidate)
+
+/* Operations table of the backend */
+#define RT_FS_VFS_OPS(name)                                                   \
+  const rt_fs_ops_t rt_fs_ops_##name = {                                     \
+    rt_fs_open,    rt_fs_close,   rt_fs_write,   rt_fs_read,                  \
+    rt_fs_seek,    rt_fs_size,    rt_fs_stat,    rt_fs_remove,                \
+    rt_fs_rename,  rt_fs_flush,   rt_fs_sync,    rt_fs_cache_get_stats,       \
+    rt_fs_map,     rt_fs_unmap,   rt_fs_writev,  rt_fs_readv,                 \
+    rt_fs_mkdir,   rt_fs_rmdir,   rt_fs_opendir, rt_fs_readdir,               \
+    rt_fs_closedir, rt_fs_lookup, rt_fs_invalidate                            \
+  }
+
+#endif
+
+#ifndef RETARGET_VFS_H__
+#define RETARGET_VFS_H__
+
+#include <stdint.h>
+
+#include "retarget_fs_ext.h"
+
+/* Number of mount table entries (maximum 127) */
+#ifndef RT_VFS_MOUNT_NUM
+#define RT_VFS_MOUNT_NUM        4
+#endif
+
+/* Maximum length of a mount prefix, including the terminating null */
+#ifndef RT_VFS_PREFIX_MAX
+#define RT_VFS_PREFIX_MAX       16
+#endif
+
+/* Mount flags */
+#define RT_VFS_WRITE_THROUGH    (1U << 0)   /* Flush the file after each write */
+#define RT_VFS_RDONLY           (1U << 1)   /* No writes, no changes to entries */
+
+/* File system operations, functions not provided by a backend may be NULL */
+typedef struct {
+  int32_t (*open)            (const char *path, int32_t mode);
+  int32_t (*close)           (int32_t fd);
+  int32_t (*write)           (int32_t fd, const void *buf, uint32_t cnt);
+  int32_t (*read)            (int32_t fd, void *buf, uint32_t cnt);
+  int64_t (*seek)            (int32_t fd, int64_t offset, int32_t whence);
+  int64_t (*size)            (int32_t fd);
+  int32_t (*stat)            (int32_t fd, rt_fs_stat_t *stat);
+  int32_t (*remove)          (const char *path);
+  int32_t (*rename)          (const char *oldpath, const char *newpath);
+  int32_t (*flush)           (int32_t fd);
+  int32_t (*sync)            (int32_t fd);
+  int32_t (*cache_get_stats) (rt_fs_cache_stats_t *stats);
+  int32_t (*map)             (int32_t fd, int64_t offset, uint32_t len, const void **ptr);
+  int32_t (*unmap)           (int32_t fd, const void *ptr);
+  int32_t (*writev)          (int32_t fd, const rt_fs_iovec_t *iov, uint32_t iovcnt);
+  int32_t (*readv)           (int32_t fd, const rt_fs_iovec_t *iov, uint32_t iovcnt);
+  int32_t (*mkdir)           (const char *path);
+  int32_t (*rmdir)           (const char *path);
+  int32_t (*opendir)         (const char *path);
+  int32_t (*readdir)         (int32_t dd, rt_fs_dirent_t *ent);
+  int32_t (*closedir)        (int32_t dd);
+  int32_t (*lookup)          (const char *path, rt_fs_dirent_t *ent);
+  int32_t (*invalidate)      (const char *path);
+} rt_fs_ops_t;
+
+/* Backends of this project */
+extern const rt_fs_ops_t rt_fs_ops_fs;      /* retarget_fs.c (template)      */
+extern const rt_fs_ops_t rt_fs_ops_mdk;     /* retarget_mdk-fs.c             */
+extern const rt_fs_ops_t rt_fs_ops_ramfs;   /* retarget_ramfs.c              */
+extern const rt_fs_ops_t rt_fs_ops_logfs;   /* retarget_logfs.c              */
+extern const rt_fs_ops_t rt_fs_ops_posix;   /* Host/retarget_posix-fs.c      */
+
+/* Mount a backend at a path prefix ("" for paths of no other mount) */
+extern int32_t rt_vfs_mount (const char *prefix, const rt_fs_ops_t *ops, uint32_t flags);
+
+#endif /* RETARGET_VFS_H__ */
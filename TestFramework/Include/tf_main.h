@@ -69,4 +69,12 @@ extern TEST_REPORT  TestReport;
 */
 #define ASSERT_TRUE(cond)             __assert_true (__FILE__, __LINE__, cond)
 
+/**
+  TEST_MESSAGE:
+  - add informational message (i.e. measurement result) to the test case report
+
+\param[in]  msg           message string
+*/
+#define TEST_MESSAGE(msg)             TReport_TestMsg (__FILE__, __LINE__, msg)
+
 #endif /* TF_MAIN_H__ */
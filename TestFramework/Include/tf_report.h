@@ -84,6 +84,7 @@ int32_t TReport_Open     (const char *title, const char *date, const char *time,
 int32_t TReport_Close    (void);
 int32_t TReport_TestOpen (uint32_t num, const char *fn);
 int32_t TReport_TestAdd  (const char *fn, uint32_t ln, char *desc, TC_RES res);
+int32_t TReport_TestMsg  (const char *fn, uint32_t ln, char *desc);
 int32_t TReport_TestClose(void);
 
 #endif /* TF_REPORT_H__ */
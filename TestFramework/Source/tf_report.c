@@ -73,6 +73,9 @@ TEST_REPORT TestReport;
 /* Temporary assert statistics */
 static AS_STAT AssertStat;
 
+/* Number of messages added to the current Test Case */
+static uint32_t MsgCount;
+
 #define TC_Asserts (&AssertStat)            /* Assert statistics: for the current Test Case */
 #define TR_Asserts (&TestReport.assertions) /* Assert statistics: all Test Cases combined   */
 
@@ -145,6 +148,8 @@ static void TR_Print_Close_TC (const char *res) {
   PRINT(("<res>%s</res>%s", res, TF_EOL));
   PRINT(("</tc>%s", TF_EOL));
 #else
+  if (MsgCount != 0U)
+    PRINT(("%s  ", TF_EOL));
   if ((res == Passed) || (res == NotExe))
     PRINT(("%s%s", res, TF_EOL));
   else
@@ -567,6 +572,8 @@ int32_t TReport_TestOpen (uint32_t num, const char *fn) {
   TC_Asserts->failed   = 0U;
   TC_Asserts->warnings = 0U;
 
+  MsgCount = 0U;
+
   TR_Print_Open_TC (num, fn);
 
   return (0);
@@ -623,6 +630,21 @@ int32_t TReport_TestAdd (const char *fn, uint32_t ln, char *desc, TC_RES res) {
   return (0);
 }
 
+/*-----------------------------------------------------------------------------
+ * Add test case message to the Test Report
+ *----------------------------------------------------------------------------*/
+int32_t TReport_TestMsg (const char *fn, uint32_t ln, char *desc) {
+
+  /* Strip path information from the file name */
+  fn = fn_strip (fn);
+
+  MsgCount++;
+
+  TR_Print_WriteDebug (fn, ln, desc, NULL);
+
+  return (0);
+}
+
 /*-----------------------------------------------------------------------------
  * Close test case
  *----------------------------------------------------------------------------*/
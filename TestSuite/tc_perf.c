@@ -0,0 +1,2257 @@
+/*
+ * Copyright (C) 2023 ARM Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "test.h"
+#include "retarget_stdio.h"
+#include "retarget_log.h"
+#include "retarget_itm.h"
+#include "retarget_fs_ext.h"
+#include "retarget_fs_aio.h"
+#if (TC_PERF_LOGFS_1_EN) || defined(RT_FS_VFS)
+#include "retarget_logfs.h"
+#endif
+#if defined(RT_FS_VFS)
+#include "retarget_vfs.h"
+#endif
+#if ((TC_PERF_STDOUT_3_EN) || (TC_PERF_STDOUT_4_EN) || (TC_PERF_STDERR_1_EN) || (TC_PERF_LOG_1_EN)) && defined(USART_HOST_CAPTURE) && defined(RETARGET_IO_USART)
+#include "usart_host.h"
+#define PERF_CAPTURE
+#endif
+#if (TC_PERF_LOG_1_EN) && defined(PERF_CAPTURE) && defined(LOG_HOST_DECODE)
+#include "log_host.h"
+#define PERF_LOG_DECODE
+#endif
+#if (TC_PERF_RENAME_1_EN) && defined(RETARGET_HOST_FS_CALLS)
+#include "retarget_host.h"
+#endif
+
+#if (TC_PERF_STDOUT_3_EN) || (TC_PERF_STDOUT_4_EN) || (TC_PERF_THREADS_1_EN) || (TC_PERF_SYNC_1_EN)
+/* Test case thread id */
+static osThreadId_t perf_main_id;
+#endif
+
+#if defined(PERF_CAPTURE)
+/* Transmitted data captured by the host USART model */
+static uint8_t perf_cap[4096];
+#endif
+
+/**
+  Get elapsed time in microseconds.
+
+  \param[in]  start  Kernel system timer count at start of measurement
+  \return elapsed time in microseconds
+*/
+__STATIC_INLINE uint32_t perf_elapsed_us (uint32_t start) {
+  uint64_t cnt;
+
+  cnt = (uint32_t)(osKernelGetSysTimerCount() - start);
+
+  return ((uint32_t)((cnt * 1000000U) / osKernelGetSysTimerFreq()));
+}
+
+/**
+  Get elapsed time in nanoseconds.
+
+  \param[in]  start  Kernel system timer count at start of measurement
+  \return elapsed time in nanoseconds
+*/
+__STATIC_INLINE uint32_t perf_elapsed_ns (uint32_t start) {
+  uint64_t cnt;
+
+  cnt = (uint32_t)(osKernelGetSysTimerCount() - start);
+
+  return ((uint32_t)((cnt * 1000000000U) / osKernelGetSysTimerFreq()));
+}
+
+/**
+  Calculate rate per second.
+
+  \param[in]  cnt  Number of items (i.e. bytes)
+  \param[in]  us   Time in microseconds
+  \return rate per second
+*/
+__STATIC_INLINE uint32_t perf_rate (uint32_t cnt, uint32_t us) {
+
+  if (us == 0U) {
+    us = 1U;
+  }
+  return ((uint32_t)(((uint64_t)cnt * 1000000U) / us));
+}
+
+/*=======0=========1=========2=========3=========4=========5=========6=========7=========8=========9=========0=========1====*/
+/**
+\defgroup perf_funcs Performance Measurements
+\brief Retarget performance measurement test cases
+\details
+The performance test cases measure throughput and latency of the retarget layer. Measurement results are added to the test
+report as messages.
+
+@{
+*/
+
+/*=======0=========1=========2=========3=========4=========5=========6=========7=========8=========9=========0=========1====*/
+
+/**
+\brief Test case: TC_perf_stdout_1
+\details
+  - Output 1 KB of text character by character using stdout_putchar
+  - Output 1 KB of text in 64 byte blocks using stdout_write
+  - Report throughput, time spent in the caller and driver calls per KB
+*/
+void TC_perf_stdout_1 (void) {
+#if (TC_PERF_STDOUT_1_EN)
+  char msg[96];
+  static const char line[] = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ.\n";
+  stdio_stats_t s0, s1;
+  uint32_t start, t_call, t_total;
+  uint32_t i, n;
+
+  /* Output 1 KB of text character by character using stdout_putchar */
+  stdout_flush();
+  stdio_get_stats (&s0);
+  start = osKernelGetSysTimerCount();
+
+  for (i = 0U; i < 16U; i++) {
+    for (n = 0U; n < (sizeof(line) - 1U); n++) {
+      stdout_putchar (line[n]);
+    }
+  }
+
+  t_call = perf_elapsed_us (start);
+  stdout_flush();
+  t_total = perf_elapsed_us (start);
+  stdio_get_stats (&s1);
+
+  snprintf (msg, sizeof(msg), "stdout_putchar: %u B/s, caller %u us, %u Send/KB",
+                              (unsigned int)perf_rate(1024U, t_total),
+                              (unsigned int)t_call,
+                              (unsigned int)(s1.send_calls - s0.send_calls));
+  TEST_MESSAGE (msg);
+
+  /* Output 1 KB of text in 64 byte blocks using stdout_write */
+  stdio_get_stats (&s0);
+  start = osKernelGetSysTimerCount();
+
+  for (i = 0U; i < 16U; i++) {
+    ASSERT_TRUE (stdout_write ((const uint8_t *)line, sizeof(line) - 1U) == (int32_t)(sizeof(line) - 1U));
+  }
+
+  t_call = perf_elapsed_us (start);
+  stdout_flush();
+  t_total = perf_elapsed_us (start);
+  stdio_get_stats (&s1);
+
+  snprintf (msg, sizeof(msg), "stdout_write: %u B/s, caller %u us, %u Send/KB",
+                              (unsigned int)perf_rate(1024U, t_total),
+                              (unsigned int)t_call,
+                              (unsigned int)(s1.send_calls - s0.send_calls));
+  TEST_MESSAGE (msg);
+#endif
+}
+
+/**
+\brief Test case: TC_perf_stdout_2
+\details
+  - Output 4 KB of text in 64 byte lines in blocking mode
+  - Output 4 KB of text in 64 byte lines in drop-on-full mode
+  - Report worst case stdout_write latency and dropped data for both modes
+  - Blocking mode must not drop data, drop-on-full mode must drop data
+  - Worst case latency in drop-on-full mode must be below the one in blocking mode,
+    which includes waiting for the transmission
+*/
+void TC_perf_stdout_2 (void) {
+#if (TC_PERF_STDOUT_2_EN)
+  char msg[96];
+  static const char line[] = "drop-on-full latency test line ...............................\n";
+  stdio_drop_stats_t d0, d1;
+  uint32_t dropped[2], t_max[2];
+  uint32_t mode, start, t;
+  uint32_t i;
+
+  for (mode = STDIO_MODE_BLOCK; mode <= STDIO_MODE_DROP; mode++) {
+    stdout_flush();
+    ASSERT_TRUE (stdio_set_mode (STDIO_STDOUT, mode) == 0);
+    stdio_get_drop_stats (STDIO_STDOUT, &d0);
+
+    t_max[mode] = 0U;
+    for (i = 0U; i < 64U; i++) {
+      start = osKernelGetSysTimerCount();
+      ASSERT_TRUE (stdout_write ((const uint8_t *)line, sizeof(line) - 1U) == (int32_t)(sizeof(line) - 1U));
+      t = perf_elapsed_us (start);
+      if (t > t_max[mode]) {
+        t_max[mode] = t;
+      }
+    }
+
+    stdio_get_drop_stats (STDIO_STDOUT, &d1);
+    stdio_set_mode (STDIO_STDOUT, STDIO_MODE_BLOCK);
+    stdout_flush();
+
+    dropped[mode] = d1.bytes - d0.bytes;
+
+    snprintf (msg, sizeof(msg), "%s mode: max latency %u us, dropped %u bytes, %u lines",
+                                (mode == STDIO_MODE_BLOCK) ? "block" : "drop",
+                                (unsigned int)t_max[mode],
+                                (unsigned int)dropped[mode],
+                                (unsigned int)(d1.lines - d0.lines));
+    TEST_MESSAGE (msg);
+  }
+
+  ASSERT_TRUE (dropped[STDIO_MODE_BLOCK] == 0U);
+  ASSERT_TRUE (dropped[STDIO_MODE_DROP]  != 0U);
+  ASSERT_TRUE (t_max[STDIO_MODE_DROP] < t_max[STDIO_MODE_BLOCK]);
+#endif
+}
+
+#if (TC_PERF_STDOUT_3_EN)
+/* Number of concurrently printing threads */
+#define PERF_STDOUT_3_THREADS   4U
+
+/* Thread printing lines in several fragments */
+static void perf_stdout_3_thread (void *arg) {
+  uint32_t idx = (uint32_t)(uintptr_t)arg;
+  uint32_t i;
+
+  for (i = 0U; i < 16U; i++) {
+    printf ("thread %u", (unsigned int)idx);
+    printf (" line %02u", (unsigned int)i);
+    printf (" ..............................\n");
+  }
+  /* All threads wait for the transmission at the same time */
+  stdout_flush();
+  osThreadFlagsSet (perf_main_id, 1U << idx);
+}
+
+#if defined(PERF_CAPTURE)
+/* Count intact lines printed by perf_stdout_3_thread, each line once */
+static uint32_t perf_stdout_3_lines (const uint8_t *buf, uint32_t cnt) {
+  uint16_t seen[PERF_STDOUT_3_THREADS];
+  char ln[64], exp[64];
+  uint32_t pos, len, idx, num, lines;
+
+  memset (seen, 0, sizeof(seen));
+  lines = 0U;
+
+  for (pos = 0U; pos < cnt; pos += len) {
+    for (len = 0U; ((pos + len) < cnt) && (buf[pos + len] != '\n'); len++);
+    len++;
+    if (((pos + len) > cnt) || (len >= sizeof(ln))) {
+      /* Incomplete or merged line */
+      break;
+    }
+    memcpy (ln, &buf[pos], len);
+    ln[len] = '\0';
+
+    if ((sscanf (ln, "thread %u line %u", &idx, &num) != 2) || (idx >= PERF_STDOUT_3_THREADS) || (num >= 16U)) {
+      break;
+    }
+    snprintf (exp, sizeof(exp), "thread %u line %02u ..............................\n", idx, num);
+    if ((strcmp (ln, exp) != 0) || ((seen[idx] & (1U << num)) != 0U)) {
+      break;
+    }
+    seen[idx] |= (uint16_t)(1U << num);
+    lines++;
+  }
+  return (lines);
+}
+#endif
+#endif
+
+/**
+\brief Test case: TC_perf_stdout_3
+\details
+  - Print 16 lines from each of 4 threads concurrently, every line printed in three fragments
+  - Lines must appear in the output without interleaving (checked on the host with the USART capture)
+  - Each thread waits in stdout_flush at the end, all of them must return
+  - Report throughput and driver calls per KB
+*/
+void TC_perf_stdout_3 (void) {
+#if (TC_PERF_STDOUT_3_EN)
+  char msg[96];
+  stdio_stats_t s0, s1;
+  uint32_t start, t, bytes;
+  uint32_t i;
+
+  perf_main_id = osThreadGetId();
+
+  stdout_flush();
+#if defined(PERF_CAPTURE)
+  usart_host_capture_start (perf_cap, sizeof(perf_cap));
+#endif
+  stdio_get_stats (&s0);
+  start = osKernelGetSysTimerCount();
+
+  for (i = 0U; i < PERF_STDOUT_3_THREADS; i++) {
+    ASSERT_TRUE (osThreadNew (perf_stdout_3_thread, (void *)(uintptr_t)i, NULL) != NULL);
+  }
+  ASSERT_TRUE (osThreadFlagsWait ((1U << PERF_STDOUT_3_THREADS) - 1U, osFlagsWaitAll, 10000U) < 0x80000000U);
+
+  stdout_flush();
+  t = perf_elapsed_us (start);
+  stdio_get_stats (&s1);
+
+#if defined(PERF_CAPTURE)
+  bytes = usart_host_capture_stop();
+  ASSERT_TRUE (bytes < sizeof(perf_cap));
+  ASSERT_TRUE (perf_stdout_3_lines (perf_cap, bytes) == (PERF_STDOUT_3_THREADS * 16U));
+#endif
+
+  bytes = s1.tx_bytes - s0.tx_bytes;
+  snprintf (msg, sizeof(msg), "%u threads: %u B/s, %u Send/KB",
+                              (unsigned int)PERF_STDOUT_3_THREADS,
+                              (unsigned int)perf_rate(bytes, t),
+                              (unsigned int)(((s1.send_calls - s0.send_calls) * 1024U) / ((bytes != 0U) ? bytes : 1U)));
+  TEST_MESSAGE (msg);
+#endif
+}
+
+#if (TC_PERF_STDOUT_4_EN)
+static const char perf_stdout_4_open[]   = "open line ";
+static const char perf_stdout_4_prompt[] = "prompt> ";
+
+/* Hold a staging buffer with an incomplete line until the test case thread signals */
+static void perf_stdout_4_line (void *argument) {
+  (void)argument;
+
+  stdout_write ((const uint8_t *)perf_stdout_4_open, sizeof(perf_stdout_4_open) - 1U);
+  osThreadFlagsSet (perf_main_id, 1U);
+  osThreadFlagsWait (1U, osFlagsWaitAny, osWaitForever);
+  stdout_write ((const uint8_t *)"closed\n", 7U);
+  /* Exit with an incomplete line staged */
+  stdout_write ((const uint8_t *)"ended", 5U);
+  osThreadFlagsSet (perf_main_id, 1U);
+}
+
+#if defined(RTE_Compiler_IO_STDIN_User)
+/* Print a prompt without a newline, read from stdin when signaled */
+static void perf_stdout_4_reader (void *argument) {
+  uint8_t buf[1];
+  (void)argument;
+
+  stdout_write ((const uint8_t *)perf_stdout_4_prompt, sizeof(perf_stdout_4_prompt) - 1U);
+  osThreadFlagsSet (perf_main_id, 2U);
+  osThreadFlagsWait (1U, osFlagsWaitAny, osWaitForever);
+  stdin_read (buf, sizeof(buf));
+}
+#endif
+#endif
+
+/**
+\brief Test case: TC_perf_stdout_4
+\details
+  - A thread holds an incomplete line, so that a prompt printed by another thread is staged
+  - The other thread prints a prompt without a newline, it must not be transmitted yet
+  - The other thread reads from stdin, the prompt must be transmitted before the read waits for input
+  - The first thread exits with an incomplete line staged, it must be transmitted on the next write
+  - Report the time from the read call until the prompt is passed to the driver
+*/
+void TC_perf_stdout_4 (void) {
+#if (TC_PERF_STDOUT_4_EN) && defined(RTE_Compiler_IO_STDIN_User)
+  char msg[96];
+  stdio_stats_t s0, s1, sb;
+  osThreadId_t line_id, reader_id;
+  uint32_t start, t, i;
+#if defined(PERF_CAPTURE)
+  uint32_t cnt, pos;
+#endif
+
+  perf_main_id = osThreadGetId();
+
+  stdout_flush();
+#if defined(PERF_CAPTURE)
+  usart_host_capture_start (perf_cap, sizeof(perf_cap));
+#endif
+  stdio_get_stats (&sb);
+
+  line_id = osThreadNew (perf_stdout_4_line, NULL, NULL);
+  ASSERT_TRUE (line_id != NULL);
+  ASSERT_TRUE (osThreadFlagsWait (1U, osFlagsWaitAny, 1000U) == 1U);
+  stdout_flush();
+  stdio_get_stats (&s0);
+
+  reader_id = osThreadNew (perf_stdout_4_reader, NULL, NULL);
+  ASSERT_TRUE (reader_id != NULL);
+  ASSERT_TRUE (osThreadFlagsWait (2U, osFlagsWaitAny, 1000U) == 2U);
+
+  /* Prompt is staged while the other line is open */
+  stdout_flush();
+  stdio_get_stats (&s1);
+  ASSERT_TRUE (s1.tx_bytes == s0.tx_bytes);
+
+  start = osKernelGetSysTimerCount();
+  osThreadFlagsSet (reader_id, 1U);
+
+  /* Wait until the prompt is passed to the driver */
+  do {
+    stdio_get_stats (&s1);
+    t = perf_elapsed_us (start);
+  } while (((s1.tx_bytes - s0.tx_bytes) < (sizeof(perf_stdout_4_prompt) - 1U)) && (t < 1000000U));
+
+  ASSERT_TRUE ((s1.tx_bytes - s0.tx_bytes) == (sizeof(perf_stdout_4_prompt) - 1U));
+
+  /* The reader keeps waiting for input, host threads cannot be terminated */
+  osThreadTerminate (reader_id);
+
+  osThreadFlagsSet (line_id, 1U);
+  ASSERT_TRUE (osThreadFlagsWait (1U, osFlagsWaitAny, 1000U) == 1U);
+
+  /* Staged data of the terminated thread is committed by the next write */
+  for (i = 0U; (i < 100U) && (osThreadGetState (line_id) != osThreadTerminated) &&
+                            (osThreadGetState (line_id) != osThreadError); i++) {
+    osDelay (1U);
+  }
+  stdout_flush();
+  stdio_get_stats (&s1);
+  ASSERT_TRUE ((s1.tx_bytes - sb.tx_bytes) == ((sizeof(perf_stdout_4_open)   - 1U) +
+                                               (sizeof(perf_stdout_4_prompt) - 1U) + 7U + 5U));
+
+#if defined(PERF_CAPTURE)
+  cnt = usart_host_capture_stop();
+
+  /* Find the prompt in the output */
+  for (pos = 0U; (pos + sizeof(perf_stdout_4_prompt) - 1U) <= cnt; pos++) {
+    if (memcmp (&perf_cap[pos], perf_stdout_4_prompt, sizeof(perf_stdout_4_prompt) - 1U) == 0) {
+      break;
+    }
+  }
+  ASSERT_TRUE ((pos + sizeof(perf_stdout_4_prompt) - 1U) <= cnt);
+#endif
+
+  snprintf (msg, sizeof(msg), "prompt sent %u us after read", (unsigned int)t);
+  TEST_MESSAGE (msg);
+#endif
+}
+
+/**
+\brief Test case: TC_perf_stderr_1
+\details
+  - Fill the stdout buffer in drop-on-full mode with lines longer than a transmit chunk, so that stdout is saturated
+  - Output a short message to stderr
+  - Report the time until stderr output is passed to the driver and the remaining stdout backlog time
+  - The stderr message must be passed to the driver before the stdout backlog has drained
+  - The stderr message must start at a line boundary of the stdout output and come before the last
+    stdout line (checked on the host with the USART capture)
+*/
+void TC_perf_stderr_1 (void) {
+#if (TC_PERF_STDERR_1_EN)
+  char msg[96];
+  static const char line[] = "stdout backlog line ............................................\n";
+  static const char err[]  = "stderr priority message\n";
+  stdio_stats_t s0, s1;
+  uint32_t start, t_wait, t_drain;
+  uint32_t i;
+#if defined(PERF_CAPTURE)
+  uint32_t cnt, pos, last;
+#endif
+
+  stdout_flush();
+  ASSERT_TRUE (stdio_set_mode (STDIO_STDOUT, STDIO_MODE_DROP) == 0);
+#if defined(PERF_CAPTURE)
+  usart_host_capture_start (perf_cap, sizeof(perf_cap));
+#endif
+
+  /* Saturate stdout without blocking */
+  for (i = 0U; i < 16U; i++) {
+    stdout_write ((const uint8_t *)line, sizeof(line) - 1U);
+  }
+
+  stdio_get_stats (&s0);
+  start = osKernelGetSysTimerCount();
+
+  fputs (err, stderr);
+
+  /* Wait until the first stderr byte is passed to the driver */
+  do {
+    stdio_get_stats (&s1);
+    t_wait = perf_elapsed_us (start);
+  } while ((s1.err_bytes == s0.err_bytes) && (t_wait < 1000000U));
+
+  stdout_flush();
+  t_drain = perf_elapsed_us (start);
+
+  stdio_set_mode (STDIO_STDOUT, STDIO_MODE_BLOCK);
+
+  ASSERT_TRUE (s1.err_bytes != s0.err_bytes);
+  ASSERT_TRUE (t_wait < t_drain);
+
+#if defined(PERF_CAPTURE)
+  cnt = usart_host_capture_stop();
+
+  /* Find the stderr message in the output */
+  for (pos = 0U; (pos + sizeof(err) - 1U) <= cnt; pos++) {
+    if (memcmp (&perf_cap[pos], err, sizeof(err) - 1U) == 0) {
+      break;
+    }
+  }
+  ASSERT_TRUE ((pos + sizeof(err) - 1U) <= cnt);
+  ASSERT_TRUE ((pos == 0U) || (perf_cap[pos - 1U] == '\n'));
+
+  /* Find the last stdout line, the stderr message must not wait for it */
+  last = (cnt >= (sizeof(line) - 1U)) ? (cnt - (sizeof(line) - 1U)) : 0U;
+  while ((last != 0U) && (memcmp (&perf_cap[last], line, sizeof(line) - 1U) != 0)) {
+    last--;
+  }
+  ASSERT_TRUE (pos < last);
+#endif
+
+  snprintf (msg, sizeof(msg), "stderr wait %u us, stdout backlog %u us",
+                              (unsigned int)t_wait,
+                              (unsigned int)t_drain);
+  TEST_MESSAGE (msg);
+#endif
+}
+
+/**
+\brief Test case: TC_perf_log_1
+\details
+  - Output the same messages with printf and with deferred LOG_PRINTF
+  - Check that LOG_PRINTF passes fewer bytes to the driver and takes less
+    time per call, report both for printf and LOG_PRINTF
+  - Decode the captured LOG_PRINTF output with log_decode.py and compare it
+    to the printf text (on the host)
+*/
+void TC_perf_log_1 (void) {
+#if (TC_PERF_LOG_1_EN)
+  char msg[96];
+#if defined(PERF_LOG_DECODE)
+  static char text[256];
+  static char dec[256];
+  uint32_t cnt, len;
+#endif
+  stdio_stats_t s0, s1;
+  uint32_t start, t_printf, t_log, b_printf, b_log;
+  uint32_t i;
+
+  /* Few messages, so that the output fits into the transmit buffer */
+  stdout_flush();
+  stdio_get_stats (&s0);
+  start = osKernelGetSysTimerCount();
+
+  for (i = 0U; i < 4U; i++) {
+    printf ("sensor %d: %u mV, %f C\n", (int)i, (unsigned int)(3300U - i), 21.5 + (double)i);
+  }
+
+  t_printf = perf_elapsed_us (start);
+  stdout_flush();
+  stdio_get_stats (&s1);
+  b_printf = s1.tx_bytes - s0.tx_bytes;
+
+#if defined(PERF_LOG_DECODE)
+  usart_host_capture_start (perf_cap, sizeof(perf_cap));
+#endif
+  stdio_get_stats (&s0);
+  start = osKernelGetSysTimerCount();
+
+  for (i = 0U; i < 4U; i++) {
+    LOG_PRINTF ("sensor %d: %u mV, %f C\n", (int)i, (unsigned int)(3300U - i), 21.5 + (double)i);
+  }
+
+  t_log = perf_elapsed_us (start);
+  stdout_flush();
+  stdio_get_stats (&s1);
+  b_log = s1.tx_bytes - s0.tx_bytes;
+
+  ASSERT_TRUE (b_log < b_printf);
+  ASSERT_TRUE (t_log < t_printf);
+
+#if defined(PERF_LOG_DECODE)
+  cnt = usart_host_capture_stop();
+  ASSERT_TRUE (cnt == b_log);
+
+  len = 0U;
+  for (i = 0U; i < 4U; i++) {
+    len += (uint32_t)snprintf (&text[len], sizeof(text) - len, "sensor %d: %u mV, %f C\n",
+                               (int)i, (unsigned int)(3300U - i), 21.5 + (double)i);
+  }
+  ASSERT_TRUE (log_host_decode (perf_cap, cnt, dec, sizeof(dec)) == (int32_t)len);
+  ASSERT_TRUE (strcmp (dec, text) == 0);
+#endif
+
+  snprintf (msg, sizeof(msg), "printf: %u B, %u us/call; LOG_PRINTF: %u B, %u us/call",
+                              (unsigned int)b_printf, (unsigned int)(t_printf / 4U),
+                              (unsigned int)b_log,    (unsigned int)(t_log    / 4U));
+  TEST_MESSAGE (msg);
+#endif
+}
+
+/**
+\brief Test case: TC_perf_itm_1
+\details
+  - Output 1 KB to a trace stimulus port with one byte per stimulus port write
+  - Output 1 KB to a trace stimulus port packed into 32-bit stimulus port writes
+  - Check the number of stimulus port writes (1024 and 256) and that both
+    pass the same number of bytes (when the port is enabled)
+  - Report throughput and number of stimulus port writes for both
+*/
+void TC_perf_itm_1 (void) {
+#if (TC_PERF_ITM_1_EN)
+  char msg[96];
+  static const char line[] = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ.\n";
+  itm_stats_t s0, s1;
+  uint32_t start, t;
+  uint32_t i, n;
+  uint32_t bytes, drops;
+
+  /* One byte per write */
+  itm_get_stats (&s0);
+  start = osKernelGetSysTimerCount();
+
+  for (i = 0U; i < 16U; i++) {
+    for (n = 0U; n < (sizeof(line) - 1U); n++) {
+      itm_trace_write ((const uint8_t *)&line[n], 1U);
+    }
+  }
+
+  t = perf_elapsed_us (start);
+  itm_get_stats (&s1);
+
+  bytes = s1.bytes - s0.bytes;
+  drops = s1.drops - s0.drops;
+  if (drops == 0U) {
+    ASSERT_TRUE (bytes == 1024U);
+    ASSERT_TRUE ((s1.writes - s0.writes) == 1024U);
+  }
+
+  snprintf (msg, sizeof(msg), "8-bit writes: %u B/s, %u writes/KB",
+                              (unsigned int)perf_rate(1024U, t),
+                              (unsigned int)(s1.writes - s0.writes));
+  TEST_MESSAGE (msg);
+
+  /* Packed 32-bit writes */
+  itm_get_stats (&s0);
+  start = osKernelGetSysTimerCount();
+
+  for (i = 0U; i < 16U; i++) {
+    itm_trace_write ((const uint8_t *)line, sizeof(line) - 1U);
+  }
+
+  t = perf_elapsed_us (start);
+  itm_get_stats (&s1);
+
+  if ((drops == 0U) && ((s1.drops - s0.drops) == 0U)) {
+    ASSERT_TRUE ((s1.bytes - s0.bytes) == bytes);
+    ASSERT_TRUE ((s1.writes - s0.writes) == 256U);
+  }
+
+  snprintf (msg, sizeof(msg), "32-bit writes: %u B/s, %u writes/KB",
+                              (unsigned int)perf_rate(1024U, t),
+                              (unsigned int)(s1.writes - s0.writes));
+  TEST_MESSAGE (msg);
+#endif
+}
+
+/**
+\brief Test case: TC_perf_fwrite_1
+\details
+  - Write 4 KB to an unbuffered stream, one character per call
+  - Report throughput and write-back cache hit rate (when the file system
+    retarget has a cache)
+*/
+void TC_perf_fwrite_1 (void) {
+#if (TC_PERF_FWRITE_1_EN)
+  char msg[96];
+  rt_fs_cache_stats_t s0, s1;
+  uint32_t start, t;
+  uint32_t hits, rate;
+  int32_t rval;
+  FILE *f;
+  uint32_t n;
+
+  rval = rt_fs_cache_get_stats (&s0);
+
+  f = fopen ("perf.txt", "w");
+  ASSERT_TRUE (f != NULL);
+
+  if (f != NULL) {
+    ASSERT_TRUE (setvbuf (f, NULL, _IONBF, 0U) == 0);
+
+    start = osKernelGetSysTimerCount();
+
+    for (n = 0U; n < 4096U; n++) {
+      if (fputc ('E', f) != 'E') {
+        break;
+      }
+    }
+    ASSERT_TRUE (fclose (f) == 0);
+
+    t = perf_elapsed_us (start);
+    ASSERT_TRUE (n == 4096U);
+
+    if (rval == 0) {
+      rt_fs_cache_get_stats (&s1);
+
+      hits = s1.hits - s0.hits;
+      rate = 0U;
+      if ((hits + (s1.misses - s0.misses)) != 0U) {
+        rate = (hits * 100U) / (hits + (s1.misses - s0.misses));
+      }
+
+      snprintf (msg, sizeof(msg), "fputc: %u B/s, cache hit rate %u%%, %u fs writes",
+                                  (unsigned int)perf_rate(4096U, t),
+                                  (unsigned int)rate,
+                                  (unsigned int)(s1.writes - s0.writes));
+    } else {
+      snprintf (msg, sizeof(msg), "fputc: %u B/s, no write-back cache",
+                                  (unsigned int)perf_rate(4096U, t));
+    }
+    TEST_MESSAGE (msg);
+
+    remove ("perf.txt");
+  }
+#endif
+}
+
+/**
+\brief Test case: TC_perf_fread_1
+\details
+  - Create a 16 KB file
+  - Read the file sequentially with fread and calculate a checksum of the data
+  - Read the file again with rt_fs_read in chunks of one cache block, waiting
+    a tick after each chunk, and measure the time spent in rt_fs_read
+  - Report throughput and read-ahead statistics and check that read-ahead
+    blocks were read and used (when the file system retarget has a cache)
+*/
+#if (TC_PERF_FREAD_1_EN)
+/* Size of the chunks read with rt_fs_read, RT_FS_CACHE_BLOCK_SIZE of retarget_mdk-fs.c */
+#define PERF_FREAD_1_CHUNK      512U
+#endif
+
+void TC_perf_fread_1 (void) {
+#if (TC_PERF_FREAD_1_EN)
+  char msg[96];
+  static uint8_t buf[PERF_FREAD_1_CHUNK];
+  rt_fs_cache_stats_t s0, s1;
+  uint32_t start, t;
+  uint32_t sum, cnt;
+  int32_t rval;
+  int32_t fd, r;
+  size_t n;
+  FILE *f;
+
+  f = fopen ("perf.bin", "w");
+  ASSERT_TRUE (f != NULL);
+
+  if (f != NULL) {
+    for (n = 0U; n < sizeof(buf); n++) {
+      buf[n] = (uint8_t)n;
+    }
+    for (cnt = 0U; cnt < 16384U; cnt += 256U) {
+      fwrite (buf, 1U, 256U, f);
+    }
+    ASSERT_TRUE (fclose (f) == 0);
+  }
+
+  rval = rt_fs_cache_get_stats (&s0);
+
+  f = fopen ("perf.bin", "r");
+  ASSERT_TRUE (f != NULL);
+
+  if (f != NULL) {
+    start = osKernelGetSysTimerCount();
+
+    sum = 0U;
+    cnt = 0U;
+    do {
+      n = fread (buf, 1U, 256U, f);
+      cnt += n;
+      while (n != 0U) {
+        sum += buf[--n];
+      }
+    } while ((cnt < 16384U) && (feof (f) == 0));
+    ASSERT_TRUE (fclose (f) == 0);
+
+    t = perf_elapsed_us (start);
+    ASSERT_TRUE (cnt == 16384U);
+    ASSERT_TRUE (sum == (16384U / 256U) * (255U * 256U / 2U));
+
+    if (rval == 0) {
+      rt_fs_cache_get_stats (&s1);
+
+      snprintf (msg, sizeof(msg), "fread: %u B/s, read ahead %u blocks, %u used, %u misses",
+                                  (unsigned int)perf_rate(cnt, t),
+                                  (unsigned int)(s1.ra_blocks - s0.ra_blocks),
+                                  (unsigned int)(s1.ra_hits   - s0.ra_hits),
+                                  (unsigned int)(s1.ra_misses - s0.ra_misses));
+    } else {
+      snprintf (msg, sizeof(msg), "fread: %u B/s, no read-ahead",
+                                  (unsigned int)perf_rate(cnt, t));
+    }
+    TEST_MESSAGE (msg);
+  }
+
+  /* Reads of one cache block are served from the blocks read ahead while
+     the reader waits between reads, as when sending the data on */
+  rval = rt_fs_cache_get_stats (&s0);
+
+  fd = rt_fs_open ("perf.bin", RT_OPEN_RDONLY);
+  ASSERT_TRUE (fd >= 0);
+
+  if (fd >= 0) {
+    sum = 0U;
+    cnt = 0U;
+    t   = 0U;
+    do {
+      start = osKernelGetSysTimerCount();
+      r = rt_fs_read (fd, buf, PERF_FREAD_1_CHUNK);
+      t += perf_elapsed_us (start);
+      if (r > 0) {
+        cnt += (uint32_t)r;
+        while (r != 0) {
+          sum += buf[--r];
+        }
+        osDelay (1U);
+      }
+    } while ((cnt < 16384U) && (r >= 0));
+
+    ASSERT_TRUE (rt_fs_close (fd) == 0);
+    ASSERT_TRUE (cnt == 16384U);
+    ASSERT_TRUE (sum == (16384U / 256U) * (255U * 256U / 2U));
+
+    if (rval == 0) {
+      rt_fs_cache_get_stats (&s1);
+      ASSERT_TRUE ((s1.ra_blocks - s0.ra_blocks) > 0U);
+      ASSERT_TRUE ((s1.ra_hits   - s0.ra_hits)   > 0U);
+
+      snprintf (msg, sizeof(msg), "rt_fs_read: %u B/s, read ahead %u blocks, %u used, %u misses",
+                                  (unsigned int)perf_rate(cnt, t),
+                                  (unsigned int)(s1.ra_blocks - s0.ra_blocks),
+                                  (unsigned int)(s1.ra_hits   - s0.ra_hits),
+                                  (unsigned int)(s1.ra_misses - s0.ra_misses));
+    } else {
+      snprintf (msg, sizeof(msg), "rt_fs_read: %u B/s, no read-ahead",
+                                  (unsigned int)perf_rate(cnt, t));
+    }
+    TEST_MESSAGE (msg);
+  }
+
+  remove ("perf.bin");
+#endif
+}
+
+#if (TC_PERF_RENAME_1_EN)
+/* Size of the renamed file */
+#define PERF_RENAME_1_SIZE      2048U
+
+/* Number of renames */
+#define PERF_RENAME_1_CNT       16U
+
+/* Rename a file the way newlib does without a rename syscall: _link, which
+   has to copy the file on file systems without hard links, and _unlink */
+static int32_t perf_rename_1_emulate (const char *oldpath, const char *newpath, uint32_t *ops) {
+  static uint8_t buf[512];
+  int32_t fd_old, fd_new, n;
+
+  fd_old = rt_fs_open (oldpath, RT_OPEN_RDONLY);
+  (*ops)++;
+  if (fd_old < 0) {
+    return (fd_old);
+  }
+  fd_new = rt_fs_open (newpath, RT_OPEN_WRONLY | RT_OPEN_CREATE | RT_OPEN_EXCL);
+  (*ops)++;
+  if (fd_new < 0) {
+    rt_fs_close (fd_old);
+    (*ops)++;
+    return (fd_new);
+  }
+
+  do {
+    n = rt_fs_read (fd_old, buf, sizeof(buf));
+    (*ops)++;
+    if (n > 0) {
+      n = rt_fs_write (fd_new, buf, (uint32_t)n);
+      (*ops)++;
+    }
+  } while (n > 0);
+
+  rt_fs_close (fd_new);
+  rt_fs_close (fd_old);
+  *ops += 2U;
+
+  if (n == 0) {
+    n = rt_fs_remove (oldpath);
+    (*ops)++;
+  }
+  return (n);
+}
+#endif
+
+/**
+\brief Test case: TC_perf_rename_1
+\details
+  - Create a 2 KB file
+  - Rename the file back and forth with the link and unlink emulation of newlib
+  - Rename the file back and forth with rename
+  - Check that rename does one file system operation (on the host)
+  - Report file system operations and time per rename for both
+*/
+void TC_perf_rename_1 (void) {
+#if (TC_PERF_RENAME_1_EN)
+  char msg[96];
+  static const char *path[2] = { "perf_a.bin", "perf_b.bin" };
+  uint32_t start, t, ops;
+  uint32_t i;
+  FILE *f;
+
+  remove (path[1]);
+
+  f = fopen (path[0], "w");
+  ASSERT_TRUE (f != NULL);
+
+  if (f != NULL) {
+    for (i = 0U; i < PERF_RENAME_1_SIZE; i++) {
+      fputc ((int)(i & 0xFFU), f);
+    }
+    ASSERT_TRUE (fclose (f) == 0);
+
+    /* link and unlink */
+    ops   = 0U;
+    start = osKernelGetSysTimerCount();
+
+    for (i = 0U; i < PERF_RENAME_1_CNT; i++) {
+      ASSERT_TRUE (perf_rename_1_emulate (path[i & 1U], path[(i + 1U) & 1U], &ops) == 0);
+    }
+
+    t = perf_elapsed_us (start);
+
+    snprintf (msg, sizeof(msg), "link+unlink: %u FS ops/rename, %u us/rename",
+                                (unsigned int)(ops / PERF_RENAME_1_CNT),
+                                (unsigned int)(t   / PERF_RENAME_1_CNT));
+    TEST_MESSAGE (msg);
+
+    /* rename */
+#if defined(RETARGET_HOST_FS_CALLS)
+    ops   = retarget_host_fs_calls();
+#endif
+    start = osKernelGetSysTimerCount();
+
+    for (i = 0U; i < PERF_RENAME_1_CNT; i++) {
+      ASSERT_TRUE (rename (path[i & 1U], path[(i + 1U) & 1U]) == 0);
+    }
+
+    t = perf_elapsed_us (start);
+
+#if defined(RETARGET_HOST_FS_CALLS)
+    ops = retarget_host_fs_calls() - ops;
+    ASSERT_TRUE (ops == PERF_RENAME_1_CNT);
+
+    snprintf (msg, sizeof(msg), "rename: %u FS ops/rename, %u us/rename",
+                                (unsigned int)(ops / PERF_RENAME_1_CNT),
+                                (unsigned int)(t   / PERF_RENAME_1_CNT));
+#else
+    snprintf (msg, sizeof(msg), "rename: %u us/rename",
+                                (unsigned int)(t / PERF_RENAME_1_CNT));
+#endif
+    TEST_MESSAGE (msg);
+  }
+
+  remove (path[0]);
+  remove (path[1]);
+#endif
+}
+
+#if (TC_PERF_MAP_1_EN)
+/* Size of the lookup table file */
+#define PERF_MAP_1_SIZE         1024U
+
+/* Number of passes over the table */
+#define PERF_MAP_1_CNT          64U
+#endif
+
+/**
+\brief Test case: TC_perf_map_1
+\details
+  - Create a 1 KB lookup table file
+  - Read the table 64 times with fread and calculate a checksum of the data
+  - Read the table 64 times through rt_fs_map and calculate a checksum of the data
+  - Report throughput for both and maps served from the cache (when the file
+    system retarget has a cache)
+*/
+void TC_perf_map_1 (void) {
+#if (TC_PERF_MAP_1_EN)
+  char msg[96];
+  static uint8_t buf[256];
+  rt_fs_cache_stats_t s0, s1;
+  const void *ptr;
+  uint32_t start, t;
+  uint32_t sum, ofs, i;
+  int32_t fd, rval, n;
+  size_t cnt;
+  FILE *f;
+
+  f = fopen ("perf.bin", "w");
+  ASSERT_TRUE (f != NULL);
+
+  if (f != NULL) {
+    for (i = 0U; i < PERF_MAP_1_SIZE; i++) {
+      fputc ((int)(i & 0xFFU), f);
+    }
+    ASSERT_TRUE (fclose (f) == 0);
+  }
+
+  /* fread */
+  f = fopen ("perf.bin", "r");
+  ASSERT_TRUE (f != NULL);
+
+  if (f != NULL) {
+    sum   = 0U;
+    start = osKernelGetSysTimerCount();
+
+    for (i = 0U; i < PERF_MAP_1_CNT; i++) {
+      fseek (f, 0, SEEK_SET);
+      for (ofs = 0U; ofs < PERF_MAP_1_SIZE; ofs += cnt) {
+        cnt = fread (buf, 1U, sizeof(buf), f);
+        if (cnt == 0U) {
+          break;
+        }
+        while (cnt != 0U) {
+          sum += buf[--cnt];
+        }
+        cnt = sizeof(buf);
+      }
+    }
+
+    t = perf_elapsed_us (start);
+    ASSERT_TRUE (fclose (f) == 0);
+    ASSERT_TRUE (sum == PERF_MAP_1_CNT * (PERF_MAP_1_SIZE / 256U) * (255U * 256U / 2U));
+
+    snprintf (msg, sizeof(msg), "fread: %u B/s",
+                                (unsigned int)perf_rate(PERF_MAP_1_CNT * PERF_MAP_1_SIZE, t));
+    TEST_MESSAGE (msg);
+  }
+
+  /* rt_fs_map */
+  fd = rt_fs_open ("perf.bin", RT_OPEN_RDONLY);
+  ASSERT_TRUE (fd >= 0);
+
+  if (fd >= 0) {
+    rval  = rt_fs_cache_get_stats (&s0);
+    sum   = 0U;
+    n     = 0;
+    start = osKernelGetSysTimerCount();
+
+    for (i = 0U; i < PERF_MAP_1_CNT; i++) {
+      for (ofs = 0U; ofs < PERF_MAP_1_SIZE; ofs += (uint32_t)n) {
+        n = rt_fs_map (fd, ofs, PERF_MAP_1_SIZE - ofs, &ptr);
+        if (n <= 0) {
+          break;
+        }
+        for (cnt = 0U; cnt < (uint32_t)n; cnt++) {
+          sum += ((const uint8_t *)ptr)[cnt];
+        }
+        rt_fs_unmap (fd, ptr);
+      }
+      if (n <= 0) {
+        break;
+      }
+    }
+
+    t = perf_elapsed_us (start);
+
+    if (n == RT_ERR_NOTSUP) {
+      snprintf (msg, sizeof(msg), "rt_fs_map: not supported");
+    } else {
+      ASSERT_TRUE (n > 0);
+      ASSERT_TRUE (sum == PERF_MAP_1_CNT * (PERF_MAP_1_SIZE / 256U) * (255U * 256U / 2U));
+
+      if (rval == 0) {
+        rt_fs_cache_get_stats (&s1);
+
+        snprintf (msg, sizeof(msg), "rt_fs_map: %u B/s, %u maps from cache, %u blocks loaded",
+                                    (unsigned int)perf_rate(PERF_MAP_1_CNT * PERF_MAP_1_SIZE, t),
+                                    (unsigned int)(s1.map_hits  - s0.map_hits),
+                                    (unsigned int)(s1.map_loads - s0.map_loads));
+      } else {
+        snprintf (msg, sizeof(msg), "rt_fs_map: %u B/s",
+                                    (unsigned int)perf_rate(PERF_MAP_1_CNT * PERF_MAP_1_SIZE, t));
+      }
+    }
+    TEST_MESSAGE (msg);
+
+    ASSERT_TRUE (rt_fs_close (fd) == 0);
+  }
+
+  remove ("perf.bin");
+#endif
+}
+
+#if (TC_PERF_WRITEV_1_EN)
+/* Number of records */
+#define PERF_WRITEV_1_CNT       128U
+
+/* Record: header, payload and CRC */
+typedef struct {
+  uint8_t hdr[8];
+  uint8_t data[48];
+  uint8_t crc[4];
+} perf_record_t;
+
+/* Fill a record */
+static void perf_writev_1_record (perf_record_t *r, uint32_t idx) {
+  uint32_t i;
+
+  memset (r->hdr, (int)idx, sizeof(r->hdr));
+  for (i = 0U; i < sizeof(r->data); i++) {
+    r->data[i] = (uint8_t)(idx + i);
+  }
+  memset (r->crc, (int)~idx, sizeof(r->crc));
+}
+#endif
+
+/**
+\brief Test case: TC_perf_writev_1
+\details
+  - Write 128 records of header, payload and CRC with three rt_fs_write calls per record
+  - Write the same records with one rt_fs_writev call per record
+  - Read the records back with rt_fs_readv and compare them
+  - Report the time for both
+*/
+void TC_perf_writev_1 (void) {
+#if (TC_PERF_WRITEV_1_EN)
+  char msg[96];
+  perf_record_t r, rd;
+  rt_fs_iovec_t iov[3];
+  uint32_t start, t_write, t_writev;
+  uint32_t i;
+  int32_t fd, n;
+
+  /* rt_fs_write */
+  fd = rt_fs_open ("perf.bin", RT_OPEN_WRONLY | RT_OPEN_CREATE | RT_OPEN_TRUNCATE);
+  ASSERT_TRUE (fd >= 0);
+  if (fd < 0) {
+    return;
+  }
+
+  start = osKernelGetSysTimerCount();
+
+  for (i = 0U; i < PERF_WRITEV_1_CNT; i++) {
+    perf_writev_1_record (&r, i);
+    rt_fs_write (fd, r.hdr,  sizeof(r.hdr));
+    rt_fs_write (fd, r.data, sizeof(r.data));
+    rt_fs_write (fd, r.crc,  sizeof(r.crc));
+  }
+  ASSERT_TRUE (rt_fs_close (fd) == 0);
+
+  t_write = perf_elapsed_us (start);
+
+  /* rt_fs_writev */
+  fd = rt_fs_open ("perf.bin", RT_OPEN_WRONLY | RT_OPEN_CREATE | RT_OPEN_TRUNCATE);
+  ASSERT_TRUE (fd >= 0);
+  if (fd < 0) {
+    return;
+  }
+
+  iov[0].base = r.hdr;  iov[0].len = sizeof(r.hdr);
+  iov[1].base = r.data; iov[1].len = sizeof(r.data);
+  iov[2].base = r.crc;  iov[2].len = sizeof(r.crc);
+
+  start = osKernelGetSysTimerCount();
+
+  n = 0;
+  for (i = 0U; i < PERF_WRITEV_1_CNT; i++) {
+    perf_writev_1_record (&r, i);
+    n = rt_fs_writev (fd, iov, 3U);
+    if (n != (int32_t)sizeof(r)) {
+      break;
+    }
+  }
+  ASSERT_TRUE (rt_fs_close (fd) == 0);
+
+  t_writev = perf_elapsed_us (start);
+
+  if (n == RT_ERR_NOTSUP) {
+    snprintf (msg, sizeof(msg), "%u records: rt_fs_write %u us, rt_fs_writev not supported",
+                                (unsigned int)PERF_WRITEV_1_CNT,
+                                (unsigned int)t_write);
+  } else {
+    ASSERT_TRUE (n == (int32_t)sizeof(r));
+
+    /* Read back */
+    fd = rt_fs_open ("perf.bin", RT_OPEN_RDONLY);
+    ASSERT_TRUE (fd >= 0);
+
+    if (fd >= 0) {
+      iov[0].base = rd.hdr;  iov[0].len = sizeof(rd.hdr);
+      iov[1].base = rd.data; iov[1].len = sizeof(rd.data);
+      iov[2].base = rd.crc;  iov[2].len = sizeof(rd.crc);
+
+      for (i = 0U; i < PERF_WRITEV_1_CNT; i++) {
+        perf_writev_1_record (&r, i);
+        if ((rt_fs_readv (fd, iov, 3U) != (int32_t)sizeof(rd)) || (memcmp (&r, &rd, sizeof(r)) != 0)) {
+          break;
+        }
+      }
+      ASSERT_TRUE (i == PERF_WRITEV_1_CNT);
+      ASSERT_TRUE (rt_fs_readv (fd, iov, 3U) == 0);
+      ASSERT_TRUE (rt_fs_close (fd) == 0);
+    }
+
+    snprintf (msg, sizeof(msg), "%u records: rt_fs_write %u us, rt_fs_writev %u us",
+                                (unsigned int)PERF_WRITEV_1_CNT,
+                                (unsigned int)t_write,
+                                (unsigned int)t_writev);
+  }
+  TEST_MESSAGE (msg);
+
+  remove ("perf.bin");
+#endif
+}
+
+#if (TC_PERF_AIO_1_EN)
+/* Number of log lines */
+#define PERF_AIO_1_CNT          64U
+#endif
+
+/**
+\brief Test case: TC_perf_aio_1
+\details
+  - Write 64 log lines of 64 bytes to a file with rt_fs_write
+  - Write the same lines through the submission ring, collect completions only when the ring is full
+  - Close the file through the submission ring and check all completions
+  - Report average and maximum time the producer spends per line for both
+*/
+void TC_perf_aio_1 (void) {
+#if (TC_PERF_AIO_1_EN)
+  char msg[96];
+  static char line[] = "log line .......................................................\n";
+  rt_fs_aio_cqe_t c[8];
+  rt_fs_aio_sqe_t *e;
+  uint32_t start, t, t_sum, t_max;
+  uint32_t i, k, n, done, err;
+  int32_t fd;
+
+  /* rt_fs_write */
+  fd = rt_fs_open ("perf.log", RT_OPEN_WRONLY | RT_OPEN_CREATE | RT_OPEN_TRUNCATE);
+  ASSERT_TRUE (fd >= 0);
+
+  if (fd >= 0) {
+    t_sum = 0U;
+    t_max = 0U;
+    for (i = 0U; i < PERF_AIO_1_CNT; i++) {
+      start = osKernelGetSysTimerCount();
+      rt_fs_write (fd, line, sizeof(line) - 1U);
+      t = perf_elapsed_us (start);
+      t_sum += t;
+      if (t > t_max) {
+        t_max = t;
+      }
+    }
+    ASSERT_TRUE (rt_fs_close (fd) == 0);
+
+    snprintf (msg, sizeof(msg), "rt_fs_write: avg %u us, max %u us per line",
+                                (unsigned int)(t_sum / PERF_AIO_1_CNT),
+                                (unsigned int)t_max);
+    TEST_MESSAGE (msg);
+  }
+
+  /* Submission ring */
+  fd = rt_fs_open ("perf.log", RT_OPEN_WRONLY | RT_OPEN_CREATE | RT_OPEN_TRUNCATE);
+  ASSERT_TRUE (fd >= 0);
+
+  if (fd >= 0) {
+    t_sum = 0U;
+    t_max = 0U;
+    done  = 0U;
+    err   = 0U;
+    for (i = 0U; i <= PERF_AIO_1_CNT; i++) {
+      start = osKernelGetSysTimerCount();
+
+      e = rt_fs_aio_get_sqe ();
+      while (e == NULL) {
+        /* Ring full: wait for completions */
+        n = rt_fs_aio_reap (c, 8U, osWaitForever);
+        for (k = 0U; k < n; k++) {
+          if (c[k].res != (int32_t)(sizeof(line) - 1U)) {
+            err++;
+          }
+        }
+        done += n;
+        e = rt_fs_aio_get_sqe ();
+      }
+
+      if (i < PERF_AIO_1_CNT) {
+        e->op  = RT_FS_AIO_OP_WRITE;
+        e->buf = line;
+        e->len = sizeof(line) - 1U;
+      } else {
+        /* Close the file after the last line */
+        e->op  = RT_FS_AIO_OP_CLOSE;
+        e->user_data = e;
+      }
+      e->fd = fd;
+      rt_fs_aio_submit ();
+
+      t = perf_elapsed_us (start);
+      if (i < PERF_AIO_1_CNT) {
+        t_sum += t;
+        if (t > t_max) {
+          t_max = t;
+        }
+      }
+    }
+
+    /* Collect remaining completions */
+    while (done <= PERF_AIO_1_CNT) {
+      n = rt_fs_aio_reap (c, 8U, 1000U);
+      if (n == 0U) {
+        break;
+      }
+      for (k = 0U; k < n; k++) {
+        if (c[k].user_data != NULL) {
+          /* Close */
+          if (c[k].res != 0) {
+            err++;
+          }
+        } else
+        if (c[k].res != (int32_t)(sizeof(line) - 1U)) {
+          err++;
+        }
+      }
+      done += n;
+    }
+    ASSERT_TRUE (done == (PERF_AIO_1_CNT + 1U));
+    ASSERT_TRUE (err == 0U);
+
+    snprintf (msg, sizeof(msg), "rt_fs_aio: avg %u us, max %u us per line",
+                                (unsigned int)(t_sum / PERF_AIO_1_CNT),
+                                (unsigned int)t_max);
+    TEST_MESSAGE (msg);
+  }
+
+  remove ("perf.log");
+#endif
+}
+
+#if (TC_PERF_SEEK_1_EN)
+/* Number of records */
+#define PERF_SEEK_1_CNT         256U
+
+/* Record size in bytes */
+#define PERF_SEEK_1_SIZE        32U
+
+/* Fill a record */
+static void perf_seek_1_record (uint8_t *r, uint32_t idx) {
+  uint32_t i;
+
+  for (i = 0U; i < PERF_SEEK_1_SIZE; i++) {
+    r[i] = (uint8_t)(idx ^ i);
+  }
+}
+#endif
+
+/**
+\brief Test case: TC_perf_seek_1
+\details
+  - Append 256 records of 32 bytes to a file with rt_fs_write
+  - Report average time per append of the first and the last 64 records
+  - Seek to 256 records in pseudo-random order and read them with rt_fs_read
+  - Check the data and report average time per seek and read
+*/
+void TC_perf_seek_1 (void) {
+#if (TC_PERF_SEEK_1_EN)
+  char msg[96];
+  uint8_t r[PERF_SEEK_1_SIZE], rd[PERF_SEEK_1_SIZE];
+  uint32_t start, t, t_first, t_last;
+  uint32_t i, idx, err;
+  int32_t fd;
+
+  fd = rt_fs_open ("perf.bin", RT_OPEN_RDWR | RT_OPEN_CREATE | RT_OPEN_TRUNCATE);
+  ASSERT_TRUE (fd >= 0);
+  if (fd < 0) {
+    return;
+  }
+
+  /* Append, the first and the last 64 records are timed */
+  t_first = 0U;
+  t_last  = 0U;
+  err     = 0U;
+  start   = osKernelGetSysTimerCount();
+  for (i = 0U; i < PERF_SEEK_1_CNT; i++) {
+    if (i == 64U) {
+      t_first = perf_elapsed_ns (start);
+    }
+    if (i == (PERF_SEEK_1_CNT - 64U)) {
+      start = osKernelGetSysTimerCount();
+    }
+    perf_seek_1_record (r, i);
+    if (rt_fs_write (fd, r, PERF_SEEK_1_SIZE) != (int32_t)PERF_SEEK_1_SIZE) {
+      err++;
+    }
+  }
+  t_last = perf_elapsed_ns (start);
+  ASSERT_TRUE (err == 0U);
+  ASSERT_TRUE (rt_fs_size (fd) == (int64_t)(PERF_SEEK_1_CNT * PERF_SEEK_1_SIZE));
+
+  snprintf (msg, sizeof(msg), "append: first 64 records %u ns, last 64 records %u ns per record",
+                              (unsigned int)(t_first / 64U),
+                              (unsigned int)(t_last  / 64U));
+  TEST_MESSAGE (msg);
+
+  /* Seek and read, the step is odd so that every record is visited once */
+  idx   = 0U;
+  start = osKernelGetSysTimerCount();
+
+  for (i = 0U; i < PERF_SEEK_1_CNT; i++) {
+    idx = (idx + 97U) % PERF_SEEK_1_CNT;
+    if ((rt_fs_seek (fd, (int64_t)(idx * PERF_SEEK_1_SIZE), RT_SEEK_SET) != (int64_t)(idx * PERF_SEEK_1_SIZE)) ||
+        (rt_fs_read (fd, rd, PERF_SEEK_1_SIZE) != (int32_t)PERF_SEEK_1_SIZE)) {
+      err++;
+      continue;
+    }
+    perf_seek_1_record (r, idx);
+    if (memcmp (r, rd, PERF_SEEK_1_SIZE) != 0) {
+      err++;
+    }
+  }
+
+  t = perf_elapsed_ns (start);
+  ASSERT_TRUE (err == 0U);
+  ASSERT_TRUE (rt_fs_close (fd) == 0);
+
+  snprintf (msg, sizeof(msg), "seek and read: %u ns per record",
+                              (unsigned int)(t / PERF_SEEK_1_CNT));
+  TEST_MESSAGE (msg);
+
+  remove ("perf.bin");
+#endif
+}
+
+#if (TC_PERF_LOOKUP_1_EN)
+/* Number of lookups */
+#define PERF_LOOKUP_1_CNT       64U
+#endif
+
+/**
+\brief Test case: TC_perf_lookup_1
+\details
+  - Create a configuration file of 16 bytes
+  - Look up the file 64 times with rt_fs_lookup and check its size
+  - Open a file that does not exist 64 times for reading
+  - List the root directory and check that the configuration file is listed
+  - Drop cached lookups with rt_fs_invalidate and look up the file again
+  - Report average time per lookup and per failed open, and lookups served by
+    the directory cache (when the file system retarget has one)
+*/
+void TC_perf_lookup_1 (void) {
+#if (TC_PERF_LOOKUP_1_EN)
+  char msg[96];
+  rt_fs_dirent_t ent;
+  rt_fs_cache_stats_t s0, s1;
+  uint32_t start, t_lookup, t_open;
+  uint32_t i, err, found;
+  int32_t fd, dd, rval;
+
+  fd = rt_fs_open ("perf.cfg", RT_OPEN_WRONLY | RT_OPEN_CREATE | RT_OPEN_TRUNCATE);
+  ASSERT_TRUE (fd >= 0);
+  if (fd < 0) {
+    return;
+  }
+  ASSERT_TRUE (rt_fs_write (fd, "mode=1\nrate=100\n", 16U) == 16);
+  ASSERT_TRUE (rt_fs_close (fd) == 0);
+
+  rval = rt_fs_cache_get_stats (&s0);
+
+  /* Existing file */
+  err   = 0U;
+  start = osKernelGetSysTimerCount();
+
+  for (i = 0U; i < PERF_LOOKUP_1_CNT; i++) {
+    if ((rt_fs_lookup ("perf.cfg", &ent) != 0) || (ent.size != 16) || ((ent.attr & RT_ATTR_DIR) != 0U)) {
+      err++;
+    }
+  }
+
+  t_lookup = perf_elapsed_ns (start);
+  ASSERT_TRUE (err == 0U);
+
+  /* File that does not exist */
+  start = osKernelGetSysTimerCount();
+
+  for (i = 0U; i < PERF_LOOKUP_1_CNT; i++) {
+    fd = rt_fs_open ("perf_none.cfg", RT_OPEN_RDONLY);
+    if (fd >= 0) {
+      rt_fs_close (fd);
+      err++;
+    }
+  }
+
+  t_open = perf_elapsed_ns (start);
+  ASSERT_TRUE (err == 0U);
+  ASSERT_TRUE (rt_fs_lookup ("perf_none.cfg", &ent) == RT_ERR_NOTFOUND);
+
+  if (rval == 0) {
+    rval = rt_fs_cache_get_stats (&s1);
+  }
+
+  /* Directory listing */
+  dd = rt_fs_opendir ("");
+  ASSERT_TRUE (dd >= 0);
+
+  if (dd >= 0) {
+    found = 0U;
+    while (rt_fs_readdir (dd, &ent) == 1) {
+      if (strcmp (ent.name, "perf.cfg") == 0) {
+        found++;
+      }
+    }
+    ASSERT_TRUE (found == 1U);
+    ASSERT_TRUE (rt_fs_closedir (dd) == 0);
+  }
+
+  /* Cached lookups dropped, the file is found again */
+  fd = rt_fs_invalidate (NULL);
+  ASSERT_TRUE ((fd == 0) || (fd == RT_ERR_NOTSUP));
+  ASSERT_TRUE ((rt_fs_lookup ("perf.cfg", &ent) == 0) && (ent.size == 16));
+
+  if (rval == 0) {
+    snprintf (msg, sizeof(msg), "lookup %u ns, failed open %u ns, %u of %u lookups cached",
+                                (unsigned int)(t_lookup / PERF_LOOKUP_1_CNT),
+                                (unsigned int)(t_open   / PERF_LOOKUP_1_CNT),
+                                (unsigned int)(s1.dc_hits - s0.dc_hits),
+                                (unsigned int)((s1.dc_hits + s1.dc_misses) - (s0.dc_hits + s0.dc_misses)));
+  } else {
+    snprintf (msg, sizeof(msg), "lookup %u ns, failed open %u ns, no directory cache",
+                                (unsigned int)(t_lookup / PERF_LOOKUP_1_CNT),
+                                (unsigned int)(t_open   / PERF_LOOKUP_1_CNT));
+  }
+  TEST_MESSAGE (msg);
+
+  remove ("perf.cfg");
+#endif
+}
+
+#if (TC_PERF_FD_1_EN)
+/* Number of open files */
+#define PERF_FD_1_NUM           4U
+/* Number of calls per file */
+#define PERF_FD_1_CNT           256U
+#endif
+
+/**
+\brief Test case: TC_perf_fd_1
+\details
+  - Open 4 files and write 8 bytes to each of them
+  - Call rt_fs_seek (RT_SEEK_CUR) and rt_fs_size 256 times for each file,
+    alternating between the files, and check the results
+  - Close one of the files and check that calls with its file handle fail
+  - Report average time per call
+*/
+void TC_perf_fd_1 (void) {
+#if (TC_PERF_FD_1_EN)
+  char msg[96];
+  char name[16];
+  int32_t fd[PERF_FD_1_NUM];
+  uint32_t start, t;
+  uint32_t i, j, err;
+  uint8_t buf[8];
+
+  for (j = 0U; j < PERF_FD_1_NUM; j++) {
+    snprintf (name, sizeof(name), "perf%u.bin", (unsigned int)j);
+    fd[j] = rt_fs_open (name, RT_OPEN_RDWR | RT_OPEN_CREATE | RT_OPEN_TRUNCATE);
+    ASSERT_TRUE (fd[j] >= 0);
+    if (fd[j] < 0) {
+      while (j != 0U) {
+        rt_fs_close (fd[--j]);
+      }
+      return;
+    }
+    ASSERT_TRUE (rt_fs_write (fd[j], "01234567", 8U) == 8);
+  }
+
+  err   = 0U;
+  start = osKernelGetSysTimerCount();
+
+  for (i = 0U; i < PERF_FD_1_CNT; i++) {
+    for (j = 0U; j < PERF_FD_1_NUM; j++) {
+      if (rt_fs_seek (fd[j], 0, RT_SEEK_CUR) != 8) {
+        err++;
+      }
+      if (rt_fs_size (fd[j]) != 8) {
+        err++;
+      }
+    }
+  }
+
+  t = perf_elapsed_ns (start);
+  ASSERT_TRUE (err == 0U);
+
+  /* File handle is no longer valid after close */
+  ASSERT_TRUE (rt_fs_close (fd[0]) == 0);
+  ASSERT_TRUE (rt_fs_size (fd[0]) < 0);
+  ASSERT_TRUE (rt_fs_read (fd[0], buf, sizeof(buf)) < 0);
+  ASSERT_TRUE (rt_fs_close (fd[0]) < 0);
+
+  for (j = 1U; j < PERF_FD_1_NUM; j++) {
+    ASSERT_TRUE (rt_fs_close (fd[j]) == 0);
+  }
+
+  snprintf (msg, sizeof(msg), "%u files open: %u ns per call",
+                              (unsigned int)PERF_FD_1_NUM,
+                              (unsigned int)(t / (PERF_FD_1_CNT * PERF_FD_1_NUM * 2U)));
+  TEST_MESSAGE (msg);
+
+  for (j = 0U; j < PERF_FD_1_NUM; j++) {
+    snprintf (name, sizeof(name), "perf%u.bin", (unsigned int)j);
+    remove (name);
+  }
+#endif
+}
+
+#if (TC_PERF_LARGE_1_EN)
+/* Number of records */
+#define PERF_LARGE_1_NUM        32U
+
+/* Distance of the records: 160 MB, the last record is beyond 4 GB */
+#define PERF_LARGE_1_STEP       0x0A000000LL
+
+/* Record size in bytes */
+#define PERF_LARGE_1_SIZE       16U
+
+/* Number of seeks */
+#define PERF_LARGE_1_CNT        256U
+
+/* Fill a record */
+static void perf_large_1_record (uint8_t *r, uint32_t idx) {
+  uint32_t i;
+
+  for (i = 0U; i < PERF_LARGE_1_SIZE; i++) {
+    r[i] = (uint8_t)((idx << 4) ^ i);
+  }
+}
+#endif
+
+/**
+\brief Test case: TC_perf_large_1
+\details
+  - Write 32 records of 16 bytes at a distance of 160 MB, so that the file
+    grows beyond 4 GB (a sparse file on a host file system)
+  - Check the file size with rt_fs_size
+  - Seek to the records 256 times in pseudo-random order and read them
+  - Check the data and report average time per seek and read
+  - File systems without files of 4 GB and more are reported and skipped
+*/
+void TC_perf_large_1 (void) {
+#if (TC_PERF_LARGE_1_EN)
+  char msg[96];
+  uint8_t r[PERF_LARGE_1_SIZE], rd[PERF_LARGE_1_SIZE];
+  uint32_t start, t;
+  uint32_t i, idx, seed, err;
+  int64_t pos, sz;
+  int32_t fd;
+
+  fd = rt_fs_open ("perf.bin", RT_OPEN_RDWR | RT_OPEN_CREATE | RT_OPEN_TRUNCATE);
+  ASSERT_TRUE (fd >= 0);
+  if (fd < 0) {
+    return;
+  }
+
+  /* Records beyond the end of file are written after a seek */
+  for (idx = 0U; idx < PERF_LARGE_1_NUM; idx++) {
+    pos = (int64_t)idx * PERF_LARGE_1_STEP;
+    perf_large_1_record (r, idx);
+    if ((rt_fs_seek (fd, pos, RT_SEEK_SET) != pos) ||
+        (rt_fs_write (fd, r, PERF_LARGE_1_SIZE) != (int32_t)PERF_LARGE_1_SIZE)) {
+      break;
+    }
+  }
+
+  if (idx < PERF_LARGE_1_NUM) {
+    snprintf (msg, sizeof(msg), "files of 4 GB and more not supported, stopped at %u MB",
+                                (unsigned int)(((int64_t)idx * PERF_LARGE_1_STEP) >> 20));
+    TEST_MESSAGE (msg);
+    rt_fs_close (fd);
+    remove ("perf.bin");
+    return;
+  }
+
+  sz = rt_fs_size (fd);
+  ASSERT_TRUE (sz == (((int64_t)(PERF_LARGE_1_NUM - 1U) * PERF_LARGE_1_STEP) + PERF_LARGE_1_SIZE));
+  ASSERT_TRUE (sz > (int64_t)UINT32_MAX);
+
+  /* Seek and read */
+  err   = 0U;
+  seed  = 1U;
+  start = osKernelGetSysTimerCount();
+
+  for (i = 0U; i < PERF_LARGE_1_CNT; i++) {
+    seed = (seed * 1103515245U) + 12345U;
+    idx  = (seed >> 16) % PERF_LARGE_1_NUM;
+    pos  = (int64_t)idx * PERF_LARGE_1_STEP;
+    if ((rt_fs_seek (fd, pos, RT_SEEK_SET) != pos) ||
+        (rt_fs_read (fd, rd, PERF_LARGE_1_SIZE) != (int32_t)PERF_LARGE_1_SIZE)) {
+      err++;
+      continue;
+    }
+    perf_large_1_record (r, idx);
+    if (memcmp (r, rd, PERF_LARGE_1_SIZE) != 0) {
+      err++;
+    }
+  }
+
+  t = perf_elapsed_ns (start);
+  ASSERT_TRUE (err == 0U);
+  ASSERT_TRUE (rt_fs_close (fd) == 0);
+
+  snprintf (msg, sizeof(msg), "file of %u MB: seek and read %u ns per record",
+                              (unsigned int)(sz >> 20),
+                              (unsigned int)(t / PERF_LARGE_1_CNT));
+  TEST_MESSAGE (msg);
+
+  remove ("perf.bin");
+#endif
+}
+
+#if (TC_PERF_VFS_1_EN)
+/* Number of open and close calls per path */
+#define PERF_VFS_1_CNT          256U
+
+/* Time open and close of a path, returns ns per pair or 0 on error */
+static uint32_t perf_vfs_1_open (const char *path) {
+  uint32_t start, t, i;
+  int32_t fd;
+
+  fd = rt_fs_open (path, RT_OPEN_WRONLY | RT_OPEN_CREATE | RT_OPEN_TRUNCATE);
+  if (fd < 0) {
+    return (0U);
+  }
+  if ((rt_fs_write (fd, path, 8U) != 8) || (rt_fs_close (fd) != 0)) {
+    return (0U);
+  }
+
+  start = osKernelGetSysTimerCount();
+
+  for (i = 0U; i < PERF_VFS_1_CNT; i++) {
+    fd = rt_fs_open (path, RT_OPEN_RDONLY);
+    if ((fd < 0) || (rt_fs_close (fd) != 0)) {
+      return (0U);
+    }
+  }
+
+  t = perf_elapsed_ns (start);
+
+  return ((t / PERF_VFS_1_CNT) + 1U);
+}
+#endif
+
+#if (TC_PERF_VFS_1_EN) && defined(RT_FS_VFS)
+/* Read the first 8 bytes of a path, returns 1 when they match data */
+static uint32_t perf_vfs_1_read (const char *path, const char *data) {
+  char buf[8];
+  int32_t fd, n;
+
+  fd = rt_fs_open (path, RT_OPEN_RDONLY);
+  if (fd < 0) {
+    return (0U);
+  }
+  n = rt_fs_read (fd, buf, 8U);
+  rt_fs_close (fd);
+
+  return (((n == 8) && (memcmp (buf, data, 8U) == 0)) ? 1U : 0U);
+}
+#endif
+
+/**
+\brief Test case: TC_perf_vfs_1
+\details
+  - Create "perf.bin" and "/ram/perf.bin" and write 8 bytes to each
+  - Open and close each file 256 times
+  - Report average time per open and close for each path
+  - A path that cannot be created (no mount at "/ram") is reported
+  - With the mount table (RT_FS_VFS):
+    - check that each path reaches its own backend with the prefix removed
+    - check that "/rom" (host file system, RT_VFS_RDONLY) reads "perf.bin"
+      and rejects opening for writing and removing with RT_ERR_BUSY
+    - check that data written to "/nor" (RT_VFS_WRITE_THROUGH) is in the
+      file system before the file is closed
+*/
+void TC_perf_vfs_1 (void) {
+#if (TC_PERF_VFS_1_EN)
+  char msg[96];
+  uint32_t t_def, t_ram;
+#if defined(RT_FS_VFS)
+  rt_logfs_stats_t s0, s1;
+  rt_fs_dirent_t ent;
+  int32_t fd;
+#endif
+
+  t_def = perf_vfs_1_open ("perf.bin");
+  ASSERT_TRUE (t_def != 0U);
+
+  t_ram = perf_vfs_1_open ("/ram/perf.bin");
+  if (t_ram == 0U) {
+    snprintf (msg, sizeof(msg), "open and close: %u ns, /ram not mounted",
+                                (unsigned int)t_def);
+  } else {
+    snprintf (msg, sizeof(msg), "open and close: %u ns, on /ram %u ns",
+                                (unsigned int)t_def, (unsigned int)t_ram);
+  }
+  TEST_MESSAGE (msg);
+
+#if defined(RT_FS_VFS)
+  /* Routing: the data written is the path */
+  ASSERT_TRUE (perf_vfs_1_read ("perf.bin",      "perf.bin") != 0U);
+  ASSERT_TRUE (perf_vfs_1_read ("/ram/perf.bin", "/ram/per") != 0U);
+  ASSERT_TRUE (rt_fs_ops_ramfs.lookup ("perf.bin", &ent) == 0);
+
+  /* Read-only mount */
+  ASSERT_TRUE (perf_vfs_1_read ("/rom/perf.bin", "perf.bin") != 0U);
+  ASSERT_TRUE (rt_fs_open ("/rom/perf.bin", RT_OPEN_WRONLY) == RT_ERR_BUSY);
+  ASSERT_TRUE (rt_fs_open ("/rom/perf.bin", RT_OPEN_RDWR | RT_OPEN_APPEND) == RT_ERR_BUSY);
+  ASSERT_TRUE (rt_fs_remove ("/rom/perf.bin") == RT_ERR_BUSY);
+  ASSERT_TRUE (rt_fs_lookup ("perf.bin", &ent) == 0);
+
+  /* Write-through mount: the data is programmed to flash by the write */
+  fd = rt_fs_open ("/nor/perf.bin", RT_OPEN_WRONLY | RT_OPEN_CREATE | RT_OPEN_TRUNCATE);
+  ASSERT_TRUE (fd >= 0);
+  if (fd >= 0) {
+    ASSERT_TRUE (rt_logfs_get_stats (&s0) == 0);
+    ASSERT_TRUE (rt_fs_write (fd, "/nor/per", 8U) == 8);
+    ASSERT_TRUE (rt_logfs_get_stats (&s1) == 0);
+    ASSERT_TRUE ((s1.data_bytes - s0.data_bytes) == 8U);
+    ASSERT_TRUE (s1.prog_bytes > s0.prog_bytes);
+    ASSERT_TRUE (rt_fs_close (fd) == 0);
+    ASSERT_TRUE (perf_vfs_1_read ("/nor/perf.bin", "/nor/per") != 0U);
+    remove ("/nor/perf.bin");
+  }
+#endif
+
+  if (t_ram != 0U) {
+    remove ("/ram/perf.bin");
+  }
+  remove ("perf.bin");
+#endif
+}
+
+#if (TC_PERF_LOGFS_1_EN)
+/* Record size */
+#define PERF_LOGFS_1_REC        32U
+
+/* Fill a record with a pattern depending on its offset in the file */
+static void perf_logfs_1_fill (uint8_t *rec, uint32_t ofs) {
+  uint32_t i;
+
+  for (i = 0U; i < PERF_LOGFS_1_REC; i++) {
+    rec[i] = (uint8_t)((ofs + i) ^ (ofs >> 8));
+  }
+}
+
+/* Append cnt bytes in records to two files in turn, size bytes per file,
+   write-through (wt) or write-back, returns time in us or 0 on error.
+   With the mount table, "/nor" is mounted write-through: write-back runs
+   call the backend directly. */
+static uint32_t perf_logfs_1_write (uint32_t cnt, uint32_t size, uint32_t wt) {
+  int32_t (*fs_open)  (const char *path, int32_t mode)            = rt_fs_open;
+  int32_t (*fs_close) (int32_t fd)                                = rt_fs_close;
+  int32_t (*fs_write) (int32_t fd, const void *buf, uint32_t cnt) = rt_fs_write;
+  int32_t (*fs_read)  (int32_t fd, void *buf, uint32_t cnt)       = rt_fs_read;
+  const char *dir = "/nor/";
+  uint8_t rec[PERF_LOGFS_1_REC];
+  char path[24];
+  uint32_t start, t, ofs, i;
+  int32_t fd;
+
+#if defined(RT_FS_VFS)
+  if (wt == 0U) {
+    fs_open  = rt_fs_ops_logfs.open;
+    fs_close = rt_fs_ops_logfs.close;
+    fs_write = rt_fs_ops_logfs.write;
+    fs_read  = rt_fs_ops_logfs.read;
+    dir      = "";
+  }
+  /* The mount flushes each write */
+  wt = 0U;
+#endif
+
+  fd      = -1;
+  path[0] = '\0';
+  ofs     = 0U;
+
+  start = osKernelGetSysTimerCount();
+
+  for (i = 0U; i < cnt; i += PERF_LOGFS_1_REC) {
+    if ((i % size) == 0U) {
+      /* Start over with the other file */
+      if ((fd >= 0) && (fs_close (fd) != 0)) {
+        return (0U);
+      }
+      snprintf (path, sizeof(path), "%slog%u.bin", dir, (unsigned int)((i / size) & 1U));
+      fd = fs_open (path, RT_OPEN_WRONLY | RT_OPEN_CREATE | RT_OPEN_TRUNCATE);
+      if (fd < 0) {
+        return (0U);
+      }
+      ofs = 0U;
+    }
+    perf_logfs_1_fill (rec, ofs);
+    if (fs_write (fd, rec, PERF_LOGFS_1_REC) != (int32_t)PERF_LOGFS_1_REC) {
+      fs_close (fd);
+      return (0U);
+    }
+    if ((wt != 0U) && (rt_fs_flush (fd) != 0)) {
+      fs_close (fd);
+      return (0U);
+    }
+    ofs += PERF_LOGFS_1_REC;
+  }
+  if ((fd >= 0) && (fs_close (fd) != 0)) {
+    return (0U);
+  }
+
+  t = perf_elapsed_us (start) + 1U;
+
+  /* Verify the last file written */
+  fd = fs_open (path, RT_OPEN_RDONLY);
+  if (fd < 0) {
+    return (0U);
+  }
+  for (i = 0U; i < ofs; i += PERF_LOGFS_1_REC) {
+    uint8_t exp[PERF_LOGFS_1_REC];
+
+    perf_logfs_1_fill (exp, i);
+    if ((fs_read (fd, rec, PERF_LOGFS_1_REC) != (int32_t)PERF_LOGFS_1_REC) ||
+        (memcmp (rec, exp, PERF_LOGFS_1_REC) != 0)) {
+      t = 0U;
+      break;
+    }
+  }
+  fs_close (fd);
+
+  return (t);
+}
+
+/* Write amplification in 1/100: bytes programmed per byte of file data */
+static uint32_t perf_logfs_1_wa (const rt_logfs_stats_t *s0, const rt_logfs_stats_t *s1) {
+  uint32_t data;
+
+  data = s1->data_bytes - s0->data_bytes;
+  if (data == 0U) {
+    return (0U);
+  }
+  return ((uint32_t)(((uint64_t)(s1->prog_bytes - s0->prog_bytes) * 100U) / data));
+}
+#endif
+
+/**
+rief Test case: TC_perf_logfs_1
+\details
+  - Append 256 KB in 32 byte records to "/nor/log0.bin" and "/nor/log1.bin",
+    truncating the other file each 32 KB (write-back)
+  - Append 64 KB with a flush after each record (write-through, by the
+    RT_VFS_WRITE_THROUGH mount of "/nor" with the mount table), truncating
+    the other file each 4 KB (one index entry per record)
+  - Verify the content of the last file written in each run
+  - Report data rate and write amplification of each run, and the lowest
+    and highest erase count of the flash sectors
+*/
+void TC_perf_logfs_1 (void) {
+#if (TC_PERF_LOGFS_1_EN)
+  char msg[96];
+  rt_logfs_stats_t s0, s1, s2;
+  uint32_t t_wb, t_wt;
+
+  /* The first access mounts the file system */
+  t_wb = perf_logfs_1_write (PERF_LOGFS_1_REC, PERF_LOGFS_1_REC, 1U);
+  if (t_wb == 0U) {
+    TEST_MESSAGE ("/nor not mounted");
+    return;
+  }
+  ASSERT_TRUE (rt_logfs_get_stats (&s0) == 0);
+
+  t_wb = perf_logfs_1_write (256U * 1024U, 32U * 1024U, 0U);
+  ASSERT_TRUE (t_wb != 0U);
+  ASSERT_TRUE (rt_logfs_get_stats (&s1) == 0);
+
+  t_wt = perf_logfs_1_write (64U * 1024U, 4U * 1024U, 1U);
+  ASSERT_TRUE (t_wt != 0U);
+  ASSERT_TRUE (rt_logfs_get_stats (&s2) == 0);
+
+  snprintf (msg, sizeof(msg), "write-back: %u KB/s, write amplification %u.%02u",
+                              (unsigned int)(perf_rate (256U * 1024U, t_wb) / 1024U),
+                              (unsigned int)(perf_logfs_1_wa (&s0, &s1) / 100U),
+                              (unsigned int)(perf_logfs_1_wa (&s0, &s1) % 100U));
+  TEST_MESSAGE (msg);
+
+  snprintf (msg, sizeof(msg), "write-through: %u KB/s, write amplification %u.%02u",
+                              (unsigned int)(perf_rate (64U * 1024U, t_wt) / 1024U),
+                              (unsigned int)(perf_logfs_1_wa (&s1, &s2) / 100U),
+                              (unsigned int)(perf_logfs_1_wa (&s1, &s2) % 100U));
+  TEST_MESSAGE (msg);
+
+  snprintf (msg, sizeof(msg), "%u sectors, erase count %u..%u, %u reclaimed",
+                              (unsigned int)s2.sector_num,
+                              (unsigned int)s2.erase_min,
+                              (unsigned int)s2.erase_max,
+                              (unsigned int)s2.gc_sectors);
+  TEST_MESSAGE (msg);
+
+  remove ("/nor/log0.bin");
+  remove ("/nor/log1.bin");
+#endif
+}
+
+#if (TC_PERF_THREADS_1_EN)
+/* Data written by all threads together in records, each thread flushes
+   its file every PERF_THREADS_1_FLUSH bytes */
+#define PERF_THREADS_1_SIZE     (16U * 1024U)
+#define PERF_THREADS_1_REC      128U
+#define PERF_THREADS_1_FLUSH    1024U
+
+/* Highest number of writer threads */
+#define PERF_THREADS_1_MAX      8U
+
+static const osThreadAttr_t perf_threads_1_attr = {
+  .stack_size = 1024U
+};
+
+static volatile int32_t  perf_threads_1_err;
+static volatile uint32_t perf_threads_1_size;
+
+/* Writer thread: write to its own file */
+static void perf_threads_1_thread (void *arg) {
+  uint32_t idx = (uint32_t)(uintptr_t)arg;
+  uint8_t rec[PERF_THREADS_1_REC];
+  char path[16];
+  uint32_t i;
+  int32_t fd;
+
+  snprintf (path, sizeof(path), "perf%u.bin", (unsigned int)idx);
+  memset (rec, '0' + (int)idx, sizeof(rec));
+
+  fd = rt_fs_open (path, RT_OPEN_WRONLY | RT_OPEN_CREATE | RT_OPEN_TRUNCATE);
+  if (fd < 0) {
+    perf_threads_1_err = fd;
+  } else {
+    for (i = 0U; i < perf_threads_1_size; i += PERF_THREADS_1_REC) {
+      if (rt_fs_write (fd, rec, PERF_THREADS_1_REC) != (int32_t)PERF_THREADS_1_REC) {
+        perf_threads_1_err = RT_ERR;
+        break;
+      }
+      if ((((i + PERF_THREADS_1_REC) % PERF_THREADS_1_FLUSH) == 0U) && (rt_fs_flush (fd) != 0)) {
+        perf_threads_1_err = RT_ERR;
+        break;
+      }
+    }
+    if (rt_fs_close (fd) != 0) {
+      perf_threads_1_err = RT_ERR;
+    }
+  }
+  osThreadFlagsSet (perf_main_id, 1U << idx);
+}
+#endif
+
+/**
+\brief Test case: TC_perf_threads_1
+\details
+  - Write 16 KB with 1, 2, 4 and 8 threads concurrently, each thread writes
+    its share to its own file in 128 byte records with a flush every 1 KB
+  - Report the total data rate for each number of threads
+  - With TC_PERF_THREADS_1_SCALE set, check that 8 writers are faster than 1
+*/
+void TC_perf_threads_1 (void) {
+#if (TC_PERF_THREADS_1_EN)
+  char msg[96];
+  uint32_t rate[4];
+  uint32_t start, t, n, i, k;
+
+  perf_main_id       = osThreadGetId();
+  perf_threads_1_err = 0;
+
+  for (n = 1U, k = 0U; n <= PERF_THREADS_1_MAX; n *= 2U, k++) {
+    perf_threads_1_size = PERF_THREADS_1_SIZE / n;
+
+    start = osKernelGetSysTimerCount();
+
+    for (i = 0U; i < n; i++) {
+      ASSERT_TRUE (osThreadNew (perf_threads_1_thread, (void *)(uintptr_t)i, &perf_threads_1_attr) != NULL);
+    }
+    ASSERT_TRUE (osThreadFlagsWait ((1U << n) - 1U, osFlagsWaitAll, osWaitForever) < 0x80000000U);
+
+    t = perf_elapsed_us (start);
+    rate[k] = perf_rate (PERF_THREADS_1_SIZE, t) / 1024U;
+
+    for (i = 0U; i < n; i++) {
+      snprintf (msg, sizeof(msg), "perf%u.bin", (unsigned int)i);
+      remove (msg);
+    }
+  }
+  ASSERT_TRUE (perf_threads_1_err == 0);
+
+  snprintf (msg, sizeof(msg), "1, 2, 4, 8 writers: %u, %u, %u, %u KB/s",
+                              (unsigned int)rate[0],
+                              (unsigned int)rate[1],
+                              (unsigned int)rate[2],
+                              (unsigned int)rate[3]);
+  TEST_MESSAGE (msg);
+
+#if (TC_PERF_THREADS_1_SCALE)
+  ASSERT_TRUE (rate[3] > rate[0]);
+#endif
+#endif
+}
+
+#if (TC_PERF_SYNC_1_EN)
+/* Records appended to the log and made durable one by one */
+#define PERF_SYNC_1_REC         64U
+#define PERF_SYNC_1_CNT         64U
+
+/* Threads appending to the shared log */
+#define PERF_SYNC_1_THREADS     4U
+
+static const osThreadAttr_t perf_sync_1_attr = {
+  .stack_size = 1024U
+};
+
+static volatile int32_t perf_sync_1_fd;
+static volatile int32_t perf_sync_1_err;
+
+/* Appender thread: write its share of the records to the shared log, sync each */
+static void perf_sync_1_thread (void *arg) {
+  uint32_t idx = (uint32_t)(uintptr_t)arg;
+  uint8_t rec[PERF_SYNC_1_REC];
+  uint32_t i;
+
+  memset (rec, 'A' + (int)idx, sizeof(rec));
+
+  for (i = 0U; i < (PERF_SYNC_1_CNT / PERF_SYNC_1_THREADS); i++) {
+    if (rt_fs_write (perf_sync_1_fd, rec, PERF_SYNC_1_REC) != (int32_t)PERF_SYNC_1_REC) {
+      perf_sync_1_err = RT_ERR;
+      break;
+    }
+    if (rt_fs_sync (perf_sync_1_fd) != 0) {
+      perf_sync_1_err = RT_ERR;
+      break;
+    }
+  }
+  osThreadFlagsSet (perf_main_id, 1U << idx);
+}
+#endif
+
+/**
+\brief Test case: TC_perf_sync_1
+\details
+  - Append 64 records of 64 bytes to a log, each made durable by closing
+    and reopening the file, then by rt_fs_sync
+  - Append the records from 4 threads sharing the log, each record synced
+  - Report durable records per second and, when the retarget provides
+    statistics, the number of rt_fs_sync calls and of file commits; check
+    that the threads were committed in groups (fewer commits than calls)
+  - Closing the file is durable where the file system commits on close
+    (MDK-FS, Project/Host/mdkfs_host.c); on the host file system it is not,
+    so the first rate is only comparable on such file systems
+*/
+void TC_perf_sync_1 (void) {
+#if (TC_PERF_SYNC_1_EN)
+  rt_fs_cache_stats_t s1, s2;
+  uint8_t rec[PERF_SYNC_1_REC];
+  char msg[96];
+  uint32_t start, t, i;
+  uint32_t rate[3];
+  int32_t fd, rval, stats;
+
+  memset (rec, 'x', sizeof(rec));
+  remove ("perf_log.bin");
+
+  /* Durable by closing the file */
+  start = osKernelGetSysTimerCount();
+  for (i = 0U; i < PERF_SYNC_1_CNT; i++) {
+    fd = rt_fs_open ("perf_log.bin", RT_OPEN_WRONLY | RT_OPEN_CREATE | RT_OPEN_APPEND);
+    ASSERT_TRUE (fd >= 0);
+    if (fd < 0) {
+      return;
+    }
+    ASSERT_TRUE (rt_fs_write (fd, rec, PERF_SYNC_1_REC) == (int32_t)PERF_SYNC_1_REC);
+    ASSERT_TRUE (rt_fs_close (fd) == 0);
+  }
+  t = perf_elapsed_us (start);
+  rate[0] = perf_rate (PERF_SYNC_1_CNT, t);
+
+  /* Durable by rt_fs_sync */
+  fd = rt_fs_open ("perf_log.bin", RT_OPEN_WRONLY | RT_OPEN_CREATE | RT_OPEN_TRUNCATE);
+  ASSERT_TRUE (fd >= 0);
+  if (fd < 0) {
+    return;
+  }
+  rval = rt_fs_sync (fd);
+  if (rval == RT_ERR_NOTSUP) {
+    rt_fs_close (fd);
+    remove ("perf_log.bin");
+    TEST_MESSAGE ("rt_fs_sync not supported");
+    return;
+  }
+  ASSERT_TRUE (rval == 0);
+
+  start = osKernelGetSysTimerCount();
+  for (i = 0U; i < PERF_SYNC_1_CNT; i++) {
+    ASSERT_TRUE (rt_fs_write (fd, rec, PERF_SYNC_1_REC) == (int32_t)PERF_SYNC_1_REC);
+    ASSERT_TRUE (rt_fs_sync (fd) == 0);
+  }
+  t = perf_elapsed_us (start);
+  rate[1] = perf_rate (PERF_SYNC_1_CNT, t);
+
+  /* Several threads appending to the log */
+  stats = rt_fs_cache_get_stats (&s1);
+
+  perf_main_id    = osThreadGetId();
+  perf_sync_1_fd  = fd;
+  perf_sync_1_err = 0;
+
+  start = osKernelGetSysTimerCount();
+  for (i = 0U; i < PERF_SYNC_1_THREADS; i++) {
+    ASSERT_TRUE (osThreadNew (perf_sync_1_thread, (void *)(uintptr_t)i, &perf_sync_1_attr) != NULL);
+  }
+  ASSERT_TRUE (osThreadFlagsWait ((1U << PERF_SYNC_1_THREADS) - 1U, osFlagsWaitAll, osWaitForever) < 0x80000000U);
+  t = perf_elapsed_us (start);
+  rate[2] = perf_rate (PERF_SYNC_1_CNT, t);
+
+  if (stats == 0) {
+    stats = rt_fs_cache_get_stats (&s2);
+  }
+
+  ASSERT_TRUE (perf_sync_1_err == 0);
+  ASSERT_TRUE (rt_fs_size (fd) == (int64_t)(2U * PERF_SYNC_1_CNT * PERF_SYNC_1_REC));
+  ASSERT_TRUE (rt_fs_close (fd) == 0);
+  remove ("perf_log.bin");
+
+  snprintf (msg, sizeof(msg), "close/reopen: %u, rt_fs_sync: %u, %u threads: %u records/s",
+                              (unsigned int)rate[0],
+                              (unsigned int)rate[1],
+                              (unsigned int)PERF_SYNC_1_THREADS,
+                              (unsigned int)rate[2]);
+  TEST_MESSAGE (msg);
+
+  if (stats == 0) {
+    snprintf (msg, sizeof(msg), "%u threads: %u rt_fs_sync calls, %u commits",
+                                (unsigned int)PERF_SYNC_1_THREADS,
+                                (unsigned int)(s2.syncs   - s1.syncs),
+                                (unsigned int)(s2.commits - s1.commits));
+    TEST_MESSAGE (msg);
+
+    if (s2.syncs != s1.syncs) {
+      /* Group commit */
+      ASSERT_TRUE ((s2.commits - s1.commits) < (s2.syncs - s1.syncs));
+    }
+  }
+#endif
+}
+
+/**
+@}
+*/
+// end of group perf_funcs
@@ -19,9 +19,13 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <errno.h>
 
 #include "test.h"
+#include "retarget_stdio.h"
+#include "retarget_fs.h"
+#include "retarget_fs_ext.h"
 
 static int Fn_OpenWriteClose (const char *path, uint32_t cnt);
 
@@ -507,6 +511,45 @@ void TC_fseek_2 (void) {
 #endif
 }
 
+/**
+\brief Test case: TC_fseek_3
+\details
+  - Call fseek with SEEK_END and SEEK_CUR and check position with ftell
+*/
+void TC_fseek_3 (void) {
+#if (TC_FSEEK_3_EN)
+  FILE *f;
+  const char *path;
+
+  path = "file.txt";
+
+  f = fopen (path, "w+");
+  ASSERT_TRUE (f != NULL);
+
+  if (f != NULL) {
+    /* Write 32 bytes to the file */
+    ASSERT_TRUE (fputs ("01234567890123456789012345678901", f) >= 0);
+
+    /* Call fseek with SEEK_END and offset == -4 */
+    ASSERT_TRUE (fseek(f, -4, SEEK_END) == 0);
+    ASSERT_TRUE (ftell(f) == 28);
+    ASSERT_TRUE (fgetc(f) == '8');
+
+    /* Call fseek with SEEK_CUR and offset == -10 */
+    ASSERT_TRUE (fseek(f, -10, SEEK_CUR) == 0);
+    ASSERT_TRUE (ftell(f) == 19);
+    ASSERT_TRUE (fgetc(f) == '9');
+
+    /* Call fseek with SEEK_END and offset == 0 (EOF) */
+    ASSERT_TRUE (fseek(f, 0, SEEK_END) == 0);
+    ASSERT_TRUE (ftell(f) == 32);
+
+    /* Close opened file */
+    ASSERT_TRUE (fclose(f) == 0);
+  }
+#endif
+}
+
 
 /**
 \brief Test case: TC_fgetpos_1
@@ -541,6 +584,85 @@ void TC_fgetpos_1 (void) {
 #endif
 }
 
+/**
+\brief Test case: TC_rt_fs_flush_1
+\details
+  - Open a file in append mode with rt_fs_open
+  - Write 10 bytes and call rt_fs_flush, twice
+  - Check that the file holds the 20 bytes written, each once
+*/
+void TC_rt_fs_flush_1 (void) {
+#if (TC_RT_FS_FLUSH_1_EN)
+  const char *path;
+  char buf[32];
+  int32_t fd, rval;
+
+  path = "file.txt";
+
+  ASSERT_TRUE (Fn_OpenWriteClose(path, 0) == 0);
+
+  /* Open a file in append mode */
+  fd = rt_fs_open (path, RT_OPEN_WRONLY | RT_OPEN_APPEND);
+  ASSERT_TRUE (fd >= 0);
+
+  if (fd >= 0) {
+    /* Write and flush, twice */
+    ASSERT_TRUE (rt_fs_write (fd, "0123456789", 10U) == 10);
+    rval = rt_fs_flush (fd);
+    ASSERT_TRUE ((rval == 0) || (rval == RT_ERR_NOTSUP));
+
+    ASSERT_TRUE (rt_fs_write (fd, "abcdefghij", 10U) == 10);
+    rval = rt_fs_flush (fd);
+    ASSERT_TRUE ((rval == 0) || (rval == RT_ERR_NOTSUP));
+
+    /* Close opened file */
+    ASSERT_TRUE (rt_fs_close (fd) == 0);
+  }
+
+  /* Data written before a flush is not written again */
+  fd = rt_fs_open (path, RT_OPEN_RDONLY);
+  ASSERT_TRUE (fd >= 0);
+
+  if (fd >= 0) {
+    ASSERT_TRUE (rt_fs_read (fd, buf, sizeof(buf)) == 20);
+    ASSERT_TRUE (memcmp (buf, "0123456789abcdefghij", 20U) == 0);
+
+    /* Close opened file */
+    ASSERT_TRUE (rt_fs_close (fd) == 0);
+  }
+#endif
+}
+
+/**
+\brief Test case: TC_rt_fs_open_1
+\details
+  - Open the same file three times with rt_fs_open
+  - Check that no handle is one of the standard stream handles 0 to 2
+*/
+void TC_rt_fs_open_1 (void) {
+#if (TC_RT_FS_OPEN_1_EN)
+  const char *path;
+  int32_t fd[3];
+  uint32_t i;
+
+  path = "file.txt";
+
+  ASSERT_TRUE (Fn_OpenWriteClose(path, 0) == 0);
+
+  for (i = 0U; i < 3U; i++) {
+    fd[i] = rt_fs_open (path, RT_OPEN_RDONLY);
+    ASSERT_TRUE (fd[i] > 2);
+  }
+
+  /* Close opened files */
+  for (i = 0U; i < 3U; i++) {
+    if (fd[i] >= 0) {
+      ASSERT_TRUE (rt_fs_close (fd[i]) == 0);
+    }
+  }
+#endif
+}
+
 
 /**
 \brief Test case: TC_getchar_1
@@ -557,6 +679,22 @@ void TC_getchar_1 (void) {
 #endif
 }
 
+/**
+\brief Test case: TC_stdin_read_1
+\details
+  - Call stdin_read to get all bytes already received from the stdin
+*/
+void TC_stdin_read_1 (void) {
+#if (TC_STDIN_READ_1_EN)
+  uint8_t buf[32];
+  int32_t n;
+
+  /* Call stdin_read to get all bytes already received from the stdin */
+  n = stdin_read (buf, sizeof(buf));
+  ASSERT_TRUE ((n > 0) && (n <= (int32_t)sizeof(buf)));
+#endif
+}
+
 /**
 \brief Test case: TC_scanf_1
 \details
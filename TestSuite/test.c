@@ -79,13 +79,41 @@ static const TEST_CASE TC_List[] = {
 
   TCD ( TC_fseek_1,                      TC_FSEEK_1_EN ),
   TCD ( TC_fseek_2,                      TC_FSEEK_2_EN ),
+  TCD ( TC_fseek_3,                      TC_FSEEK_3_EN ),
   
   TCD ( TC_fgetpos_1,                    TC_FGETPOS_1_EN ),
 
+  TCD ( TC_rt_fs_flush_1,                TC_RT_FS_FLUSH_1_EN ),
+  TCD ( TC_rt_fs_open_1,                 TC_RT_FS_OPEN_1_EN ),
+
   TCD ( TC_getchar_1,                    TC_GETCHAR_1_EN ),
 
+  TCD ( TC_stdin_read_1,                 TC_STDIN_READ_1_EN ),
+
   TCD ( TC_scanf_1,                      TC_SCANF_1_EN ),
   TCD ( TC_scanf_2,                      TC_SCANF_2_EN ),
+
+  TCD ( TC_perf_stdout_1,                TC_PERF_STDOUT_1_EN ),
+  TCD ( TC_perf_stdout_2,                TC_PERF_STDOUT_2_EN ),
+  TCD ( TC_perf_stdout_3,                TC_PERF_STDOUT_3_EN ),
+  TCD ( TC_perf_stdout_4,                TC_PERF_STDOUT_4_EN ),
+  TCD ( TC_perf_stderr_1,                TC_PERF_STDERR_1_EN ),
+  TCD ( TC_perf_log_1,                   TC_PERF_LOG_1_EN ),
+  TCD ( TC_perf_itm_1,                   TC_PERF_ITM_1_EN ),
+  TCD ( TC_perf_fwrite_1,                TC_PERF_FWRITE_1_EN ),
+  TCD ( TC_perf_fread_1,                 TC_PERF_FREAD_1_EN ),
+  TCD ( TC_perf_rename_1,                TC_PERF_RENAME_1_EN ),
+  TCD ( TC_perf_map_1,                   TC_PERF_MAP_1_EN ),
+  TCD ( TC_perf_writev_1,                TC_PERF_WRITEV_1_EN ),
+  TCD ( TC_perf_aio_1,                   TC_PERF_AIO_1_EN ),
+  TCD ( TC_perf_seek_1,                  TC_PERF_SEEK_1_EN ),
+  TCD ( TC_perf_lookup_1,                TC_PERF_LOOKUP_1_EN ),
+  TCD ( TC_perf_fd_1,                    TC_PERF_FD_1_EN ),
+  TCD ( TC_perf_large_1,                 TC_PERF_LARGE_1_EN ),
+  TCD ( TC_perf_vfs_1,                   TC_PERF_VFS_1_EN ),
+  TCD ( TC_perf_logfs_1,                 TC_PERF_LOGFS_1_EN ),
+  TCD ( TC_perf_threads_1,               TC_PERF_THREADS_1_EN ),
+  TCD ( TC_perf_sync_1,                  TC_PERF_SYNC_1_EN ),
 //  TCD ( , ),
 };
 
@@ -67,12 +67,40 @@ extern void TC_fread_1 (void);
 
 extern void TC_fseek_1 (void);
 extern void TC_fseek_2 (void);
+extern void TC_fseek_3 (void);
 
 extern void TC_fgetpos_1 (void);
 
+extern void TC_rt_fs_flush_1 (void);
+extern void TC_rt_fs_open_1 (void);
+
 extern void TC_getchar_1 (void);
 
+extern void TC_stdin_read_1 (void);
+
 extern void TC_scanf_1 (void);
 extern void TC_scanf_2 (void);
 
+extern void TC_perf_stdout_1 (void);
+extern void TC_perf_stdout_2 (void);
+extern void TC_perf_stdout_3 (void);
+extern void TC_perf_stdout_4 (void);
+extern void TC_perf_stderr_1 (void);
+extern void TC_perf_log_1 (void);
+extern void TC_perf_itm_1 (void);
+extern void TC_perf_fwrite_1 (void);
+extern void TC_perf_fread_1 (void);
+extern void TC_perf_rename_1 (void);
+extern void TC_perf_map_1 (void);
+extern void TC_perf_writev_1 (void);
+extern void TC_perf_aio_1 (void);
+extern void TC_perf_seek_1 (void);
+extern void TC_perf_lookup_1 (void);
+extern void TC_perf_fd_1 (void);
+extern void TC_perf_large_1 (void);
+extern void TC_perf_vfs_1 (void);
+extern void TC_perf_logfs_1 (void);
+extern void TC_perf_threads_1 (void);
+extern void TC_perf_sync_1 (void);
+
 #endif /* TEST_H__ */
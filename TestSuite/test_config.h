@@ -51,13 +51,57 @@
 
 #define TC_FSEEK_1_EN                     1
 #define TC_FSEEK_2_EN                     1
+#define TC_FSEEK_3_EN                     1
 
 #define TC_FGETPOS_1_EN                   1
 
+#define TC_RT_FS_FLUSH_1_EN               1
+#define TC_RT_FS_OPEN_1_EN                1
+
 #define TC_GETCHAR_1_EN                   0
 
+#define TC_STDIN_READ_1_EN                0
+
 #define TC_SCANF_1_EN                     0
 #define TC_SCANF_2_EN                     0
 
+/* Performance measurements (output results to stdout) */
+#ifndef TC_PERF_EN
+#define TC_PERF_EN                        0
+#endif
+
+#define TC_PERF_STDOUT_1_EN               TC_PERF_EN
+#define TC_PERF_STDOUT_2_EN               TC_PERF_EN
+#define TC_PERF_STDOUT_3_EN               TC_PERF_EN
+#define TC_PERF_STDOUT_4_EN               TC_PERF_EN
+#define TC_PERF_STDERR_1_EN               TC_PERF_EN
+#define TC_PERF_LOG_1_EN                  TC_PERF_EN
+#define TC_PERF_ITM_1_EN                  TC_PERF_EN
+#define TC_PERF_FWRITE_1_EN               TC_PERF_EN
+#define TC_PERF_FREAD_1_EN                TC_PERF_EN
+#define TC_PERF_RENAME_1_EN               TC_PERF_EN
+#define TC_PERF_MAP_1_EN                  TC_PERF_EN
+#define TC_PERF_WRITEV_1_EN               TC_PERF_EN
+#define TC_PERF_AIO_1_EN                  TC_PERF_EN
+#define TC_PERF_SEEK_1_EN                 TC_PERF_EN
+#define TC_PERF_LOOKUP_1_EN               TC_PERF_EN
+#define TC_PERF_FD_1_EN                   TC_PERF_EN
+#define TC_PERF_LARGE_1_EN                TC_PERF_EN
+#define TC_PERF_VFS_1_EN                  TC_PERF_EN
+#define TC_PERF_THREADS_1_EN              TC_PERF_EN
+#define TC_PERF_SYNC_1_EN                 TC_PERF_EN
+
+/* Requires Project/retarget_logfs.c mounted at "/nor" */
+#ifndef TC_PERF_LOGFS_1_EN
+#define TC_PERF_LOGFS_1_EN                0
+#endif
+
+/* TC_perf_threads_1 checks that 8 writers are faster than 1: requires a file
+   system waiting for the drive without blocking other files, i.e.
+   Project/retarget_mdk-fs.c on Project/Host/mdkfs_host.c */
+#ifndef TC_PERF_THREADS_1_SCALE
+#define TC_PERF_THREADS_1_SCALE           0
+#endif
+
 
 #endif /* RV2_CONFIG_H__ */